@@ -0,0 +1,861 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements benchmarks for the base64 encoding and decoding
+/// functions and the runtime object field lookup in libblob.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdlib.h>
+#include <string.h>
+#include "benchmark.hpp"
+#include "libblob.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the number of field lookups performed by each iteration.
+#define LOOKUP_COUNT          256
+/// the number of fields in each top-level object of the optimize input.
+#define RECORD_FIELD_COUNT    64
+/// the name of field i of each record, as hashed from a field name string.
+#define RECORD_FIELD_NAME(i)  uint32_t((i) * 0x9E3779B9U + 0x7F4A7C15U)
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct base64_input_t
+{
+    size_t   binary_size; /// number of bytes of binary data, excluding slack
+    size_t   text_size;   /// number of bytes of base64 text, excluding NULL
+    size_t   text_max;    /// number of bytes allocated for text
+    uint8_t *binary;      /// the binary data
+    char    *text;        /// the base64-encoded binary data
+};
+
+struct object_input_t
+{
+    blob::runtime_object_t object;  /// the optimized object being searched
+    uint8_t  *generic;              /// the generic object blob
+    uint8_t  *optimized;            /// the optimized object blob
+    uint32_t  names[LOOKUP_COUNT];  /// the field names to look up, in order
+};
+
+struct optimize_input_t
+{
+    size_t    generic_size;         /// number of bytes of generic blob data
+    size_t    optimized_size;       /// number of bytes of optimized blob data
+    uint8_t  *generic;              /// a sequence of generic object records
+    uint8_t  *optimized;            /// the output of each iteration
+};
+
+struct compress_input_t
+{
+    optimize_input_t *records;      /// the blob being compressed
+    size_t    bound;                /// number of bytes allocated for container
+    size_t    container_size;       /// number of bytes of compressed data
+    uint8_t  *container;            /// the compressed blob
+    uint8_t  *output;               /// the output of each iteration
+};
+
+struct patch_input_t
+{
+    optimize_input_t *records;      /// the old blob
+    uint8_t  *updated;              /// the new blob
+    size_t    patch_max;            /// number of bytes allocated for patch
+    size_t    patch_size;           /// number of bytes of patch data
+    uint8_t  *patch;                /// the patch from old to new blob
+    uint8_t  *output;               /// the output of each iteration
+};
+
+struct swap_input_t
+{
+    size_t    count;                /// number of matrices in the array
+    size_t    blob_size;            /// number of bytes of blob data
+    uint8_t  *pristine;             /// the big-endian blob
+    uint8_t  *work;                 /// the copy converted by each iteration
+};
+
+struct record_schema
+{
+    typedef blob::schema_field_t<uint32_t, RECORD_FIELD_NAME(5),  0> id;
+    typedef blob::schema_field_t<uint32_t, RECORD_FIELD_NAME(21), 1> flags;
+    typedef blob::schema_field_t<uint32_t, RECORD_FIELD_NAME(38), 2> parent;
+    typedef blob::schema_field_t<uint32_t, RECORD_FIELD_NAME(60), 3> weight;
+    typedef blob::schema_list_t<id,
+            blob::schema_list_t<flags,
+            blob::schema_list_t<parent,
+            blob::schema_list_t<weight> > > > fields;
+};
+
+struct schema_input_t
+{
+    optimize_input_t *records;      /// the optimized records
+    size_t    record_count;         /// number of records in the blob
+    blob::runtime_object_t              *objects;   /// each record
+    blob::schema_object_t<record_schema> *accessors; /// bound to each record
+};
+
+struct builder_input_t
+{
+    size_t          record_count;   /// number of objects written per iteration
+    blob::builder_t builder;        /// the builder, reused by each iteration
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_input(size_t size, size_t *inout_bytes)
+{
+    CMN_UNUSED(inout_bytes);
+    size_t          text_max = blob::base64_size(size, NULL);
+    size_t          slack    = blob::base64_stream_size(4096);
+    size_t          total    = sizeof(base64_input_t) + size + slack + text_max;
+    base64_input_t *input    = (base64_input_t*) ::malloc(total);
+    if (input != NULL)
+    {
+        input->binary_size = size;
+        input->text_max    = text_max;
+        input->binary      = (uint8_t*) (input + 1);
+        input->text        = (char*) (input->binary + size + slack);
+        for (size_t i = 0; i < size; ++i)
+        {
+            input->binary[i] = uint8_t(i * 131 + 7);
+        }
+        input->text_size   = blob::base64_encode(input->binary, size, input->text, text_max);
+        while (input->text_size > 0 && '\0' == input->text[input->text_size - 1])
+        {
+            // the returned size includes the NULL-terminator.
+            input->text_size--;
+        }
+    }
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_input(void *context)
+{
+    ::free(context);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_base64_encode(void *context, size_t iterations)
+{
+    base64_input_t *input = (base64_input_t*) context;
+    size_t          total = 0;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        total += blob::base64_encode(input->binary, input->binary_size, input->text, input->text_max);
+    }
+    bench::consume(uint32_t(total));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_base64_decode(void *context, size_t iterations)
+{
+    base64_input_t *input = (base64_input_t*) context;
+    size_t          total = 0;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        total += blob::base64_decode(input->text, input->text_size, input->binary, input->binary_size);
+    }
+    bench::consume(uint32_t(total));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_base64_encode_scalar(void *context, size_t iterations)
+{
+    // the portable code path, as a reference for the SIMD speedup.
+    blob::base64_select_isa(blob::BASE64_ISA_SCALAR);
+    run_base64_encode(context, iterations);
+    blob::base64_select_isa(blob::BASE64_ISA_AVX2);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_base64_decode_scalar(void *context, size_t iterations)
+{
+    // the portable code path, as a reference for the SIMD speedup.
+    blob::base64_select_isa(blob::BASE64_ISA_SCALAR);
+    run_base64_decode(context, iterations);
+    blob::base64_select_isa(blob::BASE64_ISA_AVX2);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_base64_decode_stream(void *context, size_t iterations)
+{
+    // decode the text in 4KB chunks, as when reading from a file. the
+    // binary buffer has slack for the worst-case size of a final chunk.
+    base64_input_t *input = (base64_input_t*) context;
+    size_t          total = 0;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        blob::base64_stream_t stream;
+        blob::base64_stream_init(&stream);
+        uint8_t *output = input->binary;
+        for (size_t offset = 0; offset < input->text_size; offset += 4096)
+        {
+            size_t chunk = input->text_size - offset;
+            if (chunk > 4096) chunk = 4096;
+            output += blob::base64_decode_update(&stream, input->text + offset, chunk, output, blob::base64_stream_size(chunk));
+        }
+        total += size_t(output - input->binary);
+    }
+    bench::consume(uint32_t(total));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_object(void *context)
+{
+    object_input_t *input = (object_input_t*) context;
+    ::free(input->optimized);
+    ::free(input->generic);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* setup_object(size_t field_count, int32_t flags)
+{
+    // a single generic object with field_count 4-byte fields named by
+    // scattered 32-bit values, as produced by hashing field name strings.
+    size_t          field_size = sizeof(uint32_t) * 3 + sizeof(uint32_t);
+    size_t          data_size  = field_count * field_size;
+    size_t          total_size = sizeof(int32_t) + sizeof(uint32_t) * 2 + data_size;
+    object_input_t *input      = (object_input_t*) ::calloc(1, sizeof(object_input_t));
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->generic = (uint8_t*) ::malloc(total_size);
+    if (NULL == input->generic)
+    {
+        teardown_object(input);
+        return NULL;
+    }
+    size_t offset  = blob::write_generic_object(input->generic, 0);
+    offset += blob::write_generic_object_info(input->generic, offset, field_count, data_size);
+    for (size_t i = 0; i < field_count; ++i)
+    {
+        uint32_t name  = uint32_t(i * 0x9E3779B9U + 0x7F4A7C15U);
+        uint32_t value = uint32_t(i);
+        offset += blob::write_generic_object_field(input->generic, offset, name, blob::FIELD_TYPE_UINT32, &value, sizeof(value));
+    }
+    size_t optimized_size = blob::optimized_size(input->generic, total_size, flags);
+    input->optimized = (uint8_t*) ::malloc(optimized_size);
+    if (NULL == input->optimized)
+    {
+        teardown_object(input);
+        return NULL;
+    }
+    blob::optimize(input->optimized, input->generic, total_size, flags);
+    blob::runtime_object_at(input->optimized, sizeof(int32_t), &input->object);
+    // look up existing fields in a fixed pseudo-random order.
+    uint32_t seed = 0x9E3779B9U;
+    for (size_t i = 0; i < LOOKUP_COUNT; ++i)
+    {
+        seed = seed * 1664525U + 1013904223U;
+        input->names[i] = uint32_t(((seed >> 8) % field_count) * 0x9E3779B9U + 0x7F4A7C15U);
+    }
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_object_linear(size_t field_count, size_t *inout_bytes)
+{
+    CMN_UNUSED(inout_bytes);
+    return setup_object(field_count, blob::OPTIMIZE_FLAGS_NONE);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_object_indexed(size_t field_count, size_t *inout_bytes)
+{
+    CMN_UNUSED(inout_bytes);
+    return setup_object(field_count, blob::OPTIMIZE_FLAGS_FIELD_INDEX);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_object_search(void *context, size_t iterations)
+{
+    object_input_t *input = (object_input_t*) context;
+    uint32_t        total = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        for (size_t i = 0; i < LOOKUP_COUNT; ++i)
+        {
+            blob::runtime_object_field_t field;
+            if (blob::runtime_object_search(&input->object, input->names[i], &field) != blob::FIELD_TYPE_NONE)
+            {
+                total += *(uint32_t*) field.field_data;
+            }
+        }
+    }
+    bench::consume(total);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_optimize(void *context)
+{
+    optimize_input_t *input = (optimize_input_t*) context;
+    ::free(input->optimized);
+    ::free(input->generic);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_optimize(size_t record_count, size_t *inout_bytes)
+{
+    // a sequence of top-level generic objects, as found in a level or
+    // asset database, each with RECORD_FIELD_COUNT 4-byte fields.
+    size_t            field_size  = sizeof(uint32_t) * 3 + sizeof(uint32_t);
+    size_t            data_size   = RECORD_FIELD_COUNT * field_size;
+    size_t            record_size = sizeof(int32_t) + sizeof(uint32_t) * 2 + data_size;
+    optimize_input_t *input       = (optimize_input_t*) ::calloc(1, sizeof(optimize_input_t));
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->generic_size = record_count * record_size;
+    input->generic      = (uint8_t*) ::malloc(input->generic_size);
+    if (NULL == input->generic)
+    {
+        teardown_optimize(input);
+        return NULL;
+    }
+    size_t offset = 0;
+    for (size_t r = 0; r < record_count; ++r)
+    {
+        offset += blob::write_generic_object(input->generic, offset);
+        offset += blob::write_generic_object_info(input->generic, offset, RECORD_FIELD_COUNT, data_size);
+        for (size_t i = 0; i < RECORD_FIELD_COUNT; ++i)
+        {
+            uint32_t name  = uint32_t(i * 0x9E3779B9U + 0x7F4A7C15U);
+            uint32_t value = uint32_t(r + i);
+            offset += blob::write_generic_object_field(input->generic, offset, name, blob::FIELD_TYPE_UINT32, &value, sizeof(value));
+        }
+    }
+    input->optimized_size = blob::optimized_size(input->generic, input->generic_size, blob::OPTIMIZE_FLAGS_FIELD_INDEX);
+    input->optimized      = (uint8_t*) ::malloc(input->optimized_size);
+    if (NULL == input->optimized)
+    {
+        teardown_optimize(input);
+        return NULL;
+    }
+    *inout_bytes = input->generic_size;
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_optimize(void *context, size_t iterations)
+{
+    optimize_input_t *input = (optimize_input_t*) context;
+    size_t            total = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        total += blob::optimize(input->optimized, input->generic, input->generic_size, blob::OPTIMIZE_FLAGS_FIELD_INDEX);
+    }
+    bench::consume(uint32_t(total));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_optimize_parallel(void *context, size_t iterations)
+{
+    // the sizing pass is repeated on each iteration, since the plan is
+    // only valid for the blob it was created from.
+    optimize_input_t *input = (optimize_input_t*) context;
+    size_t            total = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        blob::optimize_plan_t plan;
+        if (blob::optimize_plan(input->generic, input->generic_size, 0, blob::OPTIMIZE_FLAGS_FIELD_INDEX, &plan))
+        {
+            total += blob::optimize_parallel(input->optimized, &plan);
+            blob::free_optimize_plan(&plan);
+        }
+    }
+    bench::consume(uint32_t(total));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_schema(void *context)
+{
+    schema_input_t *input = (schema_input_t*) context;
+    if (input->records != NULL) teardown_optimize(input->records);
+    ::free(input->accessors);
+    ::free(input->objects);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_schema(size_t record_count, size_t *inout_bytes)
+{
+    // the records are located and the accessors bound once, as when the
+    // blob is loaded; only the field reads are measured.
+    size_t          blob_size = 0;
+    schema_input_t *input     = (schema_input_t*) ::calloc(1, sizeof(schema_input_t));
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->record_count = record_count;
+    input->records      = (optimize_input_t*) setup_optimize(record_count, &blob_size);
+    input->objects      = (blob::runtime_object_t*) ::malloc(record_count * sizeof(blob::runtime_object_t));
+    input->accessors    = (blob::schema_object_t<record_schema>*) ::malloc(record_count * sizeof(blob::schema_object_t<record_schema>));
+    if (NULL == input->records || NULL == input->objects || NULL == input->accessors)
+    {
+        teardown_schema(input);
+        return NULL;
+    }
+    uint8_t  *optimized = input->records->optimized;
+    ptrdiff_t offset    = 0;
+    blob::optimize(optimized, input->records->generic, input->records->generic_size, blob::OPTIMIZE_FLAGS_FIELD_INDEX);
+    for (size_t r = 0; r < record_count; ++r)
+    {
+        blob::runtime_object_at(optimized, offset + sizeof(int32_t), &input->objects[r]);
+        if (!blob::schema_bind(&input->objects[r], &input->accessors[r]))
+        {
+            teardown_schema(input);
+            return NULL;
+        }
+        offset += sizeof(int32_t) + input->objects[r].object_size;
+    }
+    CMN_UNUSED(inout_bytes);
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_schema_search(void *context, size_t iterations)
+{
+    // the reference: each field is located by name on every read.
+    schema_input_t *input = (schema_input_t*) context;
+    uint32_t        total = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        for (size_t r = 0; r < input->record_count; ++r)
+        {
+            blob::runtime_object_t const *object = &input->objects[r];
+            blob::runtime_object_field_t  field;
+            if (blob::runtime_object_search(object, record_schema::id::name, &field) == blob::FIELD_TYPE_UINT32)
+                total += *(uint32_t*) field.field_data;
+            if (blob::runtime_object_search(object, record_schema::flags::name, &field) == blob::FIELD_TYPE_UINT32)
+                total += *(uint32_t*) field.field_data;
+            if (blob::runtime_object_search(object, record_schema::parent::name, &field) == blob::FIELD_TYPE_UINT32)
+                total += *(uint32_t*) field.field_data;
+            if (blob::runtime_object_search(object, record_schema::weight::name, &field) == blob::FIELD_TYPE_UINT32)
+                total += *(uint32_t*) field.field_data;
+        }
+    }
+    bench::consume(total);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_schema_access(void *context, size_t iterations)
+{
+    schema_input_t *input = (schema_input_t*) context;
+    uint32_t        total = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        for (size_t r = 0; r < input->record_count; ++r)
+        {
+            blob::schema_object_t<record_schema> const &record = input->accessors[r];
+            total += record.get<record_schema::id>();
+            total += record.get<record_schema::flags>();
+            total += record.get<record_schema::parent>();
+            total += record.get<record_schema::weight>();
+        }
+    }
+    bench::consume(total);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_builder(void *context)
+{
+    builder_input_t *input = (builder_input_t*) context;
+    blob::builder_free(&input->builder);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_builder(size_t record_count, size_t *inout_bytes)
+{
+    // the builder buffer is retained across iterations, so only the first
+    // iteration pays for buffer growth.
+    builder_input_t *input = (builder_input_t*) ::malloc(sizeof(builder_input_t));
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    if (!blob::builder_init(&input->builder, NULL))
+    {
+        ::free(input);
+        return NULL;
+    }
+    size_t field_size   = sizeof(uint32_t) * 3 + sizeof(uint32_t);
+    size_t record_size  = sizeof(int32_t) + sizeof(uint32_t) * 2 + RECORD_FIELD_COUNT * field_size;
+    input->record_count = record_count;
+    *inout_bytes        = record_count * record_size;
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_builder(void *context, size_t iterations)
+{
+    // writes the same records as setup_optimize(), without knowing the
+    // size of each record in advance.
+    builder_input_t *input   = (builder_input_t*) context;
+    blob::builder_t *builder = &input->builder;
+    size_t           total   = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        size_t size = 0;
+        blob::builder_reset(builder);
+        for (size_t r = 0; r < input->record_count; ++r)
+        {
+            blob::builder_begin_object(builder, 0);
+            for (size_t i = 0; i < RECORD_FIELD_COUNT; ++i)
+            {
+                uint32_t name  = uint32_t(i * 0x9E3779B9U + 0x7F4A7C15U);
+                uint32_t value = uint32_t(r + i);
+                blob::builder_value(builder, name, blob::FIELD_TYPE_UINT32, &value);
+            }
+            blob::builder_end_object(builder);
+        }
+        if (blob::builder_finish(builder, &size) != NULL)
+        {
+            total += size;
+        }
+    }
+    bench::consume(uint32_t(total));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_compress(void *context)
+{
+    compress_input_t *input = (compress_input_t*) context;
+    if (input->records != NULL) teardown_optimize(input->records);
+    ::free(input->output);
+    ::free(input->container);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_compress(size_t record_count, size_t *inout_bytes)
+{
+    // the optimized form of the setup_optimize() records, as it would be
+    // stored on disk. throughput is in terms of the uncompressed size.
+    compress_input_t *input = (compress_input_t*) ::calloc(1, sizeof(compress_input_t));
+    size_t            bytes = 0;
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->records = (optimize_input_t*) setup_optimize(record_count, &bytes);
+    if (NULL == input->records)
+    {
+        teardown_compress(input);
+        return NULL;
+    }
+    optimize_input_t *records = input->records;
+    blob::optimize(records->optimized, records->generic, records->generic_size, blob::OPTIMIZE_FLAGS_FIELD_INDEX);
+    input->bound     = blob::compressed_bound(records->optimized_size);
+    input->container = (uint8_t*) ::malloc(input->bound);
+    input->output    = (uint8_t*) ::malloc(records->optimized_size);
+    if (NULL == input->container || NULL == input->output)
+    {
+        teardown_compress(input);
+        return NULL;
+    }
+    input->container_size = blob::compress_blob(input->container, input->bound, records->optimized, records->optimized_size);
+    *inout_bytes = records->optimized_size;
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_compress(void *context, size_t iterations)
+{
+    compress_input_t *input = (compress_input_t*) context;
+    size_t            total = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        total += blob::compress_blob(input->container, input->bound, input->records->optimized, input->records->optimized_size);
+    }
+    bench::consume(uint32_t(total));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_decompress(void *context, size_t iterations)
+{
+    compress_input_t *input = (compress_input_t*) context;
+    uint32_t          valid = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        valid += blob::decompress_blob(input->output, input->records->optimized_size, input->container, input->container_size, 1) ? 1 : 0;
+    }
+    bench::consume(valid);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_decompress_parallel(void *context, size_t iterations)
+{
+    compress_input_t *input = (compress_input_t*) context;
+    uint32_t          valid = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        valid += blob::decompress_blob(input->output, input->records->optimized_size, input->container, input->container_size, 0) ? 1 : 0;
+    }
+    bench::consume(valid);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_swap(void *context)
+{
+    swap_input_t *input = (swap_input_t*) context;
+    ::free(input->work);
+    ::free(input->pristine);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_swap(size_t count, size_t *inout_bytes)
+{
+    // a single array of 4x4 matrices, as found in animation data, stored
+    // with the byte order opposite to that of the host.
+    swap_input_t *input = (swap_input_t*) ::calloc(1, sizeof(swap_input_t));
+    size_t        items = count * 16;
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->count     = count;
+    input->blob_size = sizeof(int32_t) * 3 + items * sizeof(float);
+    input->pristine  = (uint8_t*) ::malloc(input->blob_size);
+    input->work      = (uint8_t*) ::malloc(input->blob_size);
+    if (NULL == input->pristine || NULL == input->work)
+    {
+        teardown_swap(input);
+        return NULL;
+    }
+    size_t offset = blob::write_field_array(input->pristine, 0);
+    offset += blob::write_field_array_info(input->pristine, offset, blob::FIELD_TYPE_MATRIX_4X4F, count);
+    for (size_t i = 0; i < items; ++i)
+    {
+        blob::write_f32(input->pristine, offset + i * sizeof(float), float(i) * 0.5f);
+    }
+    blob::swap_array_32(input->pristine, input->pristine, input->blob_size / sizeof(uint32_t));
+    *inout_bytes = input->blob_size;
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_swap_array(void *context, size_t iterations)
+{
+    swap_input_t *input = (swap_input_t*) context;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        blob::swap_array_32(input->work, input->pristine, input->blob_size / sizeof(uint32_t));
+    }
+    bench::consume(uint32_t(input->work[0]));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_swap_array_scalar(void *context, size_t iterations)
+{
+    // the portable code path, as a reference for the SIMD speedup.
+    blob::base64_select_isa(blob::BASE64_ISA_SCALAR);
+    run_swap_array(context, iterations);
+    blob::base64_select_isa(blob::BASE64_ISA_AVX2);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_normalize(void *context, size_t iterations)
+{
+    // the copy is included in the measured time.
+    swap_input_t *input = (swap_input_t*) context;
+    uint32_t      valid = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        memcpy(input->work, input->pristine, input->blob_size);
+        valid += blob::normalize_endianess(input->work, input->blob_size, BLOB_ENDIANESS_MSB_FIRST) ? 1 : 0;
+    }
+    bench::consume(valid);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_patch(void *context)
+{
+    patch_input_t *input = (patch_input_t*) context;
+    if (input->records != NULL) teardown_optimize(input->records);
+    ::free(input->output);
+    ::free(input->patch);
+    ::free(input->updated);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_patch(size_t record_count, size_t *inout_bytes)
+{
+    // the optimized setup_optimize() records, with one field changed in
+    // every 64th record, as for a small edit to a level database.
+    patch_input_t *input = (patch_input_t*) ::calloc(1, sizeof(patch_input_t));
+    size_t         bytes = 0;
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->records = (optimize_input_t*) setup_optimize(record_count, &bytes);
+    if (NULL == input->records)
+    {
+        teardown_patch(input);
+        return NULL;
+    }
+    optimize_input_t *records = input->records;
+    size_t            size    = records->optimized_size;
+    blob::optimize(records->optimized, records->generic, records->generic_size, blob::OPTIMIZE_FLAGS_FIELD_INDEX);
+    input->updated = (uint8_t*) ::malloc(size);
+    input->output  = (uint8_t*) ::malloc(size);
+    if (NULL == input->updated || NULL == input->output)
+    {
+        teardown_patch(input);
+        return NULL;
+    }
+    memcpy(input->updated, records->optimized, size);
+    ptrdiff_t offset = 0;
+    for (size_t r = 0; r < record_count; ++r)
+    {
+        blob::runtime_object_t       object;
+        blob::runtime_object_field_t field;
+        blob::runtime_object_at(input->updated, offset + sizeof(int32_t), &object);
+        if ((r & 63) == 0 && blob::runtime_object_search(&object, RECORD_FIELD_NAME(5), &field) == blob::FIELD_TYPE_UINT32)
+        {
+            *(uint32_t*) field.field_data += 1;
+        }
+        offset += sizeof(int32_t) + object.object_size;
+    }
+    input->patch_max  = blob::diff_size(records->optimized, size, input->updated, size);
+    input->patch      = (uint8_t*) ::malloc(input->patch_max);
+    if (NULL == input->patch)
+    {
+        teardown_patch(input);
+        return NULL;
+    }
+    input->patch_size = blob::diff_blob(input->patch, input->patch_max, records->optimized, size, input->updated, size);
+    *inout_bytes = size;
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_diff(void *context, size_t iterations)
+{
+    patch_input_t *input = (patch_input_t*) context;
+    size_t         size  = input->records->optimized_size;
+    size_t         total = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        total += blob::diff_blob(input->patch, input->patch_max, input->records->optimized, size, input->updated, size);
+    }
+    bench::consume(uint32_t(total));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_apply_patch(void *context, size_t iterations)
+{
+    patch_input_t *input = (patch_input_t*) context;
+    size_t         size  = input->records->optimized_size;
+    uint32_t       valid = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        valid += blob::apply_patch(input->output, size, input->records->optimized, size, input->patch, input->patch_size) ? 1 : 0;
+    }
+    bench::consume(valid);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void register_blob_benchmarks(void)
+{
+    bench::register_case("base64_encode/1K",  setup_input, run_base64_encode, teardown_input, 1024,  1024);
+    bench::register_case("base64_encode/64K", setup_input, run_base64_encode, teardown_input, 65536, 65536);
+    bench::register_case("base64_decode/1K",  setup_input, run_base64_decode, teardown_input, 1024,  1024);
+    bench::register_case("base64_decode/64K", setup_input, run_base64_decode, teardown_input, 65536, 65536);
+    bench::register_case("base64_encode_scalar/64K", setup_input, run_base64_encode_scalar, teardown_input, 65536, 65536);
+    bench::register_case("base64_decode_scalar/64K", setup_input, run_base64_decode_scalar, teardown_input, 65536, 65536);
+    bench::register_case("base64_decode_stream/64K", setup_input, run_base64_decode_stream, teardown_input, 65536, 65536);
+
+    // the argument is the number of fields in the object; each iteration
+    // performs LOOKUP_COUNT searches for fields that exist.
+    bench::register_case("object_search_linear/4",     setup_object_linear,  run_object_search, teardown_object, 4,    0);
+    bench::register_case("object_search_linear/64",    setup_object_linear,  run_object_search, teardown_object, 64,   0);
+    bench::register_case("object_search_linear/512",   setup_object_linear,  run_object_search, teardown_object, 512,  0);
+    bench::register_case("object_search_linear/4096",  setup_object_linear,  run_object_search, teardown_object, 4096, 0);
+    bench::register_case("object_search_indexed/4",    setup_object_indexed, run_object_search, teardown_object, 4,    0);
+    bench::register_case("object_search_indexed/64",   setup_object_indexed, run_object_search, teardown_object, 64,   0);
+    bench::register_case("object_search_indexed/512",  setup_object_indexed, run_object_search, teardown_object, 512,  0);
+    bench::register_case("object_search_indexed/4096", setup_object_indexed, run_object_search, teardown_object, 4096, 0);
+
+    // the argument is the number of top-level objects in the blob; the
+    // throughput is reported in terms of the size of the generic blob.
+    bench::register_case("optimize/16K",          setup_optimize, run_optimize,          teardown_optimize, 16384, 0);
+    bench::register_case("optimize_parallel/16K", setup_optimize, run_optimize_parallel, teardown_optimize, 16384, 0);
+    bench::register_case("builder/16K",           setup_builder,  run_builder,           teardown_builder,  16384, 0);
+
+    // the argument is the number of records; each iteration reads four
+    // fields of every record, by search or through a bound schema accessor.
+    bench::register_case("schema_search/4K", setup_schema, run_schema_search, teardown_schema, 4096, 0);
+    bench::register_case("schema_access/4K", setup_schema, run_schema_access, teardown_schema, 4096, 0);
+
+    // the argument is the number of 4x4 matrices in the array.
+    bench::register_case("swap_array32/4K",        setup_swap, run_swap_array,        teardown_swap, 4096, 0);
+    bench::register_case("swap_array32_scalar/4K", setup_swap, run_swap_array_scalar, teardown_swap, 4096, 0);
+    bench::register_case("normalize_endianess/4K", setup_swap, run_normalize,         teardown_swap, 4096, 0);
+
+    // the argument is the number of records, as for the optimize cases.
+    bench::register_case("compress/4K",            setup_compress, run_compress,            teardown_compress, 4096, 0);
+    bench::register_case("decompress/4K",          setup_compress, run_decompress,          teardown_compress, 4096, 0);
+    bench::register_case("decompress_parallel/4K", setup_compress, run_decompress_parallel, teardown_compress, 4096, 0);
+    bench::register_case("diff/4K",                setup_patch,    run_diff,                teardown_patch,    4096, 0);
+    bench::register_case("apply_patch/4K",         setup_patch,    run_apply_patch,         teardown_patch,    4096, 0);
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
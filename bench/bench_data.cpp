@@ -0,0 +1,444 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements benchmarks for the 4-ary priority queue in libdata,
+/// with the binary heap built by data::heapify() and drained with
+/// data::sift_down() as a point of reference, and for the timer wheel and
+/// the slot map.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdlib.h>
+#include <string.h>
+#include "benchmark.hpp"
+#include "libdata.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the range of timer deadlines, in ticks. this spans three wheel levels.
+#define TIMER_HORIZON         65536
+/// the number of ticks covered by each call to data::timer_wheel_advance().
+#define TIMER_STEP            16
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct heap_input_t
+{
+    uint32_t                 *keys;   /// the keys inserted each iteration
+    uint32_t                 *heap;   /// scratch array for data::heapify()
+    void                     *memory; /// storage for the priority queue
+    data::pqueue_t<uint32_t>  queue;  /// the 4-ary priority queue
+    size_t                    count;  /// the number of keys
+};
+
+struct timer_input_t
+{
+    data::timer_node_t       *nodes;  /// the timers scheduled each iteration
+    uint64_t                 *ticks;  /// the deadline of each timer
+    data::timer_wheel_t       wheel;  /// the timer wheel
+    size_t                    count;  /// the number of timers
+};
+
+struct slot_input_t
+{
+    void                     *memory; /// storage for the slot map
+    uint64_t                 *live;   /// handles inserted each iteration
+    uint64_t                 *probe;  /// live, stale and forged handles
+    data::slot_map_t<uint32_t> map;   /// the slot map
+    size_t                    count;  /// the number of items
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_heap(void *context)
+{
+    heap_input_t *input = (heap_input_t*) context;
+    ::free(input->memory);
+    ::free(input->heap);
+    ::free(input->keys);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_heap(size_t count, size_t *inout_bytes)
+{
+    heap_input_t *input = (heap_input_t*) ::calloc(1, sizeof(heap_input_t));
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->count  = count;
+    input->keys   = (uint32_t*) ::malloc(count * sizeof(uint32_t));
+    input->heap   = (uint32_t*) ::malloc(count * sizeof(uint32_t));
+    input->memory = ::malloc(data::pqueue_memory_size<uint32_t>(count));
+    if (NULL == input->keys || NULL == input->heap || NULL == input->memory)
+    {
+        teardown_heap(input);
+        return NULL;
+    }
+    // the keys follow a fixed pseudo-random sequence, so every
+    // iteration performs the same sequence of comparisons.
+    uint32_t seed = 0x9E3779B9U;
+    for (size_t i = 0; i < count; ++i)
+    {
+        seed = seed * 1664525U + 1013904223U;
+        input->keys[i] = seed;
+    }
+    *inout_bytes = count * sizeof(uint32_t);
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_pqueue_push_pop(void *context, size_t iterations)
+{
+    heap_input_t             *input = (heap_input_t*) context;
+    data::pqueue_t<uint32_t> *queue = &input->queue;
+    data::comparer_t          cmp;
+    uint32_t                  sum   = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        uint32_t item = 0;
+        data::pqueue_init(queue, input->memory, input->count);
+        for (size_t i = 0; i < input->count; ++i)
+        {
+            data::pqueue_push(queue, input->keys[i], cmp, (uint32_t*) NULL);
+        }
+        while (data::pqueue_pop(queue, cmp, &item))
+        {
+            sum += item;
+        }
+    }
+    bench::consume(sum);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_pqueue_bulk(void *context, size_t iterations)
+{
+    heap_input_t             *input = (heap_input_t*) context;
+    data::pqueue_t<uint32_t> *queue = &input->queue;
+    data::comparer_t          cmp;
+    uint32_t                  sum   = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        data::pqueue_init(queue, input->memory, input->count);
+        data::pqueue_push_bulk(queue, input->keys, input->count, cmp, (uint32_t*) NULL);
+        sum += queue->items[0];
+    }
+    bench::consume(sum);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_pqueue_bulk_pop(void *context, size_t iterations)
+{
+    heap_input_t             *input = (heap_input_t*) context;
+    data::pqueue_t<uint32_t> *queue = &input->queue;
+    data::comparer_t          cmp;
+    uint32_t                  sum   = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        uint32_t item = 0;
+        data::pqueue_init(queue, input->memory, input->count);
+        data::pqueue_push_bulk(queue, input->keys, input->count, cmp, (uint32_t*) NULL);
+        while (data::pqueue_pop(queue, cmp, &item))
+        {
+            sum += item;
+        }
+    }
+    bench::consume(sum);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_heapify(void *context, size_t iterations)
+{
+    heap_input_t     *input = (heap_input_t*) context;
+    data::comparer_t  cmp;
+    uint32_t          sum   = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        memcpy(input->heap, input->keys, input->count * sizeof(uint32_t));
+        data::heapify(input->heap, input->count, cmp);
+        sum += input->heap[0];
+    }
+    bench::consume(sum);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_heapify_pop(void *context, size_t iterations)
+{
+    heap_input_t     *input = (heap_input_t*) context;
+    uint32_t         *heap  = input->heap;
+    data::comparer_t  cmp;
+    uint32_t          sum   = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        // this is the drain loop used by data::sort(); each pop swaps
+        // the root with the last item and sifts the new root down.
+        ptrdiff_t end = ptrdiff_t(input->count) - 1;
+        memcpy(heap, input->keys, input->count * sizeof(uint32_t));
+        data::heapify(heap, input->count, cmp);
+        while (end > 0)
+        {
+            uint32_t tmp = heap[end];
+            heap[end]    = heap[0];
+            heap[0]      = tmp;
+            sum         += heap[end];
+            data::sift_down(heap, 0, end - 1, cmp);
+            --end;
+        }
+    }
+    bench::consume(sum);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_timers(void *context)
+{
+    timer_input_t *input = (timer_input_t*) context;
+    ::free(input->ticks);
+    ::free(input->nodes);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_timers(size_t count, size_t *inout_bytes)
+{
+    timer_input_t *input = (timer_input_t*) ::calloc(1, sizeof(timer_input_t));
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->count = count;
+    input->nodes = (data::timer_node_t*) ::malloc(count * sizeof(data::timer_node_t));
+    input->ticks = (uint64_t*) ::malloc(count * sizeof(uint64_t));
+    if (NULL == input->nodes || NULL == input->ticks)
+    {
+        teardown_timers(input);
+        return NULL;
+    }
+    // deadlines follow a fixed pseudo-random sequence in [1, TIMER_HORIZON].
+    uint32_t seed = 0x9E3779B9U;
+    for (size_t i = 0; i < count; ++i)
+    {
+        seed = seed * 1664525U + 1013904223U;
+        input->ticks[i] = 1 + (seed >> 8) % TIMER_HORIZON;
+        data::timer_node_init(&input->nodes[i], NULL);
+    }
+    *inout_bytes = count * sizeof(data::timer_node_t);
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_timer_expire(void *context, size_t iterations)
+{
+    timer_input_t       *input = (timer_input_t*) context;
+    data::timer_wheel_t *wheel = &input->wheel;
+    size_t               total = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        // schedule every timer, then advance in small steps until all of
+        // them have expired, cascading through the upper levels.
+        data::timer_wheel_init(wheel, 0);
+        for (size_t i = 0; i < input->count; ++i)
+        {
+            data::timer_wheel_schedule(wheel, &input->nodes[i], input->ticks[i]);
+        }
+        for (uint64_t now = TIMER_STEP; now <= TIMER_HORIZON; now += TIMER_STEP)
+        {
+            size_t expired = 0;
+            data::timer_wheel_advance(wheel, now, &expired);
+            total += expired;
+        }
+    }
+    bench::consume(uint32_t(total));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_timer_cancel(void *context, size_t iterations)
+{
+    timer_input_t       *input = (timer_input_t*) context;
+    data::timer_wheel_t *wheel = &input->wheel;
+    size_t               total = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        // schedule every timer, reschedule each one to a later deadline
+        // and then cancel them all, as a timeout that rarely fires would.
+        data::timer_wheel_init(wheel, 0);
+        for (size_t i = 0; i < input->count; ++i)
+        {
+            data::timer_wheel_schedule(wheel, &input->nodes[i], input->ticks[i]);
+        }
+        for (size_t i = 0; i < input->count; ++i)
+        {
+            data::timer_wheel_schedule(wheel, &input->nodes[i], input->ticks[i] + TIMER_HORIZON);
+        }
+        for (size_t i = 0; i < input->count; ++i)
+        {
+            total += data::timer_wheel_cancel(wheel, &input->nodes[i]) ? 1 : 0;
+        }
+    }
+    bench::consume(uint32_t(total));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_slots(void *context)
+{
+    slot_input_t *input = (slot_input_t*) context;
+    ::free(input->probe);
+    ::free(input->live);
+    ::free(input->memory);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_slots(size_t count, size_t *inout_bytes)
+{
+    slot_input_t *input = (slot_input_t*) ::calloc(1, sizeof(slot_input_t));
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->count  = count;
+    input->memory = ::malloc(data::slot_map_memory_size<uint32_t>(count));
+    input->live   = (uint64_t*) ::malloc(count * sizeof(uint64_t));
+    input->probe  = (uint64_t*) ::malloc(count * sizeof(uint64_t));
+    if (NULL == input->memory || NULL == input->live || NULL == input->probe)
+    {
+        teardown_slots(input);
+        return NULL;
+    }
+    // fill the map, then remove every other item. the lookup case probes
+    // the surviving handles, the stale handles of the removed items and
+    // forged handles naming free slots with their current generation.
+    data::slot_map_init(&input->map, input->memory, count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        data::slot_map_insert(&input->map, uint32_t(i), &input->live[i]);
+    }
+    for (size_t i = 1; i < count; i += 2)
+    {
+        data::slot_map_remove(&input->map, input->live[i]);
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        // even entries are live and odd entries stale; every fourth entry
+        // is replaced by a forged handle carrying its free slot's generation.
+        uint64_t slot   = input->live[i] & 0xFFFFFFFFULL;
+        input->probe[i] = input->live[i];
+        if (3 == (i & 3))
+        {
+            input->probe[i] = (uint64_t(input->map.generations[slot]) << 32) | slot;
+        }
+    }
+    *inout_bytes = count * sizeof(uint64_t);
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_slot_churn(void *context, size_t iterations)
+{
+    slot_input_t               *input = (slot_input_t*) context;
+    data::slot_map_t<uint32_t> *map   = &input->map;
+    uint32_t                    sum   = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        // insert every item, then remove them in insertion order, so each
+        // removal moves the last item into the vacated position.
+        data::slot_map_clear(map);
+        for (size_t i = 0; i < input->count; ++i)
+        {
+            data::slot_map_insert(map, uint32_t(i), &input->live[i]);
+        }
+        for (size_t i = 0; i < input->count; ++i)
+        {
+            uint32_t item = 0;
+            data::slot_map_remove(map, input->live[i], &item);
+            sum += item;
+        }
+    }
+    bench::consume(sum);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_slot_get(void *context, size_t iterations)
+{
+    slot_input_t               *input = (slot_input_t*) context;
+    data::slot_map_t<uint32_t> *map   = &input->map;
+    uint32_t                    sum   = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        for (size_t i = 0; i < input->count; ++i)
+        {
+            uint32_t *item = data::slot_map_get(map, input->probe[i]);
+            if (item != NULL) sum += *item;
+        }
+    }
+    bench::consume(sum);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void register_data_benchmarks(void)
+{
+    // the argument is the number of keys inserted by each iteration. the
+    // push_pop and bulk_pop cases drain the queue after filling it.
+    bench::register_case("pqueue_push_pop/1k",   setup_heap, run_pqueue_push_pop, teardown_heap, 1000,    0);
+    bench::register_case("pqueue_push_pop/10k",  setup_heap, run_pqueue_push_pop, teardown_heap, 10000,   0);
+    bench::register_case("pqueue_push_pop/100k", setup_heap, run_pqueue_push_pop, teardown_heap, 100000,  0);
+    bench::register_case("pqueue_push_pop/1M",   setup_heap, run_pqueue_push_pop, teardown_heap, 1000000, 0);
+    bench::register_case("pqueue_bulk_pop/1k",   setup_heap, run_pqueue_bulk_pop, teardown_heap, 1000,    0);
+    bench::register_case("pqueue_bulk_pop/10k",  setup_heap, run_pqueue_bulk_pop, teardown_heap, 10000,   0);
+    bench::register_case("pqueue_bulk_pop/100k", setup_heap, run_pqueue_bulk_pop, teardown_heap, 100000,  0);
+    bench::register_case("pqueue_bulk_pop/1M",   setup_heap, run_pqueue_bulk_pop, teardown_heap, 1000000, 0);
+    bench::register_case("heapify_pop/1k",       setup_heap, run_heapify_pop,     teardown_heap, 1000,    0);
+    bench::register_case("heapify_pop/10k",      setup_heap, run_heapify_pop,     teardown_heap, 10000,   0);
+    bench::register_case("heapify_pop/100k",     setup_heap, run_heapify_pop,     teardown_heap, 100000,  0);
+    bench::register_case("heapify_pop/1M",       setup_heap, run_heapify_pop,     teardown_heap, 1000000, 0);
+    bench::register_case("pqueue_bulk/1k",       setup_heap, run_pqueue_bulk,     teardown_heap, 1000,    0);
+    bench::register_case("pqueue_bulk/10k",      setup_heap, run_pqueue_bulk,     teardown_heap, 10000,   0);
+    bench::register_case("pqueue_bulk/100k",     setup_heap, run_pqueue_bulk,     teardown_heap, 100000,  0);
+    bench::register_case("pqueue_bulk/1M",       setup_heap, run_pqueue_bulk,     teardown_heap, 1000000, 0);
+    bench::register_case("heapify/1k",           setup_heap, run_heapify,         teardown_heap, 1000,    0);
+    bench::register_case("heapify/10k",          setup_heap, run_heapify,         teardown_heap, 10000,   0);
+    bench::register_case("heapify/100k",         setup_heap, run_heapify,         teardown_heap, 100000,  0);
+    bench::register_case("heapify/1M",           setup_heap, run_heapify,         teardown_heap, 1000000, 0);
+    // the argument is the number of timers scheduled by each iteration.
+    bench::register_case("timer_expire/1k",     setup_timers, run_timer_expire, teardown_timers, 1000,    0);
+    bench::register_case("timer_expire/10k",    setup_timers, run_timer_expire, teardown_timers, 10000,   0);
+    bench::register_case("timer_expire/100k",   setup_timers, run_timer_expire, teardown_timers, 100000,  0);
+    bench::register_case("timer_expire/1M",     setup_timers, run_timer_expire, teardown_timers, 1000000, 0);
+    bench::register_case("timer_cancel/1k",     setup_timers, run_timer_cancel, teardown_timers, 1000,    0);
+    bench::register_case("timer_cancel/10k",    setup_timers, run_timer_cancel, teardown_timers, 10000,   0);
+    bench::register_case("timer_cancel/100k",   setup_timers, run_timer_cancel, teardown_timers, 100000,  0);
+    bench::register_case("timer_cancel/1M",     setup_timers, run_timer_cancel, teardown_timers, 1000000, 0);
+    // the argument is the number of items inserted or handles looked up.
+    bench::register_case("slot_map_churn/1k",   setup_slots,  run_slot_churn,   teardown_slots,  1000,    0);
+    bench::register_case("slot_map_churn/100k", setup_slots,  run_slot_churn,   teardown_slots,  100000,  0);
+    bench::register_case("slot_map_get/1k",     setup_slots,  run_slot_get,     teardown_slots,  1000,    0);
+    bench::register_case("slot_map_get/100k",   setup_slots,  run_slot_get,     teardown_slots,  100000,  0);
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
@@ -0,0 +1,92 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements benchmarks for the hashing functions in libhash.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdlib.h>
+#include "benchmark.hpp"
+#include "libhash.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct hash_input_t
+{
+    size_t   size;        /// number of bytes of input data
+    uint8_t *data;        /// the input data
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_input(size_t size, size_t *inout_bytes)
+{
+    CMN_UNUSED(inout_bytes);
+    hash_input_t *input = (hash_input_t*) ::malloc(sizeof(hash_input_t) + size);
+    if (input != NULL)
+    {
+        input->size = size;
+        input->data = (uint8_t*) (input + 1);
+        for (size_t i = 0; i < size; ++i)
+        {
+            input->data[i] = uint8_t(i * 131 + 7);
+        }
+    }
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_input(void *context)
+{
+    ::free(context);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_hash32(void *context, size_t iterations)
+{
+    hash_input_t *input = (hash_input_t*) context;
+    uint32_t      seed  = 0;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        seed = hash::hash32(input->data, input->size, seed);
+    }
+    bench::consume(seed);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_crc32(void *context, size_t iterations)
+{
+    hash_input_t *input = (hash_input_t*) context;
+    uint32_t      crc   = 0;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        crc = hash::crc32(input->data, 0, input->size, crc);
+    }
+    bench::consume(crc);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void register_hash_benchmarks(void)
+{
+    bench::register_case("hash32/16",  setup_input, run_hash32, teardown_input, 16,    16);
+    bench::register_case("hash32/1K",  setup_input, run_hash32, teardown_input, 1024,  1024);
+    bench::register_case("hash32/64K", setup_input, run_hash32, teardown_input, 65536, 65536);
+    bench::register_case("crc32/1K",   setup_input, run_crc32,  teardown_input, 1024,  1024);
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
@@ -0,0 +1,168 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements benchmarks for the image filtering functions in
+/// libimage.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdlib.h>
+#include "benchmark.hpp"
+#include "libimage.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct image_input_t
+{
+    size_t                       width;      /// source channel width
+    size_t                       height;     /// source channel height
+    float                       *source;     /// the source channel
+    float                       *middle;     /// horizontally resampled channel
+    float                       *target;     /// the filtered channel
+    float                       *column;     /// one column of vertical output
+    image::polyphase_kernel_1d_t horizontal; /// kernel for width / 2
+    image::polyphase_kernel_1d_t vertical;   /// kernel for height / 2
+    image::convolution_kernel_t  sobel;      /// 3x3 Sobel kernel
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_image(void *context)
+{
+    image_input_t *input = (image_input_t*) context;
+    ::free(input->sobel.kernel_matrix);
+    ::free(input->vertical.filter_weights);
+    ::free(input->horizontal.filter_weights);
+    ::free(input->column);
+    ::free(input->target);
+    ::free(input->middle);
+    ::free(input->source);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_image(size_t dimension, size_t *inout_bytes)
+{
+    image::kaiser_args_t args;
+    image_input_t       *input = (image_input_t*) ::calloc(1, sizeof(image_input_t));
+    size_t               count = dimension * dimension;
+    size_t               hsize = 0;
+    size_t               vsize = 0;
+    size_t               ksize = 0;
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->width  = dimension;
+    input->height = dimension;
+    input->source = (float*) ::malloc(count * sizeof(float));
+    input->middle = (float*) ::malloc(count * sizeof(float));
+    input->target = (float*) ::malloc(count * sizeof(float));
+    input->column = (float*) ::malloc(dimension * sizeof(float));
+
+    // a 2:1 reduction with a Kaiser filter, as used for mipmap generation.
+    image::kaiser_args_init(3.0f, &args);
+    hsize = image::polyphase_1d_init(dimension, dimension / 2, 32, args.filter_width, &input->horizontal);
+    vsize = image::polyphase_1d_init(dimension, dimension / 2, 32, args.filter_width, &input->vertical);
+    ksize = image::convolution_kernel_init(3, &input->sobel);
+    input->horizontal.filter_weights = (float*) ::malloc(hsize);
+    input->vertical.filter_weights   = (float*) ::malloc(vsize);
+    input->sobel.kernel_matrix       = (float*) ::malloc(ksize);
+    if (NULL == input->source || NULL == input->middle ||
+        NULL == input->target || NULL == input->column ||
+        NULL == input->horizontal.filter_weights ||
+        NULL == input->vertical.filter_weights   ||
+        NULL == input->sobel.kernel_matrix)
+    {
+        teardown_image(input);
+        return NULL;
+    }
+    image::compute_polyphase_matrix_1d(image::kaiser_filter, &args, &input->horizontal);
+    image::compute_polyphase_matrix_1d(image::kaiser_filter, &args, &input->vertical);
+    image::convolution_kernel_sobel_3x3(&input->sobel);
+    for (size_t i = 0; i < count; ++i)
+    {
+        input->source[i] = float((i * 131 + 7) & 255) / 255.0f;
+    }
+    *inout_bytes = count * sizeof(float);
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_resample(void *context, size_t iterations)
+{
+    image_input_t *input = (image_input_t*) context;
+    size_t         w     = input->width;
+    size_t         h     = input->height;
+    size_t         tw    = w / 2;
+    size_t         th    = h / 2;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        // resample each row into a (w/2) x h channel, then each
+        // column of that into the (w/2) x (h/2) target channel.
+        for (size_t y = 0; y < h; ++y)
+        {
+            image::apply_polyphase_horizontal_1d(
+                &input->horizontal, image::BORDER_MODE_CLAMP,
+                y, w, h, input->source, input->middle + y * tw);
+        }
+        for (size_t x = 0; x < tw; ++x)
+        {
+            image::apply_polyphase_vertical_1d(
+                &input->vertical, image::BORDER_MODE_CLAMP,
+                x, tw, h, input->middle, input->column);
+            for (size_t y = 0; y < th; ++y)
+            {
+                input->target[y * tw + x] = input->column[y];
+            }
+        }
+    }
+    bench::consume(uint32_t(input->target[0] * 255.0f));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_sobel(void *context, size_t iterations)
+{
+    image_input_t *input = (image_input_t*) context;
+    size_t         w     = input->width;
+    size_t         h     = input->height;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        for (size_t y = 0; y < h; ++y)
+        {
+            for (size_t x = 0; x < w; ++x)
+            {
+                input->target[y * w + x] = image::convolution_kernel_apply(
+                    &input->sobel, image::BORDER_MODE_MIRROR,
+                    x, y, w, h, input->source);
+            }
+        }
+    }
+    bench::consume(uint32_t(input->target[0] * 255.0f));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void register_image_benchmarks(void)
+{
+    // the argument is the width and height of the source channel; the
+    // throughput is reported in terms of the source channel size.
+    bench::register_case("image_resample/256", setup_image, run_resample, teardown_image, 256, 0);
+    bench::register_case("image_sobel3x3/256", setup_image, run_sobel,    teardown_image, 256, 0);
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
@@ -0,0 +1,276 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements benchmarks for the JSON document parser in libjson.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "benchmark.hpp"
+#include "libjson.hpp"
+#include "libjsonblob.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the maximum number of bytes of JSON generated for a single record.
+#define MAX_RECORD_SIZE       256
+/// the number of field name strings passed to jsonblob::from_blob().
+#define RECORD_NAME_COUNT     11
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct json_input_t
+{
+    size_t   size;        /// number of bytes in the document
+    char    *document;    /// the pristine document
+    char    *work;        /// the copy parsed by each iteration
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct convert_input_t
+{
+    size_t          size;      /// number of bytes in the document
+    char           *document;  /// the JSON text
+    char           *output;    /// receives text written by jsonblob::from_blob()
+    size_t          out_size;  /// number of bytes written to output
+    size_t          out_max;   /// number of bytes available at output
+    void           *data;      /// the document converted to a blob
+    size_t          data_size; /// number of bytes in data
+    blob::builder_t builder;   /// reused by each jsonblob::to_blob() iteration
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the field names used by the records, for mapping names back to strings.
+static char const *RecordNames[RECORD_NAME_COUNT] =
+{
+    "id", "name", "weight", "enabled", "parent", "tags",
+    "position", "x", "y", "z", "score"
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_document(size_t record_count, size_t *inout_bytes)
+{
+    size_t        max_size = record_count * MAX_RECORD_SIZE + 16;
+    json_input_t *input    = (json_input_t*) ::malloc(sizeof(json_input_t) + max_size * 2);
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->document = (char*) (input + 1);
+    input->work     =  input->document + max_size;
+
+    // generate an array of records with a typical mix of field types.
+    char *p = input->document;
+    p  += sprintf(p, "[");
+    for (size_t i = 0; i < record_count; ++i)
+    {
+        p += sprintf(p,
+            "%s\n {\"id\":%u,\"name\":\"item_%u\",\"weight\":%u.%02u,"
+            "\"enabled\":%s,\"parent\":null,\"tags\":[\"alpha\",\"beta\",%u],"
+            "\"position\":{\"x\":%u.5,\"y\":-%u.25,\"z\":%u}}",
+            i > 0 ? "," : "",
+            unsigned(i), unsigned(i * 7), unsigned(i % 100), unsigned(i % 97),
+            (i & 1) ? "true" : "false", unsigned(i & 15),
+            unsigned(i), unsigned(i * 3), unsigned(i * 5));
+    }
+    p  += sprintf(p, "\n]\n");
+    input->size  = size_t(p - input->document) + 1;
+    *inout_bytes = input->size - 1;
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_document(void *context)
+{
+    ::free(context);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_parse(void *context, size_t iterations)
+{
+    // json::parse() modifies the document in place, so each iteration
+    // parses a fresh copy. the copy is included in the measured time.
+    json_input_t *input = (json_input_t*) context;
+    uint32_t      count = 0;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        json::item_t  *root = NULL;
+        json::error_t  error;
+        memcpy(input->work, input->document, input->size);
+        if (json::parse(input->work, NULL, &root, &error))
+        {
+            count += uint32_t(root->value_type);
+            json::free(root, NULL);
+        }
+    }
+    bench::consume(count);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool CMN_CALL_C write_output(char const *data, size_t size_in_bytes, void *context)
+{
+    convert_input_t *input = (convert_input_t*) context;
+    if (size_in_bytes > input->out_max - input->out_size)
+    {
+        return false;
+    }
+    memcpy(input->output + input->out_size, data, size_in_bytes);
+    input->out_size += size_in_bytes;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool rejects_malformed_blob(convert_input_t *input)
+{
+    // a generic object whose one array field claims 2^28 items within an
+    // 8-byte body. it must be rejected before any text is written.
+    uint32_t const Malformed[8] =
+    {
+        blob::FIELD_TYPE_GN_OBJECT, 1, 20,
+        0x1234, blob::FIELD_TYPE_ARRAY, 8, 0x10000000U, blob::FIELD_TYPE_SINT32
+    };
+    input->out_size = 0;
+    return !jsonblob::from_blob((void*) Malformed, sizeof(Malformed), write_output, input) &&
+            0 == input->out_size;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_convert(void *context)
+{
+    convert_input_t *input = (convert_input_t*) context;
+    blob::builder_free(&input->builder);
+    ::free(input->data);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_convert(size_t record_count, size_t *inout_bytes)
+{
+    size_t           max_size = record_count * MAX_RECORD_SIZE + 16;
+    convert_input_t *input    = (convert_input_t*) ::malloc(sizeof(convert_input_t) + max_size * 3);
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->document = (char*) (input + 1);
+    input->output   =  input->document + max_size;
+    input->out_max  =  max_size * 2;
+    input->data     =  NULL;
+    if (!blob::builder_init(&input->builder, NULL))
+    {
+        ::free(input);
+        return NULL;
+    }
+
+    // the same records as setup_document(), except that blob arrays are
+    // homogeneous, so every tag is a string.
+    char *p = input->document;
+    p  += sprintf(p, "[");
+    for (size_t i = 0; i < record_count; ++i)
+    {
+        p += sprintf(p,
+            "%s\n {\"id\":%u,\"name\":\"item_%u\",\"weight\":%u.%02u,"
+            "\"enabled\":%s,\"parent\":null,\"tags\":[\"alpha\",\"beta\",\"t%u\"],"
+            "\"position\":{\"x\":%u.5,\"y\":-%u.25,\"z\":%u},\"score\":[%u,%u,%u]}",
+            i > 0 ? "," : "",
+            unsigned(i), unsigned(i * 7), unsigned(i % 100), unsigned(i % 97),
+            (i & 1) ? "true" : "false", unsigned(i & 15),
+            unsigned(i), unsigned(i * 3), unsigned(i * 5),
+            unsigned(i % 10), unsigned(i % 11), unsigned(i % 12));
+    }
+    p  += sprintf(p, "\n]\n");
+    input->size = size_t(p - input->document);
+
+    // from_blob() is measured against a copy of the blob converted up
+    // front, since run_to_blob() overwrites the builder's buffer.
+    void *data = NULL;
+    if (!jsonblob::to_blob(input->document, input->size, &input->builder, NULL) ||
+        NULL == (data = blob::builder_finish(&input->builder, &input->data_size)) ||
+        NULL == (input->data = ::malloc(input->data_size)))
+    {
+        teardown_convert(input);
+        return NULL;
+    }
+    memcpy(input->data, data, input->data_size);
+    if (!rejects_malformed_blob(input))
+    {
+        teardown_convert(input);
+        return NULL;
+    }
+    *inout_bytes = input->size;
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_to_blob(void *context, size_t iterations)
+{
+    // the builder keeps its buffer between iterations, as a tool converting
+    // many documents would.
+    convert_input_t *input = (convert_input_t*) context;
+    uint32_t         total = 0;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        size_t size = 0;
+        blob::builder_reset(&input->builder);
+        if (jsonblob::to_blob(input->document, input->size, &input->builder, NULL) &&
+            blob::builder_finish(&input->builder, &size) != NULL)
+        {
+            total += uint32_t(size);
+        }
+    }
+    bench::consume(total);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_from_blob(void *context, size_t iterations)
+{
+    convert_input_t *input = (convert_input_t*) context;
+    uint32_t         total = 0;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        input->out_size = 0;
+        if (jsonblob::from_blob(input->data, input->data_size, write_output, input, RecordNames, RECORD_NAME_COUNT))
+        {
+            total += uint32_t(input->out_size);
+        }
+    }
+    bench::consume(total);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void register_json_benchmarks(void)
+{
+    // the argument is the number of records in the document.
+    bench::register_case("json_parse/16",   setup_document, run_parse, teardown_document, 16,   0);
+    bench::register_case("json_parse/1024", setup_document, run_parse, teardown_document, 1024, 0);
+    // the throughput of the blob converters is in terms of the JSON text.
+    bench::register_case("json_to_blob/1024",   setup_convert, run_to_blob,   teardown_convert, 1024, 0);
+    bench::register_case("json_from_blob/1024", setup_convert, run_from_blob, teardown_convert, 1024, 0);
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
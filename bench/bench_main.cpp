@@ -0,0 +1,180 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements the entry point of the benchmark runner. All suites
+/// are registered and the selected cases are run, optionally saving the
+/// results as a baseline or comparing them against a previous baseline.
+/// Baselines hold absolute times, so they are only meaningful on the machine
+/// and build that produced them and are not kept in the repository.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "benchmark.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*////////////////////////////
+//   Forward Declarations   //
+////////////////////////////*/
+extern void register_hash_benchmarks(void);
+extern void register_blob_benchmarks(void);
+extern void register_stomp_benchmarks(void);
+extern void register_json_benchmarks(void);
+extern void register_utf8_benchmarks(void);
+extern void register_image_benchmarks(void);
+extern void register_memory_benchmarks(void);
+extern void register_data_benchmarks(void);
+extern void register_processor_benchmarks(void);
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the relative slowdown of the median flagged as a regression by default.
+#define DEFAULT_THRESHOLD      0.05
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the results of the cases that were run.
+static bench::result_t  Results[BENCH_MAX_CASES];
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void print_usage(char const *program)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --list              list the benchmark cases and exit\n"
+        "  --filter <text>     run only cases whose name contains text\n"
+        "  --samples <n>       number of timed samples (default 31; p99 needs %d)\n"
+        "  --warmup <n>        number of untimed warmup samples (default 5)\n"
+        "  --min-time <usec>   minimum duration of each sample (default 2000)\n"
+        "  --save <file>       save the results as a JSON baseline\n"
+        "  --compare <file>    compare the results against a JSON baseline\n"
+        "  --threshold <pct>   slowdown flagged as a regression (default 5)\n",
+        program, BENCH_P99_MIN_SAMPLES);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int main(int argc, char **argv)
+{
+    bench::options_t options;
+    char const      *save_path    = NULL;
+    char const      *compare_path = NULL;
+    double           threshold    = DEFAULT_THRESHOLD;
+    bool             list_only    = false;
+    size_t           result_count = 0;
+
+    bench::options_init(&options);
+    for (int i = 1; i < argc; ++i)
+    {
+        bool has_value = (i + 1 < argc);
+        if (0 == strcmp(argv[i], "--list"))
+        {
+            list_only = true;
+        }
+        else if (0 == strcmp(argv[i], "--filter") && has_value)
+        {
+            options.filter = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--samples") && has_value)
+        {
+            options.sample_count = size_t(strtoul(argv[++i], NULL, 10));
+        }
+        else if (0 == strcmp(argv[i], "--warmup") && has_value)
+        {
+            options.warmup_count = size_t(strtoul(argv[++i], NULL, 10));
+        }
+        else if (0 == strcmp(argv[i], "--min-time") && has_value)
+        {
+            options.sample_usec  = uint64_t(strtoul(argv[++i], NULL, 10));
+        }
+        else if (0 == strcmp(argv[i], "--save") && has_value)
+        {
+            save_path    = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--compare") && has_value)
+        {
+            compare_path = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--threshold") && has_value)
+        {
+            threshold    = strtod(argv[++i], NULL) / 100.0;
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    register_hash_benchmarks();
+    register_blob_benchmarks();
+    register_stomp_benchmarks();
+    register_json_benchmarks();
+    register_utf8_benchmarks();
+    register_image_benchmarks();
+    register_memory_benchmarks();
+    register_data_benchmarks();
+    register_processor_benchmarks();
+
+    for (size_t i = 0; i < bench::case_count(); ++i)
+    {
+        bench::case_t const *c = bench::get_case(i);
+        if (options.filter != NULL && NULL == strstr(c->name, options.filter))
+        {
+            continue;
+        }
+        if (list_only)
+        {
+            printf("%s\n", c->name);
+            continue;
+        }
+        if (bench::run_case(c, &options, &Results[result_count]))
+        {
+            bench::print_result(stdout, &Results[result_count++]);
+            fflush(stdout);
+        }
+        else fprintf(stderr, "%s: setup failed\n", c->name);
+    }
+    if (list_only)
+    {
+        return 0;
+    }
+
+    if (save_path != NULL && !bench::save_baseline(save_path, Results, result_count))
+    {
+        fprintf(stderr, "Unable to write baseline %s.\n", save_path);
+        return 1;
+    }
+    if (compare_path != NULL)
+    {
+        size_t regressions = 0;
+        printf("\n");
+        if (!bench::compare_baseline(compare_path, Results, result_count, threshold, stdout, &regressions))
+        {
+            fprintf(stderr, "Unable to read baseline %s.\n", compare_path);
+            return 1;
+        }
+        if (regressions > 0)
+        {
+            printf("%u of %u benchmarks regressed by more than %.1f%%.\n",
+                unsigned(regressions), unsigned(result_count), threshold * 100.0);
+            return 2;
+        }
+    }
+    return 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
@@ -0,0 +1,218 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements benchmarks for the allocator implementations in
+/// libmemory, with the C runtime heap as a point of reference, and for the
+/// small_vector_t container.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdlib.h>
+#include "benchmark.hpp"
+#include "libmemory.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the number of allocations performed by each iteration.
+#define ALLOCATION_COUNT      256
+/// the size of the memory block managed by the sub-allocators.
+#define ARENA_SIZE            (4 * 1024 * 1024)
+/// the number of items stored inline by the small_vector_t cases.
+#define SMALL_VECTOR_INLINE   16
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct memory_input_t
+{
+    void                          *arena;  /// block managed by the allocators
+    memory::heap_allocator_t      *heap;   /// general-purpose sub-allocator
+    memory::increment_allocator_t *linear; /// bump-pointer sub-allocator
+    memory::decrement_allocator_t *stack;  /// reverse bump-pointer allocator
+    size_t                         sizes[ALLOCATION_COUNT];
+    void                          *items[ALLOCATION_COUNT];
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_allocators(void *context)
+{
+    memory_input_t *input = (memory_input_t*) context;
+    delete input->stack;
+    delete input->linear;
+    delete input->heap;
+    ::free(input->arena);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_allocators(size_t max_size, size_t *inout_bytes)
+{
+    memory_input_t *input = (memory_input_t*) ::calloc(1, sizeof(memory_input_t));
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->arena = ::malloc(ARENA_SIZE);
+    if (NULL == input->arena)
+    {
+        ::free(input);
+        return NULL;
+    }
+    // each allocator gets its own third of the arena. the request sizes
+    // follow a fixed pseudo-random sequence in [16, max_size].
+    size_t third  = ARENA_SIZE / 3;
+    uint8_t *base = (uint8_t*) input->arena;
+    input->heap   = new memory::heap_allocator_t(base, third);
+    input->linear = new memory::increment_allocator_t(base + third, third);
+    input->stack  = new memory::decrement_allocator_t(base + third * 2, third);
+    uint32_t seed = 0x9E3779B9U;
+    for (size_t i = 0; i < ALLOCATION_COUNT; ++i)
+    {
+        seed = seed * 1664525U + 1013904223U;
+        input->sizes[i] = 16 + (seed >> 8) % (max_size - 15);
+    }
+    CMN_UNUSED(inout_bytes);
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_crt(void *context, size_t iterations)
+{
+    memory_input_t *input = (memory_input_t*) context;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        for (size_t i = 0; i < ALLOCATION_COUNT; ++i)
+        {
+            input->items[i] = ::malloc(input->sizes[i]);
+        }
+        for (size_t i = 0; i < ALLOCATION_COUNT; ++i)
+        {
+            ::free(input->items[(i * 7) & (ALLOCATION_COUNT - 1)]);
+        }
+    }
+    bench::consume(uint32_t(input->sizes[0]));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_heap(void *context, size_t iterations)
+{
+    memory_input_t           *input = (memory_input_t*) context;
+    memory::heap_allocator_t *alloc = input->heap;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        for (size_t i = 0; i < ALLOCATION_COUNT; ++i)
+        {
+            input->items[i] = alloc->allocate(input->sizes[i], 16);
+        }
+        for (size_t i = 0; i < ALLOCATION_COUNT; ++i)
+        {
+            alloc->deallocate(input->items[(i * 7) & (ALLOCATION_COUNT - 1)]);
+        }
+    }
+    bench::consume(uint32_t(input->sizes[0]));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_increment(void *context, size_t iterations)
+{
+    memory_input_t                *input = (memory_input_t*) context;
+    memory::increment_allocator_t *alloc = input->linear;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        for (size_t i = 0; i < ALLOCATION_COUNT; ++i)
+        {
+            input->items[i] = alloc->allocate(input->sizes[i], 16);
+        }
+        alloc->reset();
+    }
+    bench::consume(uint32_t(input->sizes[0]));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_decrement(void *context, size_t iterations)
+{
+    memory_input_t                *input = (memory_input_t*) context;
+    memory::decrement_allocator_t *alloc = input->stack;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        for (size_t i = 0; i < ALLOCATION_COUNT; ++i)
+        {
+            input->items[i] = alloc->allocate(input->sizes[i], 16);
+        }
+        alloc->reset();
+    }
+    bench::consume(uint32_t(input->sizes[0]));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_small_vector(size_t item_count, size_t *inout_bytes)
+{
+    // reuse the allocator setup; sizes[0] holds the item count instead.
+    memory_input_t *input = (memory_input_t*) setup_allocators(512, inout_bytes);
+    if (input != NULL)
+    {
+        input->sizes[0] = item_count;
+        *inout_bytes    = item_count * sizeof(uint32_t);
+    }
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_small_vector(void *context, size_t iterations)
+{
+    typedef memory::small_vector_t<uint32_t, SMALL_VECTOR_INLINE> vector_t;
+
+    memory_input_t *input = (memory_input_t*) context;
+    uint32_t        sum   = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        // each item after the first is a copy of one already stored, so
+        // the pushes that grow the vector pass a reference into the
+        // storage that grow() releases. the vector's destructor returns
+        // any heap storage to the sub-allocator.
+        vector_t items(input->heap);
+        items.push_back(uint32_t(n));
+        for (size_t i = 1; i < input->sizes[0]; ++i)
+        {
+            items.push_back(items[i >> 1]);
+        }
+        sum += items[items.size() - 1];
+    }
+    bench::consume(sum);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void register_memory_benchmarks(void)
+{
+    // the argument is the largest request size; each iteration performs
+    // ALLOCATION_COUNT allocations and releases them all.
+    bench::register_case("alloc_crt/256x512",       setup_allocators, run_crt,       teardown_allocators, 512, 0);
+    bench::register_case("alloc_heap/256x512",      setup_allocators, run_heap,      teardown_allocators, 512, 0);
+    bench::register_case("alloc_increment/256x512", setup_allocators, run_increment, teardown_allocators, 512, 0);
+    bench::register_case("alloc_decrement/256x512", setup_allocators, run_decrement, teardown_allocators, 512, 0);
+    // the argument is the number of items pushed; the first case stays
+    // within the inline storage and the second grows onto the heap.
+    bench::register_case("small_vector/16",         setup_small_vector, run_small_vector, teardown_allocators, 16,  0);
+    bench::register_case("small_vector/256",        setup_small_vector, run_small_vector, teardown_allocators, 256, 0);
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
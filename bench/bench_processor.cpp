@@ -0,0 +1,201 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements benchmarks for the multiple-producer, single-consumer
+/// queues in libprocessor: the intrusive mpsc_list_t, and the bounded ring
+/// mpsc_queue_t as a point of reference.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdlib.h>
+#include "benchmark.hpp"
+#include "libprocessor.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the number of producer threads used by the contended cases.
+#define PRODUCER_COUNT        4
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct queue_item_t
+{
+    processor::mpsc_node_t   node;   /// link used by mpsc_list_t
+    uint32_t                 value;  /// the payload
+};
+
+typedef processor::mpsc_queue_t<uint32_t> ring_t;
+
+struct queue_input_t
+{
+    queue_item_t            *items;  /// the nodes pushed each iteration
+    ring_t::cell_t          *cells;  /// storage for the bounded ring
+    processor::mpsc_list_t   list;   /// the intrusive list
+    size_t                   count;  /// the number of items per iteration
+};
+
+/// pushes a contiguous range of nodes onto a shared mpsc_list_t.
+class producer_t : public processor::thread_t
+{
+public:
+    processor::mpsc_list_t  *list;   /// the list to push onto
+    queue_item_t            *items;  /// the first node to push
+    size_t                   count;  /// the number of nodes to push
+
+public:
+    void* run(void)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            list->push(&items[i].node);
+        }
+        return NULL;
+    }
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the bounded ring. its offsets are cache-line aligned, so it lives at file
+/// scope rather than in the heap-allocated input; cases run one at a time.
+static ring_t Ring;
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_queue(void *context)
+{
+    queue_input_t *input = (queue_input_t*) context;
+    ::free(input->cells);
+    ::free(input->items);
+    delete input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_queue(size_t count, size_t *inout_bytes)
+{
+    queue_input_t *input = new queue_input_t();
+    input->count = count;
+    input->items = (queue_item_t  *) ::malloc(count * sizeof(queue_item_t));
+    input->cells = (ring_t::cell_t*) ::malloc(count * sizeof(ring_t::cell_t));
+    if (NULL == input->items || NULL == input->cells || !Ring.bind(input->cells, count))
+    {
+        teardown_queue(input);
+        return NULL;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        input->items[i].node.next = NULL;
+        input->items[i].value     = uint32_t(i);
+    }
+    *inout_bytes = count * sizeof(uint32_t);
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static uint32_t drain_list(processor::mpsc_list_t *list, size_t count)
+{
+    // pop() returns NULL while a producer is between its exchange and
+    // its link, so keep polling until every node has been seen.
+    uint32_t sum = 0;
+    while (count > 0)
+    {
+        processor::mpsc_node_t *node = list->pop();
+        if (node != NULL)
+        {
+            sum += ((queue_item_t*) node)->value;
+            --count;
+        }
+    }
+    return sum;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_list(void *context, size_t iterations)
+{
+    queue_input_t *input = (queue_input_t*) context;
+    uint32_t       sum   = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        for (size_t i = 0; i < input->count; ++i)
+        {
+            input->list.push(&input->items[i].node);
+        }
+        sum += drain_list(&input->list, input->count);
+    }
+    bench::consume(sum);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_ring(void *context, size_t iterations)
+{
+    queue_input_t *input = (queue_input_t*) context;
+    uint32_t       sum   = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        uint32_t value = 0;
+        for (size_t i = 0; i < input->count; ++i)
+        {
+            Ring.enqueue(input->items[i].value);
+        }
+        while (Ring.dequeue(&value))
+        {
+            sum += value;
+        }
+    }
+    bench::consume(sum);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_list_producers(void *context, size_t iterations)
+{
+    queue_input_t *input = (queue_input_t*) context;
+    size_t         share = input->count / PRODUCER_COUNT;
+    uint32_t       sum   = 0;
+    for (size_t n = 0; n < iterations; ++n)
+    {
+        // the producers are started each iteration, so the timing
+        // includes thread creation; the consumer drains concurrently.
+        producer_t producers[PRODUCER_COUNT];
+        for (size_t i = 0; i < PRODUCER_COUNT; ++i)
+        {
+            producers[i].list  = &input->list;
+            producers[i].items = &input->items[i * share];
+            producers[i].count = share;
+            producers[i].start();
+        }
+        sum += drain_list(&input->list, share * PRODUCER_COUNT);
+        for (size_t i = 0; i < PRODUCER_COUNT; ++i)
+        {
+            producers[i].join();
+        }
+    }
+    bench::consume(sum);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void register_processor_benchmarks(void)
+{
+    // the argument is the number of items pushed and popped by each
+    // iteration; the ring capacity matches, so it never fills.
+    bench::register_case("mpsc_list/4096",     setup_queue, run_list,           teardown_queue, 4096,  0);
+    bench::register_case("mpsc_queue/4096",    setup_queue, run_ring,           teardown_queue, 4096,  0);
+    bench::register_case("mpsc_list_4p/65536", setup_queue, run_list_producers, teardown_queue, 65536, 0);
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
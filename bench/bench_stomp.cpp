@@ -0,0 +1,140 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements benchmarks for the STOMP frame parser in libstomp.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "benchmark.hpp"
+#include "libstomp.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the number of frames in the stream parsed by each iteration.
+#define FRAME_COUNT           64
+/// the size of the parser message buffer.
+#define MESSAGE_BUFFER_SIZE   65536
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct stomp_input_t
+{
+    size_t               size;     /// number of bytes in the stream
+    uint8_t             *stream;   /// FRAME_COUNT back-to-back MESSAGE frames
+    stomp::parse_state_t parser;   /// the parser state
+    uint8_t              message[MESSAGE_BUFFER_SIZE];
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_stream(size_t body_size, size_t *inout_bytes)
+{
+    size_t         frame_max = body_size + 256;
+    stomp_input_t *input     = (stomp_input_t*) ::malloc(sizeof(stomp_input_t));
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->stream = (uint8_t*) ::malloc(frame_max * FRAME_COUNT);
+    if (NULL == input->stream)
+    {
+        ::free(input);
+        return NULL;
+    }
+
+    // build a stream of typical MESSAGE frames, as a client would
+    // receive them from a broker, each carrying a binary body.
+    uint8_t *p = input->stream;
+    for (size_t i = 0; i < FRAME_COUNT; ++i)
+    {
+        int n = sprintf((char*) p,
+            "MESSAGE\n"
+            "destination:/topic/profile\n"
+            "message-id:%u\n"
+            "subscription:0\n"
+            "content-type:application/octet-stream\n"
+            "content-length:%u\n"
+            "\n",
+            unsigned(i), unsigned(body_size));
+        p += n;
+        for (size_t j = 0; j < body_size; ++j)
+        {
+            *p++ = uint8_t(i + j);
+        }
+        *p++ = 0;
+    }
+    input->size  = size_t(p - input->stream);
+    *inout_bytes = input->size;
+    stomp::parse_state_init(&input->parser, input->message, MESSAGE_BUFFER_SIZE);
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_stream(void *context)
+{
+    stomp_input_t *input = (stomp_input_t*) context;
+    ::free(input->stream);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_parse_state_update(void *context, size_t iterations)
+{
+    stomp_input_t *input = (stomp_input_t*) context;
+    uint32_t       count = 0;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        size_t offset = 0;
+        while (offset < input->size)
+        {
+            size_t  used  = 0;
+            int32_t state = stomp::parse_state_update(
+                &input->parser,
+                input->stream,
+                input->size,
+                offset,
+                &used);
+
+            offset += used;
+            if (stomp::PARSE_STATE_MESSAGE_COMPLETE == state)
+            {
+                stomp::parse_state_reset(&input->parser);
+                count++;
+            }
+            else if (stomp::PARSE_STATE_ERROR == state)
+            {
+                stomp::parse_state_reset(&input->parser);
+                break;
+            }
+        }
+    }
+    bench::consume(count);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void register_stomp_benchmarks(void)
+{
+    // the argument is the body size of each frame; the throughput is
+    // reported for the whole stream of frames, headers included.
+    bench::register_case("stomp_parse/64x16", setup_stream, run_parse_state_update, teardown_stream, 16,   0);
+    bench::register_case("stomp_parse/64x4K", setup_stream, run_parse_state_update, teardown_stream, 4096, 0);
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
@@ -0,0 +1,149 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements benchmarks for the UTF-8 conversion functions in
+/// libutf8.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdlib.h>
+#include "benchmark.hpp"
+#include "libutf8.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct utf8_input_t
+{
+    size_t    count;      /// number of codepoints in the text
+    size_t    utf8_size;  /// number of bytes of UTF-8 text
+    size_t    utf16_size; /// number of UTF-16 code units
+    uint8_t  *utf8;       /// the text, UTF-8 encoded
+    uint16_t *utf16;      /// the text, UTF-16 encoded
+    uint32_t *utf32;      /// the text, UTF-32 encoded
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C teardown_text(void *context)
+{
+    utf8_input_t *input = (utf8_input_t*) context;
+    ::free(input->utf32);
+    ::free(input->utf16);
+    ::free(input->utf8);
+    ::free(input);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* CMN_CALL_C setup_text(size_t count, size_t *inout_bytes)
+{
+    // mostly ASCII, with the proportion of multi-byte sequences found
+    // in typical localized UI strings: accented Latin, CJK and emoji.
+    static uint32_t const Codepoints[16] =
+    {
+        'L', 'o', 'r', 'e', 'm', ' ', 'i', 'p', 's', 'u', 'm', ' ',
+        0x00E9, 0x00FC, 0x6F22, 0x1F600
+    };
+    utf8_input_t *input = (utf8_input_t*) ::malloc(sizeof(utf8_input_t));
+    if (NULL == input)
+    {
+        return NULL;
+    }
+    input->count = count;
+    input->utf8  = (uint8_t *) ::malloc(count * 4 + 1);
+    input->utf16 = (uint16_t*) ::malloc(count * 2 * sizeof(uint16_t) + 2);
+    input->utf32 = (uint32_t*) ::malloc(count * sizeof(uint32_t));
+    if (NULL == input->utf8 || NULL == input->utf16 || NULL == input->utf32)
+    {
+        teardown_text(input);
+        return NULL;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        input->utf32[i] = Codepoints[(i * 7) & 15];
+    }
+
+    uint32_t const *src32 = input->utf32;
+    uint8_t        *dst8  = input->utf8;
+    utf8::from_utf32(&src32, input->utf32 + count, &dst8, input->utf8 + count * 4);
+    input->utf8_size = size_t(dst8 - input->utf8);
+
+    uint8_t const  *src8  = input->utf8;
+    uint16_t       *dst16 = input->utf16;
+    utf8::to_utf16(&src8, input->utf8 + input->utf8_size, &dst16, input->utf16 + count * 2);
+    input->utf16_size = size_t(dst16 - input->utf16);
+    *inout_bytes = input->utf8_size;
+    return input;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_to_utf16(void *context, size_t iterations)
+{
+    utf8_input_t *input = (utf8_input_t*) context;
+    uint32_t      units = 0;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        uint8_t const *src = input->utf8;
+        uint16_t      *dst = input->utf16;
+        utf8::to_utf16(&src, input->utf8 + input->utf8_size, &dst, input->utf16 + input->count * 2);
+        units += uint32_t(dst - input->utf16);
+    }
+    bench::consume(units);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_from_utf16(void *context, size_t iterations)
+{
+    utf8_input_t *input = (utf8_input_t*) context;
+    uint32_t      units = 0;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        uint16_t const *src = input->utf16;
+        uint8_t        *dst = input->utf8;
+        utf8::from_utf16(&src, input->utf16 + input->utf16_size, &dst, input->utf8 + input->count * 4);
+        units += uint32_t(dst - input->utf8);
+    }
+    bench::consume(units);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void CMN_CALL_C run_to_utf32(void *context, size_t iterations)
+{
+    utf8_input_t *input = (utf8_input_t*) context;
+    uint32_t      units = 0;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        uint8_t const *src = input->utf8;
+        uint32_t      *dst = input->utf32;
+        utf8::to_utf32(&src, input->utf8 + input->utf8_size, &dst, input->utf32 + input->count);
+        units += uint32_t(dst - input->utf32);
+    }
+    bench::consume(units);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void register_utf8_benchmarks(void)
+{
+    // the argument is the number of codepoints; the throughput is
+    // reported in terms of the size of the UTF-8 encoded text.
+    bench::register_case("utf8_to_utf16/4K",   setup_text, run_to_utf16,   teardown_text, 4096, 0);
+    bench::register_case("utf8_from_utf16/4K", setup_text, run_from_utf16, teardown_text, 4096, 0);
+    bench::register_case("utf8_to_utf32/4K",   setup_text, run_to_utf32,   teardown_text, 4096, 0);
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
@@ -0,0 +1,413 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements the micro-benchmark framework. Timing uses the same
+/// high-resolution clock as the profiler.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "benchmark.hpp"
+#include "libjson.hpp"
+#include "libprofile.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the maximum number of iterations in a single sample.
+#define MAX_ITERATIONS        (size_t(1) << 30)
+/// the version number written to baseline documents.
+#define BASELINE_VERSION      1
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the location written by bench::consume().
+uint32_t volatile        bench::Sink                = 0;
+/// the registered benchmark cases.
+static bench::case_t     Cases[BENCH_MAX_CASES];
+/// the number of registered benchmark cases.
+static size_t            Case_Count                 = 0;
+/// per-sample times of the case being run, in nanoseconds per iteration.
+static double            Samples[BENCH_MAX_SAMPLES];
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static int compare_doubles(void const *a, void const *b)
+{
+    double x = *(double const*) a;
+    double y = *(double const*) b;
+    if (x < y) return -1;
+    if (x > y) return +1;
+    return 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static double percentile(double const *sorted, size_t count, double p)
+{
+    // nearest-rank percentile of a sorted array.
+    size_t rank = size_t(ceil(p * double(count)));
+    if (rank < 1)     rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static int64_t time_sample(
+    bench::case_t const *bench_case,
+    void                *context,
+    size_t               iterations)
+{
+    int64_t start = 0;
+    int64_t end   = 0;
+    profile::tick_count(&start);
+    bench_case->run(context, iterations);
+    profile::tick_count(&end);
+    return (end - start);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void write_json_string(FILE *fp, char const *str)
+{
+    fputc('"', fp);
+    for (char const *s = str; *s != '\0'; ++s)
+    {
+        if ('"' == *s || '\\' == *s) fputc('\\', fp);
+        fputc(*s, fp);
+    }
+    fputc('"', fp);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static char* read_file(char const *path)
+{
+    FILE  *fp   = fopen(path, "rb");
+    char  *data = NULL;
+    long   size = 0;
+    if (NULL == fp)
+    {
+        return NULL;
+    }
+    if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0)
+    {
+        fclose(fp);
+        return NULL;
+    }
+    rewind(fp);
+    data = (char*) ::malloc(size_t(size) + 1);
+    if (data != NULL && fread(data, 1, size_t(size), fp) != size_t(size))
+    {
+        ::free(data);
+        data = NULL;
+    }
+    if (data != NULL)
+    {
+        data[size] = '\0';
+    }
+    fclose(fp);
+    return data;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static json::item_t* find_field(json::item_t *object, char const *key)
+{
+    for (json::item_t *i = object->first_child; i != NULL; i = i->next_sibling)
+    {
+        if (i->key != NULL && 0 == strcmp(i->key, key)) return i;
+    }
+    return NULL;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool number_value(json::item_t *item, double *out_value)
+{
+    if (item != NULL && json::TYPE_NUMBER == item->value_type)
+    {
+        *out_value = item->value.number;
+        return true;
+    }
+    if (item != NULL && json::TYPE_INTEGER == item->value_type)
+    {
+        *out_value = double(item->value.integer);
+        return true;
+    }
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void bench::options_init(bench::options_t *out_options)
+{
+    out_options->warmup_count   = 5;
+    out_options->sample_count   = 31;
+    out_options->sample_usec    = 2000;
+    out_options->outlier_factor = 1.5;
+    out_options->filter         = NULL;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool bench::register_case(
+    char const        *name,
+    bench::setup_fn    setup,
+    bench::run_fn      run,
+    bench::teardown_fn teardown,
+    size_t             argument,
+    size_t             bytes)
+{
+    if (Case_Count >= BENCH_MAX_CASES || NULL == name || NULL == run)
+    {
+        return false;
+    }
+    bench::case_t *c = &Cases[Case_Count++];
+    c->name     = name;
+    c->setup    = setup;
+    c->run      = run;
+    c->teardown = teardown;
+    c->argument = argument;
+    c->bytes    = bytes;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t bench::case_count(void)
+{
+    return Case_Count;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bench::case_t const* bench::get_case(size_t index)
+{
+    return (index < Case_Count) ? &Cases[index] : NULL;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool bench::run_case(
+    bench::case_t const    *bench_case,
+    bench::options_t const *options,
+    bench::result_t        *out_result)
+{
+    double  ns_per_tick  = 1000000000.0 / double(profile::tick_frequency());
+    double  min_ticks    = double(options->sample_usec) * 1000.0 / ns_per_tick;
+    size_t  sample_count = CMN_MIN(options->sample_count, size_t(BENCH_MAX_SAMPLES));
+    size_t  iterations   = 1;
+    size_t  first        = 0;
+    size_t  last         = 0;
+    size_t  bytes        = 0;
+    void   *context      = NULL;
+
+    if (NULL == bench_case || 0 == sample_count)
+    {
+        return false;
+    }
+    bytes = bench_case->bytes;
+    if (bench_case->setup != NULL)
+    {
+        context = bench_case->setup(bench_case->argument, &bytes);
+        if (NULL == context) return false;
+    }
+
+    // calibrate: double the iteration count until a single sample
+    // is long enough that the clock resolution doesn't matter.
+    while (iterations < MAX_ITERATIONS)
+    {
+        if (double(time_sample(bench_case, context, iterations)) >= min_ticks)
+        {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    // warm the caches and branch predictors, then take the samples.
+    for (size_t i = 0; i < options->warmup_count; ++i)
+    {
+        time_sample(bench_case, context, iterations);
+    }
+    for (size_t i = 0; i < sample_count; ++i)
+    {
+        int64_t ticks = time_sample(bench_case, context, iterations);
+        Samples[i]    = double(ticks) * ns_per_tick / double(iterations);
+    }
+    if (bench_case->teardown != NULL)
+    {
+        bench_case->teardown(context);
+    }
+
+    // reject samples outside of Tukey's fences. on a quiet machine
+    // these are usually a few slow samples caused by interrupts or
+    // context switches, which would otherwise skew the mean and p99.
+    qsort(Samples, sample_count, sizeof(double), compare_doubles);
+    last = sample_count;
+    if (sample_count >= 4 && options->outlier_factor > 0.0)
+    {
+        double q1  = percentile(Samples, sample_count, 0.25);
+        double q3  = percentile(Samples, sample_count, 0.75);
+        double iqr = q3 - q1;
+        double lo  = q1 - iqr * options->outlier_factor;
+        double hi  = q3 + iqr * options->outlier_factor;
+        while (first < last && Samples[first]    < lo) ++first;
+        while (last > first && Samples[last - 1] > hi) --last;
+    }
+
+    double sum = 0.0;
+    for (size_t i = first; i < last; ++i)
+    {
+        sum += Samples[i];
+    }
+    out_result->name       = bench_case->name;
+    out_result->bytes      = bytes;
+    out_result->iterations = iterations;
+    out_result->samples    = last - first;
+    out_result->outliers   = sample_count - (last - first);
+    out_result->median_ns  = percentile(Samples + first, last - first, 0.50);
+    out_result->p99_ns     = 0.0;
+    out_result->min_ns     = Samples[first];
+    out_result->max_ns     = Samples[last - 1];
+    out_result->mean_ns    = sum / double(last - first);
+    if (last - first >= BENCH_P99_MIN_SAMPLES)
+    {
+        out_result->p99_ns = percentile(Samples + first, last - first, 0.99);
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void bench::print_result(FILE *fp, bench::result_t const *result)
+{
+    // with too few samples for a 99th percentile, the tail is the max.
+    bool p99 = result->samples >= BENCH_P99_MIN_SAMPLES;
+    fprintf(fp, "%-36s %12.1f ns %12.1f ns %s  %3u/%-3u",
+        result->name,
+        result->median_ns,
+        p99 ? result->p99_ns : result->max_ns,
+        p99 ? "p99" : "max",
+        unsigned(result->samples),
+        unsigned(result->samples + result->outliers));
+    if (result->bytes > 0 && result->median_ns > 0.0)
+    {
+        // bytes per nanosecond is GB/s; report MB/s.
+        double mbps = double(result->bytes) / result->median_ns * 1000.0;
+        fprintf(fp, " %10.1f MB/s", mbps);
+    }
+    fputc('\n', fp);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool bench::save_baseline(
+    char const            *path,
+    bench::result_t const *results,
+    size_t                 count)
+{
+    FILE *fp = fopen(path, "wb");
+    if (NULL == fp)
+    {
+        return false;
+    }
+    fprintf(fp, "{\"version\":%d,\"benchmarks\":[", BASELINE_VERSION);
+    for (size_t i = 0; i < count; ++i)
+    {
+        bench::result_t const *r = &results[i];
+        fprintf(fp, "%s\n {\"name\":", i > 0 ? "," : "");
+        write_json_string(fp, r->name);
+        fprintf(fp,
+            ",\"median_ns\":%.3f,\"p99_ns\":%.3f,\"min_ns\":%.3f,\"max_ns\":%.3f"
+            ",\"mean_ns\":%.3f,\"samples\":%u,\"bytes\":%u}",
+            r->median_ns, r->p99_ns, r->min_ns, r->max_ns, r->mean_ns,
+            unsigned(r->samples), unsigned(r->bytes));
+    }
+    fprintf(fp, "]}\n");
+    return (0 == fclose(fp));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool bench::compare_baseline(
+    char const            *path,
+    bench::result_t const *results,
+    size_t                 count,
+    double                 threshold,
+    FILE                  *fp,
+    size_t                *out_regressions)
+{
+    char          *doc   = read_file(path);
+    json::item_t  *root  = NULL;
+    json::item_t  *list  = NULL;
+    json::error_t  error;
+    size_t         worse = 0;
+
+    *out_regressions = 0;
+    if (NULL == doc)
+    {
+        return false;
+    }
+    if (!json::parse(doc, NULL, &root, &error))
+    {
+        fprintf(fp, "%s:%u: %s\n", path, unsigned(error.line), error.description);
+        ::free(doc);
+        return false;
+    }
+    list = find_field(root, "benchmarks");
+    if (NULL == list || json::TYPE_ARRAY != list->value_type)
+    {
+        json::free(root, NULL);
+        ::free(doc);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        bench::result_t const *r    = &results[i];
+        double                 base = 0.0;
+        bool                   hit  = false;
+        for (json::item_t *b = list->first_child; b != NULL; b = b->next_sibling)
+        {
+            json::item_t *name = find_field(b, "name");
+            if (name != NULL && json::TYPE_STRING == name->value_type &&
+                0 == strcmp(name->value.string, r->name))
+            {
+                hit = number_value(find_field(b, "median_ns"), &base);
+                break;
+            }
+        }
+        if (!hit || base <= 0.0)
+        {
+            fprintf(fp, "%-36s %12.1f ns  (no baseline)\n", r->name, r->median_ns);
+            continue;
+        }
+
+        double change  = (r->median_ns - base) / base;
+        bool   regress = change > threshold;
+        fprintf(fp, "%-36s %12.1f ns %12.1f ns base %+7.1f%%%s\n",
+            r->name, r->median_ns, base, change * 100.0,
+            regress ? "  REGRESSION" : "");
+        if (regress) worse++;
+    }
+    json::free(root, NULL);
+    ::free(doc);
+    *out_regressions = worse;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
@@ -0,0 +1,215 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Defines a minimal micro-benchmark framework. Each benchmark case
+/// is calibrated, warmed up and then timed over a number of samples using the
+/// profiler clock. Outlying samples are rejected before the median and 99th
+/// percentile times are reported; short runs report the slowest sample in
+/// place of the 99th percentile. Results can be saved as a JSON baseline and
+/// later compared against, flagging any case that has regressed.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+#ifndef BENCHMARK_HPP_INCLUDED
+#define BENCHMARK_HPP_INCLUDED
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdio.h>
+#include "common.hpp"
+
+/*///////////////////////
+//   Namespace Begin   //
+///////////////////////*/
+namespace bench {
+
+/*////////////////////////////
+//   Forward Declarations   //
+////////////////////////////*/
+
+/*//////////////////////////////////
+//   Public Types and Functions   //
+//////////////////////////////////*/
+/// The maximum number of benchmark cases that can be registered.
+#define BENCH_MAX_CASES             256
+
+/// The maximum number of timed samples taken for a single benchmark case.
+#define BENCH_MAX_SAMPLES           1024
+
+/// The number of retained samples needed to report a 99th percentile. With
+/// fewer samples the percentile is just the slowest sample, so it is left at
+/// zero and only the maximum is reported.
+#define BENCH_P99_MIN_SAMPLES       100
+
+/// Function signature for a user-defined function that prepares the input
+/// data for a benchmark case. The setup time is not measured.
+///
+/// @param argument The argument specified when the case was registered.
+/// @param inout_bytes On entry, the number of bytes processed per iteration
+/// specified when the case was registered. The function may update this value
+/// if it is only known once the input data has been generated.
+/// @return Opaque data passed to the run and teardown functions.
+typedef void* (CMN_CALL_C *setup_fn)(size_t argument, size_t *inout_bytes);
+
+/// Function signature for the body of a benchmark case.
+///
+/// @param context The value returned by the setup function, or NULL.
+/// @param iterations The number of times the operation under test should be
+/// performed. The time taken by the call is divided by this value.
+typedef void  (CMN_CALL_C *run_fn)(void *context, size_t iterations);
+
+/// Function signature for a user-defined function that releases the data
+/// allocated by the setup function of a benchmark case.
+///
+/// @param context The value returned by the setup function.
+typedef void  (CMN_CALL_C *teardown_fn)(void *context);
+
+/// Describes a single registered benchmark case.
+struct case_t
+{
+    char const  *name;        /// the unique name of the case, a literal
+    setup_fn     setup;       /// the setup function, or NULL
+    run_fn       run;         /// the function containing the timed code
+    teardown_fn  teardown;    /// the teardown function, or NULL
+    size_t       argument;    /// the argument passed to the setup function
+    size_t       bytes;       /// bytes processed per iteration, or zero
+};
+
+/// Specifies the parameters used when timing benchmark cases.
+struct options_t
+{
+    size_t       warmup_count;     /// number of untimed samples taken first
+    size_t       sample_count;     /// number of timed samples
+    uint64_t     sample_usec;      /// minimum duration of a single sample
+    double       outlier_factor;   /// IQR multiple beyond which to reject
+    char const  *filter;           /// run only cases containing this string
+};
+
+/// Stores the measurements for a single benchmark case. All times are in
+/// nanoseconds per iteration.
+struct result_t
+{
+    char const  *name;        /// the name of the benchmark case
+    size_t       bytes;       /// bytes processed per iteration, or zero
+    size_t       iterations;  /// number of iterations per sample
+    size_t       samples;     /// number of samples retained
+    size_t       outliers;    /// number of samples rejected as outliers
+    double       median_ns;   /// median time of the retained samples
+    double       p99_ns;      /// 99th percentile, or zero if too few samples
+    double       min_ns;      /// fastest retained sample
+    double       max_ns;      /// slowest retained sample
+    double       mean_ns;     /// arithmetic mean of the retained samples
+};
+
+/// Initializes a set of benchmark options with the default values: 5 warmup
+/// samples, 31 timed samples of at least 2ms each, and Tukey's outlier fences
+/// at 1.5 times the interquartile range.
+///
+/// @param out_options The options structure to initialize.
+CMN_PUBLIC void options_init(bench::options_t *out_options);
+
+/// Registers a benchmark case. Cases are run in the order they are registered.
+///
+/// @param name The unique name of the case. This must be a string literal.
+/// @param setup The function used to create the input data for the case.
+/// This value may be NULL.
+/// @param run The function containing the code to be timed.
+/// @param teardown The function used to release the input data for the case.
+/// This value may be NULL.
+/// @param argument An application-defined value passed to @a setup, such as
+/// the size of the input data.
+/// @param bytes The number of bytes processed by one iteration, used to
+/// report throughput. Specify zero if throughput is not meaningful.
+/// @return true if the case was registered.
+CMN_PUBLIC bool register_case(
+    char const        *name,
+    bench::setup_fn    setup,
+    bench::run_fn      run,
+    bench::teardown_fn teardown,
+    size_t             argument,
+    size_t             bytes);
+
+/// Retrieves the number of registered benchmark cases.
+///
+/// @return The number of registered cases.
+CMN_PUBLIC size_t case_count(void);
+
+/// Retrieves a registered benchmark case.
+///
+/// @param index The zero-based index of the case.
+/// @return The case, or NULL if @a index is out of range.
+CMN_PUBLIC bench::case_t const* get_case(size_t index);
+
+/// Runs a single benchmark case. The number of iterations per sample is
+/// doubled until one sample takes at least the configured sample duration.
+/// The warmup samples are then run and discarded, and the timed samples are
+/// taken. Samples outside the outlier fences are rejected before computing
+/// the statistics.
+///
+/// @param bench_case The benchmark case to run.
+/// @param options The options controlling the measurement.
+/// @param out_result On return, the measurements for the case.
+/// @return true if the case was run.
+CMN_PUBLIC bool run_case(
+    bench::case_t const    *bench_case,
+    bench::options_t const *options,
+    bench::result_t        *out_result);
+
+/// Writes a single result to a stream as one line of human-readable text.
+///
+/// @param fp The stream to write to.
+/// @param result The result to write.
+CMN_PUBLIC void print_result(FILE *fp, bench::result_t const *result);
+
+/// Saves a set of results as a JSON baseline document.
+///
+/// @param path The path of the file to write.
+/// @param results The array of results.
+/// @param count The number of items in @a results.
+/// @return true if the file was written successfully.
+CMN_PUBLIC bool save_baseline(
+    char const            *path,
+    bench::result_t const *results,
+    size_t                 count);
+
+/// Compares a set of results against a JSON baseline document written by
+/// bench::save_baseline(). A result whose median time exceeds the baseline
+/// median by more than the threshold is reported as a regression. Results
+/// without a corresponding baseline entry are reported but not flagged.
+///
+/// @param path The path of the baseline file to read.
+/// @param results The array of results.
+/// @param count The number of items in @a results.
+/// @param threshold The allowed relative slowdown, for example 0.05 for 5%.
+/// @param fp The stream to write the comparison report to.
+/// @param out_regressions On return, the number of regressed results.
+/// @return true if the baseline was read successfully.
+CMN_PUBLIC bool compare_baseline(
+    char const            *path,
+    bench::result_t const *results,
+    size_t                 count,
+    double                 threshold,
+    FILE                  *fp,
+    size_t                *out_regressions);
+
+/// A location written by bench::consume(). Benchmark bodies pass the values
+/// they compute to bench::consume() so that the compiler cannot discard the
+/// work being measured.
+extern uint32_t volatile Sink;
+
+/// Prevents the compiler from eliminating the computation of a value.
+///
+/// @param value The value to consume.
+static inline void consume(uint32_t value)
+{
+    bench::Sink ^= value;
+}
+
+/*/////////////////////
+//   Namespace End   //
+/////////////////////*/
+}; /* end namespace bench */
+
+#endif /* BENCHMARK_HPP_INCLUDED */
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
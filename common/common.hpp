@@ -205,7 +205,7 @@
         #define CMN_FORCE_INLINE        __forceinline
     #endif /* defined(_MSC_VER) */
     #ifdef __GNUC__
-        #define CMN_FORCE_INLINE        __attribute__((always_inline))
+        #define CMN_FORCE_INLINE        inline __attribute__((always_inline))
     #endif /* defined(__GNUC__) */
 #endif /* !defined(CMN_FORCE_INLINE) */
 
@@ -222,6 +222,17 @@
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+#ifndef CMN_THREAD_LOCAL
+    #ifdef _MSC_VER
+        #define CMN_THREAD_LOCAL        __declspec(thread)
+    #endif /* defined(_MSC_VER) */
+    #ifdef __GNUC__
+        #define CMN_THREAD_LOCAL        __thread
+    #endif /* defined(__GNUC__) */
+#endif /* !defined(CMN_THREAD_LOCAL) */
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 /*//////////////////////////////////
 //   Public Types and Functions   //
 //////////////////////////////////*/
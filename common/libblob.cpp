@@ -12,9 +12,39 @@
 //   Includes   //
 ////////////////*/
 #include <limits>
+#include <stdlib.h>
+#include <string.h>
 #include "libblob.hpp"
+#include "libmemory.hpp"
 #include "common_traits.hpp"
 
+#if   CMN_IS_APPLE || CMN_IS_LINUX
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <pthread.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#elif CMN_IS_WINDOWS
+    #include <windows.h>
+#endif
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+#if defined(CMN_HAVE_TMMINTRIN_H) && \
+   (defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64))
+    #include <immintrin.h>
+    #define BLOB_USE_SIMD         1
+    #ifdef __GNUC__
+        #define BLOB_TARGET_SSSE3 __attribute__((target("ssse3")))
+        #define BLOB_TARGET_AVX2  __attribute__((target("avx2")))
+    #else
+        #define BLOB_TARGET_SSSE3
+        #define BLOB_TARGET_AVX2
+    #endif
+#endif
+
 /*//////////////////////////
 //   Using Declarations   //
 //////////////////////////*/
@@ -76,206 +106,298 @@ static const signed char Base64_Indices[] =
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-int32_t blob::determine_text_encoding(uint8_t BOM[4], size_t *out_size)
-{
-    size_t  bom_size = 0;
-    int32_t text_enc = blob::TEXT_ENCODING_UNSURE;
+/// the maximum depth of nested arrays and objects accepted by validation.
+#define MAX_VALIDATE_DEPTH    64
 
-    if (0 == BOM[0])
-    {
-        if (0 == BOM[1] && 0xFE == BOM[2] && 0xFF == BOM[3])
-        {
-            // UTF32 big-endian.
-            bom_size = 4;
-            text_enc = blob::TEXT_ENCODING_UTF32_BE;
-        }
-        else
-        {
-            // no BOM (or unrecognized).
-            bom_size = 0;
-            text_enc = blob::TEXT_ENCODING_UNSURE;
-        }
-    }
-    else if (0xFF == BOM[0])
-    {
-        if (0xFE == BOM[1])
-        {
-            if (0 == BOM[2] && 0 == BOM[3])
-            {
-                // UTF32 little-endian.
-                bom_size = 4;
-                text_enc = blob::TEXT_ENCODING_UTF32_LE;
-            }
-            else
-            {
-                // UTF16 little-endian.
-                bom_size = 2;
-                text_enc = blob::TEXT_ENCODING_UTF16_LE;
-            }
-        }
-        else
-        {
-            // no BOM (or unrecognized).
-            bom_size = 0;
-            text_enc = blob::TEXT_ENCODING_UNSURE;
-        }
-    }
-    else if (0xFE == BOM[0] && 0xFF == BOM[1])
-    {
-        // UTF16 big-endian.
-        bom_size = 2;
-        text_enc = blob::TEXT_ENCODING_UTF16_BE;
-    }
-    else if (0xEF == BOM[0] && 0xBB == BOM[1] && 0xBF == BOM[2])
-    {
-        // UTF-8.
-        bom_size = 3;
-        text_enc = blob::TEXT_ENCODING_UTF8;
-    }
-    else
-    {
-        // no BOM (or unrecognized).
-        bom_size = 0;
-        text_enc = blob::TEXT_ENCODING_UNSURE;
-    }
+/// the number of top-level fields claimed at once by a parallel worker.
+#define OPTIMIZE_BATCH_SIZE   16
 
-    if (out_size != NULL)
+/// the maximum number of threads used by a parallel operation.
+#define MAX_WORKER_THREADS    64
+
+/// the number of bits of the hash table used by the LZ compressor.
+#define LZ_HASH_BITS          12
+
+/// the length of the shortest match encoded by the LZ codec.
+#define LZ_MIN_MATCH          4
+
+/// the number of bytes at the end of a chunk that are always literals.
+#define LZ_LAST_LITERALS      5
+
+/// matches may not start within this many bytes of the end of a chunk.
+#define LZ_MATCH_LIMIT        12
+
+/// the largest match distance representable by the LZ codec.
+#define LZ_MAX_DISTANCE       65535
+
+/// the size of the header of a compressed blob container.
+#define CONTAINER_HEADER_SIZE 16
+
+/// the size of each entry in the chunk index of a compressed blob container.
+#define CONTAINER_ENTRY_SIZE  8
+
+/// the alignment of the buffer allocated by a blob builder.
+#define BUILDER_ALIGNMENT     16
+
+/// the builder size offset value used for fields not written to an object.
+#define BUILDER_NO_SIZE       (~size_t(0))
+
+/// the size of the header of a blob patch.
+#define PATCH_HEADER_SIZE     16
+
+/// the op tag bit marking literal bytes; otherwise the op copies old bytes.
+#define PATCH_OP_DATA         0x80000000U
+
+/// the op tag value of a copy from the old blob.
+#define PATCH_OP_COPY         0x00000000U
+
+/// the pending op kind of a diff when no op has been started.
+#define PATCH_OP_NONE         0xFFFFFFFFU
+
+/// the largest number of bytes produced by a single patch op.
+#define PATCH_MAX_RUN         0x7FFFFFFFU
+
+/// unchanged runs shorter than a copy op are sent as literal data instead.
+#define PATCH_MIN_COPY        8
+
+/// the best instruction set usable by the SIMD code paths, or -1 if unknown.
+static int32_t           Simd_ISA         = -1;
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static int32_t detect_simd_isa(void)
+{
+#if   BLOB_USE_SIMD && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))  return blob::BASE64_ISA_AVX2;
+    if (__builtin_cpu_supports("ssse3")) return blob::BASE64_ISA_SSSE3;
+    return blob::BASE64_ISA_SCALAR;
+#elif BLOB_USE_SIMD && defined(_MSC_VER)
+    // AVX2 also requires the OS to preserve the YMM registers.
+    int regs[4];
+    int isa = blob::BASE64_ISA_SCALAR;
+    __cpuid(regs, 1);
+    if (regs[2] & (1 << 9)) isa = blob::BASE64_ISA_SSSE3;
+    if ((regs[2] & (1 << 27)) && (regs[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6)
     {
-        // store the BOM size in bytes.
-        *out_size = bom_size;
+        __cpuidex(regs, 7, 0);
+        if (regs[1] & (1 << 5)) isa = blob::BASE64_ISA_AVX2;
     }
-    return text_enc;
+    return isa;
+#else
+    return blob::BASE64_ISA_SCALAR;
+#endif
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::bom(int32_t encoding, uint8_t out_BOM[4])
+static inline int32_t simd_isa(void)
 {
-    size_t  bom_size = 0;
-    switch (encoding)
-    {
-        case blob::TEXT_ENCODING_UTF8:
-            {
-                bom_size   = 3;
-                out_BOM[0] = 0xEF;
-                out_BOM[1] = 0xBB;
-                out_BOM[2] = 0xBF;
-                out_BOM[3] = 0x00;
-            }
-            break;
-
-        case blob::TEXT_ENCODING_UTF16_BE:
-            {
-                bom_size   = 2;
-                out_BOM[0] = 0xFE;
-                out_BOM[1] = 0xFF;
-                out_BOM[2] = 0x00;
-                out_BOM[3] = 0x00;
-            }
-            break;
+    // detection is idempotent, so a race here is harmless.
+    if (Simd_ISA < 0) Simd_ISA = detect_simd_isa();
+    return Simd_ISA;
+}
 
-        case blob::TEXT_ENCODING_UTF16_LE:
-            {
-                bom_size   = 2;
-                out_BOM[0] = 0xFF;
-                out_BOM[1] = 0xFE;
-                out_BOM[2] = 0x00;
-                out_BOM[3] = 0x00;
-            }
-            break;
+/*/////////////////////////////////////////////////////////////////////////80*/
 
-        case blob::TEXT_ENCODING_UTF32_BE:
-            {
-                bom_size   = 4;
-                out_BOM[0] = 0x00;
-                out_BOM[1] = 0x00;
-                out_BOM[2] = 0xFE;
-                out_BOM[3] = 0xFF;
-            }
-            break;
+#if BLOB_USE_SIMD
+BLOB_TARGET_SSSE3
+static inline __m128i encode_chars_ssse3(__m128i input)
+{
+    // split each group of three bytes into four 6-bit indices, one per
+    // byte, then map the indices to ASCII by adding a per-range offset.
+    // see http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+    __m128i in   = _mm_shuffle_epi8(input, _mm_setr_epi8(
+        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    __m128i t0   = _mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00));
+    __m128i t1   = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    __m128i t2   = _mm_and_si128(in, _mm_set1_epi32(0x003F03F0));
+    __m128i t3   = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    __m128i idx  = _mm_or_si128(t1, t3);
+    __m128i res  = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+    __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+    res = _mm_or_si128(res, _mm_and_si128(less, _mm_set1_epi8(13)));
+    res = _mm_shuffle_epi8(_mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+        '/' - 63, 'A', 0, 0), res);
+    return _mm_add_epi8(res, idx);
+}
 
-        case blob::TEXT_ENCODING_UTF32_LE:
-            {
-                bom_size   = 4;
-                out_BOM[0] = 0xFF;
-                out_BOM[1] = 0xFE;
-                out_BOM[2] = 0x00;
-                out_BOM[3] = 0x00;
-            }
-            break;
+/*/////////////////////////////////////////////////////////////////////////80*/
 
-        default:
-            {
-                // no byte order marker.
-                bom_size   = 0;
-                out_BOM[0] = 0;
-                out_BOM[1] = 0;
-                out_BOM[2] = 0;
-                out_BOM[3] = 0;
-            }
-            break;
+BLOB_TARGET_SSSE3
+static size_t encode_ssse3(uint8_t const *input, size_t input_size, char *output)
+{
+    // each iteration reads 16 bytes but consumes only 12 of them.
+    size_t n = 0;
+    for ( ; input_size - n >= 16; n += 12, output += 16)
+    {
+        __m128i in = _mm_loadu_si128((__m128i const*) (input + n));
+        _mm_storeu_si128((__m128i*) output, encode_chars_ssse3(in));
     }
-    return bom_size;
+    return n;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::base64_size(size_t binary_size, size_t *out_pad_size)
+BLOB_TARGET_SSSE3
+static size_t decode_ssse3(char const *input, size_t input_size, uint8_t *output, size_t output_size)
 {
-    // base64 transforms 3 input bytes into 4 output bytes.
-    // pad the binary size so it is evenly divisible by 3.
-    size_t rem = binary_size % 3;
-    size_t adj = (rem != 0)  ? 3 - rem : 0;
-    if (out_pad_size  != 0)  *out_pad_size = adj;
-    return ((binary_size + adj) / 3) * 4 + 1; // +1 for NULL
+    // each iteration decodes 16 characters into 12 bytes but stores 16.
+    // decoding stops at the first block containing a character outside
+    // of the base64 alphabet, including padding; see
+    // http://0x80.pl/notesen/2016-01-17-sse-base64-decoding.html
+    size_t n = 0;
+    for ( ; input_size - n >= 16 && output_size >= 16; n += 16, output += 12, output_size -= 12)
+    {
+        __m128i in    = _mm_loadu_si128((__m128i const*) (input + n));
+        __m128i hi    = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0F));
+        __m128i lo    = _mm_and_si128(in, _mm_set1_epi8(0x0F));
+        __m128i mask  = _mm_shuffle_epi8(_mm_setr_epi8(
+            char(0xA8), char(0xF8), char(0xF8), char(0xF8),
+            char(0xF8), char(0xF8), char(0xF8), char(0xF8),
+            char(0xF8), char(0xF8), char(0xF0), char(0x54),
+            char(0x50), char(0x50), char(0x50), char(0x54)), lo);
+        __m128i bit   = _mm_shuffle_epi8(_mm_setr_epi8(
+            0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, char(0x80),
+            0, 0, 0, 0, 0, 0, 0, 0), hi);
+        __m128i bad   = _mm_cmpeq_epi8(_mm_and_si128(mask, bit), _mm_setzero_si128());
+        if (_mm_movemask_epi8(bad) != 0)
+        {
+            break;
+        }
+        // '/' shares its high nibble with '+' but needs a shift of 16.
+        __m128i shift = _mm_shuffle_epi8(_mm_setr_epi8(
+            0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0), hi);
+        __m128i slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+        shift = _mm_add_epi8(shift, _mm_and_si128(slash, _mm_set1_epi8(-3)));
+        __m128i val   = _mm_add_epi8(in, shift);
+        // pack four 6-bit values into three bytes, in big-endian order.
+        __m128i ab    = _mm_maddubs_epi16(val, _mm_set1_epi32(0x01400140));
+        __m128i abc   = _mm_madd_epi16(ab, _mm_set1_epi32(0x00011000));
+        __m128i out   = _mm_shuffle_epi8(abc, _mm_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128((__m128i*) output, out);
+    }
+    return n;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::binary_size(size_t base64_size, size_t pad_size)
+BLOB_TARGET_AVX2
+static size_t encode_avx2(uint8_t const *input, size_t input_size, char *output)
 {
-    return (((3 * base64_size) / 4) - pad_size);
+    // the same as encode_ssse3(), with 12 bytes in each 128-bit lane.
+    // each iteration reads 28 bytes but consumes only 24 of them.
+    size_t n = 0;
+    for ( ; input_size - n >= 28; n += 24, output += 32)
+    {
+        __m128i lo   = _mm_loadu_si128((__m128i const*) (input + n));
+        __m128i hi   = _mm_loadu_si128((__m128i const*) (input + n + 12));
+        __m256i in   = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        in = _mm256_shuffle_epi8(in, _mm256_setr_epi8(
+            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+        __m256i t0   = _mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00));
+        __m256i t1   = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        __m256i t2   = _mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0));
+        __m256i t3   = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        __m256i idx  = _mm256_or_si256(t1, t3);
+        __m256i res  = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+        __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx);
+        res = _mm256_or_si256(res, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        res = _mm256_shuffle_epi8(_mm256_setr_epi8(
+            'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+            '/' - 63, 'A', 0, 0,
+            'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+            '/' - 63, 'A', 0, 0), res);
+        _mm256_storeu_si256((__m256i*) output, _mm256_add_epi8(res, idx));
+    }
+    return n;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::binary_size(char const *base64_source, size_t base64_length)
+BLOB_TARGET_AVX2
+static size_t decode_avx2(char const *input, size_t input_size, uint8_t *output, size_t output_size)
 {
-    if (NULL == base64_source || 0 == base64_length)
+    // the same as decode_ssse3(), with 16 characters in each 128-bit
+    // lane. each iteration decodes 32 characters and stores 32 bytes.
+    size_t n = 0;
+    for ( ; input_size - n >= 32 && output_size >= 32; n += 32, output += 24, output_size -= 24)
     {
-        // zero-length input - zero-length output.
-        return 0;
+        __m256i in    = _mm256_loadu_si256((__m256i const*) (input + n));
+        __m256i hi    = _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0F));
+        __m256i lo    = _mm256_and_si256(in, _mm256_set1_epi8(0x0F));
+        __m256i mask  = _mm256_shuffle_epi8(_mm256_setr_epi8(
+            char(0xA8), char(0xF8), char(0xF8), char(0xF8),
+            char(0xF8), char(0xF8), char(0xF8), char(0xF8),
+            char(0xF8), char(0xF8), char(0xF0), char(0x54),
+            char(0x50), char(0x50), char(0x50), char(0x54),
+            char(0xA8), char(0xF8), char(0xF8), char(0xF8),
+            char(0xF8), char(0xF8), char(0xF8), char(0xF8),
+            char(0xF8), char(0xF8), char(0xF0), char(0x54),
+            char(0x50), char(0x50), char(0x50), char(0x54)), lo);
+        __m256i bit   = _mm256_shuffle_epi8(_mm256_setr_epi8(
+            0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, char(0x80),
+            0, 0, 0, 0, 0, 0, 0, 0,
+            0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, char(0x80),
+            0, 0, 0, 0, 0, 0, 0, 0), hi);
+        __m256i bad   = _mm256_cmpeq_epi8(_mm256_and_si256(mask, bit), _mm256_setzero_si256());
+        if (_mm256_movemask_epi8(bad) != 0)
+        {
+            break;
+        }
+        __m256i shift = _mm256_shuffle_epi8(_mm256_setr_epi8(
+            0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0), hi);
+        __m256i slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+        shift = _mm256_add_epi8(shift, _mm256_and_si256(slash, _mm256_set1_epi8(-3)));
+        __m256i val   = _mm256_add_epi8(in, shift);
+        __m256i ab    = _mm256_maddubs_epi16(val, _mm256_set1_epi32(0x01400140));
+        __m256i abc   = _mm256_madd_epi16(ab, _mm256_set1_epi32(0x00011000));
+        __m256i out   = _mm256_shuffle_epi8(abc, _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        // move the 12 bytes in the upper lane down next to the lower 12.
+        out = _mm256_permutevar8x32_epi32(out, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_storeu_si256((__m256i*) output, out);
     }
-
-    // end points at the last character in the base64 source data.
-    char const *end = base64_source + base64_length - 1;
-    size_t      pad = 0;
-    if (base64_length >= 1 && '=' == *end--)  ++pad;
-    if (base64_length >= 2 && '=' == *end--)  ++pad;
-    return blob::binary_size(base64_length, pad);
+    return n;
 }
+#endif /* BLOB_USE_SIMD */
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::base64_encode(
-    void const *input,
-    size_t      input_size,
-    char       *output,
-    size_t      output_size)
+static size_t encode_groups(uint8_t const *input, size_t input_size, char *output)
 {
-    size_t         pad    = 0;
-    size_t         req    = blob::base64_size(input_size, &pad);
-    size_t         ins    = input_size;
-    uint8_t const *inp    = (uint8_t const*) input;
-    char          *outp   = output;
-    uint8_t        buf[4] = {0};
-
-    if (output_size < req)
+    // encodes as many complete three-byte groups as possible, using the
+    // widest instruction set available, and returns the bytes consumed.
+    uint8_t const *inp  = input;
+    char          *outp = output;
+    size_t         ins  = input_size;
+    uint8_t        buf[4];
+#if BLOB_USE_SIMD
+    int32_t        isa  = simd_isa();
+    size_t         n    = 0;
+    if (isa >= blob::BASE64_ISA_AVX2)
     {
-        // insufficient space in buffer.
-        return 0;
+        n     = encode_avx2(inp, ins, outp);
+        inp  += n;
+        ins  -= n;
+        outp += (n / 3) * 4;
     }
-
+    if (isa >= blob::BASE64_ISA_SSSE3)
+    {
+        n     = encode_ssse3(inp, ins, outp);
+        inp  += n;
+        ins  -= n;
+        outp += (n / 3) * 4;
+    }
+#endif
     // process input three bytes at a time.
     while (ins >= 3)
     {
@@ -296,61 +418,84 @@ size_t blob::base64_encode(
         inp    += 3;
         ins    -= 3;
     }
-    // pad any remaining input (either 1 or 2 bytes) up to three bytes; encode.
-    if (ins > 0)
-    {
-        uint8_t src[3];
-        size_t  i  = 0;
-
-        // copy remaining real bytes from input; pad with nulls.
-        for (i = 0; i  < ins; ++i) src[i] = *inp++;
-        for (     ; i != 3;   ++i) src[i] = 0;
-        // buf[0] = left  6 bits of inp[0].
-        // buf[1] = right 2 bits of inp[0], left 4 bits of inp[1].
-        // buf[2] = right 4 bits of inp[1], left 2 bits of inp[2].
-        // buf[3] = right 6 bits of inp[2].
-        buf[0]  = (uint8_t)  ((src[0] & 0xFC) >> 2);
-        buf[1]  = (uint8_t) (((src[0] & 0x03) << 4) + ((src[1] & 0xF0) >> 4));
-        buf[2]  = (uint8_t) (((src[1] & 0x0F) << 2) + ((src[2] & 0xC0) >> 6));
-        buf[3]  = (uint8_t)   (src[2] & 0x3F);
-        // produce four bytes of output from three bytes of input.
-        *(outp+0) = Base64_Chars[buf[0]];
-        *(outp+1) = Base64_Chars[buf[1]];
-        *(outp+2) = Base64_Chars[buf[2]];
-        *(outp+3) = Base64_Chars[buf[3]];
-        // overwrite the junk characters with '=' characters.
-        for (outp += 1 + ins; ins++ != 3;)  *outp++ = '=';
-    }
-    // always append the trailing null.
-    *outp++ = '\0';
-    // return the number of bytes written.
-    return ((size_t)(outp - output));
+    return (size_t) (inp - input);
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::base64_decode(
-    char const *input,
-    size_t      input_size,
-    void       *output,
-    size_t      output_size)
+static size_t encode_final(uint8_t const *input, size_t input_size, char *output)
 {
-    char const *inp    = input;
-    char const *end    = input + input_size;
-    signed char idx[4] = {0};
-    uint8_t    *outp   = (uint8_t*) output;
-    size_t      curr   =  0;
-    size_t      pad    =  0;
-    size_t      req    = blob::binary_size(input_size, 0);
-
-    if (output_size < (req - 2))
+    // pad the remaining input (either 1 or 2 bytes) up to three bytes; encode.
+    uint8_t const *inp  = input;
+    char          *outp = output;
+    size_t         ins  = input_size;
+    uint8_t        src[3];
+    uint8_t        buf[4];
+    size_t         i    = 0;
+
+    if (0 == ins)
     {
-        // insufficient space in buffer.
         return 0;
     }
+    // copy remaining real bytes from input; pad with nulls.
+    for (i = 0; i  < ins; ++i) src[i] = *inp++;
+    for (     ; i != 3;   ++i) src[i] = 0;
+    // buf[0] = left  6 bits of inp[0].
+    // buf[1] = right 2 bits of inp[0], left 4 bits of inp[1].
+    // buf[2] = right 4 bits of inp[1], left 2 bits of inp[2].
+    // buf[3] = right 6 bits of inp[2].
+    buf[0]  = (uint8_t)  ((src[0] & 0xFC) >> 2);
+    buf[1]  = (uint8_t) (((src[0] & 0x03) << 4) + ((src[1] & 0xF0) >> 4));
+    buf[2]  = (uint8_t) (((src[1] & 0x0F) << 2) + ((src[2] & 0xC0) >> 6));
+    buf[3]  = (uint8_t)   (src[2] & 0x3F);
+    // produce four bytes of output from three bytes of input.
+    *(outp+0) = Base64_Chars[buf[0]];
+    *(outp+1) = Base64_Chars[buf[1]];
+    *(outp+2) = Base64_Chars[buf[2]];
+    *(outp+3) = Base64_Chars[buf[3]];
+    // overwrite the junk characters with '=' characters.
+    for (outp += 1 + ins; ins++ != 3;)  *outp++ = '=';
+    return 4;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
 
-    while (inp != end)
+static uint8_t* decode_chars(
+    blob::base64_stream_t *state,
+    char const            *input,
+    size_t                 input_size,
+    uint8_t               *output,
+    uint8_t               *output_end)
+{
+    char const  *inp  = input;
+    char const  *end  = input + input_size;
+    uint8_t     *outp = output;
+    uint8_t     *idx  = state->buffer;
+#if BLOB_USE_SIMD
+    int32_t      isa  = simd_isa();
+#endif
+
+    while (inp != end && !state->finished)
     {
+#if BLOB_USE_SIMD
+        if (0 == state->buffer_count && isa != blob::BASE64_ISA_SCALAR)
+        {
+            // between groups; decode whole blocks of valid characters.
+            // blocks with whitespace or padding fall through to the
+            // scalar path below, one character at a time.
+            size_t n = 0;
+            if (isa >= blob::BASE64_ISA_AVX2)
+            {
+                n     = decode_avx2(inp, size_t(end - inp), outp, size_t(output_end - outp));
+                inp  += n;
+                outp += (n / 4) * 3;
+            }
+            n     = decode_ssse3(inp, size_t(end - inp), outp, size_t(output_end - outp));
+            inp  += n;
+            outp += (n / 4) * 3;
+            if (inp == end) break;
+        }
+#endif
         char ch = *inp++;
         if (ch != '=')
         {
@@ -358,8 +503,8 @@ size_t blob::base64_decode(
             if (chi != -1)
             {
                 // valid character, buffer it.
-                idx[curr++] = chi;
-                pad         = 0;
+                idx[state->buffer_count++] = (uint8_t) chi;
+                state->pad_count = 0;
             }
             else
             {
@@ -370,14 +515,15 @@ size_t blob::base64_decode(
         else
         {
             // this is a padding character.
-            idx[curr++] = 0;
-            ++pad;
+            idx[state->buffer_count++] = 0;
+            state->pad_count++;
         }
 
-        if (4 == curr)
+        if (4 == state->buffer_count)
         {
             // we've read three bytes of data; generate output.
-            curr     = 0;
+            size_t pad = state->pad_count;
+            state->buffer_count = 0;
             *outp++  = (uint8_t) ((idx[0] << 2) + ((idx[1] & 0x30) >> 4));
             if (pad != 2)
             {
@@ -387,823 +533,3877 @@ size_t blob::base64_decode(
                     *outp++ = (uint8_t) (((idx[2] & 0x3) << 6) + idx[3]);
                 }
             }
-            if (pad != 0) break;
+            if (pad != 0) state->finished = 1;
         }
     }
-    // return the number of bytes written.
-    return ((size_t)(outp - ((uint8_t*)output)));
+    return outp;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-int32_t blob::field_type_minimum_integer(
-    int64_t max_value,
-    bool    support_signed)
+static inline uint32_t field_slot(uint32_t field_name, uint32_t slot_mask)
 {
-    if (max_value < 0 || support_signed)
+    // field names are often small integers or already hashed; mix the bits
+    // so that either spreads evenly over the table.
+    uint32_t h = field_name * 0x9E3779B1U;
+    return  (h ^ (h >> 16)) & slot_mask;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline uint32_t index_size_for_count(uint32_t field_count)
+{
+    // keep the load factor between 1/4 and 1/2 so that most lookups
+    // resolve on the first probe.
+    uint32_t n = 4;
+    while (n < field_count * 2) n <<= 1;
+    return n;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline size_t runtime_object_header(
+    void      *data,
+    ptrdiff_t  byte_offset,
+    uint32_t  *out_field_count,
+    uint32_t  *out_index_size)
+{
+    // returns the size of the count, names, offsets and index, that is,
+    // the offset of the value blob relative to byte_offset.
+    uint32_t count_bits  = blob::read_u32(data, byte_offset);
+    uint32_t field_count = count_bits & ~uint32_t(BLOB_RT_OBJECT_INDEXED);
+    size_t   header_size = sizeof(uint32_t) + field_count * sizeof(uint32_t) * 2;
+    uint32_t index_size  = 0;
+    if (count_bits & BLOB_RT_OBJECT_INDEXED)
     {
-        // check signed types only.
-        if (max_value >= std::numeric_limits<int8_t>::min()  &&
-            max_value <= std::numeric_limits<int8_t>::max())
-        {
-            return blob::FIELD_TYPE_SINT8;
-        }
-        if (max_value >= std::numeric_limits<int16_t>::min() &&
-            max_value <= std::numeric_limits<int16_t>::max())
-        {
-            return blob::FIELD_TYPE_SINT16;
+        index_size   = blob::read_u32(data, byte_offset + header_size);
+        header_size += sizeof(uint32_t) + index_size * sizeof(uint32_t);
+    }
+    *out_field_count = field_count;
+    *out_index_size  = index_size;
+    return header_size;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static size_t optimize_body(
+    uint8_t *dst,
+    size_t   dst_ofs,
+    void    *src,
+    size_t   src_ofs,
+    int32_t  field_type,
+    size_t   src_size,
+    int32_t  flags,
+    int32_t *out_type);
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static size_t optimize_object_body(
+    uint8_t *dst,
+    size_t   dst_ofs,
+    void    *src,
+    size_t   src_ofs,
+    int32_t  flags)
+{
+    // converts the generic object whose field count is at src_ofs into
+    // the body of a runtime object at dst_ofs. if dst is NULL, only the
+    // size is computed.
+    uint32_t field_count = blob::read_u32(src, src_ofs);
+    uint32_t index_size  = 0;
+    size_t   names_ofs   = dst_ofs   + sizeof(uint32_t);
+    size_t   offset_ofs  = names_ofs + field_count * sizeof(uint32_t);
+    size_t   values_ofs  = offset_ofs+ field_count * sizeof(uint32_t);
+    size_t   field_ofs   = src_ofs   + sizeof(uint32_t) * 2;
+    size_t   val_ofs     = 0;
+
+    if (flags & blob::OPTIMIZE_FLAGS_FIELD_INDEX)
+    {
+        index_size  = index_size_for_count(field_count);
+        values_ofs += sizeof(uint32_t) + index_size * sizeof(uint32_t);
+    }
+    for (uint32_t i = 0; i < field_count; ++i)
+    {
+        blob::generic_object_field_t sf;
+        int32_t type = blob::FIELD_TYPE_NONE;
+        blob::generic_object_field_at(src, field_ofs, &sf);
+        size_t  size = optimize_body(
+            dst, values_ofs + val_ofs + sizeof(int32_t),
+            src, field_ofs  + sf.total_size - sf.field_size,
+            sf.field_type,    sf.field_size, flags, &type);
+        if (dst != NULL)
+        {
+            blob::write_u32(dst, names_ofs  + i * sizeof(uint32_t), sf.field_name);
+            blob::write_u32(dst, offset_ofs + i * sizeof(uint32_t), uint32_t(val_ofs));
+            blob::write_s32(dst, values_ofs + val_ofs, type);
         }
-        if (max_value >= std::numeric_limits<int32_t>::min() &&
-            max_value <= std::numeric_limits<int32_t>::max())
+        val_ofs   += sizeof(int32_t) + size;
+        field_ofs += sf.total_size;
+    }
+    if (dst != NULL)
+    {
+        uint32_t count_bits = field_count;
+        if (index_size > 0)
         {
-            return blob::FIELD_TYPE_SINT32;
+            // build the index with linear probing. fields are inserted in
+            // order, so a duplicate name resolves to its first occurrence,
+            // just as it would with a linear search.
+            uint32_t  mask  = index_size - 1;
+            size_t    table = values_ofs - index_size * sizeof(uint32_t);
+            uint32_t *slots = blob::data_at<uint32_t>(dst, table);
+            for (uint32_t i = 0; i < index_size; ++i)
+            {
+                slots[i] = BLOB_FIELD_INDEX_INVALID;
+            }
+            for (uint32_t i = 0; i < field_count; ++i)
+            {
+                uint32_t name = blob::read_u32(dst, names_ofs + i * sizeof(uint32_t));
+                uint32_t slot = field_slot(name, mask);
+                while (slots[slot] != BLOB_FIELD_INDEX_INVALID)
+                {
+                    slot = (slot + 1) & mask;
+                }
+                slots[slot] = i;
+            }
+            blob::write_u32(dst, table - sizeof(uint32_t), index_size);
+            count_bits |= BLOB_RT_OBJECT_INDEXED;
         }
-        return blob::FIELD_TYPE_SINT64;
+        blob::write_u32(dst, dst_ofs, count_bits);
     }
-    else
+    return (values_ofs - dst_ofs) + val_ofs;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static size_t optimize_array_body(
+    uint8_t *dst,
+    size_t   dst_ofs,
+    void    *src,
+    size_t   src_ofs,
+    int32_t  flags)
+{
+    // converts the array whose item count is at src_ofs, optimizing any
+    // generic object items. if dst is NULL, only the size is computed.
+    uint32_t item_count  = blob::read_u32(src, src_ofs);
+    int32_t  item_type   = blob::read_s32(src, src_ofs + sizeof(uint32_t));
+    size_t   header_size = sizeof(uint32_t) + sizeof(int32_t);
+    size_t   src_item    = src_ofs + header_size;
+    size_t   dst_item    = dst_ofs + header_size;
+
+    if (blob::FIELD_TYPE_GN_OBJECT == item_type)
     {
-        // check unsigned types only.
-        uint64_t uns_value = (uint64_t) max_value;
-        if (uns_value >= std::numeric_limits<uint8_t>::min()  &&
-            uns_value <= std::numeric_limits<uint8_t>::max())
+        for (uint32_t i = 0; i < item_count; ++i)
         {
-            return blob::FIELD_TYPE_UINT8;
+            size_t src_size = blob::generic_object_total_size(src, src_item);
+            dst_item += optimize_object_body(dst, dst_item, src, src_item, flags);
+            src_item += src_size;
         }
-        if (uns_value >= std::numeric_limits<uint16_t>::min() &&
-            uns_value <= std::numeric_limits<uint16_t>::max())
+        item_type = blob::FIELD_TYPE_RT_OBJECT;
+    }
+    else if (blob::FIELD_TYPE_ARRAY == item_type)
+    {
+        for (uint32_t i = 0; i < item_count; ++i)
         {
-            return blob::FIELD_TYPE_UINT16;
+            size_t src_size = blob::array_total_size(src, src_item);
+            dst_item += optimize_array_body(dst, dst_item, src, src_item, flags);
+            src_item += src_size;
         }
-        if (uns_value >= std::numeric_limits<uint32_t>::min() &&
-            uns_value <= std::numeric_limits<uint32_t>::max())
+    }
+    else
+    {
+        // the items need no conversion; copy them directly.
+        size_t data_size = blob::array_data_size(src, src_ofs);
+        if (dst != NULL)
         {
-            return blob::FIELD_TYPE_UINT32;
+            traits::copy(blob::data_at<uint8_t>(src, src_item), data_size, dst + dst_item);
         }
-        return blob::FIELD_TYPE_UINT64;
+        dst_item += data_size;
+    }
+    if (dst != NULL)
+    {
+        blob::write_field_array_info(dst, dst_ofs, item_type, item_count);
     }
+    return dst_item - dst_ofs;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-bool blob::field_type_is_signed(int32_t field_type)
+static size_t optimize_body(
+    uint8_t *dst,
+    size_t   dst_ofs,
+    void    *src,
+    size_t   src_ofs,
+    int32_t  field_type,
+    size_t   src_size,
+    int32_t  flags,
+    int32_t *out_type)
 {
-    switch (field_type)
+    // converts the src_size bytes of field data at src_ofs, not including
+    // the field type, and returns the type and size of the result.
+    if (blob::FIELD_TYPE_GN_OBJECT == field_type)
     {
-        case blob::FIELD_TYPE_NONE:        return false;
-        case blob::FIELD_TYPE_NULL:        return false;
-        case blob::FIELD_TYPE_BOOLEAN:     return false;
-        case blob::FIELD_TYPE_SINT8:       return true;
-        case blob::FIELD_TYPE_UINT8:       return false;
-        case blob::FIELD_TYPE_CHAR:        return true;
-        case blob::FIELD_TYPE_SINT16:      return true;
-        case blob::FIELD_TYPE_UINT16:      return false;
-        case blob::FIELD_TYPE_SINT32:      return true;
-        case blob::FIELD_TYPE_UINT32:      return false;
-        case blob::FIELD_TYPE_SINT64:      return true;
-        case blob::FIELD_TYPE_UINT64:      return false;
-        case blob::FIELD_TYPE_FLOAT32:     return true;
-        case blob::FIELD_TYPE_FLOAT64:     return true;
-        case blob::FIELD_TYPE_VECTOR_2F:   return true;
-        case blob::FIELD_TYPE_VECTOR_3F:   return true;
-        case blob::FIELD_TYPE_VECTOR_4F:   return true;
-        case blob::FIELD_TYPE_MATRIX_2X2F: return true;
-        case blob::FIELD_TYPE_MATRIX_3X3F: return true;
-        case blob::FIELD_TYPE_MATRIX_3X4F: return true;
-        case blob::FIELD_TYPE_MATRIX_4X4F: return true;
-        default:                           break;
+        *out_type = blob::FIELD_TYPE_RT_OBJECT;
+        return optimize_object_body(dst, dst_ofs, src, src_ofs, flags);
     }
-    return false;
+    if (blob::FIELD_TYPE_ARRAY == field_type)
+    {
+        *out_type = blob::FIELD_TYPE_ARRAY;
+        return optimize_array_body(dst, dst_ofs, src, src_ofs, flags);
+    }
+    if (dst != NULL)
+    {
+        traits::copy(blob::data_at<uint8_t>(src, src_ofs), src_size, dst + dst_ofs);
+    }
+    *out_type = field_type;
+    return src_size;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-bool blob::field_type_is_unsigned(int32_t field_type)
+static size_t optimize_field(
+    uint8_t *dst,
+    size_t   dst_ofs,
+    void    *src,
+    size_t   src_ofs,
+    size_t   src_size,
+    int32_t  flags)
 {
-    switch (field_type)
+    // optimizes the top-level field of src_size bytes at src_ofs. if dst
+    // is NULL, only the size of the result is computed.
+    int32_t type = blob::read_s32(src, src_ofs);
+    size_t  body = optimize_body(
+        dst,  dst_ofs  + sizeof(int32_t),
+        src,  src_ofs  + sizeof(int32_t),
+        type, src_size - sizeof(int32_t), flags, &type);
+    if (dst != NULL)
     {
-        case blob::FIELD_TYPE_NONE:        return false;
-        case blob::FIELD_TYPE_NULL:        return false;
-        case blob::FIELD_TYPE_BOOLEAN:     return true;
-        case blob::FIELD_TYPE_SINT8:       return false;
-        case blob::FIELD_TYPE_UINT8:       return true;
-        case blob::FIELD_TYPE_CHAR:        return false;
-        case blob::FIELD_TYPE_SINT16:      return false;
-        case blob::FIELD_TYPE_UINT16:      return true;
-        case blob::FIELD_TYPE_SINT32:      return false;
-        case blob::FIELD_TYPE_UINT32:      return true;
-        case blob::FIELD_TYPE_SINT64:      return false;
-        case blob::FIELD_TYPE_UINT64:      return true;
-        case blob::FIELD_TYPE_FLOAT32:     return false;
-        case blob::FIELD_TYPE_FLOAT64:     return false;
-        case blob::FIELD_TYPE_VECTOR_2F:   return false;
-        case blob::FIELD_TYPE_VECTOR_3F:   return false;
-        case blob::FIELD_TYPE_VECTOR_4F:   return false;
-        case blob::FIELD_TYPE_MATRIX_2X2F: return false;
-        case blob::FIELD_TYPE_MATRIX_3X3F: return false;
-        case blob::FIELD_TYPE_MATRIX_3X4F: return false;
-        case blob::FIELD_TYPE_MATRIX_4X4F: return false;
-        default:                           break;
+        blob::write_s32(dst, dst_ofs, type);
     }
-    return false;
+    return sizeof(int32_t) + body;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::field_size_for_type(int32_t field_type)
+static size_t optimize_fields(uint8_t *dst, void *src, size_t src_size, int32_t flags)
 {
-    switch (field_type)
+    // optimizes each top-level field in turn. if dst is NULL, only the
+    // size of the result is computed.
+    size_t src_ofs = 0;
+    size_t dst_ofs = 0;
+    while (src_ofs < src_size)
     {
-        case blob::FIELD_TYPE_NONE:        return 0;
-        case blob::FIELD_TYPE_NULL:        return 0;
-        case blob::FIELD_TYPE_BOOLEAN:     return sizeof(int8_t);
-        case blob::FIELD_TYPE_SINT8:       return sizeof(int8_t);
-        case blob::FIELD_TYPE_UINT8:       return sizeof(uint8_t);
-        case blob::FIELD_TYPE_CHAR:        return sizeof(int8_t);
-        case blob::FIELD_TYPE_SINT16:      return sizeof(int16_t);
-        case blob::FIELD_TYPE_UINT16:      return sizeof(uint16_t);
-        case blob::FIELD_TYPE_SINT32:      return sizeof(int32_t);
-        case blob::FIELD_TYPE_UINT32:      return sizeof(uint32_t);
-        case blob::FIELD_TYPE_SINT64:      return sizeof(int64_t);
-        case blob::FIELD_TYPE_UINT64:      return sizeof(uint64_t);
-        case blob::FIELD_TYPE_FLOAT32:     return sizeof(float);
-        case blob::FIELD_TYPE_FLOAT64:     return sizeof(double);
-        case blob::FIELD_TYPE_VECTOR_2F:   return sizeof(float) * 2;
-        case blob::FIELD_TYPE_VECTOR_3F:   return sizeof(float) * 3;
-        case blob::FIELD_TYPE_VECTOR_4F:   return sizeof(float) * 4;
-        case blob::FIELD_TYPE_MATRIX_2X2F: return sizeof(float) * 4;
-        case blob::FIELD_TYPE_MATRIX_3X3F: return sizeof(float) * 9;
-        case blob::FIELD_TYPE_MATRIX_3X4F: return sizeof(float) * 12;
-        case blob::FIELD_TYPE_MATRIX_4X4F: return sizeof(float) * 16;
-        default:                           break;
+        size_t size = blob::field_total_size(src, src_ofs);
+        dst_ofs += optimize_field(dst, dst_ofs, src, src_ofs, size, flags);
+        src_ofs += size;
     }
-    return BLOB_FIELD_SIZE_VARIABLE;
+    return dst_ofs;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::total_size_for_type(int32_t field_type)
+static inline bool in_bounds(size_t data_size, size_t offset, size_t amount)
 {
-    size_t base_size = blob::field_size_for_type(field_type);
-    return base_size + sizeof(int32_t);
+    return (offset <= data_size && amount <= data_size - offset);
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::optimize(
-    void * CMN_RESTRICT blob_dst,
-    void * CMN_RESTRICT blob_src,
-    size_t              blob_size)
-{
-    uint8_t *dst_ptr = (uint8_t*) blob_dst;
-    uint8_t *src_ptr = (uint8_t*) blob_src;
-    uint8_t *src_end =((uint8_t*) blob_src) + blob_size;
-    size_t   src_ofs = 0;
-    while (src_ptr  != src_end)
-    {
-        blob::field_t  field  = {0};
-        switch (blob::field_at(blob_src, src_ofs, &field))
-        {
-            case    blob::FIELD_TYPE_GN_OBJECT:
-                {
-                    // this is an optimizable object. the generic and the optimized
-                    // object representations have the same size, but the data is
-                    // organized differently in memory.
-                    size_t bytes_written = blob::optimize_object_field(
-                        blob_dst, src_ofs,
-                        blob_src, src_ofs);
-                    dst_ptr += bytes_written;
-                    src_ptr += bytes_written;
-                    src_ofs += bytes_written;
-                }
-                break;
+static bool valid_body(
+    void   *data,
+    size_t  data_size,
+    int32_t field_type,
+    size_t  offset,
+    size_t  depth,
+    size_t *out_end);
 
-            case    blob::FIELD_TYPE_ARRAY:
-                {
-                    size_t bytes_written = blob::optimize_array_field(
-                        blob_dst, src_ofs,
-                        blob_src, src_ofs);
-                    dst_ptr += bytes_written;
-                    src_ptr += bytes_written;
-                    src_ofs += bytes_written;
-                }
-                break;
+/*/////////////////////////////////////////////////////////////////////////80*/
 
-            default:
-                {
-                    // no need to optimize; we can just copy this data directly.
-                    traits::copy(src_ptr, field.total_size, dst_ptr);
-                    dst_ptr += field.total_size;
-                    src_ptr += field.total_size;
-                    src_ofs += field.total_size;
-                }
-                break;
-        }
+static bool valid_field(void *data, size_t data_size, size_t offset, size_t depth, size_t *out_end)
+{
+    if (!in_bounds(data_size, offset, sizeof(int32_t)))
+    {
+        return false;
     }
-    return blob_size;
+    int32_t field_type = blob::read_s32(data, offset);
+    return valid_body(data, data_size, field_type, offset + sizeof(int32_t), depth, out_end);
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::optimize_object_field(
-    void * CMN_RESTRICT blob_dst,
-    ptrdiff_t           blob_dst_offset,
-    void * CMN_RESTRICT blob_src,
-    ptrdiff_t           blob_src_offset)
-{
-    uint8_t   *dst_ptr        = (uint8_t*) blob_dst;
-    uint8_t   *src_ptr        = (uint8_t*) blob_src;
-    ptrdiff_t  src_type_ofs   = blob_src_offset + 0;
-    ptrdiff_t  src_count_ofs  = src_type_ofs    + sizeof(int32_t);
-    ptrdiff_t  src_size_ofs   = src_count_ofs   + sizeof(uint32_t);
-    ptrdiff_t  src_data_ofs   = src_size_ofs    + sizeof(uint32_t);
-    uint32_t   field_count    = blob::read_u32(src_ptr, src_count_ofs);
-    size_t     dst_name_sz    = field_count     * sizeof(uint32_t);
-    size_t     dst_offset_sz  = field_count     * sizeof(uint32_t);
-    ptrdiff_t  dst_type_ofs   = blob_dst_offset + 0;
-    ptrdiff_t  dst_count_ofs  = dst_type_ofs    + sizeof(int32_t);
-    ptrdiff_t  dst_name_ofs   = dst_count_ofs   + sizeof(uint32_t);
-    ptrdiff_t  dst_offset_ofs = dst_name_ofs    + dst_name_sz;
-    ptrdiff_t  dst_data_ofs   = dst_offset_ofs  + dst_offset_sz;
-    uint32_t  *dst_names      = blob::data_at<uint32_t>(dst_ptr, dst_name_ofs);
-    uint32_t  *dst_offsets    = blob::data_at<uint32_t>(dst_ptr, dst_offset_ofs);
-    uint8_t   *dst_fields     = blob::data_at<uint8_t> (dst_ptr, dst_data_ofs);
-    int32_t    type           = blob::FIELD_TYPE_RT_OBJECT;
-    uint32_t   val_ofs        = 0;
-    size_t     total_size     = 0;
-
-    // write the field type:
-    blob::write_s32(blob_dst, dst_type_ofs, type);
-    total_size  += sizeof(type);
-
-    // write the sub-field count:
-    blob::write_u32(blob_dst, dst_count_ofs, field_count);
-    total_size  += sizeof(field_count);
-
-    // iterate over all fields to generate the names, offsets and data.
-    for (size_t i= 0; i < field_count; ++i)
-    {
-        blob::generic_object_field_t sf = {0};
-        blob::generic_object_field_at(blob_src, src_data_ofs, &sf);
-
-        // write the field name:
-        blob::write_u32(&dst_names[i], 0, sf.field_name);
-        total_size += sizeof(uint32_t);
-
-        // write the field offset:
-        blob::write_u32(&dst_offsets[i], 0, val_ofs);
-        total_size += sizeof(uint32_t);
-
-        // if this is a generic object, we must optimize it.
-        if (blob::FIELD_TYPE_GN_OBJECT == sf.field_type)
-        {
-            // recursively optimize the object.
-            size_t obj_size = blob::optimize_object_field(
-                blob_dst,
-                dst_data_ofs+ val_ofs,
-                blob_src,
-                src_data_ofs);
-            total_size     += obj_size;
-            dst_fields     += obj_size;
-            val_ofs        += obj_size;
-            src_data_ofs   += sf.total_size;
-            continue;
+static bool valid_generic_object(void *data, size_t data_size, size_t offset, size_t depth, size_t *out_end)
+{
+    size_t header_size = sizeof(uint32_t) * 2;
+    size_t field_header_size = sizeof(uint32_t) * 2 + sizeof(int32_t);
+    if (!in_bounds(data_size, offset, header_size))
+    {
+        return false;
+    }
+    uint32_t field_count = blob::read_u32(data, offset);
+    uint32_t field_size  = blob::read_u32(data, offset + sizeof(uint32_t));
+    if (!in_bounds(data_size, offset, header_size + size_t(field_size)))
+    {
+        return false;
+    }
+    // each field must fit within the declared field data size, and each
+    // field body must exactly fill the size declared for that field.
+    size_t at  = offset + header_size;
+    size_t end = at + field_size;
+    for (uint32_t i = 0; i < field_count; ++i)
+    {
+        if (!in_bounds(end, at, field_header_size))
+        {
+            return false;
         }
-
-        // this could be an array of generic objects, which
-        // again require special handling and optimization.
-        if (blob::FIELD_TYPE_ARRAY == sf.field_type)
-        {
-            // optimize the array.
-            size_t arr_size = blob::optimize_array_field(
-                blob_dst,
-                dst_data_ofs+ val_ofs,
-                blob_src,
-                src_data_ofs);
-            total_size     += arr_size;
-            dst_fields     += arr_size;
-            val_ofs        += arr_size;
-            src_data_ofs   += sf.total_size;
-            continue;
+        int32_t  type = blob::read_s32(data, at + sizeof(uint32_t));
+        uint32_t size = blob::read_u32(data, at + sizeof(uint32_t) + sizeof(int32_t));
+        size_t   body = at + field_header_size;
+        size_t   last = 0;
+        if (!in_bounds(end, body, size))
+        {
+            return false;
         }
-
-        // this is a plain old field and nothing special is required.
-        // first, copy over the field value type to the destination.
-        blob::write_s32(dst_fields, 0, sf.field_type);
-        total_size += sizeof(int32_t);
-        dst_fields += sizeof(int32_t);
-        val_ofs    += sizeof(int32_t);
-
-        // write the field value data:
-        traits::copy((uint8_t*) sf.field_data, sf.field_size, dst_fields);
-        total_size += sf.field_size;
-        dst_fields += sf.field_size;
-        val_ofs    += sf.field_size;
-
-        // update our source offset to the start of the next field.
-        src_data_ofs   += sf.total_size;
+        if (!valid_body(data, body + size, type, body, depth + 1, &last) || last != body + size)
+        {
+            return false;
+        }
+        at = body + size;
     }
-    return total_size;
+    *out_end = offset + header_size + field_size;
+    return true;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::optimize_array_field(
-    void * CMN_RESTRICT blob_dst,
-    ptrdiff_t           blob_dst_offset,
-    void * CMN_RESTRICT blob_src,
-    ptrdiff_t           blob_src_offset)
-{
-    size_t total_size         =  0;
-    blob::array_field_t array = {0};
-    blob::array_field_at(blob_src, blob_src_offset, &array);
-
-    // write the array header.
-    size_t type_size   = blob::write_field_array(blob_dst, blob_dst_offset);
-    blob_dst_offset   += type_size;
-    total_size        += type_size;
-
-    // this could be an array of generic objects, in which case we need
-    // to optimize them into runtime objects using blob_optimize_object().
-    if (blob::FIELD_TYPE_GN_OBJECT == array.item_type)
-    {
-        // write the array header, but use BLOB_FIELD_TYPE_RT_OBJECT.
-        size_t obj_ofs   = 0;
-        size_t hdr_size  = blob::write_field_array_info(
-            blob_dst,
-            blob_dst_offset,
-            blob::FIELD_TYPE_RT_OBJECT,
-            array.item_count);
-        blob_dst_offset += hdr_size;
-        total_size      += hdr_size;
-
-        // for each source generic object, optimize into runtime form.
-        for (size_t i = 0; i < array.item_count; ++i)
-        {
-            size_t sub_size  = blob::optimize_object_field(
-                blob_dst,
-                blob_dst_offset,
-                array.item_data,
-                obj_ofs);
-            blob_dst_offset += sub_size;
-            total_size      += sub_size;
-            obj_ofs         += sub_size;
+static bool valid_runtime_object(void *data, size_t data_size, size_t offset, size_t depth, size_t *out_end)
+{
+    if (!in_bounds(data_size, offset, sizeof(uint32_t)))
+    {
+        return false;
+    }
+    uint32_t count_bits  = blob::read_u32(data, offset);
+    uint32_t field_count = count_bits & ~uint32_t(BLOB_RT_OBJECT_INDEXED);
+    size_t   names_ofs   = offset + sizeof(uint32_t);
+    if (field_count > (data_size - names_ofs) / (sizeof(uint32_t) * 2))
+    {
+        return false;
+    }
+    size_t    offset_ofs = names_ofs  + field_count * sizeof(uint32_t);
+    size_t    base       = offset_ofs + field_count * sizeof(uint32_t);
+    if (count_bits & BLOB_RT_OBJECT_INDEXED)
+    {
+        // the index must be a power of two with at least one empty slot,
+        // so that probing terminates, and must reference valid fields.
+        if (!in_bounds(data_size, base, sizeof(uint32_t)))
+        {
+            return false;
         }
-        return total_size;
+        uint32_t index_size = blob::read_u32(data, base);
+        uint32_t empty      = 0;
+        base += sizeof(uint32_t);
+        if (index_size <= field_count || (index_size & (index_size - 1)) != 0)
+        {
+            return false;
+        }
+        if (index_size > (data_size - base) / sizeof(uint32_t))
+        {
+            return false;
+        }
+        for (uint32_t i = 0; i < index_size; ++i)
+        {
+            uint32_t slot = blob::read_u32(data, base + i * sizeof(uint32_t));
+            if (BLOB_FIELD_INDEX_INVALID == slot) empty++;
+            else if (slot >= field_count) return false;
+        }
+        if (0 == empty)
+        {
+            return false;
+        }
+        base += index_size * sizeof(uint32_t);
     }
-    // this could be an array of arrays; optimize recursively.
-    if (blob::FIELD_TYPE_ARRAY == array.item_type)
-    {
-        // write the array header unchanged.
-        size_t arr_ofs   = 0;
-        size_t hdr_size  = blob::write_field_array_info(
-            blob_dst,
-            blob_dst_offset,
-            array.item_type,
-            array.item_count);
-        blob_dst_offset += hdr_size;
-        total_size      += hdr_size;
-
-        // recursively write each array.
-        for (size_t i = 0; i < array.item_count; ++i)
-        {
-            size_t sub_size  = blob::optimize_array_field(
-                blob_dst,
-                blob_dst_offset,
-                array.item_data,
-                arr_ofs);
-            blob_dst_offset += sub_size;
-            total_size      += sub_size;
-            arr_ofs         += sub_size;
+    // the field offsets must match the order in which values are stored,
+    // so that each value is validated exactly once.
+    size_t    at         = base;
+    for (uint32_t i = 0; i < field_count; ++i)
+    {
+        if (blob::read_u32(data, offset_ofs + i * sizeof(uint32_t)) != at - base)
+        {
+            return false;
+        }
+        if (!valid_field(data, data_size, at, depth + 1, &at))
+        {
+            return false;
         }
-        return total_size;
     }
-
-    // this is an array of directly-copyable values.
-    size_t header_size = blob::write_field_array_info(
-        blob_dst,
-        blob_dst_offset,
-        array.item_type,
-        array.item_count);
-    blob_dst_offset   += header_size;
-    total_size        += header_size;
-
-    // now copy over the array data directly.
-    size_t values_size = blob::write_field_array_data(
-        blob_dst,
-        blob_dst_offset,
-        array.item_data,
-        array.array_size - header_size - type_size);
-    blob_dst_offset   += values_size;
-    total_size        += values_size;
-    return total_size;
+    *out_end = at;
+    return true;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::field_data_size(void *data, ptrdiff_t byte_offset)
+static bool valid_prototype(void *data, size_t data_size, size_t offset, size_t *out_end)
 {
-    int32_t  field_type = blob::read_s32(data, byte_offset);
-    size_t   field_size = blob::field_size_for_type(field_type);
-    size_t   type_size  = sizeof(int32_t);
-    if (field_size != BLOB_FIELD_SIZE_VARIABLE)
+    if (!in_bounds(data_size, offset, sizeof(uint32_t)))
     {
-        // this is a fixed-length field, no further computation necessary.
-        return field_size;
+        return false;
     }
-    else if (blob::FIELD_TYPE_ARRAY == field_type)
+    uint32_t field_count = blob::read_u32(data, offset);
+    size_t   names_ofs   = offset + sizeof(uint32_t);
+    if (field_count > (data_size - names_ofs) / (sizeof(uint32_t) + sizeof(int32_t)))
     {
-        // this is a variable-length array possibly containing variable-length
-        // data for individual entries. compute the total size. the array info
-        // is stored after the field_type, thus the sizeof(int32_t) offset.
-        return blob::array_total_size(data, byte_offset + type_size);
+        return false;
     }
-    else if (blob::FIELD_TYPE_GN_OBJECT == field_type)
+    *out_end = names_ofs + field_count * (sizeof(uint32_t) + sizeof(int32_t));
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool valid_array(void *data, size_t data_size, size_t offset, size_t depth, size_t *out_end)
+{
+    size_t header_size = sizeof(uint32_t) + sizeof(int32_t);
+    if (depth > MAX_VALIDATE_DEPTH || !in_bounds(data_size, offset, header_size))
     {
-        // this is a variable-length object possibly containing variable-length
-        // fields. compute the total size. the object info is stored after the
-        // field_type, and thus the sizeof(int32_t) offset.
-        return blob::generic_object_total_size(data, byte_offset + type_size);
+        return false;
     }
-    else if (blob::FIELD_TYPE_RT_OBJECT == field_type)
+    uint32_t item_count = blob::read_u32(data, offset);
+    int32_t  item_type  = blob::read_s32(data, offset + sizeof(uint32_t));
+    size_t   item_size  = blob::field_size_for_type(item_type);
+    size_t   at         = offset + header_size;
+    if (item_type <= blob::FIELD_TYPE_NONE || item_type > blob::FIELD_TYPE_MAX)
     {
-        // this is a variable-length object possibly containing variable-length
-        // fields. compute the total size. the object info is stored after the
-        // field_type, and thus the sizeof(int32_t) offset.
-        return blob::runtime_object_total_size(data, byte_offset + type_size);
+        return false;
     }
-    else if (blob::FIELD_TYPE_PROTOTYPE == field_type)
+    if (item_size != BLOB_FIELD_SIZE_VARIABLE)
     {
-        // this is a variable-length prototype object. compute the total size.
-        // the prototype info is stored after the field type, and thus the
-        // sizeof(int32_t) offset.
-        return blob::prototype_total_size(data, byte_offset + type_size);
+        // fixed-length items; check the size without overflowing.
+        if (item_size > 0 && item_count > (data_size - at) / item_size)
+        {
+            return false;
+        }
+        *out_end = at + item_count * item_size;
+        return true;
     }
-    else
+    // variable-length items are stored without a field type, and each
+    // takes up at least four bytes, so the loop terminates at the end of
+    // the data block for any item count.
+    for (uint32_t i = 0; i < item_count; ++i)
     {
-        // unknown field type or NULL data block.
-        return 0;
+        bool valid = false;
+        switch (item_type)
+        {
+            case blob::FIELD_TYPE_ARRAY:
+                valid = valid_array(data, data_size, at, depth + 1, &at);
+                break;
+            case blob::FIELD_TYPE_GN_OBJECT:
+                valid = valid_generic_object(data, data_size, at, depth + 1, &at);
+                break;
+            case blob::FIELD_TYPE_RT_OBJECT:
+                valid = valid_runtime_object(data, data_size, at, depth + 1, &at);
+                break;
+            case blob::FIELD_TYPE_PROTOTYPE:
+                valid = valid_prototype(data, data_size, at, &at);
+                break;
+            default:
+                break;
+        }
+        if (!valid) return false;
     }
+    *out_end = at;
+    return true;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::field_total_size(void *data, ptrdiff_t byte_offset)
+static bool valid_body(
+    void   *data,
+    size_t  data_size,
+    int32_t field_type,
+    size_t  offset,
+    size_t  depth,
+    size_t *out_end)
 {
-    return (blob::field_data_size(data, byte_offset) + sizeof(int32_t));
-}
-
-/*/////////////////////////////////////////////////////////////////////////80*/
-
-size_t blob::array_data_size(void *data, ptrdiff_t byte_offset)
+    size_t field_size = blob::field_size_for_type(field_type);
+    if (depth > MAX_VALIDATE_DEPTH)
+    {
+        return false;
+    }
+    if (field_type <= blob::FIELD_TYPE_NONE || field_type > blob::FIELD_TYPE_MAX)
+    {
+        return false;
+    }
+    if (field_size != BLOB_FIELD_SIZE_VARIABLE)
+    {
+        *out_end = offset + field_size;
+        return in_bounds(data_size, offset, field_size);
+    }
+    switch (field_type)
+    {
+        case blob::FIELD_TYPE_ARRAY:
+            return valid_array(data, data_size, offset, depth, out_end);
+        case blob::FIELD_TYPE_GN_OBJECT:
+            return valid_generic_object(data, data_size, offset, depth, out_end);
+        case blob::FIELD_TYPE_RT_OBJECT:
+            return valid_runtime_object(data, data_size, offset, depth, out_end);
+        case blob::FIELD_TYPE_PROTOTYPE:
+            return valid_prototype(data, data_size, offset, out_end);
+        default:
+            break;
+    }
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void swap_scalar(uint8_t *dst, uint8_t const *src, size_t count, size_t width)
+{
+    // dst and src may be the same buffer, since each element is loaded
+    // before it is stored.
+    switch (width)
+    {
+        case sizeof(uint16_t):
+            for (size_t i = 0; i < count; ++i, src += 2, dst += 2)
+            {
+                uint16_t v; memcpy(&v, src, 2); v = BLOB_SWAP_2(v); memcpy(dst, &v, 2);
+            }
+            break;
+        case sizeof(uint32_t):
+            for (size_t i = 0; i < count; ++i, src += 4, dst += 4)
+            {
+                uint32_t v; memcpy(&v, src, 4); v = BLOB_SWAP_4(v); memcpy(dst, &v, 4);
+            }
+            break;
+        case sizeof(uint64_t):
+            for (size_t i = 0; i < count; ++i, src += 8, dst += 8)
+            {
+                uint64_t v; memcpy(&v, src, 8); v = BLOB_SWAP_8(v); memcpy(dst, &v, 8);
+            }
+            break;
+        default:
+            if (dst != src) memcpy(dst, src, count * width);
+            break;
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+#if BLOB_USE_SIMD
+BLOB_TARGET_SSSE3
+static __m128i swap_mask_ssse3(size_t width)
+{
+    // the byte order within each element is reversed by pshufb.
+    switch (width)
+    {
+        case sizeof(uint16_t):
+            return _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+        case sizeof(uint32_t):
+            return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        default:
+            return _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+BLOB_TARGET_SSSE3
+static size_t swap_ssse3(uint8_t *dst, uint8_t const *src, size_t size, size_t width)
+{
+    // swaps 64 bytes per iteration, then 16, and returns the bytes done.
+    __m128i const mask = swap_mask_ssse3(width);
+    size_t        n    = 0;
+    for ( ; n + 64 <= size; n += 64)
+    {
+        __m128i a = _mm_loadu_si128((__m128i const*) (src + n));
+        __m128i b = _mm_loadu_si128((__m128i const*) (src + n + 16));
+        __m128i c = _mm_loadu_si128((__m128i const*) (src + n + 32));
+        __m128i d = _mm_loadu_si128((__m128i const*) (src + n + 48));
+        _mm_storeu_si128((__m128i*) (dst + n),      _mm_shuffle_epi8(a, mask));
+        _mm_storeu_si128((__m128i*) (dst + n + 16), _mm_shuffle_epi8(b, mask));
+        _mm_storeu_si128((__m128i*) (dst + n + 32), _mm_shuffle_epi8(c, mask));
+        _mm_storeu_si128((__m128i*) (dst + n + 48), _mm_shuffle_epi8(d, mask));
+    }
+    for ( ; n + 16 <= size; n += 16)
+    {
+        __m128i a = _mm_loadu_si128((__m128i const*) (src + n));
+        _mm_storeu_si128((__m128i*) (dst + n), _mm_shuffle_epi8(a, mask));
+    }
+    return n;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+BLOB_TARGET_AVX2
+static size_t swap_avx2(uint8_t *dst, uint8_t const *src, size_t size, size_t width)
+{
+    // vpshufb shuffles within each 128-bit lane, and elements never span
+    // lanes, so the SSSE3 mask is used for both lanes.
+    __m256i const mask = _mm256_broadcastsi128_si256(swap_mask_ssse3(width));
+    size_t        n    = 0;
+    for ( ; n + 128 <= size; n += 128)
+    {
+        __m256i a = _mm256_loadu_si256((__m256i const*) (src + n));
+        __m256i b = _mm256_loadu_si256((__m256i const*) (src + n + 32));
+        __m256i c = _mm256_loadu_si256((__m256i const*) (src + n + 64));
+        __m256i d = _mm256_loadu_si256((__m256i const*) (src + n + 96));
+        _mm256_storeu_si256((__m256i*) (dst + n),      _mm256_shuffle_epi8(a, mask));
+        _mm256_storeu_si256((__m256i*) (dst + n + 32), _mm256_shuffle_epi8(b, mask));
+        _mm256_storeu_si256((__m256i*) (dst + n + 64), _mm256_shuffle_epi8(c, mask));
+        _mm256_storeu_si256((__m256i*) (dst + n + 96), _mm256_shuffle_epi8(d, mask));
+    }
+    for ( ; n + 32 <= size; n += 32)
+    {
+        __m256i a = _mm256_loadu_si256((__m256i const*) (src + n));
+        _mm256_storeu_si256((__m256i*) (dst + n), _mm256_shuffle_epi8(a, mask));
+    }
+    return n;
+}
+#endif /* BLOB_USE_SIMD */
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void swap_elements(void *dst, void const *src, size_t count, size_t width)
+{
+    // swaps count elements of width bytes, using the widest instruction
+    // set available for the bulk of the data.
+    uint8_t       *d    = (uint8_t*) dst;
+    uint8_t const *s    = (uint8_t const*) src;
+    size_t         size = count * width;
+    size_t         done = 0;
+    if (width <= 1)
+    {
+        if (d != s) memcpy(d, s, size);
+        return;
+    }
+#if BLOB_USE_SIMD
+    int32_t        isa  = simd_isa();
+    if (isa >= blob::BASE64_ISA_AVX2)  done  = swap_avx2 (d, s, size, width);
+    if (isa >= blob::BASE64_ISA_SSSE3) done += swap_ssse3(d + done, s + done, size - done, width);
+#endif
+    swap_scalar(d + done, s + done, (size - done) / width, width);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static size_t swap_width_for_type(int32_t field_type)
+{
+    // returns the size of each scalar within a fixed-length value; vector
+    // and matrix types are swapped component-wise.
+    switch (field_type)
+    {
+        case blob::FIELD_TYPE_SINT16:
+        case blob::FIELD_TYPE_UINT16:
+            return sizeof(uint16_t);
+        case blob::FIELD_TYPE_SINT32:
+        case blob::FIELD_TYPE_UINT32:
+        case blob::FIELD_TYPE_FLOAT32:
+        case blob::FIELD_TYPE_VECTOR_2F:
+        case blob::FIELD_TYPE_VECTOR_3F:
+        case blob::FIELD_TYPE_VECTOR_4F:
+        case blob::FIELD_TYPE_MATRIX_2X2F:
+        case blob::FIELD_TYPE_MATRIX_3X3F:
+        case blob::FIELD_TYPE_MATRIX_3X4F:
+        case blob::FIELD_TYPE_MATRIX_4X4F:
+            return sizeof(uint32_t);
+        case blob::FIELD_TYPE_SINT64:
+        case blob::FIELD_TYPE_UINT64:
+        case blob::FIELD_TYPE_FLOAT64:
+            return sizeof(uint64_t);
+        default:
+            break;
+    }
+    return 1;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline uint32_t swap_u32_at(void *data, size_t offset)
+{
+    // swaps a 4-byte value in place and returns it in host byte order.
+    uint32_t value = blob::read_u32(data, offset);
+    value = BLOB_SWAP_4(value);
+    blob::write_u32(data, offset, value);
+    return value;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool normalize_body(
+    void   *data,
+    size_t  data_size,
+    int32_t field_type,
+    size_t  offset,
+    size_t  depth,
+    size_t *out_end);
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool normalize_field(void *data, size_t data_size, size_t offset, size_t depth, size_t *out_end)
+{
+    if (!in_bounds(data_size, offset, sizeof(int32_t)))
+    {
+        return false;
+    }
+    int32_t field_type = int32_t(swap_u32_at(data, offset));
+    return normalize_body(data, data_size, field_type, offset + sizeof(int32_t), depth, out_end);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool normalize_generic_object(void *data, size_t data_size, size_t offset, size_t depth, size_t *out_end)
+{
+    size_t header_size = sizeof(uint32_t) * 2;
+    size_t field_header_size = sizeof(uint32_t) * 2 + sizeof(int32_t);
+    if (!in_bounds(data_size, offset, header_size))
+    {
+        return false;
+    }
+    uint32_t field_count = swap_u32_at(data, offset);
+    uint32_t field_size  = swap_u32_at(data, offset + sizeof(uint32_t));
+    if (!in_bounds(data_size, offset, header_size + size_t(field_size)))
+    {
+        return false;
+    }
+    // unlike validation, the field data must be visited to be swapped.
+    size_t at  = offset + header_size;
+    size_t end = at + field_size;
+    for (uint32_t i = 0; i < field_count; ++i)
+    {
+        if (!in_bounds(end, at, field_header_size))
+        {
+            return false;
+        }
+        swap_u32_at(data, at);
+        int32_t  type = int32_t(swap_u32_at(data, at + sizeof(uint32_t)));
+        uint32_t size = swap_u32_at(data, at + sizeof(uint32_t) + sizeof(int32_t));
+        size_t   body = at + field_header_size;
+        size_t   last = 0;
+        if (!in_bounds(end, body, size))
+        {
+            return false;
+        }
+        if (!normalize_body(data, body + size, type, body, depth + 1, &last) || last != body + size)
+        {
+            return false;
+        }
+        at = body + size;
+    }
+    *out_end = end;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool normalize_runtime_object(void *data, size_t data_size, size_t offset, size_t depth, size_t *out_end)
+{
+    if (!in_bounds(data_size, offset, sizeof(uint32_t)))
+    {
+        return false;
+    }
+    uint32_t count_bits  = swap_u32_at(data, offset);
+    uint32_t field_count = count_bits & ~uint32_t(BLOB_RT_OBJECT_INDEXED);
+    size_t   names_ofs   = offset + sizeof(uint32_t);
+    if (field_count > (data_size - names_ofs) / (sizeof(uint32_t) * 2))
+    {
+        return false;
+    }
+    // the names and offsets are contiguous 4-byte arrays.
+    uint8_t *base_ptr = (uint8_t*) data;
+    size_t   base     = names_ofs + field_count * sizeof(uint32_t) * 2;
+    swap_elements(base_ptr + names_ofs, base_ptr + names_ofs, size_t(field_count) * 2, sizeof(uint32_t));
+    if (count_bits & BLOB_RT_OBJECT_INDEXED)
+    {
+        if (!in_bounds(data_size, base, sizeof(uint32_t)))
+        {
+            return false;
+        }
+        uint32_t index_size = swap_u32_at(data, base);
+        base += sizeof(uint32_t);
+        if (index_size > (data_size - base) / sizeof(uint32_t))
+        {
+            return false;
+        }
+        swap_elements(base_ptr + base, base_ptr + base, index_size, sizeof(uint32_t));
+        base += index_size * sizeof(uint32_t);
+    }
+    // values are stored in the order of the offsets array.
+    size_t at = base;
+    for (uint32_t i = 0; i < field_count; ++i)
+    {
+        if (!normalize_field(data, data_size, at, depth + 1, &at))
+        {
+            return false;
+        }
+    }
+    *out_end = at;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool normalize_prototype(void *data, size_t data_size, size_t offset, size_t *out_end)
+{
+    if (!in_bounds(data_size, offset, sizeof(uint32_t)))
+    {
+        return false;
+    }
+    uint32_t field_count = swap_u32_at(data, offset);
+    size_t   names_ofs   = offset + sizeof(uint32_t);
+    if (field_count > (data_size - names_ofs) / (sizeof(uint32_t) + sizeof(int32_t)))
+    {
+        return false;
+    }
+    uint8_t *names = ((uint8_t*) data) + names_ofs;
+    swap_elements(names, names, size_t(field_count) * 2, sizeof(uint32_t));
+    *out_end = names_ofs + field_count * (sizeof(uint32_t) + sizeof(int32_t));
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool normalize_array(void *data, size_t data_size, size_t offset, size_t depth, size_t *out_end)
+{
+    size_t header_size = sizeof(uint32_t) + sizeof(int32_t);
+    if (depth > MAX_VALIDATE_DEPTH || !in_bounds(data_size, offset, header_size))
+    {
+        return false;
+    }
+    uint32_t item_count = swap_u32_at(data, offset);
+    int32_t  item_type  = int32_t(swap_u32_at(data, offset + sizeof(uint32_t)));
+    size_t   item_size  = blob::field_size_for_type(item_type);
+    size_t   at         = offset + header_size;
+    if (item_type <= blob::FIELD_TYPE_NONE || item_type > blob::FIELD_TYPE_MAX)
+    {
+        return false;
+    }
+    if (item_size != BLOB_FIELD_SIZE_VARIABLE)
+    {
+        // fixed-length items are swapped in bulk; this is where nearly all
+        // of the time goes for vertex and animation data.
+        if (item_size > 0 && item_count > (data_size - at) / item_size)
+        {
+            return false;
+        }
+        size_t width = swap_width_for_type(item_type);
+        uint8_t *items = ((uint8_t*) data) + at;
+        swap_elements(items, items, (item_count * item_size) / width, width);
+        *out_end = at + item_count * item_size;
+        return true;
+    }
+    for (uint32_t i = 0; i < item_count; ++i)
+    {
+        bool valid = false;
+        switch (item_type)
+        {
+            case blob::FIELD_TYPE_ARRAY:
+                valid = normalize_array(data, data_size, at, depth + 1, &at);
+                break;
+            case blob::FIELD_TYPE_GN_OBJECT:
+                valid = normalize_generic_object(data, data_size, at, depth + 1, &at);
+                break;
+            case blob::FIELD_TYPE_RT_OBJECT:
+                valid = normalize_runtime_object(data, data_size, at, depth + 1, &at);
+                break;
+            case blob::FIELD_TYPE_PROTOTYPE:
+                valid = normalize_prototype(data, data_size, at, &at);
+                break;
+            default:
+                break;
+        }
+        if (!valid) return false;
+    }
+    *out_end = at;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool normalize_body(
+    void   *data,
+    size_t  data_size,
+    int32_t field_type,
+    size_t  offset,
+    size_t  depth,
+    size_t *out_end)
+{
+    size_t field_size = blob::field_size_for_type(field_type);
+    if (depth > MAX_VALIDATE_DEPTH)
+    {
+        return false;
+    }
+    if (field_type <= blob::FIELD_TYPE_NONE || field_type > blob::FIELD_TYPE_MAX)
+    {
+        return false;
+    }
+    if (field_size != BLOB_FIELD_SIZE_VARIABLE)
+    {
+        if (!in_bounds(data_size, offset, field_size))
+        {
+            return false;
+        }
+        size_t   width = swap_width_for_type(field_type);
+        uint8_t *value = ((uint8_t*) data) + offset;
+        swap_scalar(value, value, field_size / width, width);
+        *out_end = offset + field_size;
+        return true;
+    }
+    switch (field_type)
+    {
+        case blob::FIELD_TYPE_ARRAY:
+            return normalize_array(data, data_size, offset, depth, out_end);
+        case blob::FIELD_TYPE_GN_OBJECT:
+            return normalize_generic_object(data, data_size, offset, depth, out_end);
+        case blob::FIELD_TYPE_RT_OBJECT:
+            return normalize_runtime_object(data, data_size, offset, depth, out_end);
+        case blob::FIELD_TYPE_PROTOTYPE:
+            return normalize_prototype(data, data_size, offset, out_end);
+        default:
+            break;
+    }
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline uint32_t lz_read32(uint8_t const *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline uint32_t lz_hash(uint32_t v)
+{
+    return (v * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline size_t lz_match_length(uint8_t const *a, uint8_t const *b, uint8_t const *b_end)
+{
+    // returns the number of leading bytes that a and b have in common,
+    // where b < b_end and a < b. eight bytes are compared at a time.
+    uint8_t const *start = b;
+#if defined(__GNUC__) && BLOB_SYSTEM_ENDIANESS == BLOB_ENDIANESS_LSB_FIRST
+    while (b + sizeof(uint64_t) <= b_end)
+    {
+        uint64_t x, y;
+        memcpy(&x, a, sizeof(x));
+        memcpy(&y, b, sizeof(y));
+        if (x != y) return size_t(b - start) + (__builtin_ctzll(x ^ y) >> 3);
+        a += sizeof(uint64_t);
+        b += sizeof(uint64_t);
+    }
+#endif
+    while (b < b_end && *a == *b)
+    {
+        a++;
+        b++;
+    }
+    return size_t(b - start);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline uint8_t* lz_write_length(uint8_t *op, size_t length)
+{
+    // writes the part of a length that did not fit in the token nibble.
+    while (length >= 255)
+    {
+        *op++   = 255;
+        length -= 255;
+    }
+    *op++ = uint8_t(length);
+    return op;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static size_t lz_compress(uint8_t *dst, size_t dst_size, uint8_t const *src, size_t src_size)
+{
+    // encodes src as a sequence of (literals, match) pairs, each starting
+    // with a token holding 4-bit literal and match lengths, followed by the
+    // literals, a 2-byte distance and any length extension bytes. the last
+    // pair has no match. returns zero if the output does not fit in dst.
+    uint32_t       table[1 << LZ_HASH_BITS];
+    uint8_t const *ip     = src;
+    uint8_t const *anchor = src;
+    uint8_t const *iend   = src + src_size;
+    uint8_t const *mlimit = src + (src_size > LZ_MATCH_LIMIT ? src_size - LZ_MATCH_LIMIT : 0);
+    uint8_t const *mend   = src + (src_size > LZ_LAST_LITERALS ? src_size - LZ_LAST_LITERALS : 0);
+    uint8_t       *op     = dst;
+    uint8_t       *oend   = dst + dst_size;
+    size_t         misses = 0;
+
+    memset(table, 0, sizeof(table));
+    while (ip < mlimit)
+    {
+        uint32_t       v    = lz_read32(ip);
+        uint32_t       h    = lz_hash(v);
+        uint8_t const *ref  = src + table[h];
+        table[h] = uint32_t(ip - src);
+        if (ref >= ip || size_t(ip - ref) > LZ_MAX_DISTANCE || lz_read32(ref) != v)
+        {
+            // step faster through incompressible data.
+            ip += 1 + (misses++ >> 6);
+            continue;
+        }
+        size_t literals = size_t(ip - anchor);
+        size_t distance = size_t(ip - ref);
+        size_t length   = LZ_MIN_MATCH + lz_match_length(ref + LZ_MIN_MATCH, ip + LZ_MIN_MATCH, mend);
+        size_t match    = length - LZ_MIN_MATCH;
+        size_t need     = 1 + literals + literals / 255 + 1 + 2 + match / 255 + 1;
+        if (need > size_t(oend - op))
+        {
+            return 0;
+        }
+        uint8_t *token = op++;
+        *token = uint8_t(((literals < 15 ? literals : 15) << 4) | (match < 15 ? match : 15));
+        if (literals >= 15) op = lz_write_length(op, literals - 15);
+        memcpy(op, anchor, literals);
+        op   += literals;
+        *op++ = uint8_t(distance & 0xFF);
+        *op++ = uint8_t(distance >> 8);
+        if (match >= 15) op = lz_write_length(op, match - 15);
+        ip     += length;
+        anchor  = ip;
+        misses  = 0;
+        if (ip < mlimit)
+        {
+            // index a position within the match for the next search.
+            table[lz_hash(lz_read32(ip - 2))] = uint32_t(ip - 2 - src);
+        }
+    }
+    size_t literals = size_t(iend - anchor);
+    if (1 + literals + literals / 255 + 1 > size_t(oend - op))
+    {
+        return 0;
+    }
+    *op++ = uint8_t((literals < 15 ? literals : 15) << 4);
+    if (literals >= 15) op = lz_write_length(op, literals - 15);
+    memcpy(op, anchor, literals);
+    op += literals;
+    return size_t(op - dst);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool lz_read_length(uint8_t const **ipp, uint8_t const *iend, size_t *inout_length)
+{
+    uint8_t const *ip = *ipp;
+    size_t         b  = 255;
+    while (b == 255)
+    {
+        if (ip >= iend) return false;
+        b = *ip++;
+        *inout_length += b;
+    }
+    *ipp = ip;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool lz_decompress(uint8_t *dst, size_t dst_size, uint8_t const *src, size_t src_size)
+{
+    // every length and distance is checked, so corrupt input can never
+    // read or write out of bounds. the output must fill dst exactly.
+    uint8_t const *ip   = src;
+    uint8_t const *iend = src + src_size;
+    uint8_t       *op   = dst;
+    uint8_t       *oend = dst + dst_size;
+    while (ip < iend)
+    {
+        size_t token    = *ip++;
+        size_t literals = token >> 4;
+        if (literals == 15 && !lz_read_length(&ip, iend, &literals))
+        {
+            return false;
+        }
+        if (literals > size_t(iend - ip) || literals > size_t(oend - op))
+        {
+            return false;
+        }
+        memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+        if (ip == iend)
+        {
+            break;
+        }
+        if (iend - ip < 2)
+        {
+            return false;
+        }
+        size_t distance = size_t(ip[0]) | (size_t(ip[1]) << 8);
+        size_t length   = token & 15;
+        ip += 2;
+        if (length == 15 && !lz_read_length(&ip, iend, &length))
+        {
+            return false;
+        }
+        length += LZ_MIN_MATCH;
+        if (distance == 0 || distance > size_t(op - dst) || length > size_t(oend - op))
+        {
+            return false;
+        }
+        uint8_t const *ref = op - distance;
+        if (distance >= length)
+        {
+            memcpy(op, ref, length);
+            op += length;
+        }
+        else if (distance >= sizeof(uint64_t))
+        {
+            // overlapping, but each eight-byte block is disjoint.
+            uint8_t *end = op + length;
+            while (op + sizeof(uint64_t) <= end)
+            {
+                memcpy(op, ref, sizeof(uint64_t));
+                op  += sizeof(uint64_t);
+                ref += sizeof(uint64_t);
+            }
+            while (op < end) *op++ = *ref++;
+        }
+        else
+        {
+            // a short repeating pattern.
+            uint8_t *end = op + length;
+            while (op < end) *op++ = *ref++;
+        }
+    }
+    return (op == oend);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool container_chunk(
+    void const *container,
+    size_t      container_size,
+    size_t      chunk_index,
+    size_t     *out_offset,
+    size_t     *out_stored,
+    size_t     *out_length)
+{
+    // reads and checks the header and a single chunk index entry.
+    void    *data = (void*) container;
+    if (container_size < CONTAINER_HEADER_SIZE)
+    {
+        return false;
+    }
+    uint32_t magic       = blob::read_u32(data, 0);
+    uint32_t chunk_size  = blob::read_u32(data, 4);
+    uint32_t chunk_count = blob::read_u32(data, 8);
+    uint32_t blob_size   = blob::read_u32(data, 12);
+    if (magic != BLOB_COMPRESSED_MAGIC || 0 == chunk_size)
+    {
+        return false;
+    }
+    if (chunk_count != (size_t(blob_size) + chunk_size - 1) / chunk_size || chunk_index >= chunk_count)
+    {
+        return false;
+    }
+    size_t entry = CONTAINER_HEADER_SIZE + chunk_index * CONTAINER_ENTRY_SIZE;
+    size_t data_start = CONTAINER_HEADER_SIZE + size_t(chunk_count) * CONTAINER_ENTRY_SIZE;
+    if (data_start > container_size)
+    {
+        return false;
+    }
+    size_t offset = blob::read_u32(data, entry);
+    size_t stored = blob::read_u32(data, entry + sizeof(uint32_t));
+    size_t length = blob_size - chunk_index * chunk_size;
+    if (length > chunk_size) length = chunk_size;
+    if (offset < data_start || !in_bounds(container_size, offset, stored) || stored > length)
+    {
+        return false;
+    }
+    *out_offset = offset;
+    *out_stored = stored;
+    *out_length = length;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline int32_t atomic_add(int32_t volatile *value, int32_t amount)
+{
+    // returns the value prior to the addition; acts as a full barrier.
+#if   defined(__GNUC__)
+    return __sync_fetch_and_add(value, amount);
+#elif defined(_MSC_VER)
+    return _InterlockedExchangeAdd((long volatile*) value, amount);
+#else
+    #error No atomic add implementation for your compiler!
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static size_t processor_count(void)
+{
+#if   CMN_IS_APPLE || CMN_IS_LINUX
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? size_t(count) : 1;
+#elif CMN_IS_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ? size_t(info.dwNumberOfProcessors) : 1;
+#else
+    return 1;
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+enum diff_sequence_e
+{
+    DIFF_FIELDS  = 0,  /// fields prefixed with a type, as at the top level
+    DIFF_ITEMS   = 1,  /// the items of an array of variable-length type
+    DIFF_MEMBERS = 2   /// the named fields of a generic object
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct diff_state_t
+{
+    uint8_t const    *old_data;    /// the blob being diffed from
+    uint8_t const    *new_data;    /// the blob being diffed to
+    size_t            old_size;    /// the size of old_data, in bytes
+    size_t            new_size;    /// the size of new_data, in bytes
+    uint8_t          *patch;       /// the output patch, or NULL when sizing
+    size_t            patch_max;   /// the number of bytes available at patch
+    size_t            patch_size;  /// the number of bytes emitted so far
+    uint32_t          op_kind;     /// one of PATCH_OP_COPY, _DATA or _NONE
+    size_t            op_source;   /// old offset of a copy, new offset of data
+    size_t            op_length;   /// the number of bytes in the pending op
+    size_t           *extents;     /// stack of item boundaries being compared
+    size_t            extent_count;/// the number of entries used in extents
+    size_t            extent_max;  /// the number of entries allocated
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static uint32_t patch_checksum(void const *data, size_t size)
+{
+    // FNV-1a over 32-bit words, so that a patch is not applied to some
+    // other blob of the same size.
+    uint8_t const *p    = (uint8_t const*) data;
+    uint32_t       hash = 0x811C9DC5U;
+    size_t         i    = 0;
+    for ( ; i + sizeof(uint32_t) <= size; i += sizeof(uint32_t))
+    {
+        uint32_t word;
+        memcpy(&word, p + i, sizeof(uint32_t));
+        hash = (hash ^ word) * 0x01000193U;
+    }
+    for ( ; i < size; ++i)
+    {
+        hash = (hash ^ p[i]) * 0x01000193U;
+    }
+    return hash;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline uint32_t patch_u32(void const *patch, size_t offset)
+{
+    // literal data leaves op tags at arbitrary alignment.
+    uint32_t value;
+    memcpy(&value, ((uint8_t const*) patch) + offset, sizeof(uint32_t));
+    return value;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void diff_emit(diff_state_t *d, void const *src, size_t amount)
+{
+    // when sizing, or once the output is full, only the size is tracked.
+    if (d->patch != NULL && in_bounds(d->patch_max, d->patch_size, amount))
+    {
+        memcpy(d->patch + d->patch_size, src, amount);
+    }
+    d->patch_size += amount;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void diff_flush(diff_state_t *d)
+{
+    uint32_t tag = d->op_kind | uint32_t(d->op_length);
+    if (PATCH_OP_NONE == d->op_kind)
+    {
+        return;
+    }
+    diff_emit(d, &tag, sizeof(uint32_t));
+    if (PATCH_OP_COPY == d->op_kind)
+    {
+        uint32_t offset = uint32_t(d->op_source);
+        diff_emit(d, &offset, sizeof(uint32_t));
+    }
+    else diff_emit(d, d->new_data + d->op_source, d->op_length);
+    d->op_kind = PATCH_OP_NONE;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void diff_data(diff_state_t *d, size_t new_offset, size_t length)
+{
+    // ops are produced in new blob order, so literal runs are contiguous.
+    while (length > 0)
+    {
+        if (PATCH_OP_DATA != d->op_kind || PATCH_MAX_RUN == d->op_length)
+        {
+            diff_flush(d);
+            d->op_kind   = PATCH_OP_DATA;
+            d->op_source = new_offset;
+            d->op_length = 0;
+        }
+        size_t room  = PATCH_MAX_RUN - d->op_length;
+        size_t run   = length < room ? length : room;
+        d->op_length+= run;
+        new_offset  += run;
+        length      -= run;
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void diff_copy(diff_state_t *d, size_t old_offset, size_t new_offset, size_t length)
+{
+    if (length < PATCH_MIN_COPY && PATCH_OP_DATA == d->op_kind)
+    {
+        diff_data(d, new_offset, length);
+        return;
+    }
+    while (length > 0)
+    {
+        if (PATCH_OP_COPY != d->op_kind || PATCH_MAX_RUN == d->op_length ||
+            d->op_source + d->op_length != old_offset)
+        {
+            diff_flush(d);
+            d->op_kind   = PATCH_OP_COPY;
+            d->op_source = old_offset;
+            d->op_length = 0;
+        }
+        size_t room  = PATCH_MAX_RUN - d->op_length;
+        size_t run   = length < room ? length : room;
+        d->op_length+= run;
+        old_offset  += run;
+        length      -= run;
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline bool diff_same(diff_state_t *d, size_t old_at, size_t old_end, size_t new_at, size_t new_end)
+{
+    return (old_end - old_at == new_end - new_at &&
+            memcmp(d->old_data + old_at, d->new_data + new_at, old_end - old_at) == 0);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void diff_bytes(diff_state_t *d, size_t old_at, size_t old_end, size_t new_at, size_t new_end)
+{
+    if (diff_same(d, old_at, old_end, new_at, new_end))
+    {
+        diff_copy(d, old_at, new_at, old_end - old_at);
+    }
+    else diff_data(d, new_at, new_end - new_at);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool diff_extents(
+    diff_state_t  *d,
+    uint8_t const *data,
+    size_t         data_size,
+    int32_t        kind,
+    int32_t        item_type,
+    size_t         at,
+    size_t         end,
+    size_t         count,
+    size_t         depth,
+    size_t        *out_count)
+{
+    // pushes the start of each item, followed by the end of the last item.
+    size_t n = 0;
+    for ( ; ; ++n)
+    {
+        if (d->extent_count == d->extent_max)
+        {
+            size_t  new_max = d->extent_max ? d->extent_max * 2 : 256;
+            size_t *new_ext = (size_t*) ::realloc(d->extents, new_max * sizeof(size_t));
+            if (NULL == new_ext) return false;
+            d->extents    = new_ext;
+            d->extent_max = new_max;
+        }
+        d->extents[d->extent_count++] = at;
+        if (n == count || at >= end) break;
+
+        bool valid = false;
+        switch (kind)
+        {
+            case DIFF_FIELDS:
+                valid = valid_field((void*) data, data_size, at, depth, &at);
+                break;
+            case DIFF_ITEMS:
+                valid = valid_body((void*) data, data_size, item_type, at, depth, &at);
+                break;
+            case DIFF_MEMBERS:
+                valid = in_bounds(end, at, sizeof(uint32_t) * 3);
+                if (valid)
+                {
+                    size_t size = blob::read_u32((void*) data, at + sizeof(uint32_t) * 2);
+                    valid = in_bounds(end, at + sizeof(uint32_t) * 3, size);
+                    at   += sizeof(uint32_t) * 3 + size;
+                }
+                break;
+        }
+        if (!valid) return false;
+    }
+    *out_count = n;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool diff_item(
+    diff_state_t *d,
+    int32_t       kind,
+    int32_t       item_type,
+    size_t        old_at,
+    size_t        old_end,
+    size_t        new_at,
+    size_t        new_end,
+    size_t        depth);
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool diff_sequence(
+    diff_state_t *d,
+    int32_t       kind,
+    int32_t       item_type,
+    size_t        old_at,
+    size_t        old_end,
+    size_t        old_count,
+    size_t        new_at,
+    size_t        new_end,
+    size_t        new_count,
+    size_t        depth)
+{
+    // unchanged items at either end are copied, items in between are
+    // paired up and compared, and any extra new items are inserted. extra
+    // old items are removed simply by never being copied.
+    size_t mark     = d->extent_count;
+    size_t old_base = mark;
+    size_t new_base = 0;
+    size_t on = 0, nn = 0;
+    bool   ok = true;
+    if (!diff_extents(d, d->old_data, d->old_size, kind, item_type, old_at, old_end, old_count, depth, &on))
+    {
+        d->extent_count = mark;
+        return false;
+    }
+    new_base = d->extent_count;
+    if (!diff_extents(d, d->new_data, d->new_size, kind, item_type, new_at, new_end, new_count, depth, &nn))
+    {
+        d->extent_count = mark;
+        return false;
+    }
+    size_t const *oe = d->extents + old_base;
+    size_t const *ne = d->extents + new_base;
+    size_t n    = on < nn ? on : nn;
+    size_t head = 0;
+    size_t tail = 0;
+    while (head < n && diff_same(d, oe[head], oe[head + 1], ne[head], ne[head + 1]))
+    {
+        head++;
+    }
+    while (tail < n - head && diff_same(d, oe[on - tail - 1], oe[on - tail], ne[nn - tail - 1], ne[nn - tail]))
+    {
+        tail++;
+    }
+    size_t pairs = n - head - tail;
+    size_t o_mid = oe[on - tail], o_end = oe[on];
+    size_t n_mid = ne[nn - tail], n_end = ne[nn];
+    diff_copy(d, oe[0], ne[0], oe[head] - oe[0]);
+    for (size_t i = head; ok && i < head + pairs; ++i)
+    {
+        // nested sequences push onto extents, which may move it.
+        oe = d->extents + old_base;
+        ne = d->extents + new_base;
+        ok = diff_item(d, kind, item_type, oe[i], oe[i + 1], ne[i], ne[i + 1], depth);
+    }
+    if (ok)
+    {
+        ne = d->extents + new_base;
+        diff_data(d, ne[head + pairs], n_mid - ne[head + pairs]);
+        diff_copy(d, o_mid, n_mid, o_end - o_mid);
+        // any bytes after the last item, such as unused generic object space.
+        diff_bytes(d, o_end, old_end, n_end, new_end);
+    }
+    d->extent_count = mark;
+    return ok;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void diff_fixed(
+    diff_state_t *d,
+    size_t        old_at,
+    size_t        old_count,
+    size_t        new_at,
+    size_t        new_count,
+    size_t        item_size)
+{
+    // as for diff_sequence, but the items are compared one by one without
+    // recursion; short unchanged runs are folded into the literal data.
+    size_t n    = old_count < new_count ? old_count : new_count;
+    size_t head = 0;
+    size_t tail = 0;
+    if (0 == item_size)
+    {
+        return;
+    }
+    while (head < n && memcmp(d->old_data + old_at + head * item_size, d->new_data + new_at + head * item_size, item_size) == 0)
+    {
+        head++;
+    }
+    while (tail < n - head && memcmp(d->old_data + old_at + (old_count - tail - 1) * item_size, d->new_data + new_at + (new_count - tail - 1) * item_size, item_size) == 0)
+    {
+        tail++;
+    }
+    diff_copy(d, old_at, new_at, head * item_size);
+    for (size_t i = head; i < n - tail; ++i)
+    {
+        size_t o = old_at + i * item_size;
+        size_t p = new_at + i * item_size;
+        diff_bytes(d, o, o + item_size, p, p + item_size);
+    }
+    diff_data(d, new_at + (n - tail) * item_size, (new_count - n) * item_size);
+    diff_copy(d, old_at + (old_count - tail) * item_size, new_at + (new_count - tail) * item_size, tail * item_size);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool diff_body(
+    diff_state_t *d,
+    int32_t       field_type,
+    size_t        old_at,
+    size_t        old_end,
+    size_t        new_at,
+    size_t        new_end,
+    size_t        depth)
+{
+    void  *od = (void*) d->old_data;
+    void  *nd = (void*) d->new_data;
+    size_t header_size = sizeof(uint32_t) * 2;
+    if (depth > MAX_VALIDATE_DEPTH)
+    {
+        return false;
+    }
+    switch (field_type)
+    {
+        case blob::FIELD_TYPE_ARRAY:
+            {
+                int32_t item_type = blob::read_s32(od, old_at + sizeof(uint32_t));
+                size_t  old_count = blob::read_u32(od, old_at);
+                size_t  new_count = blob::read_u32(nd, new_at);
+                size_t  item_size = blob::field_size_for_type(item_type);
+                if (blob::read_s32(nd, new_at + sizeof(uint32_t)) != item_type)
+                {
+                    break;
+                }
+                diff_bytes(d, old_at, old_at + header_size, new_at, new_at + header_size);
+                if (item_size != BLOB_FIELD_SIZE_VARIABLE)
+                {
+                    diff_fixed(d, old_at + header_size, old_count, new_at + header_size, new_count, item_size);
+                    return true;
+                }
+                return diff_sequence(d, DIFF_ITEMS, item_type,
+                    old_at + header_size, old_end, old_count,
+                    new_at + header_size, new_end, new_count, depth + 1);
+            }
+        case blob::FIELD_TYPE_GN_OBJECT:
+            {
+                size_t old_count = blob::read_u32(od, old_at);
+                size_t new_count = blob::read_u32(nd, new_at);
+                diff_bytes(d, old_at, old_at + header_size, new_at, new_at + header_size);
+                return diff_sequence(d, DIFF_MEMBERS, blob::FIELD_TYPE_NONE,
+                    old_at + header_size, old_end, old_count,
+                    new_at + header_size, new_end, new_count, depth + 1);
+            }
+        case blob::FIELD_TYPE_RT_OBJECT:
+            {
+                // the names, offsets and index are sent as a unit; they are
+                // unchanged unless fields are added, removed or resized.
+                uint32_t old_count = 0, new_count = 0, index_size = 0;
+                size_t   old_header = runtime_object_header(od, old_at, &old_count, &index_size);
+                size_t   new_header = runtime_object_header(nd, new_at, &new_count, &index_size);
+                diff_bytes(d, old_at, old_at + old_header, new_at, new_at + new_header);
+                return diff_sequence(d, DIFF_FIELDS, blob::FIELD_TYPE_NONE,
+                    old_at + old_header, old_end, old_count,
+                    new_at + new_header, new_end, new_count, depth + 1);
+            }
+        default:
+            break;
+    }
+    diff_data(d, new_at, new_end - new_at);
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool diff_item(
+    diff_state_t *d,
+    int32_t       kind,
+    int32_t       item_type,
+    size_t        old_at,
+    size_t        old_end,
+    size_t        new_at,
+    size_t        new_end,
+    size_t        depth)
+{
+    // the field type, and for generic object fields the name, must match
+    // for the item to be compared structurally.
+    size_t prefix = 0;
+    if (diff_same(d, old_at, old_end, new_at, new_end))
+    {
+        diff_copy(d, old_at, new_at, old_end - old_at);
+        return true;
+    }
+    switch (kind)
+    {
+        case DIFF_FIELDS:
+            item_type = blob::read_s32((void*) d->new_data, new_at);
+            prefix    = sizeof(int32_t);
+            break;
+        case DIFF_MEMBERS:
+            item_type = blob::read_s32((void*) d->new_data, new_at + sizeof(uint32_t));
+            prefix    = sizeof(uint32_t) * 2;
+            break;
+        default:
+            break;
+    }
+    if (prefix > 0 && !diff_same(d, old_at, old_at + prefix, new_at, new_at + prefix))
+    {
+        diff_data(d, new_at, new_end - new_at);
+        return true;
+    }
+    diff_copy(d, old_at, new_at, prefix);
+    if (DIFF_MEMBERS == kind)
+    {
+        // the data size of a generic object field.
+        diff_bytes(d, old_at + prefix, old_at + prefix + sizeof(uint32_t), new_at + prefix, new_at + prefix + sizeof(uint32_t));
+        prefix += sizeof(uint32_t);
+    }
+    return diff_body(d, item_type, old_at + prefix, old_end, new_at + prefix, new_end, depth + 1);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static size_t diff_blobs(
+    void       *dst,
+    size_t      dst_size,
+    void const *old_blob,
+    size_t      old_size,
+    void const *new_blob,
+    size_t      new_size)
+{
+    diff_state_t d;
+    size_t       end = 0;
+    if (old_size > BLOB_FIELD_OFFSET_INVALID || new_size > BLOB_FIELD_OFFSET_INVALID)
+    {
+        return 0;
+    }
+    // both blobs are validated up front, so the structural walk below can
+    // read sizes and counts without further checks.
+    for (size_t at = 0; at < old_size; at = end)
+    {
+        if (!valid_field((void*) old_blob, old_size, at, 0, &end)) return 0;
+    }
+    for (size_t at = 0; at < new_size; at = end)
+    {
+        if (!valid_field((void*) new_blob, new_size, at, 0, &end)) return 0;
+    }
+    memset(&d, 0, sizeof(diff_state_t));
+    d.old_data  = (uint8_t const*) old_blob;
+    d.new_data  = (uint8_t const*) new_blob;
+    d.old_size  = old_size;
+    d.new_size  = new_size;
+    d.patch     = (uint8_t*) dst;
+    d.patch_max = dst_size;
+    d.op_kind   = PATCH_OP_NONE;
+
+    uint32_t header[4] =
+    {
+        uint32_t(BLOB_PATCH_MAGIC),
+        uint32_t(old_size),
+        uint32_t(new_size),
+        patch_checksum(old_blob, old_size)
+    };
+    diff_emit(&d, header, PATCH_HEADER_SIZE);
+    bool ok = diff_sequence(&d, DIFF_FIELDS, blob::FIELD_TYPE_NONE, 0, old_size, ~size_t(0), 0, new_size, ~size_t(0), 0);
+    diff_flush(&d);
+    ::free(d.extents);
+    if (!ok || (dst != NULL && d.patch_size > dst_size))
+    {
+        return 0;
+    }
+    return d.patch_size;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct optimize_field_t
+{
+    size_t            src_offset;  /// byte offset of the field in the source
+    size_t            src_size;    /// total size of the source field
+    size_t            dst_offset;  /// byte offset of the field in the output
+    size_t            dst_size;    /// total size of the optimized field
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct optimize_job_t
+{
+    uint8_t          *dst;         /// the output blob, or NULL when sizing
+    void             *src;         /// the source blob
+    optimize_field_t *fields;      /// the top-level fields to process
+    size_t            field_count; /// the number of items in fields
+    int32_t           flags;       /// a combination of optimize_flags_e
+    int32_t volatile  next_batch;  /// the next unclaimed batch of fields
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+typedef void (*worker_func_t)(void *job);
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct worker_t
+{
+    worker_func_t     run;         /// the function run by each thread
+    void             *job;         /// the job shared by all threads
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+#if   CMN_IS_APPLE || CMN_IS_LINUX
+static void* worker_thread_main(void *argp)
+{
+    worker_t *worker = (worker_t*) argp;
+    worker->run(worker->job);
+    return NULL;
+}
+#elif CMN_IS_WINDOWS
+static DWORD WINAPI worker_thread_main(LPVOID argp)
+{
+    worker_t *worker = (worker_t*) argp;
+    worker->run(worker->job);
+    return 0;
+}
+#endif
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void run_workers(worker_func_t run, void *job, size_t thread_count)
+{
+    // the calling thread participates, so only thread_count - 1 threads
+    // are started. the job must divide its work among however many threads
+    // call run, since a thread that cannot be started leaves its share of
+    // the work to the others.
+    worker_t worker = { run, job };
+    size_t   started = 0;
+    if (thread_count > MAX_WORKER_THREADS) thread_count = MAX_WORKER_THREADS;
+#if   CMN_IS_APPLE || CMN_IS_LINUX
+    pthread_t threads[MAX_WORKER_THREADS];
+    for (size_t i = 1; i < thread_count; ++i)
+    {
+        if (pthread_create(&threads[started], NULL, worker_thread_main, &worker) == 0)
+        {
+            started++;
+        }
+    }
+    run(job);
+    for (size_t i = 0; i < started; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+#elif CMN_IS_WINDOWS
+    HANDLE threads[MAX_WORKER_THREADS];
+    for (size_t i = 1; i < thread_count; ++i)
+    {
+        HANDLE thread = CreateThread(NULL, 0, worker_thread_main, &worker, 0, NULL);
+        if (thread != NULL) threads[started++] = thread;
+    }
+    run(job);
+    for (size_t i = 0; i < started; ++i)
+    {
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+    }
+#else
+    CMN_UNUSED(worker);
+    CMN_UNUSED(started);
+    run(job);
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void run_optimize_job(void *argp)
+{
+    // claim batches of fields until none remain. top-level fields never
+    // share output bytes, so no further synchronization is required.
+    optimize_job_t *job = (optimize_job_t*) argp;
+    for ( ; ; )
+    {
+        size_t batch = size_t(atomic_add(&job->next_batch, 1));
+        size_t first = batch * OPTIMIZE_BATCH_SIZE;
+        size_t last  = first + OPTIMIZE_BATCH_SIZE;
+        if (first >= job->field_count) break;
+        if (last  >  job->field_count) last = job->field_count;
+        for (size_t i = first; i < last; ++i)
+        {
+            optimize_field_t *f = &job->fields[i];
+            size_t size = optimize_field(
+                job->dst, f->dst_offset,
+                job->src, f->src_offset, f->src_size, job->flags);
+            if (NULL == job->dst) f->dst_size = size;
+        }
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void run_optimize_threads(optimize_job_t *job, size_t thread_count)
+{
+    size_t batch_count = (job->field_count + OPTIMIZE_BATCH_SIZE - 1) / OPTIMIZE_BATCH_SIZE;
+    if (thread_count > batch_count) thread_count = batch_count;
+    job->next_batch = 0;
+    run_workers(run_optimize_job, job, thread_count);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct decompress_job_t
+{
+    uint8_t          *dst;            /// the output blob
+    size_t            dst_size;       /// the size of the output buffer
+    void const       *container;      /// the compressed container
+    size_t            container_size; /// the size of the container
+    size_t            chunk_size;     /// the uncompressed size of each chunk
+    size_t            chunk_count;    /// the number of chunks
+    int32_t volatile  next_chunk;     /// the next unclaimed chunk
+    int32_t volatile  failed;         /// non-zero if any chunk is corrupt
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void run_decompress_job(void *argp)
+{
+    // chunks are large enough that they are claimed one at a time.
+    decompress_job_t *job = (decompress_job_t*) argp;
+    for ( ; ; )
+    {
+        size_t chunk = size_t(atomic_add(&job->next_chunk, 1));
+        if (chunk >= job->chunk_count) break;
+        size_t   at  = chunk * job->chunk_size;
+        if (!blob::decompress_chunk(job->dst + at, job->dst_size - at, job->container, job->container_size, chunk))
+        {
+            atomic_add(&job->failed, 1);
+        }
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct stream_buffer_t
+{
+    uint8_t          *data;        /// the buffer contents
+    size_t            size;        /// the number of bytes used
+    size_t            capacity;    /// the number of bytes allocated
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool reserve_buffer(stream_buffer_t *buffer, size_t amount)
+{
+    // ensures room for amount more bytes, growing geometrically.
+    if (amount <= buffer->capacity - buffer->size)
+    {
+        return true;
+    }
+    if (amount > std::numeric_limits<size_t>::max() - buffer->size)
+    {
+        return false;
+    }
+    size_t   need = buffer->size + amount;
+    size_t   cap  = buffer->capacity ? buffer->capacity : 4096;
+    while (cap < need && cap <= std::numeric_limits<size_t>::max() / 2) cap *= 2;
+    if (cap < need) cap = need;
+    uint8_t *data = (uint8_t*) ::realloc(buffer->data, cap);
+    if (NULL == data)
+    {
+        return false;
+    }
+    buffer->data     = data;
+    buffer->capacity = cap;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool read_exact(disk::file_t file, stream_buffer_t *buffer, size_t amount)
+{
+    bool eof = false;
+    if (!reserve_buffer(buffer, amount))
+    {
+        return false;
+    }
+    size_t n = disk::read_file(file, buffer->data, buffer->size, amount, &eof);
+    buffer->size += n;
+    return (n == amount);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool read_body(disk::file_t file, stream_buffer_t *buffer, int32_t field_type, size_t depth)
+{
+    // reads the data of a field of the given type, parsing just enough of
+    // it to determine its size. offsets are used rather than pointers,
+    // because each read may move the buffer.
+    size_t field_size = blob::field_size_for_type(field_type);
+    size_t start      = buffer->size;
+    if (depth > MAX_VALIDATE_DEPTH)
+    {
+        return false;
+    }
+    if (field_type <= blob::FIELD_TYPE_NONE || field_type > blob::FIELD_TYPE_MAX)
+    {
+        return false;
+    }
+    if (field_size != BLOB_FIELD_SIZE_VARIABLE)
+    {
+        return read_exact(file, buffer, field_size);
+    }
+    switch (field_type)
+    {
+        case blob::FIELD_TYPE_GN_OBJECT:
+            {
+                if (!read_exact(file, buffer, sizeof(uint32_t) * 2)) return false;
+                uint32_t data_size = blob::read_u32(buffer->data, start + sizeof(uint32_t));
+                return read_exact(file, buffer, data_size);
+            }
+
+        case blob::FIELD_TYPE_PROTOTYPE:
+            {
+                if (!read_exact(file, buffer, sizeof(uint32_t))) return false;
+                uint32_t field_count = blob::read_u32(buffer->data, start);
+                return read_exact(file, buffer, size_t(field_count) * (sizeof(uint32_t) + sizeof(int32_t)));
+            }
+
+        case blob::FIELD_TYPE_RT_OBJECT:
+            {
+                if (!read_exact(file, buffer, sizeof(uint32_t))) return false;
+                uint32_t count_bits  = blob::read_u32(buffer->data, start);
+                uint32_t field_count = count_bits & ~uint32_t(BLOB_RT_OBJECT_INDEXED);
+                if (!read_exact(file, buffer, size_t(field_count) * sizeof(uint32_t) * 2)) return false;
+                if (count_bits & BLOB_RT_OBJECT_INDEXED)
+                {
+                    size_t index_ofs = buffer->size;
+                    if (!read_exact(file, buffer, sizeof(uint32_t))) return false;
+                    uint32_t index_size = blob::read_u32(buffer->data, index_ofs);
+                    if (!read_exact(file, buffer, size_t(index_size) * sizeof(uint32_t))) return false;
+                }
+                for (uint32_t i = 0; i < field_count; ++i)
+                {
+                    size_t type_ofs = buffer->size;
+                    if (!read_exact(file, buffer, sizeof(int32_t))) return false;
+                    int32_t type = blob::read_s32(buffer->data, type_ofs);
+                    if (!read_body(file, buffer, type, depth + 1)) return false;
+                }
+                return true;
+            }
+
+        case blob::FIELD_TYPE_ARRAY:
+            {
+                if (!read_exact(file, buffer, sizeof(uint32_t) + sizeof(int32_t))) return false;
+                uint32_t item_count = blob::read_u32(buffer->data, start);
+                int32_t  item_type  = blob::read_s32(buffer->data, start + sizeof(uint32_t));
+                size_t   item_size  = blob::field_size_for_type(item_type);
+                if (item_type <= blob::FIELD_TYPE_NONE || item_type > blob::FIELD_TYPE_MAX)
+                {
+                    return false;
+                }
+                if (item_size != BLOB_FIELD_SIZE_VARIABLE)
+                {
+                    if (item_size > 0 && item_count > std::numeric_limits<size_t>::max() / item_size)
+                    {
+                        return false;
+                    }
+                    return read_exact(file, buffer, item_count * item_size);
+                }
+                for (uint32_t i = 0; i < item_count; ++i)
+                {
+                    if (!read_body(file, buffer, item_type, depth + 1)) return false;
+                }
+                return true;
+            }
+
+        default:
+            break;
+    }
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void* builder_allocate(memory::allocator_t *allocator, size_t size)
+{
+    if (allocator != NULL) return allocator->allocate(size, BUILDER_ALIGNMENT);
+    else return ::malloc(size);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void builder_release(memory::allocator_t *allocator, void *data)
+{
+    if (data == NULL) return;
+    if (allocator != NULL) allocator->deallocate(data);
+    else ::free(data);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool builder_fail(blob::builder_t *builder)
+{
+    builder->error = true;
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool builder_reserve(blob::builder_t *builder, size_t amount)
+{
+    // ensures room for amount more bytes. blob offsets are 32-bit, so the
+    // blob may not exceed 4GB.
+    size_t const max_size = BLOB_FIELD_OFFSET_INVALID;
+    if (amount <= builder->capacity - builder->size)
+    {
+        return true;
+    }
+    if (amount > max_size - builder->size)
+    {
+        return builder_fail(builder);
+    }
+    size_t   need = builder->size + amount;
+    size_t   cap  = builder->capacity ? builder->capacity : 4096;
+    while (cap < need && cap <= max_size / 2) cap *= 2;
+    if (cap < need) cap = need;
+    uint8_t *data = (uint8_t*) builder_allocate(builder->allocator, cap);
+    if (NULL == data)
+    {
+        return builder_fail(builder);
+    }
+    if (builder->size > 0)
+    {
+        memcpy(data, builder->data, builder->size);
+    }
+    builder_release(builder->allocator, builder->data);
+    builder->data     = data;
+    builder->capacity = cap;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool builder_begin_field(
+    blob::builder_t *builder,
+    uint32_t         field_name,
+    int32_t          field_type,
+    size_t           body_size,
+    size_t          *out_size_offset)
+{
+    // writes whatever precedes the field data in the current container and
+    // reserves room for body_size bytes of data. the size of a field within
+    // a generic object is written by builder_end_field().
+    *out_size_offset = BUILDER_NO_SIZE;
+    if (builder->error)
+    {
+        return false;
+    }
+    if (0 == builder->depth)
+    {
+        if (!builder_reserve(builder, sizeof(int32_t) + body_size)) return false;
+        blob::write_s32(builder->data, builder->size, field_type);
+        builder->size += sizeof(int32_t);
+        return true;
+    }
+    blob::builder_frame_t *parent = &builder->stack[builder->depth - 1];
+    if (blob::FIELD_TYPE_GN_OBJECT == parent->field_type)
+    {
+        size_t header_size = sizeof(uint32_t) * 2 + sizeof(int32_t);
+        if (!builder_reserve(builder, header_size + body_size)) return false;
+        blob::write_u32(builder->data, builder->size, field_name);
+        blob::write_s32(builder->data, builder->size + sizeof(uint32_t), field_type);
+        blob::write_u32(builder->data, builder->size + sizeof(uint32_t) + sizeof(int32_t), 0);
+        *out_size_offset = builder->size + sizeof(uint32_t) + sizeof(int32_t);
+        builder->size   += header_size;
+        return true;
+    }
+    if (field_type != parent->item_type)
+    {
+        return builder_fail(builder);
+    }
+    return builder_reserve(builder, body_size);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void builder_end_field(blob::builder_t *builder, size_t size_offset)
+{
+    if (size_offset != BUILDER_NO_SIZE)
+    {
+        size_t data_size = builder->size - size_offset - sizeof(uint32_t);
+        blob::write_u32(builder->data, size_offset, uint32_t(data_size));
+    }
+    if (builder->depth > 0)
+    {
+        builder->stack[builder->depth - 1].item_count++;
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool builder_push(
+    blob::builder_t *builder,
+    uint32_t         field_name,
+    int32_t          field_type,
+    int32_t          item_type)
+{
+    // opens an array or object. both begin with two 4-byte values, which
+    // are rewritten when the container is closed.
+    size_t size_offset = BUILDER_NO_SIZE;
+    if (builder->depth >= BLOB_BUILDER_MAX_DEPTH)
+    {
+        return builder_fail(builder);
+    }
+    if (!builder_begin_field(builder, field_name, field_type, sizeof(uint32_t) * 2, &size_offset))
+    {
+        return false;
+    }
+    blob::builder_frame_t *frame = &builder->stack[builder->depth++];
+    frame->field_type  = field_type;
+    frame->item_type   = item_type;
+    frame->item_count  = 0;
+    frame->info_offset = builder->size;
+    frame->size_offset = size_offset;
+    blob::write_u32(builder->data, builder->size, 0);
+    blob::write_s32(builder->data, builder->size + sizeof(uint32_t), item_type);
+    builder->size += sizeof(uint32_t) * 2;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool map_file(char const *path, blob::view_t *out_view)
+{
+#if   CMN_IS_APPLE || CMN_IS_LINUX
+    struct stat file_info;
+    int         fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    if (fstat(fd, &file_info) != 0 || uint64_t(file_info.st_size) > std::numeric_limits<size_t>::max())
+    {
+        close(fd);
+        return false;
+    }
+    if (0 == file_info.st_size)
+    {
+        // an empty blob is valid, but cannot be mapped.
+        close(fd);
+        return true;
+    }
+    // the mapping remains valid after the descriptor is closed.
+    size_t size = size_t(file_info.st_size);
+    void  *addr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == addr)
+    {
+        return false;
+    }
+    out_view->data      = addr;
+    out_view->data_size = size;
+    return true;
+#elif CMN_IS_WINDOWS
+    LARGE_INTEGER file_size;
+    HANDLE        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (INVALID_HANDLE_VALUE == file)
+    {
+        return false;
+    }
+    if (!GetFileSizeEx(file, &file_size) || uint64_t(file_size.QuadPart) > std::numeric_limits<size_t>::max())
+    {
+        CloseHandle(file);
+        return false;
+    }
+    if (0 == file_size.QuadPart)
+    {
+        // an empty blob is valid, but cannot be mapped.
+        CloseHandle(file);
+        return true;
+    }
+    // the mapping object keeps the file open.
+    HANDLE map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (NULL == map)
+    {
+        return false;
+    }
+    void *addr = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    if (NULL == addr)
+    {
+        CloseHandle(map);
+        return false;
+    }
+    out_view->data      = addr;
+    out_view->data_size = size_t(file_size.QuadPart);
+    out_view->mapping   = map;
+    return true;
+#else
+    CMN_UNUSED(path);
+    CMN_UNUSED(out_view);
+    return false;
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t blob::determine_text_encoding(uint8_t BOM[4], size_t *out_size)
+{
+    size_t  bom_size = 0;
+    int32_t text_enc = blob::TEXT_ENCODING_UNSURE;
+
+    if (0 == BOM[0])
+    {
+        if (0 == BOM[1] && 0xFE == BOM[2] && 0xFF == BOM[3])
+        {
+            // UTF32 big-endian.
+            bom_size = 4;
+            text_enc = blob::TEXT_ENCODING_UTF32_BE;
+        }
+        else
+        {
+            // no BOM (or unrecognized).
+            bom_size = 0;
+            text_enc = blob::TEXT_ENCODING_UNSURE;
+        }
+    }
+    else if (0xFF == BOM[0])
+    {
+        if (0xFE == BOM[1])
+        {
+            if (0 == BOM[2] && 0 == BOM[3])
+            {
+                // UTF32 little-endian.
+                bom_size = 4;
+                text_enc = blob::TEXT_ENCODING_UTF32_LE;
+            }
+            else
+            {
+                // UTF16 little-endian.
+                bom_size = 2;
+                text_enc = blob::TEXT_ENCODING_UTF16_LE;
+            }
+        }
+        else
+        {
+            // no BOM (or unrecognized).
+            bom_size = 0;
+            text_enc = blob::TEXT_ENCODING_UNSURE;
+        }
+    }
+    else if (0xFE == BOM[0] && 0xFF == BOM[1])
+    {
+        // UTF16 big-endian.
+        bom_size = 2;
+        text_enc = blob::TEXT_ENCODING_UTF16_BE;
+    }
+    else if (0xEF == BOM[0] && 0xBB == BOM[1] && 0xBF == BOM[2])
+    {
+        // UTF-8.
+        bom_size = 3;
+        text_enc = blob::TEXT_ENCODING_UTF8;
+    }
+    else
+    {
+        // no BOM (or unrecognized).
+        bom_size = 0;
+        text_enc = blob::TEXT_ENCODING_UNSURE;
+    }
+
+    if (out_size != NULL)
+    {
+        // store the BOM size in bytes.
+        *out_size = bom_size;
+    }
+    return text_enc;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::bom(int32_t encoding, uint8_t out_BOM[4])
+{
+    size_t  bom_size = 0;
+    switch (encoding)
+    {
+        case blob::TEXT_ENCODING_UTF8:
+            {
+                bom_size   = 3;
+                out_BOM[0] = 0xEF;
+                out_BOM[1] = 0xBB;
+                out_BOM[2] = 0xBF;
+                out_BOM[3] = 0x00;
+            }
+            break;
+
+        case blob::TEXT_ENCODING_UTF16_BE:
+            {
+                bom_size   = 2;
+                out_BOM[0] = 0xFE;
+                out_BOM[1] = 0xFF;
+                out_BOM[2] = 0x00;
+                out_BOM[3] = 0x00;
+            }
+            break;
+
+        case blob::TEXT_ENCODING_UTF16_LE:
+            {
+                bom_size   = 2;
+                out_BOM[0] = 0xFF;
+                out_BOM[1] = 0xFE;
+                out_BOM[2] = 0x00;
+                out_BOM[3] = 0x00;
+            }
+            break;
+
+        case blob::TEXT_ENCODING_UTF32_BE:
+            {
+                bom_size   = 4;
+                out_BOM[0] = 0x00;
+                out_BOM[1] = 0x00;
+                out_BOM[2] = 0xFE;
+                out_BOM[3] = 0xFF;
+            }
+            break;
+
+        case blob::TEXT_ENCODING_UTF32_LE:
+            {
+                bom_size   = 4;
+                out_BOM[0] = 0xFF;
+                out_BOM[1] = 0xFE;
+                out_BOM[2] = 0x00;
+                out_BOM[3] = 0x00;
+            }
+            break;
+
+        default:
+            {
+                // no byte order marker.
+                bom_size   = 0;
+                out_BOM[0] = 0;
+                out_BOM[1] = 0;
+                out_BOM[2] = 0;
+                out_BOM[3] = 0;
+            }
+            break;
+    }
+    return bom_size;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::base64_size(size_t binary_size, size_t *out_pad_size)
+{
+    // base64 transforms 3 input bytes into 4 output bytes.
+    // pad the binary size so it is evenly divisible by 3.
+    size_t rem = binary_size % 3;
+    size_t adj = (rem != 0)  ? 3 - rem : 0;
+    if (out_pad_size  != 0)  *out_pad_size = adj;
+    return ((binary_size + adj) / 3) * 4 + 1; // +1 for NULL
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::binary_size(size_t base64_size, size_t pad_size)
+{
+    return (((3 * base64_size) / 4) - pad_size);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::binary_size(char const *base64_source, size_t base64_length)
+{
+    if (NULL == base64_source || 0 == base64_length)
+    {
+        // zero-length input - zero-length output.
+        return 0;
+    }
+
+    // end points at the last character in the base64 source data.
+    char const *end = base64_source + base64_length - 1;
+    size_t      pad = 0;
+    if (base64_length >= 1 && '=' == *end--)  ++pad;
+    if (base64_length >= 2 && '=' == *end--)  ++pad;
+    return blob::binary_size(base64_length, pad);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::base64_encode(
+    void const *input,
+    size_t      input_size,
+    char       *output,
+    size_t      output_size)
+{
+    size_t         pad    = 0;
+    size_t         req    = blob::base64_size(input_size, &pad);
+    uint8_t const *inp    = (uint8_t const*) input;
+    char          *outp   = output;
+    size_t         n      = 0;
+
+    if (output_size < req)
+    {
+        // insufficient space in buffer.
+        return 0;
+    }
+
+    // encode all complete three-byte groups, then the padded remainder.
+    n     = encode_groups(inp, input_size, outp);
+    outp += (n / 3) * 4;
+    outp += encode_final(inp + n, input_size - n, outp);
+    // always append the trailing null.
+    *outp++ = '\0';
+    // return the number of bytes written.
+    return ((size_t)(outp - output));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::base64_decode(
+    char const *input,
+    size_t      input_size,
+    void       *output,
+    size_t      output_size)
+{
+    blob::base64_stream_t state;
+    uint8_t              *outp = (uint8_t*) output;
+    size_t                req  = blob::binary_size(input_size, 0);
+
+    if (output_size < (req - 2))
+    {
+        // insufficient space in buffer.
+        return 0;
+    }
+
+    blob::base64_stream_init(&state);
+    outp = decode_chars(&state, input, input_size, outp, outp + output_size);
+    // return the number of bytes written.
+    return ((size_t)(outp - ((uint8_t*)output)));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t blob::base64_select_isa(int32_t max_isa)
+{
+    int32_t isa = detect_simd_isa();
+    if (max_isa < isa) isa = max_isa;
+    if (isa < blob::BASE64_ISA_SCALAR) isa = blob::BASE64_ISA_SCALAR;
+    Simd_ISA    = isa;
+    return isa;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void blob::base64_stream_init(blob::base64_stream_t *stream)
+{
+    stream->buffer[0]    = 0;
+    stream->buffer[1]    = 0;
+    stream->buffer[2]    = 0;
+    stream->buffer[3]    = 0;
+    stream->buffer_count = 0;
+    stream->pad_count    = 0;
+    stream->finished     = 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::base64_stream_size(size_t input_size)
+{
+    // up to two bytes may be carried over from the previous call, and a
+    // decoder never writes more than an encoder would for the same size.
+    return ((input_size + 2) / 3) * 4;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::base64_encode_update(
+    blob::base64_stream_t *stream,
+    void const            *input,
+    size_t                 input_size,
+    char                  *output,
+    size_t                 output_size)
+{
+    uint8_t const *inp  = (uint8_t const*) input;
+    char          *outp = output;
+    size_t         ins  = input_size;
+    size_t         n    = 0;
+
+    if (output_size < blob::base64_stream_size(input_size))
+    {
+        // insufficient space in buffer.
+        return 0;
+    }
+
+    // complete the group carried over from the previous call.
+    while (stream->buffer_count > 0 && stream->buffer_count < 3 && ins > 0)
+    {
+        stream->buffer[stream->buffer_count++] = *inp++;
+        ins--;
+    }
+    if (3 == stream->buffer_count)
+    {
+        outp += (encode_groups(stream->buffer, 3, outp) / 3) * 4;
+        stream->buffer_count = 0;
+    }
+
+    // encode the complete groups in place and carry over the rest.
+    n     = encode_groups(inp, ins, outp);
+    outp += (n / 3) * 4;
+    for (inp += n, ins -= n; ins > 0; --ins)
+    {
+        stream->buffer[stream->buffer_count++] = *inp++;
+    }
+    return ((size_t)(outp - output));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::base64_encode_final(
+    blob::base64_stream_t *stream,
+    char                  *output,
+    size_t                 output_size)
+{
+    size_t n = 0;
+    if (stream->buffer_count > 0 && output_size >= 4)
+    {
+        n = encode_final(stream->buffer, stream->buffer_count, output);
+        stream->buffer_count = 0;
+    }
+    return n;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::base64_decode_update(
+    blob::base64_stream_t *stream,
+    char const            *input,
+    size_t                 input_size,
+    void                  *output,
+    size_t                 output_size)
+{
+    uint8_t *outp = (uint8_t*) output;
+
+    if (output_size < blob::base64_stream_size(input_size))
+    {
+        // insufficient space in buffer.
+        return 0;
+    }
+
+    outp = decode_chars(stream, input, input_size, outp, outp + output_size);
+    return ((size_t)(outp - ((uint8_t*)output)));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t blob::field_type_minimum_integer(
+    int64_t max_value,
+    bool    support_signed)
+{
+    if (max_value < 0 || support_signed)
+    {
+        // check signed types only.
+        if (max_value >= std::numeric_limits<int8_t>::min()  &&
+            max_value <= std::numeric_limits<int8_t>::max())
+        {
+            return blob::FIELD_TYPE_SINT8;
+        }
+        if (max_value >= std::numeric_limits<int16_t>::min() &&
+            max_value <= std::numeric_limits<int16_t>::max())
+        {
+            return blob::FIELD_TYPE_SINT16;
+        }
+        if (max_value >= std::numeric_limits<int32_t>::min() &&
+            max_value <= std::numeric_limits<int32_t>::max())
+        {
+            return blob::FIELD_TYPE_SINT32;
+        }
+        return blob::FIELD_TYPE_SINT64;
+    }
+    else
+    {
+        // check unsigned types only.
+        uint64_t uns_value = (uint64_t) max_value;
+        if (uns_value >= std::numeric_limits<uint8_t>::min()  &&
+            uns_value <= std::numeric_limits<uint8_t>::max())
+        {
+            return blob::FIELD_TYPE_UINT8;
+        }
+        if (uns_value >= std::numeric_limits<uint16_t>::min() &&
+            uns_value <= std::numeric_limits<uint16_t>::max())
+        {
+            return blob::FIELD_TYPE_UINT16;
+        }
+        if (uns_value >= std::numeric_limits<uint32_t>::min() &&
+            uns_value <= std::numeric_limits<uint32_t>::max())
+        {
+            return blob::FIELD_TYPE_UINT32;
+        }
+        return blob::FIELD_TYPE_UINT64;
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool blob::field_type_is_signed(int32_t field_type)
+{
+    switch (field_type)
+    {
+        case blob::FIELD_TYPE_NONE:        return false;
+        case blob::FIELD_TYPE_NULL:        return false;
+        case blob::FIELD_TYPE_BOOLEAN:     return false;
+        case blob::FIELD_TYPE_SINT8:       return true;
+        case blob::FIELD_TYPE_UINT8:       return false;
+        case blob::FIELD_TYPE_CHAR:        return true;
+        case blob::FIELD_TYPE_SINT16:      return true;
+        case blob::FIELD_TYPE_UINT16:      return false;
+        case blob::FIELD_TYPE_SINT32:      return true;
+        case blob::FIELD_TYPE_UINT32:      return false;
+        case blob::FIELD_TYPE_SINT64:      return true;
+        case blob::FIELD_TYPE_UINT64:      return false;
+        case blob::FIELD_TYPE_FLOAT32:     return true;
+        case blob::FIELD_TYPE_FLOAT64:     return true;
+        case blob::FIELD_TYPE_VECTOR_2F:   return true;
+        case blob::FIELD_TYPE_VECTOR_3F:   return true;
+        case blob::FIELD_TYPE_VECTOR_4F:   return true;
+        case blob::FIELD_TYPE_MATRIX_2X2F: return true;
+        case blob::FIELD_TYPE_MATRIX_3X3F: return true;
+        case blob::FIELD_TYPE_MATRIX_3X4F: return true;
+        case blob::FIELD_TYPE_MATRIX_4X4F: return true;
+        default:                           break;
+    }
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool blob::field_type_is_unsigned(int32_t field_type)
+{
+    switch (field_type)
+    {
+        case blob::FIELD_TYPE_NONE:        return false;
+        case blob::FIELD_TYPE_NULL:        return false;
+        case blob::FIELD_TYPE_BOOLEAN:     return true;
+        case blob::FIELD_TYPE_SINT8:       return false;
+        case blob::FIELD_TYPE_UINT8:       return true;
+        case blob::FIELD_TYPE_CHAR:        return false;
+        case blob::FIELD_TYPE_SINT16:      return false;
+        case blob::FIELD_TYPE_UINT16:      return true;
+        case blob::FIELD_TYPE_SINT32:      return false;
+        case blob::FIELD_TYPE_UINT32:      return true;
+        case blob::FIELD_TYPE_SINT64:      return false;
+        case blob::FIELD_TYPE_UINT64:      return true;
+        case blob::FIELD_TYPE_FLOAT32:     return false;
+        case blob::FIELD_TYPE_FLOAT64:     return false;
+        case blob::FIELD_TYPE_VECTOR_2F:   return false;
+        case blob::FIELD_TYPE_VECTOR_3F:   return false;
+        case blob::FIELD_TYPE_VECTOR_4F:   return false;
+        case blob::FIELD_TYPE_MATRIX_2X2F: return false;
+        case blob::FIELD_TYPE_MATRIX_3X3F: return false;
+        case blob::FIELD_TYPE_MATRIX_3X4F: return false;
+        case blob::FIELD_TYPE_MATRIX_4X4F: return false;
+        default:                           break;
+    }
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::field_size_for_type(int32_t field_type)
+{
+    switch (field_type)
+    {
+        case blob::FIELD_TYPE_NONE:        return 0;
+        case blob::FIELD_TYPE_NULL:        return 0;
+        case blob::FIELD_TYPE_BOOLEAN:     return sizeof(int8_t);
+        case blob::FIELD_TYPE_SINT8:       return sizeof(int8_t);
+        case blob::FIELD_TYPE_UINT8:       return sizeof(uint8_t);
+        case blob::FIELD_TYPE_CHAR:        return sizeof(int8_t);
+        case blob::FIELD_TYPE_SINT16:      return sizeof(int16_t);
+        case blob::FIELD_TYPE_UINT16:      return sizeof(uint16_t);
+        case blob::FIELD_TYPE_SINT32:      return sizeof(int32_t);
+        case blob::FIELD_TYPE_UINT32:      return sizeof(uint32_t);
+        case blob::FIELD_TYPE_SINT64:      return sizeof(int64_t);
+        case blob::FIELD_TYPE_UINT64:      return sizeof(uint64_t);
+        case blob::FIELD_TYPE_FLOAT32:     return sizeof(float);
+        case blob::FIELD_TYPE_FLOAT64:     return sizeof(double);
+        case blob::FIELD_TYPE_VECTOR_2F:   return sizeof(float) * 2;
+        case blob::FIELD_TYPE_VECTOR_3F:   return sizeof(float) * 3;
+        case blob::FIELD_TYPE_VECTOR_4F:   return sizeof(float) * 4;
+        case blob::FIELD_TYPE_MATRIX_2X2F: return sizeof(float) * 4;
+        case blob::FIELD_TYPE_MATRIX_3X3F: return sizeof(float) * 9;
+        case blob::FIELD_TYPE_MATRIX_3X4F: return sizeof(float) * 12;
+        case blob::FIELD_TYPE_MATRIX_4X4F: return sizeof(float) * 16;
+        default:                           break;
+    }
+    return BLOB_FIELD_SIZE_VARIABLE;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::total_size_for_type(int32_t field_type)
+{
+    size_t base_size = blob::field_size_for_type(field_type);
+    return base_size + sizeof(int32_t);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::optimized_size(
+    void     *blob_src,
+    size_t    blob_size,
+    int32_t   flags)
+{
+    // a NULL destination measures the output without writing it.
+    return optimize_fields(NULL, blob_src, blob_size, flags);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::optimize(
+    void * CMN_RESTRICT blob_dst,
+    void * CMN_RESTRICT blob_src,
+    size_t              blob_size,
+    int32_t             flags)
+{
+    return optimize_fields((uint8_t*) blob_dst, blob_src, blob_size, flags);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool blob::optimize_plan(
+    void                  *blob_src,
+    size_t                 blob_size,
+    size_t                 thread_count,
+    int32_t                flags,
+    blob::optimize_plan_t *out_plan)
+{
+    optimize_field_t *fields      = NULL;
+    size_t            field_count = 0;
+    size_t            offset      = 0;
+
+    // locate the top-level fields. this is cheap compared to conversion,
+    // since only the sizes of nested fields need to be read.
+    while (offset < blob_size)
+    {
+        offset += blob::field_total_size(blob_src, offset);
+        field_count++;
+    }
+    fields = (optimize_field_t*) ::malloc((field_count ? field_count : 1) * sizeof(optimize_field_t));
+    if (NULL == fields)
+    {
+        memset(out_plan, 0, sizeof(blob::optimize_plan_t));
+        return false;
+    }
+    offset = 0;
+    for (size_t i = 0; i < field_count; ++i)
+    {
+        fields[i].src_offset = offset;
+        fields[i].src_size   = blob::field_total_size(blob_src, offset);
+        fields[i].dst_offset = 0;
+        fields[i].dst_size   = 0;
+        offset += fields[i].src_size;
+    }
+
+    // size each field in parallel, then assign the output offsets.
+    optimize_job_t job;
+    if (0 == thread_count) thread_count = processor_count();
+    job.dst         = NULL;
+    job.src         = blob_src;
+    job.fields      = fields;
+    job.field_count = field_count;
+    job.flags       = flags;
+    run_optimize_threads(&job, thread_count);
+    offset = 0;
+    for (size_t i = 0; i < field_count; ++i)
+    {
+        fields[i].dst_offset = offset;
+        offset += fields[i].dst_size;
+    }
+    out_plan->blob_src       = blob_src;
+    out_plan->blob_size      = blob_size;
+    out_plan->optimized_size = offset;
+    out_plan->thread_count   = thread_count;
+    out_plan->field_count    = field_count;
+    out_plan->field_list     = fields;
+    out_plan->flags          = flags;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::optimize_parallel(
+    void                        *blob_dst,
+    blob::optimize_plan_t const *plan)
+{
+    optimize_job_t job;
+    job.dst         = (uint8_t*) blob_dst;
+    job.src         = plan->blob_src;
+    job.fields      = (optimize_field_t*) plan->field_list;
+    job.field_count = plan->field_count;
+    job.flags       = plan->flags;
+    run_optimize_threads(&job, plan->thread_count);
+    return plan->optimized_size;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void blob::free_optimize_plan(blob::optimize_plan_t *plan)
+{
+    ::free(plan->field_list);
+    memset(plan, 0, sizeof(blob::optimize_plan_t));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool blob::optimize_stream(
+    disk::file_t  dst,
+    disk::file_t  src,
+    int32_t       flags,
+    uint64_t     *out_size)
+{
+    stream_buffer_t input  = {NULL, 0, 0};
+    stream_buffer_t output = {NULL, 0, 0};
+    uint64_t        total  = 0;
+    bool            result = true;
+
+    for ( ; ; )
+    {
+        // read the type of the next top-level field; stop cleanly at the
+        // end of the file, but not in the middle of a field.
+        bool   eof = false;
+        size_t n   = 0;
+        input.size = 0;
+        if (!reserve_buffer(&input, sizeof(int32_t)))
+        {
+            result = false;
+            break;
+        }
+        n = disk::read_file(src, input.data, 0, sizeof(int32_t), &eof);
+        if (0 == n && eof)
+        {
+            break;
+        }
+        input.size = n;
+        if (n != sizeof(int32_t) || !read_body(src, &input, blob::read_s32(input.data, 0), 0))
+        {
+            result = false;
+            break;
+        }
+        // the field is converted with the in-memory optimizer, so it must
+        // pass the same validation as a mapped blob.
+        size_t end = 0;
+        if (!valid_field(input.data, input.size, 0, 0, &end) || end != input.size)
+        {
+            result = false;
+            break;
+        }
+        output.size = 0;
+        size_t size = optimize_field(NULL, 0, input.data, 0, input.size, flags);
+        if (!reserve_buffer(&output, size))
+        {
+            result = false;
+            break;
+        }
+        optimize_field(output.data, 0, input.data, 0, input.size, flags);
+        if (disk::write_file(dst, output.data, 0, size) != size)
+        {
+            result = false;
+            break;
+        }
+        total += size;
+    }
+    ::free(output.data);
+    ::free(input.data);
+    if (out_size != NULL) *out_size = total;
+    return result;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::optimize_object_field(
+    void * CMN_RESTRICT blob_dst,
+    ptrdiff_t           blob_dst_offset,
+    void * CMN_RESTRICT blob_src,
+    ptrdiff_t           blob_src_offset,
+    int32_t             flags)
+{
+    uint8_t *dst  = (uint8_t*) blob_dst;
+    size_t   size = optimize_object_body(
+        dst, blob_dst_offset + sizeof(int32_t),
+        blob_src, blob_src_offset + sizeof(int32_t), flags);
+    blob::write_s32(dst, blob_dst_offset, blob::FIELD_TYPE_RT_OBJECT);
+    return size + sizeof(int32_t);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::optimize_array_field(
+    void * CMN_RESTRICT blob_dst,
+    ptrdiff_t           blob_dst_offset,
+    void * CMN_RESTRICT blob_src,
+    ptrdiff_t           blob_src_offset,
+    int32_t             flags)
+{
+    uint8_t *dst  = (uint8_t*) blob_dst;
+    size_t   size = optimize_array_body(
+        dst, blob_dst_offset + sizeof(int32_t),
+        blob_src, blob_src_offset + sizeof(int32_t), flags);
+    blob::write_field_array(dst, blob_dst_offset);
+    return size + sizeof(int32_t);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::field_data_size(void *data, ptrdiff_t byte_offset)
+{
+    int32_t  field_type = blob::read_s32(data, byte_offset);
+    size_t   field_size = blob::field_size_for_type(field_type);
+    size_t   type_size  = sizeof(int32_t);
+    if (field_size != BLOB_FIELD_SIZE_VARIABLE)
+    {
+        // this is a fixed-length field, no further computation necessary.
+        return field_size;
+    }
+    else if (blob::FIELD_TYPE_ARRAY == field_type)
+    {
+        // this is a variable-length array possibly containing variable-length
+        // data for individual entries. compute the total size. the array info
+        // is stored after the field_type, thus the sizeof(int32_t) offset.
+        return blob::array_total_size(data, byte_offset + type_size);
+    }
+    else if (blob::FIELD_TYPE_GN_OBJECT == field_type)
+    {
+        // this is a variable-length object possibly containing variable-length
+        // fields. compute the total size. the object info is stored after the
+        // field_type, and thus the sizeof(int32_t) offset.
+        return blob::generic_object_total_size(data, byte_offset + type_size);
+    }
+    else if (blob::FIELD_TYPE_RT_OBJECT == field_type)
+    {
+        // this is a variable-length object possibly containing variable-length
+        // fields. compute the total size. the object info is stored after the
+        // field_type, and thus the sizeof(int32_t) offset.
+        return blob::runtime_object_total_size(data, byte_offset + type_size);
+    }
+    else if (blob::FIELD_TYPE_PROTOTYPE == field_type)
+    {
+        // this is a variable-length prototype object. compute the total size.
+        // the prototype info is stored after the field type, and thus the
+        // sizeof(int32_t) offset.
+        return blob::prototype_total_size(data, byte_offset + type_size);
+    }
+    else
+    {
+        // unknown field type or NULL data block.
+        return 0;
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::field_total_size(void *data, ptrdiff_t byte_offset)
+{
+    return (blob::field_data_size(data, byte_offset) + sizeof(int32_t));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::array_data_size(void *data, ptrdiff_t byte_offset)
+{
+    uint32_t item_count  = blob::read_u32(data, byte_offset);
+    int32_t  item_type   = blob::read_s32(data, byte_offset + sizeof(uint32_t));
+    size_t   item_size   = blob::field_size_for_type(item_type);
+    size_t   base_size   = sizeof(uint32_t) + sizeof(int32_t);
+    size_t   base_offset = byte_offset + base_size;
+    size_t   total_size  = 0;
+
+    if (item_size != BLOB_FIELD_SIZE_VARIABLE)
+    {
+        // this is an array of fixed-length types. compute the size directly.
+        return (item_count * item_size);
+    }
+    else if (blob::FIELD_TYPE_ARRAY == item_type)
+    {
+        // this is an array of arrays. compute the total size (inc. metadata.)
+        for (size_t i = 0; i < item_count; ++i)
+        {
+            // for each sub-array, compute the total size.
+            ptrdiff_t offset = base_offset  + total_size;
+            size_t  sub_size = blob::array_total_size(data, offset);
+            total_size      += sub_size;
+        }
+        return total_size;
+    }
+    else if (blob::FIELD_TYPE_GN_OBJECT == item_type)
+    {
+        // this is an array of objects. compute the total size (inc. metadata.)
+        for (size_t i = 0; i < item_count; ++i)
+        {
+            // for each sub-object, compute the total size.
+            ptrdiff_t offset = base_offset  + total_size;
+            size_t  sub_size = blob::generic_object_total_size(data, offset);
+            total_size      += sub_size;
+        }
+        return total_size;
+    }
+    else if (blob::FIELD_TYPE_RT_OBJECT == item_type)
+    {
+        // this is an array of objects. compute the total size (inc. metadata.)
+        for (size_t i = 0; i < item_count; ++i)
+        {
+            // for each sub-object, compute the total size.
+            ptrdiff_t offset = base_offset  + total_size;
+            size_t  sub_size = blob::runtime_object_total_size(data, offset);
+            total_size      += sub_size;
+        }
+        return total_size;
+    }
+    else if (blob::FIELD_TYPE_PROTOTYPE == item_type)
+    {
+        // this is an array of prototypes. compute the total size (+ metadata.)
+        for (size_t i = 0; i < item_count; ++i)
+        {
+            // for each sub-prototype, compute the total size.
+            ptrdiff_t offset = base_offset  + total_size;
+            size_t  sub_size = blob::prototype_total_size(data, offset);
+            total_size      += sub_size;
+        }
+        return total_size;
+    }
+    else
+    {
+        // unknown field type or NULL data block.
+        return 0;
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::array_total_size(void *data, ptrdiff_t byte_offset)
+{
+    size_t  base_size = sizeof(uint32_t) + sizeof(int32_t);
+    return (base_size + blob::array_data_size(data, byte_offset));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::generic_object_data_size(void *data, ptrdiff_t byte_offset)
+{
+    uint32_t field_size  = blob::read_u32(data, sizeof(uint32_t) + byte_offset);
+    return   field_size;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::generic_object_total_size(void *data, ptrdiff_t byte_offset)
+{
+    // the field count and field data size precede the field data.
+    return blob::generic_object_data_size(data, byte_offset) + (sizeof(uint32_t) * 2);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::runtime_object_data_size(void *data, ptrdiff_t byte_offset)
+{
+    uint32_t  field_count = 0;
+    uint32_t  index_size  = 0;
+    size_t    header_size = runtime_object_header(data, byte_offset, &field_count, &index_size);
+    ptrdiff_t base_offset = byte_offset + header_size;
+    size_t    total_size  = 0;
+
+    // sum the total size of all fields in the object.
+    for (size_t i = 0; i  < field_count; ++i)
+    {
+        ptrdiff_t offset     = base_offset + total_size;
+        size_t    field_size = blob::field_total_size(data, offset);
+        total_size          += field_size;
+    }
+    return total_size;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::runtime_object_total_size(void *data, ptrdiff_t byte_offset)
+{
+    uint32_t  field_count = 0;
+    uint32_t  index_size  = 0;
+    size_t    header_size = runtime_object_header(data, byte_offset, &field_count, &index_size);
+    return   (header_size + blob::runtime_object_data_size(data, byte_offset));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::prototype_data_size(void *data, ptrdiff_t byte_offset)
+{
+    uint32_t  field_count = blob::read_u32(data, byte_offset);
+    size_t    names_size  = field_count * sizeof(uint32_t);
+    size_t    types_size  = field_count * sizeof(int32_t);
+    return   (names_size  + types_size);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::prototype_total_size(void *data, ptrdiff_t byte_offset)
+{
+    return blob::prototype_data_size(data, byte_offset) + sizeof(uint32_t);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t blob::field_at(
+    void          *data,
+    ptrdiff_t      byte_offset,
+    blob::field_t *out_field_info)
+{
+    ptrdiff_t  type_offset      = byte_offset + 0;
+    ptrdiff_t  data_offset      = byte_offset + sizeof(int32_t);
+    int32_t    field_type       = blob::read_s32(data, type_offset);
+    size_t     total_size       = blob::field_total_size(data, byte_offset);
+    size_t     field_size       = total_size  - sizeof(int32_t);
+    out_field_info->total_size  = total_size;
+    out_field_info->field_size  = field_size;
+    out_field_info->field_type  = field_type;
+    out_field_info->field_data  = ((uint8_t*) data) + data_offset;
+    return field_type;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void blob::array_field_at(
+    void                *data,
+    ptrdiff_t            byte_offset,
+    blob::array_field_t *out_field_info)
+{
+    size_t   count_size        = sizeof(uint32_t);
+    size_t   type_size         = sizeof(int32_t);
+    out_field_info->item_count = blob::read_u32(data, byte_offset);
+    out_field_info->item_type  = blob::read_s32(data, byte_offset + count_size);
+    out_field_info->array_size = blob::array_total_size(data, byte_offset);
+    out_field_info->item_data  = ((uint8_t*) data) + byte_offset + count_size + type_size;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void blob::generic_object_at(
+    void                   *data,
+    ptrdiff_t               byte_offset,
+    blob::generic_object_t *out_field_info)
+{
+    ptrdiff_t count_offset       = byte_offset + 0;
+    ptrdiff_t size_offset        = byte_offset + sizeof(uint32_t);
+    ptrdiff_t data_offset        = byte_offset + sizeof(uint32_t) * 2;
+    uint32_t  field_count        = blob::read_u32(data, count_offset);
+    uint32_t  field_size         = blob::read_u32(data, size_offset);
+    size_t    object_size        = blob::generic_object_total_size(data, byte_offset);
+    out_field_info->object_size  = object_size;
+    out_field_info->field_size   = field_size;
+    out_field_info->field_count  = field_count;
+    out_field_info->field_values = ((uint8_t*) data) + data_offset;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t blob::generic_object_field_at(
+    void                         *data,
+    ptrdiff_t                     byte_offset,
+    blob::generic_object_field_t *out_field_info)
+{
+    ptrdiff_t name_offset      = byte_offset + 0;
+    ptrdiff_t type_offset      = byte_offset + sizeof(uint32_t);
+    ptrdiff_t size_offset      = byte_offset + sizeof(uint32_t) + sizeof(int32_t);
+    ptrdiff_t data_offset      = byte_offset +(sizeof(uint32_t) * 2) + sizeof(int32_t);
+    uint32_t  field_name       = blob::read_u32(data, name_offset);
+    int32_t   field_type       = blob::read_s32(data, type_offset);
+    uint32_t  field_size       = blob::read_u32(data, size_offset);
+    out_field_info->total_size = field_size  +(sizeof(uint32_t) * 2) + sizeof(int32_t);
+    out_field_info->field_name = field_name;
+    out_field_info->field_type = field_type;
+    out_field_info->field_size = field_size;
+    out_field_info->field_data = ((uint8_t*) data) + data_offset;
+    return field_type;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void blob::runtime_object_at(
+    void                   *data,
+    ptrdiff_t               byte_offset,
+    blob::runtime_object_t *out_field_info)
+{
+    uint32_t  field_count         = 0;
+    uint32_t  index_size          = 0;
+    size_t    header_size         = runtime_object_header(data, byte_offset, &field_count, &index_size);
+    size_t    names_size          = field_count   * sizeof(uint32_t);
+    size_t    offset_size         = field_count   * sizeof(uint32_t);
+    ptrdiff_t offset_offset       = byte_offset   + sizeof(uint32_t) + names_size;
+    ptrdiff_t names_offset        = byte_offset   + sizeof(uint32_t);
+    ptrdiff_t index_offset        = offset_offset + offset_size + sizeof(uint32_t);
+    ptrdiff_t field_offset        = byte_offset   + header_size;
+    size_t    object_size         = blob::runtime_object_total_size(data, byte_offset);
+    out_field_info->object_size   = object_size;
+    out_field_info->field_count   = field_count;
+    out_field_info->field_names   = blob::data_at<uint32_t>(data, names_offset);
+    out_field_info->field_offsets = blob::data_at<uint32_t>(data, offset_offset);
+    out_field_info->field_index   = index_size ? blob::data_at<uint32_t>(data, index_offset) : NULL;
+    out_field_info->index_size    = index_size;
+    out_field_info->field_values  = blob::data_at<uint8_t> (data, field_offset);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t blob::runtime_object_field_at(
+    void                         *data,
+    ptrdiff_t                     byte_offset,
+    blob::runtime_object_field_t *out_field_info)
 {
-    uint32_t item_count  = blob::read_u32(data, byte_offset);
-    int32_t  item_type   = blob::read_s32(data, byte_offset + sizeof(uint32_t));
-    size_t   item_size   = blob::field_size_for_type(item_type);
-    size_t   base_size   = sizeof(uint32_t) + sizeof(int32_t);
-    size_t   base_offset = byte_offset + base_size;
-    size_t   total_size  = 0;
+    ptrdiff_t  type_offset      = byte_offset + 0;
+    ptrdiff_t  data_offset      = byte_offset + sizeof(int32_t);
+    int32_t    field_type       = blob::read_s32(data, type_offset);
+    size_t     field_size       = blob::field_data_size(data, byte_offset);
+    uint32_t   total_size       = field_size  + sizeof(int32_t);
+    out_field_info->total_size  = total_size;
+    out_field_info->field_type  = field_type;
+    out_field_info->field_size  = field_size;
+    out_field_info->field_data  = ((uint8_t*) data) + data_offset;
+    return field_type;
+}
 
-    if (item_size != BLOB_FIELD_SIZE_VARIABLE)
-    {
-        // this is an array of fixed-length types. compute the size directly.
-        return (item_count * item_size);
-    }
-    else if (blob::FIELD_TYPE_ARRAY == item_type)
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void blob::prototype_at(
+    void              *data,
+    ptrdiff_t          byte_offset,
+    blob::prototype_t *out_field_info)
+{
+    uint32_t  field_count       = blob::read_u32(data, byte_offset);
+    size_t    names_size        = field_count * sizeof(uint32_t);
+    size_t    types_size        = field_count * sizeof(int32_t);
+    ptrdiff_t names_offset      = byte_offset + sizeof(uint32_t);
+    ptrdiff_t types_offset      = byte_offset + sizeof(uint32_t)   + names_size;
+    out_field_info->proto_size  = sizeof(field_count) + names_size + types_size;
+    out_field_info->field_count = field_count;
+    out_field_info->field_names = blob::data_at<uint32_t>(data, names_offset);
+    out_field_info->field_types = blob::data_at< int32_t>(data, types_offset);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t blob::generic_object_search(
+    blob::generic_object_t const *object,
+    uint32_t                      field_name,
+    blob::generic_object_field_t *out_field_info)
+{
+    void   *b_ptr = object->field_values; // base pointer value
+    size_t  b_ofs = 0;                    // base offset value
+
+    // generic objects require checking each field in the blob.
+    // this can be inefficient for complex types, since it requires
+    // touching a lot of memory (since fields are variable-length.)
+    for (size_t i = 0; i < object->field_count; ++i)
     {
-        // this is an array of arrays. compute the total size (inc. metadata.)
-        for (size_t i = 0; i < item_count; ++i)
+        blob::generic_object_field_t field_info = {0};
+        blob::generic_object_field_at(b_ptr, b_ofs, &field_info);
+        if (field_info.field_name == field_name)
         {
-            // for each sub-array, compute the total size.
-            ptrdiff_t offset = base_offset  + total_size;
-            size_t  sub_size = blob::array_total_size(data, offset);
-            total_size      += sub_size;
+            if (out_field_info != NULL) *out_field_info = field_info;
+            return  field_info.field_type;
         }
-        return total_size;
+        // update our offset to the start of the next field.
+        b_ofs += field_info.total_size;
     }
-    else if (blob::FIELD_TYPE_GN_OBJECT == item_type)
+    return blob::FIELD_TYPE_NONE;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t blob::runtime_object_search(
+    blob::runtime_object_t const *object,
+    uint32_t                      field_name,
+    blob::runtime_object_field_t *out_field_info)
+{
+    uint32_t const *name_list   = object->field_names;
+    size_t          field_count = object->field_count;
+    if (object->index_size > 0)
     {
-        // this is an array of objects. compute the total size (inc. metadata.)
-        for (size_t i = 0; i < item_count; ++i)
+        // probe the hashed index until the field or an empty slot is found.
+        uint32_t const *slots = object->field_index;
+        uint32_t        mask  = uint32_t(object->index_size - 1);
+        uint32_t        slot  = field_slot(field_name, mask);
+        for ( ; slots[slot] != BLOB_FIELD_INDEX_INVALID; slot = (slot + 1) & mask)
         {
-            // for each sub-object, compute the total size.
-            ptrdiff_t offset = base_offset  + total_size;
-            size_t  sub_size = blob::generic_object_total_size(data, offset);
-            total_size      += sub_size;
+            uint32_t i = slots[slot];
+            if (name_list[i] == field_name)
+            {
+                blob::runtime_object_field_t field_info = {0};
+                blob::runtime_object_field_at(
+                    object->field_values,
+                    object->field_offsets[i],
+                    &field_info);
+                if (out_field_info  != NULL) *out_field_info = field_info;
+                return  field_info.field_type;
+            }
         }
-        return total_size;
+        return blob::FIELD_TYPE_NONE;
     }
-    else if (blob::FIELD_TYPE_RT_OBJECT == item_type)
+    for (size_t i = 0; i < field_count; ++i)
     {
-        // this is an array of objects. compute the total size (inc. metadata.)
-        for (size_t i = 0; i < item_count; ++i)
+        if (name_list[i] == field_name)
         {
-            // for each sub-object, compute the total size.
-            ptrdiff_t offset = base_offset  + total_size;
-            size_t  sub_size = blob::runtime_object_total_size(data, offset);
-            total_size      += sub_size;
+            blob::runtime_object_field_t field_info = {0};
+            blob::runtime_object_field_at(
+                object->field_values,
+                object->field_offsets[i],
+                &field_info);
+            if (out_field_info  != NULL) *out_field_info = field_info;
+            return  field_info.field_type;
         }
-        return total_size;
     }
-    else if (blob::FIELD_TYPE_PROTOTYPE == item_type)
+    return blob::FIELD_TYPE_NONE;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t blob::prototype_search(
+    blob::prototype_t const *prototype,
+    uint32_t                 field_name)
+{
+    uint32_t const *name_list   = prototype->field_names;
+    size_t          field_count = prototype->field_count;
+    for (size_t i = 0; i < field_count; ++i)
     {
-        // this is an array of prototypes. compute the total size (+ metadata.)
-        for (size_t i = 0; i < item_count; ++i)
-        {
-            // for each sub-prototype, compute the total size.
-            ptrdiff_t offset = base_offset  + total_size;
-            size_t  sub_size = blob::prototype_total_size(data, offset);
-            total_size      += sub_size;
-        }
-        return total_size;
+        if (name_list[i] == field_name) return prototype->field_types[i];
     }
-    else
+    return blob::FIELD_TYPE_NONE;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool blob::field_offset_valid(
+    void      *data,
+    size_t     data_size,
+    ptrdiff_t  byte_offset)
+{
+    size_t end = 0;
+    if (NULL == data || byte_offset < 0)
     {
-        // unknown field type or NULL data block.
-        return 0;
+        return false;
     }
+    return valid_field(data, data_size, size_t(byte_offset), 0, &end);
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::array_total_size(void *data, ptrdiff_t byte_offset)
+void blob::swap_array_16(void *dst, void const *src, size_t count)
 {
-    size_t  base_size = sizeof(uint32_t) + sizeof(int32_t);
-    return (base_size + blob::array_data_size(data, byte_offset));
+    swap_elements(dst, src, count, sizeof(uint16_t));
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::generic_object_data_size(void *data, ptrdiff_t byte_offset)
+void blob::swap_array_32(void *dst, void const *src, size_t count)
 {
-    uint32_t field_size  = blob::read_u32(data, sizeof(uint32_t) + byte_offset);
-    return   field_size  + (sizeof(uint32_t) * 2);
+    swap_elements(dst, src, count, sizeof(uint32_t));
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::generic_object_total_size(void *data, ptrdiff_t byte_offset)
+void blob::swap_array_64(void *dst, void const *src, size_t count)
 {
-    return blob::generic_object_data_size(data, byte_offset) + sizeof(int32_t);
+    swap_elements(dst, src, count, sizeof(uint64_t));
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::runtime_object_data_size(void *data, ptrdiff_t byte_offset)
+bool blob::normalize_endianess(
+    void    *data,
+    size_t   data_size,
+    int32_t  blob_endianess)
 {
-    uint32_t  field_count = blob::read_u32(data, byte_offset);
-    size_t    names_size  = field_count  * sizeof(uint32_t);
-    size_t    offset_size = field_count  * sizeof(uint32_t);
-    ptrdiff_t offset_ofs  = byte_offset  + sizeof(uint32_t) + names_size;
-    ptrdiff_t base_offset = offset_ofs   + offset_size;
-    size_t    total_size  = 0;
-
-    // sum the total size of all fields in the object.
-    for (size_t i = 0; i  < field_count; ++i)
+    size_t offset = 0;
+    if (BLOB_SYSTEM_ENDIANESS == blob_endianess)
     {
-        ptrdiff_t offset     = base_offset + total_size;
-        size_t    field_size = blob::field_total_size(data, offset);
-        total_size          += field_size;
+        return true;
     }
-    return total_size;
+    while (offset < data_size)
+    {
+        if (!normalize_field(data, data_size, offset, 0, &offset))
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::runtime_object_total_size(void *data, ptrdiff_t byte_offset)
+size_t blob::compressed_bound(size_t blob_size, size_t chunk_size)
 {
-    uint32_t  field_count = blob::read_u32(data, byte_offset);
-    size_t    names_size  = field_count * sizeof(uint32_t);
-    size_t    offset_size = field_count * sizeof(uint32_t);
-    ptrdiff_t offset_ofs  = byte_offset + sizeof(uint32_t) + names_size;
-    ptrdiff_t base_offset = offset_ofs  + offset_size;
-    size_t    total_size  = 0;
+    // chunks that do not compress are stored as-is.
+    size_t chunk_count = chunk_size ? (blob_size + chunk_size - 1) / chunk_size : 0;
+    return CONTAINER_HEADER_SIZE + chunk_count * CONTAINER_ENTRY_SIZE + blob_size;
+}
 
-    // sum the total size of all fields in the object.
-    for (size_t i = 0; i  < field_count; ++i)
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t blob::compress_blob(
+    void       *dst,
+    size_t      dst_size,
+    void const *src,
+    size_t      src_size,
+    size_t      chunk_size)
+{
+    uint8_t       *out         = (uint8_t*) dst;
+    uint8_t const *in          = (uint8_t const*) src;
+    size_t         chunk_count = 0;
+    size_t         offset      = 0;
+    if (0 == chunk_size || chunk_size > BLOB_FIELD_OFFSET_INVALID || src_size > BLOB_FIELD_OFFSET_INVALID)
     {
-        ptrdiff_t offset     = base_offset + total_size;
-        size_t    field_size = blob::field_total_size(data, offset);
-        total_size          += field_size;
+        return 0;
+    }
+    chunk_count = (src_size + chunk_size - 1) / chunk_size;
+    offset      = CONTAINER_HEADER_SIZE + chunk_count * CONTAINER_ENTRY_SIZE;
+    if (dst_size < offset)
+    {
+        return 0;
+    }
+    blob::write_u32(dst, 0,  uint32_t(BLOB_COMPRESSED_MAGIC));
+    blob::write_u32(dst, 4,  uint32_t(chunk_size));
+    blob::write_u32(dst, 8,  uint32_t(chunk_count));
+    blob::write_u32(dst, 12, uint32_t(src_size));
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        size_t length = src_size - i * chunk_size;
+        size_t room   = dst_size - offset;
+        if (length > chunk_size) length = chunk_size;
+        // a chunk is only kept compressed if that makes it smaller.
+        size_t stored = lz_compress(out + offset, room < length - 1 ? room : length - 1, in + i * chunk_size, length);
+        if (0 == stored)
+        {
+            if (room < length) return 0;
+            memcpy(out + offset, in + i * chunk_size, length);
+            stored = length;
+        }
+        if (offset + stored > BLOB_FIELD_OFFSET_INVALID)
+        {
+            return 0;
+        }
+        blob::write_u32(dst, CONTAINER_HEADER_SIZE + i * CONTAINER_ENTRY_SIZE, uint32_t(offset));
+        blob::write_u32(dst, CONTAINER_HEADER_SIZE + i * CONTAINER_ENTRY_SIZE + sizeof(uint32_t), uint32_t(stored));
+        offset += stored;
     }
-    return (sizeof(uint32_t) + names_size + offset_size + total_size);
+    return offset;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::prototype_data_size(void *data, ptrdiff_t byte_offset)
+bool blob::compressed_info(
+    void const              *container,
+    size_t                   container_size,
+    blob::compressed_info_t *out_info)
 {
-    uint32_t  field_count = blob::read_u32(data, byte_offset);
-    size_t    names_size  = field_count * sizeof(uint32_t);
-    size_t    types_size  = field_count * sizeof(int32_t);
-    return   (names_size  + types_size);
+    size_t end = CONTAINER_HEADER_SIZE;
+    if (container_size < CONTAINER_HEADER_SIZE)
+    {
+        return false;
+    }
+    size_t chunk_count = blob::read_u32((void*) container, 8);
+    if (0 == chunk_count)
+    {
+        // an empty blob; check the header alone.
+        if (blob::read_u32((void*) container, 0) != BLOB_COMPRESSED_MAGIC ||
+            blob::read_u32((void*) container, 4) == 0 ||
+            blob::read_u32((void*) container, 12) != 0)
+        {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        size_t offset, stored, length;
+        if (!container_chunk(container, container_size, i, &offset, &stored, &length))
+        {
+            return false;
+        }
+        if (offset + stored > end) end = offset + stored;
+    }
+    out_info->blob_size      = blob::read_u32((void*) container, 12);
+    out_info->chunk_size     = blob::read_u32((void*) container, 4);
+    out_info->chunk_count    = chunk_count;
+    out_info->container_size = end;
+    return true;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-size_t blob::prototype_total_size(void *data, ptrdiff_t byte_offset)
+bool blob::decompress_chunk(
+    void       *dst,
+    size_t      dst_size,
+    void const *container,
+    size_t      container_size,
+    size_t      chunk_index)
 {
-    return blob::prototype_data_size(data, byte_offset) + sizeof(uint32_t);
+    size_t offset = 0;
+    size_t stored = 0;
+    size_t length = 0;
+    if (!container_chunk(container, container_size, chunk_index, &offset, &stored, &length))
+    {
+        return false;
+    }
+    if (length > dst_size)
+    {
+        return false;
+    }
+    uint8_t const *src = ((uint8_t const*) container) + offset;
+    if (stored == length)
+    {
+        memcpy(dst, src, length);
+        return true;
+    }
+    return lz_decompress((uint8_t*) dst, length, src, stored);
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-int32_t blob::field_at(
-    void          *data,
-    ptrdiff_t      byte_offset,
-    blob::field_t *out_field_info)
+bool blob::decompress_range(
+    void       *dst,
+    size_t      dst_size,
+    void const *container,
+    size_t      container_size,
+    size_t      offset,
+    size_t      amount)
 {
-    ptrdiff_t  type_offset      = byte_offset + 0;
-    ptrdiff_t  data_offset      = byte_offset + sizeof(int32_t);
-    int32_t    field_type       = blob::read_s32(data, type_offset);
-    size_t     total_size       = blob::field_total_size(data, byte_offset);
-    size_t     field_size       = total_size  - sizeof(int32_t);
-    out_field_info->total_size  = total_size;
-    out_field_info->field_size  = field_size;
-    out_field_info->field_type  = field_type;
-    out_field_info->field_data  = ((uint8_t*) data) + data_offset;
-    return field_type;
+    blob::compressed_info_t info;
+    uint8_t *out     = (uint8_t*) dst;
+    uint8_t *scratch = NULL;
+    bool     result  = true;
+    if (!blob::compressed_info(container, container_size, &info))
+    {
+        return false;
+    }
+    if (offset > info.blob_size || amount > info.blob_size - offset || amount > dst_size)
+    {
+        return false;
+    }
+    while (amount > 0 && result)
+    {
+        // whole chunks are decompressed directly into dst, while chunks at
+        // either end of the range go through a scratch buffer.
+        size_t chunk = offset / info.chunk_size;
+        size_t start = offset - chunk * info.chunk_size;
+        size_t size  = info.blob_size - chunk * info.chunk_size;
+        if (size  > info.chunk_size) size = info.chunk_size;
+        size_t count = size - start;
+        if (count > amount) count = amount;
+        if (0 == start && count == size)
+        {
+            result = blob::decompress_chunk(out, count, container, container_size, chunk);
+        }
+        else
+        {
+            if (NULL == scratch && NULL == (scratch = (uint8_t*) ::malloc(info.chunk_size)))
+            {
+                return false;
+            }
+            result = blob::decompress_chunk(scratch, info.chunk_size, container, container_size, chunk);
+            memcpy(out, scratch + start, count);
+        }
+        out    += count;
+        offset += count;
+        amount -= count;
+    }
+    ::free(scratch);
+    return result;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-void blob::array_field_at(
-    void                *data,
-    ptrdiff_t            byte_offset,
-    blob::array_field_t *out_field_info)
-{
-    size_t   count_size        = sizeof(uint32_t);
-    size_t   type_size         = sizeof(int32_t);
-    out_field_info->item_count = blob::read_u32(data, byte_offset);
-    out_field_info->item_type  = blob::read_s32(data, byte_offset + count_size);
-    out_field_info->array_size = blob::array_total_size(data, byte_offset);
-    out_field_info->item_data  = ((uint8_t*) data) + byte_offset + count_size + type_size;
+bool blob::decompress_blob(
+    void       *dst,
+    size_t      dst_size,
+    void const *container,
+    size_t      container_size,
+    size_t      thread_count)
+{
+    blob::compressed_info_t info;
+    decompress_job_t        job;
+    if (!blob::compressed_info(container, container_size, &info) || info.blob_size > dst_size)
+    {
+        return false;
+    }
+    if (0 == thread_count) thread_count = processor_count();
+    if (thread_count > info.chunk_count) thread_count = info.chunk_count;
+    job.dst            = (uint8_t*) dst;
+    job.dst_size       = dst_size;
+    job.container      = container;
+    job.container_size = container_size;
+    job.chunk_size     = info.chunk_size;
+    job.chunk_count    = info.chunk_count;
+    job.next_chunk     = 0;
+    job.failed         = 0;
+    run_workers(run_decompress_job, &job, thread_count);
+    return (0 == job.failed);
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-void blob::generic_object_at(
-    void                   *data,
-    ptrdiff_t               byte_offset,
-    blob::generic_object_t *out_field_info)
+size_t blob::diff_size(
+    void const *old_blob,
+    size_t      old_size,
+    void const *new_blob,
+    size_t      new_size)
 {
-    ptrdiff_t count_offset       = byte_offset + 0;
-    ptrdiff_t size_offset        = byte_offset + sizeof(uint32_t);
-    ptrdiff_t data_offset        = byte_offset + sizeof(uint32_t) * 2;
-    uint32_t  field_count        = blob::read_u32(data, count_offset);
-    uint32_t  field_size         = blob::read_u32(data, size_offset);
-    size_t    object_size        = blob::generic_object_total_size(data, byte_offset);
-    out_field_info->object_size  = object_size;
-    out_field_info->field_size   = field_size;
-    out_field_info->field_count  = field_count;
-    out_field_info->field_values = ((uint8_t*) data) + data_offset;
+    return diff_blobs(NULL, 0, old_blob, old_size, new_blob, new_size);
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-int32_t blob::generic_object_field_at(
-    void                         *data,
-    ptrdiff_t                     byte_offset,
-    blob::generic_object_field_t *out_field_info)
+size_t blob::diff_blob(
+    void       *dst,
+    size_t      dst_size,
+    void const *old_blob,
+    size_t      old_size,
+    void const *new_blob,
+    size_t      new_size)
 {
-    ptrdiff_t name_offset      = byte_offset + 0;
-    ptrdiff_t type_offset      = byte_offset + sizeof(uint32_t);
-    ptrdiff_t size_offset      = byte_offset + sizeof(uint32_t) + sizeof(int32_t);
-    ptrdiff_t data_offset      = byte_offset +(sizeof(uint32_t) * 2) + sizeof(int32_t);
-    uint32_t  field_name       = blob::read_u32(data, name_offset);
-    int32_t   field_type       = blob::read_s32(data, type_offset);
-    uint32_t  field_size       = blob::read_u32(data, size_offset);
-    out_field_info->total_size = field_size  +(sizeof(uint32_t) * 2) +(sizeof(int32_t) * 2);
-    out_field_info->field_name = field_name;
-    out_field_info->field_type = field_type;
-    out_field_info->field_size = field_size;
-    out_field_info->field_data = ((uint8_t*) data) + data_offset;
-    return field_type;
+    if (NULL == dst)
+    {
+        return 0;
+    }
+    return diff_blobs(dst, dst_size, old_blob, old_size, new_blob, new_size);
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-void blob::runtime_object_at(
-    void                   *data,
-    ptrdiff_t               byte_offset,
-    blob::runtime_object_t *out_field_info)
+bool blob::patch_info(
+    void const         *patch,
+    size_t              patch_size,
+    blob::patch_info_t *out_info)
 {
-    uint32_t  field_count         = blob::read_u32(data, byte_offset);
-    size_t    names_size          = field_count   * sizeof(uint32_t);
-    size_t    offset_size         = field_count   * sizeof(uint32_t);
-    ptrdiff_t offset_offset       = byte_offset   + sizeof(uint32_t) + names_size;
-    ptrdiff_t names_offset        = byte_offset   + sizeof(uint32_t);
-    ptrdiff_t field_offset        = offset_offset + offset_size;
-    size_t    object_size         = blob::runtime_object_total_size(data, byte_offset);
-    out_field_info->object_size   = object_size;
-    out_field_info->field_count   = field_count;
-    out_field_info->field_names   = blob::data_at<uint32_t>(data, names_offset);
-    out_field_info->field_offsets = blob::data_at<uint32_t>(data, offset_offset);
-    out_field_info->field_values  = blob::data_at<uint8_t> (data, field_offset);
+    size_t at     = PATCH_HEADER_SIZE;
+    size_t output = 0;
+    if (patch_size < PATCH_HEADER_SIZE || patch_u32(patch, 0) != BLOB_PATCH_MAGIC)
+    {
+        return false;
+    }
+    out_info->old_size  = patch_u32(patch, 4);
+    out_info->new_size  = patch_u32(patch, 8);
+    out_info->copy_size = 0;
+    out_info->data_size = 0;
+    out_info->op_count  = 0;
+    while (at < patch_size)
+    {
+        if (!in_bounds(patch_size, at, sizeof(uint32_t)))
+        {
+            return false;
+        }
+        uint32_t tag    = patch_u32(patch, at);
+        size_t   length = tag & PATCH_MAX_RUN;
+        if (length > out_info->new_size - output)
+        {
+            return false;
+        }
+        if (tag & PATCH_OP_DATA)
+        {
+            if (!in_bounds(patch_size, at + sizeof(uint32_t), length))
+            {
+                return false;
+            }
+            out_info->data_size += length;
+            at += sizeof(uint32_t) + length;
+        }
+        else
+        {
+            if (!in_bounds(patch_size, at, sizeof(uint32_t) * 2))
+            {
+                return false;
+            }
+            size_t offset = patch_u32(patch, at + sizeof(uint32_t));
+            if (!in_bounds(out_info->old_size, offset, length))
+            {
+                return false;
+            }
+            out_info->copy_size += length;
+            at += sizeof(uint32_t) * 2;
+        }
+        output += length;
+        out_info->op_count++;
+    }
+    return (output == out_info->new_size);
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-int32_t blob::runtime_object_field_at(
-    void                         *data,
-    ptrdiff_t                     byte_offset,
-    blob::runtime_object_field_t *out_field_info)
+bool blob::apply_patch(
+    void       *dst,
+    size_t      dst_size,
+    void const *old_blob,
+    size_t      old_size,
+    void const *patch,
+    size_t      patch_size)
 {
-    ptrdiff_t  type_offset      = byte_offset + 0;
-    ptrdiff_t  data_offset      = byte_offset + sizeof(int32_t);
-    int32_t    field_type       = blob::read_s32(data, type_offset);
-    size_t     field_size       = blob::field_data_size(data, byte_offset);
-    uint32_t   total_size       = field_size  + sizeof(int32_t);
-    out_field_info->total_size  = total_size;
-    out_field_info->field_type  = field_type;
-    out_field_info->field_size  = field_size;
-    out_field_info->field_data  = ((uint8_t*) data) + data_offset;
-    return field_type;
+    blob::patch_info_t info;
+    uint8_t           *out = (uint8_t*) dst;
+    uint8_t const     *src = (uint8_t const*) old_blob;
+    uint8_t const     *ops = (uint8_t const*) patch;
+    size_t             at  = PATCH_HEADER_SIZE;
+    // the ops are fully checked before anything is written.
+    if (!blob::patch_info(patch, patch_size, &info))
+    {
+        return false;
+    }
+    if (info.old_size != old_size || info.new_size > dst_size)
+    {
+        return false;
+    }
+    if (patch_u32(patch, 12) != patch_checksum(old_blob, old_size))
+    {
+        return false;
+    }
+    while (at < patch_size)
+    {
+        uint32_t tag    = patch_u32(patch, at);
+        size_t   length = tag & PATCH_MAX_RUN;
+        if (tag & PATCH_OP_DATA)
+        {
+            memcpy(out, ops + at + sizeof(uint32_t), length);
+            at += sizeof(uint32_t) + length;
+        }
+        else
+        {
+            size_t offset = patch_u32(patch, at + sizeof(uint32_t));
+            memcpy(out, src + offset, length);
+            at += sizeof(uint32_t) * 2;
+        }
+        out += length;
+    }
+    return true;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-void blob::prototype_at(
-    void              *data,
-    ptrdiff_t          byte_offset,
-    blob::prototype_t *out_field_info)
+bool blob::open_view(char const *path, blob::view_t *out_view)
 {
-    uint32_t  field_count       = blob::read_u32(data, byte_offset);
-    size_t    names_size        = field_count * sizeof(uint32_t);
-    size_t    types_size        = field_count * sizeof(int32_t);
-    ptrdiff_t names_offset      = byte_offset + sizeof(uint32_t);
-    ptrdiff_t types_offset      = byte_offset + sizeof(uint32_t)   + names_size;
-    out_field_info->proto_size  = sizeof(field_count) + names_size + types_size;
-    out_field_info->field_count = field_count;
-    out_field_info->field_names = blob::data_at<uint32_t>(data, names_offset);
-    out_field_info->field_types = blob::data_at< int32_t>(data, types_offset);
+    out_view->data      = NULL;
+    out_view->data_size = 0;
+    out_view->mapping   = NULL;
+    if (!map_file(path, out_view))
+    {
+        return false;
+    }
+    // validate the top-level fields, which must exactly cover the file.
+    size_t offset = 0;
+    while (offset < out_view->data_size)
+    {
+        if (!valid_field(out_view->data, out_view->data_size, offset, 0, &offset))
+        {
+            blob::close_view(out_view);
+            return false;
+        }
+    }
+    return true;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-int32_t blob::generic_object_search(
-    blob::generic_object_t const *object,
-    uint32_t                      field_name,
-    blob::generic_object_field_t *out_field_info)
+void blob::close_view(blob::view_t *view)
 {
-    void   *b_ptr = object->field_values; // base pointer value
-    size_t  b_ofs = 0;                    // base offset value
+#if   CMN_IS_APPLE || CMN_IS_LINUX
+    if (view->data != NULL) munmap(view->data, view->data_size);
+#elif CMN_IS_WINDOWS
+    if (view->data    != NULL) UnmapViewOfFile(view->data);
+    if (view->mapping != NULL) CloseHandle((HANDLE) view->mapping);
+#endif
+    view->data      = NULL;
+    view->data_size = 0;
+    view->mapping   = NULL;
+}
 
-    // generic objects require checking each field in the blob.
-    // this can be inefficient for complex types, since it requires
-    // touching a lot of memory (since fields are variable-length.)
-    for (size_t i = 0; i < object->field_count; ++i)
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t blob::view_field_at(
+    blob::view_t const *view,
+    ptrdiff_t           byte_offset,
+    blob::field_t      *out_field_info)
+{
+    if (byte_offset < 0 || size_t(byte_offset) >= view->data_size)
     {
-        blob::generic_object_field_t field_info = {0};
-        blob::generic_object_field_at(b_ptr, b_ofs, &field_info);
-        if (field_info.field_name == field_name)
-        {
-            if (out_field_info != NULL) *out_field_info = field_info;
-            return  field_info.field_type;
-        }
-        // update our offset to the start of the next field.
-        b_ofs += field_info.total_size;
+        return blob::FIELD_TYPE_NONE;
     }
-    return blob::FIELD_TYPE_NONE;
+    return blob::field_at(view->data, byte_offset, out_field_info);
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-int32_t blob::runtime_object_search(
-    blob::runtime_object_t const *object,
-    uint32_t                      field_name,
-    blob::runtime_object_field_t *out_field_info)
+bool blob::view_array_at(
+    blob::view_t const  *view,
+    ptrdiff_t            byte_offset,
+    blob::array_field_t *out_field_info)
 {
-    uint32_t const *name_list   = object->field_names;
-    size_t          field_count = object->field_count;
-    for (size_t i = 0; i < field_count; ++i)
+    if (byte_offset < 0 || size_t(byte_offset) >= view->data_size)
     {
-        if (name_list[i] == field_name)
-        {
-            blob::runtime_object_field_t field_info = {0};
-            blob::runtime_object_field_at(
-                object->field_values,
-                object->field_offsets[i],
-                &field_info);
-            if (out_field_info  != NULL) *out_field_info = field_info;
-            return  field_info.field_type;
-        }
+        return false;
     }
-    return blob::FIELD_TYPE_NONE;
+    if (blob::read_s32(view->data, byte_offset) != blob::FIELD_TYPE_ARRAY)
+    {
+        return false;
+    }
+    blob::array_field_at(view->data, byte_offset + sizeof(int32_t), out_field_info);
+    return true;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-int32_t blob::prototype_search(
-    blob::prototype_t const *prototype,
-    uint32_t                 field_name)
+bool blob::view_runtime_object_at(
+    blob::view_t const     *view,
+    ptrdiff_t               byte_offset,
+    blob::runtime_object_t *out_field_info)
 {
-    uint32_t const *name_list   = prototype->field_names;
-    size_t          field_count = prototype->field_count;
-    for (size_t i = 0; i < field_count; ++i)
+    if (byte_offset < 0 || size_t(byte_offset) >= view->data_size)
     {
-        if (name_list[i] == field_name) return prototype->field_types[i];
+        return false;
     }
-    return blob::FIELD_TYPE_NONE;
+    if (blob::read_s32(view->data, byte_offset) != blob::FIELD_TYPE_RT_OBJECT)
+    {
+        return false;
+    }
+    blob::runtime_object_at(view->data, byte_offset + sizeof(int32_t), out_field_info);
+    return true;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
@@ -1459,7 +4659,7 @@ size_t blob::write_field_string(
     // substitute an empty string for NULL.
     if (NULL == str) str = "";
     // determine the length of the supplied string, in bytes.
-    while (*str++) ++len;
+    while (str[len]) ++len;
     // write the value as an array of char.
     return blob::write_field_array(
         data,
@@ -1656,6 +4856,201 @@ size_t blob::write_field_prototype(
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+bool blob::builder_init(
+    blob::builder_t     *builder,
+    memory::allocator_t *allocator,
+    size_t               capacity)
+{
+    builder->allocator = allocator;
+    builder->data      = NULL;
+    builder->size      = 0;
+    builder->capacity  = 0;
+    builder->depth     = 0;
+    builder->error     = false;
+    if (capacity > 0)
+    {
+        builder->data  = (uint8_t*) builder_allocate(allocator, capacity);
+        if (NULL == builder->data)
+        {
+            builder->error = true;
+            return false;
+        }
+        builder->capacity = capacity;
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void blob::builder_free(blob::builder_t *builder)
+{
+    builder_release(builder->allocator, builder->data);
+    builder->data     = NULL;
+    builder->size     = 0;
+    builder->capacity = 0;
+    builder->depth    = 0;
+    builder->error    = false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void blob::builder_reset(blob::builder_t *builder)
+{
+    builder->size  = 0;
+    builder->depth = 0;
+    builder->error = false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool blob::builder_value(
+    blob::builder_t *builder,
+    uint32_t         field_name,
+    int32_t          field_type,
+    void const      *field_data)
+{
+    size_t field_size  = blob::field_size_for_type(field_type);
+    size_t size_offset = BUILDER_NO_SIZE;
+    if (field_type <= blob::FIELD_TYPE_NONE || field_type > blob::FIELD_TYPE_MAX ||
+        field_size == BLOB_FIELD_SIZE_VARIABLE)
+    {
+        return builder_fail(builder);
+    }
+    if (!builder_begin_field(builder, field_name, field_type, field_size, &size_offset))
+    {
+        return false;
+    }
+    memcpy(builder->data + builder->size, field_data, field_size);
+    builder->size += field_size;
+    builder_end_field(builder, size_offset);
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool blob::builder_string(
+    blob::builder_t *builder,
+    uint32_t         field_name,
+    char const      *str)
+{
+    size_t size_offset = BUILDER_NO_SIZE;
+    size_t length      = 0;
+    // substitute an empty string for NULL. include the NULL-terminator.
+    if (NULL == str) str = "";
+    length = strlen(str) + 1;
+    if (!builder_begin_field(builder, field_name, blob::FIELD_TYPE_ARRAY, sizeof(uint32_t) * 2 + length, &size_offset))
+    {
+        return false;
+    }
+    builder->size += blob::write_field_array_info(builder->data, builder->size, blob::FIELD_TYPE_CHAR, length);
+    memcpy(builder->data + builder->size, str, length);
+    builder->size += length;
+    builder_end_field(builder, size_offset);
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool blob::builder_begin_array(
+    blob::builder_t *builder,
+    uint32_t         field_name,
+    int32_t          item_type)
+{
+    if (item_type <= blob::FIELD_TYPE_NONE || item_type > blob::FIELD_TYPE_MAX)
+    {
+        return builder_fail(builder);
+    }
+    return builder_push(builder, field_name, blob::FIELD_TYPE_ARRAY, item_type);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool blob::builder_array_data(
+    blob::builder_t *builder,
+    void const      *item_data,
+    size_t           item_count)
+{
+    if (builder->error || 0 == builder->depth)
+    {
+        return builder_fail(builder);
+    }
+    blob::builder_frame_t *frame = &builder->stack[builder->depth - 1];
+    size_t                 size  = blob::field_size_for_type(frame->item_type);
+    if (frame->field_type != blob::FIELD_TYPE_ARRAY || size == BLOB_FIELD_SIZE_VARIABLE)
+    {
+        return builder_fail(builder);
+    }
+    if (size > 0 && item_count > (BLOB_FIELD_OFFSET_INVALID - builder->size) / size)
+    {
+        return builder_fail(builder);
+    }
+    if (!builder_reserve(builder, item_count * size))
+    {
+        return false;
+    }
+    memcpy(builder->data + builder->size, item_data, item_count * size);
+    builder->size     += item_count * size;
+    frame->item_count += uint32_t(item_count);
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool blob::builder_end_array(blob::builder_t *builder)
+{
+    if (builder->error || 0 == builder->depth ||
+        builder->stack[builder->depth - 1].field_type != blob::FIELD_TYPE_ARRAY)
+    {
+        return builder_fail(builder);
+    }
+    blob::builder_frame_t *frame = &builder->stack[--builder->depth];
+    blob::write_u32(builder->data, frame->info_offset, frame->item_count);
+    builder_end_field(builder, frame->size_offset);
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool blob::builder_begin_object(
+    blob::builder_t *builder,
+    uint32_t         field_name)
+{
+    return builder_push(builder, field_name, blob::FIELD_TYPE_GN_OBJECT, 0);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool blob::builder_end_object(blob::builder_t *builder)
+{
+    if (builder->error || 0 == builder->depth ||
+        builder->stack[builder->depth - 1].field_type != blob::FIELD_TYPE_GN_OBJECT)
+    {
+        return builder_fail(builder);
+    }
+    blob::builder_frame_t *frame = &builder->stack[--builder->depth];
+    size_t data_offset = frame->info_offset + sizeof(uint32_t) * 2;
+    blob::write_generic_object_info(builder->data, frame->info_offset, frame->item_count, builder->size - data_offset);
+    builder_end_field(builder, frame->size_offset);
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void* blob::builder_finish(
+    blob::builder_t *builder,
+    size_t          *out_size)
+{
+    if (builder->error || builder->depth > 0)
+    {
+        *out_size = 0;
+        return NULL;
+    }
+    *out_size = builder->size;
+    return builder->data;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 /*/////////////////////////////////////////////////////////////////////////////
 //    $Id$
 ///////////////////////////////////////////////////////////////////////////80*/
@@ -14,6 +14,14 @@
 //   Includes   //
 ////////////////*/
 #include "common.hpp"
+#include "libdisk.hpp"
+
+/*////////////////////////////
+//   Forward Declarations   //
+////////////////////////////*/
+namespace memory {
+class allocator_t;
+}; /* end namespace memory */
 
 /*///////////////////////
 //   Namespace Begin   //
@@ -45,6 +53,40 @@ namespace blob {
 #define BLOB_FIELD_OFFSET_INVALID            0xFFFFFFFFUL
 #endif /* !defined(BLOB_FIELD_OFFSET_INVALID) */
 
+/// The bit set in the field count of a runtime object when the field offsets
+/// are followed by a hashed field index. See blob::FIELD_TYPE_RT_OBJECT.
+#ifndef BLOB_RT_OBJECT_INDEXED
+#define BLOB_RT_OBJECT_INDEXED               0x80000000UL
+#endif /* !defined(BLOB_RT_OBJECT_INDEXED)    */
+
+/// The maximum number of arrays and objects that may be open at once within
+/// a blob::builder_t. The open containers are tracked without allocation.
+#ifndef BLOB_BUILDER_MAX_DEPTH
+#define BLOB_BUILDER_MAX_DEPTH               64
+#endif /* !defined(BLOB_BUILDER_MAX_DEPTH)    */
+
+/// The default number of uncompressed bytes stored in each chunk of a
+/// compressed blob container. Smaller chunks allow finer-grained random
+/// access, at some cost in compression ratio.
+#ifndef BLOB_CHUNK_SIZE_DEFAULT
+#define BLOB_CHUNK_SIZE_DEFAULT              65536
+#endif /* !defined(BLOB_CHUNK_SIZE_DEFAULT)   */
+
+/// The value stored in the first four bytes of a compressed blob container,
+/// 'BLBZ' when read as ASCII. The container header is stored in host byte
+/// order; a byte-swapped value indicates a container from a foreign host.
+#ifndef BLOB_COMPRESSED_MAGIC
+#define BLOB_COMPRESSED_MAGIC                0x5A424C42UL
+#endif /* !defined(BLOB_COMPRESSED_MAGIC)     */
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// The value stored in the first four bytes of a blob patch, 'BLBP' when
+/// read as ASCII. The patch is stored in host byte order.
+#ifndef BLOB_PATCH_MAGIC
+#define BLOB_PATCH_MAGIC                     0x50424C42UL
+#endif /* !defined(BLOB_PATCH_MAGIC)          */
+
 /*/////////////////////////////////////////////////////////////////////////80*/
 
 #ifndef BLOB_ENDIANESS_LSB_FIRST
@@ -140,6 +182,22 @@ enum text_encoding_e
     TEXT_ENCODING_FORCE_32BIT = CMN_FORCE_32BIT
 };
 
+/// An enumeration defining the instruction sets used by the base64 encoder and
+/// decoder. The best instruction set supported by the CPU is selected at
+/// runtime; the scalar implementation is always available.
+enum base64_isa_e
+{
+    /// Process three bytes (four characters) at a time with table lookups.
+    BASE64_ISA_SCALAR         = 0,
+    /// Process 12 bytes (16 characters) at a time using SSSE3.
+    BASE64_ISA_SSSE3          = 1,
+    /// Process 24 bytes (32 characters) at a time using AVX2.
+    BASE64_ISA_AVX2           = 2,
+    /// This type value is unused and serves only to force a minimum of 32-bits
+    /// of storage space for values of this enumeration type.
+    BASE64_ISA_FORCE_32BIT    = CMN_FORCE_32BIT
+};
+
 /// An enumeration defining the types of fields that can be stored in blobs.
 /// The blob field type is stored as a 4-byte integer value within the blob.
 enum field_type_e
@@ -222,6 +280,10 @@ enum field_type_e
     /// followed by the value blob, with each value being stored as a 4-byte
     /// field type identifier, followed by the variable-length field data. The
     /// offsets in field_offsets point to the start of the field type ID.
+    /// If the field count has BLOB_RT_OBJECT_INDEXED set, the field offsets
+    /// are followed by a 4-byte power-of-two slot count and an open-addressed
+    /// hash table of that many 4-byte field indices, with empty slots set to
+    /// BLOB_FIELD_INDEX_INVALID, and then by the value blob.
     FIELD_TYPE_RT_OBJECT      = 24,
     /// The maximum valid field type identifier.
     FIELD_TYPE_MAX            = FIELD_TYPE_RT_OBJECT,
@@ -230,6 +292,32 @@ enum field_type_e
     FIELD_TYPE_FORCE_32BIT    = CMN_FORCE_32BIT
 };
 
+/// Defines the flags that can be passed to the blob::optimize() family of
+/// functions.
+enum optimize_flags_e
+{
+    /// Produce runtime objects without a field index.
+    OPTIMIZE_FLAGS_NONE        = 0,
+    /// Emit a hashed field index for each runtime object, so that
+    /// blob::runtime_object_search() can locate a field in a single probe
+    /// on average, at a cost of 8 to 16 bytes per field.
+    OPTIMIZE_FLAGS_FIELD_INDEX = (1 << 0),
+    /// This type value is unused and serves only to force a minimum of 32-bits
+    /// of storage space for values of this enumeration type.
+    OPTIMIZE_FLAGS_FORCE_32BIT = CMN_FORCE_32BIT
+};
+
+/// Maintains the state of an incremental base64 encoder or decoder, so that
+/// data can be converted in chunks without holding all of it in memory.
+/// Initialize instances with blob::base64_stream_init().
+struct base64_stream_t
+{
+    uint8_t   buffer[4];     /// Input bytes or decoded sextets carried over.
+    size_t    buffer_count;  /// The number of items in buffer.
+    size_t    pad_count;     /// The number of padding characters decoded.
+    size_t    finished;      /// Non-zero once the decoder has seen padding.
+};
+
 /// Represents a single generic field of any type stored within a blob.
 struct field_t
 {
@@ -281,6 +369,8 @@ struct runtime_object_t
     size_t    field_count;   /// The number of fields defined on the type.
     uint32_t *field_names;   /// An array of field_count field identifiers.
     uint32_t *field_offsets; /// An array of byte offsets for field values.
+    uint32_t *field_index;   /// The hashed field index, or NULL.
+    size_t    index_size;    /// The number of slots in field_index.
     void     *field_values;  /// Pointer to the start of field data.
 };
 
@@ -304,6 +394,86 @@ struct prototype_t
     int32_t  *field_types;   /// An array of field_count field types.
 };
 
+/// Describes the work performed by blob::optimize_parallel(). The plan is
+/// produced by blob::optimize_plan(), which sizes the optimized form of each
+/// top-level field, so that the output offsets are known before any data is
+/// converted. Release the plan with blob::free_optimize_plan().
+struct optimize_plan_t
+{
+    void     *blob_src;       /// The source blob.
+    size_t    blob_size;      /// The size of the source blob, in bytes.
+    size_t    optimized_size; /// The size of the optimized blob, in bytes.
+    size_t    thread_count;   /// The number of threads used for conversion.
+    size_t    field_count;    /// The number of top-level fields.
+    void     *field_list;     /// Internal per-field offsets and sizes.
+    int32_t   flags;          /// A combination of blob::optimize_flags_e.
+};
+
+/// Represents a blob file mapped read-only into the address space of the
+/// process. The blob structure is validated once when the view is opened,
+/// after which fields are accessed directly from the mapped pages. Views
+/// of the same file opened by multiple processes share physical memory.
+struct view_t
+{
+    void     *data;          /// The start of the mapped blob data.
+    size_t    data_size;     /// The size of the mapped blob data, in bytes.
+    void     *mapping;       /// The OS file mapping handle, if any.
+};
+
+/// Describes a compressed blob container. A container consists of a 16-byte
+/// header (the magic value, chunk size, chunk count and blob size, each a
+/// 4-byte value), followed by an index of chunk_count entries, each a 4-byte
+/// byte offset and a 4-byte stored size, followed by the chunk data. Every
+/// chunk but the last holds chunk_size bytes of the blob, and is either
+/// LZ-compressed or, if it did not compress, stored as-is.
+struct compressed_info_t
+{
+    size_t    blob_size;      /// The size of the uncompressed blob, in bytes.
+    size_t    chunk_size;     /// The uncompressed size of each chunk.
+    size_t    chunk_count;    /// The number of chunks in the container.
+    size_t    container_size; /// The size of the container, in bytes.
+};
+
+/// Describes a patch produced by blob::diff_blob(). A patch consists of a
+/// 16-byte header, holding the magic value, the old and new blob sizes and
+/// a checksum of the old blob, followed by a sequence of ops. Each op is a
+/// 4-byte tag whose high bit is set for literal data and whose low 31 bits
+/// give the number of bytes produced. Literal data follows its tag; a copy
+/// is followed by the 4-byte offset of the bytes within the old blob.
+struct patch_info_t
+{
+    size_t    old_size;       /// The size of the blob the patch applies to.
+    size_t    new_size;       /// The size of the blob the patch produces.
+    size_t    copy_size;      /// The number of bytes copied from the old blob.
+    size_t    data_size;      /// The number of literal bytes in the patch.
+    size_t    op_count;       /// The number of ops in the patch.
+};
+
+/// Describes an array or generic object that is open within a builder.
+struct builder_frame_t
+{
+    int32_t   field_type;    /// FIELD_TYPE_ARRAY or FIELD_TYPE_GN_OBJECT.
+    int32_t   item_type;     /// The array element type, if an array.
+    uint32_t  item_count;    /// The number of items or fields written.
+    size_t    info_offset;   /// The offset of the array or object info.
+    size_t    size_offset;   /// The offset of the enclosing field size, if any.
+};
+
+/// Writes a generic blob in a single pass. Fields are appended to a growable
+/// buffer, and the counts and sizes of arrays and objects are written back
+/// when each one is closed, so they need not be known up front. If any call
+/// fails, the builder enters an error state and all further calls fail.
+struct builder_t
+{
+    memory::allocator_t *allocator; /// The allocator, or NULL for the CRT heap.
+    uint8_t             *data;      /// The blob data written so far.
+    size_t               size;      /// The number of bytes written.
+    size_t               capacity;  /// The number of bytes allocated.
+    size_t               depth;     /// The number of open containers.
+    bool                 error;     /// true if any operation has failed.
+    builder_frame_t      stack[BLOB_BUILDER_MAX_DEPTH];
+};
+
 /// Given four bytes possibly representing a Unicode byte-order-marker
 /// attempts to determine the text encoding and actual size of the BOM.
 ///
@@ -395,6 +565,83 @@ CMN_PUBLIC extern size_t base64_decode(
     void       *output,
     size_t      output_size);
 
+/// Selects the instruction set used by the base64 encoder and decoder and by
+/// the blob::swap_array_16() family of functions. By default, the best
+/// instruction set supported by the CPU is used; this function is intended
+/// for testing and benchmarking.
+///
+/// @param max_isa One of blob::base64_isa_e specifying the best instruction
+/// set that may be used.
+/// @return The instruction set that will be used, which is the lesser of
+/// @a max_isa and the best instruction set supported by the CPU.
+CMN_PUBLIC int32_t base64_select_isa(int32_t max_isa);
+
+/// Initializes the state of an incremental base64 encoder or decoder.
+///
+/// @param stream The stream state to initialize.
+CMN_PUBLIC void base64_stream_init(blob::base64_stream_t *stream);
+
+/// Computes the maximum number of bytes written by a single call to either
+/// blob::base64_encode_update() or blob::base64_decode_update().
+///
+/// @param input_size The number of bytes of input passed to the call.
+/// @return The number of bytes the output buffer must be able to hold.
+CMN_PUBLIC size_t base64_stream_size(size_t input_size);
+
+/// Base64-encodes the next chunk of a block of arbitrary data. Input bytes
+/// that do not form a complete three-byte group are carried over to the next
+/// call. No NULL terminator is written.
+///
+/// @param stream The encoder state.
+/// @param input Pointer to the start of the input data.
+/// @param input_size The number of bytes of input data to encode.
+/// @param output Pointer to the start of the output buffer.
+/// @param output_size The maximum number of bytes that can be written to
+/// the output buffer. This value must be at least as large as the value
+/// returned by blob::base64_stream_size() for @a input_size.
+/// @return The number of bytes written to the output buffer. If the output
+/// buffer is too small, no input is consumed and zero is returned.
+CMN_PUBLIC size_t base64_encode_update(
+    blob::base64_stream_t *stream,
+    void const            *input,
+    size_t                 input_size,
+    char                  *output,
+    size_t                 output_size);
+
+/// Completes an incremental base64 encoding by writing the final group of
+/// characters and any padding. No NULL terminator is written.
+///
+/// @param stream The encoder state.
+/// @param output Pointer to the start of the output buffer.
+/// @param output_size The maximum number of bytes that can be written to
+/// the output buffer. At most four bytes are written.
+/// @return The number of bytes written to the output buffer.
+CMN_PUBLIC size_t base64_encode_final(
+    blob::base64_stream_t *stream,
+    char                  *output,
+    size_t                 output_size);
+
+/// Decodes the next chunk of a base64-encoded block of text. Characters that
+/// do not form a complete four-character group are carried over to the next
+/// call. Characters outside of the base64 alphabet are skipped, and decoding
+/// stops at the group containing padding characters.
+///
+/// @param stream The decoder state.
+/// @param input Pointer to the start of the base64-encoded input data.
+/// @param input_size The number of bytes of input data to decode.
+/// @param output Pointer to the start of the output buffer.
+/// @param output_size The maximum number of bytes that can be written to
+/// the output buffer. This value must be at least as large as the value
+/// returned by blob::base64_stream_size() for @a input_size.
+/// @return The number of bytes written to the output buffer. If the output
+/// buffer is too small, no input is consumed and zero is returned.
+CMN_PUBLIC size_t base64_decode_update(
+    blob::base64_stream_t *stream,
+    char const            *input,
+    size_t                 input_size,
+    void                  *output,
+    size_t                 output_size);
+
 /// Examines the value stored in an integer to determine the smallest field
 /// type that can store the value without loss of information within a blob.
 ///
@@ -440,21 +687,92 @@ CMN_PUBLIC size_t field_size_for_type(int32_t field_type);
 /// or other variable-length type.
 CMN_PUBLIC size_t total_size_for_type(int32_t field_type);
 
+/// Computes the number of bytes written by blob::optimize() for a given
+/// source blob. Without blob::OPTIMIZE_FLAGS_FIELD_INDEX this is never more
+/// than the size of the source blob.
+///
+/// @param blob_src A pointer to the source blob.
+/// @param blob_size The total size of the source blob, in bytes.
+/// @param flags A combination of blob::optimize_flags_e.
+/// @return The size of the optimized blob, in bytes.
+CMN_PUBLIC size_t optimized_size(
+    void     *blob_src,
+    size_t    blob_size,
+    int32_t   flags = blob::OPTIMIZE_FLAGS_NONE);
+
 /// Copies one blob into another storage location, optimizing any raw object
 /// fields for efficient runtime performance. The source and destination
 /// pointers must not overlap.
 ///
 /// @param blob_dst A pointer to the destination blob. This memory block should
-/// be at least @a blob_size bytes.
+/// be at least blob::optimized_size() bytes.
 /// @param blob_src A pointer to the source blob. This memory block should be
 /// at least @a blob_size bytes.
 /// @param blob_size The total size of the blob, in bytes.
-/// @return The number of bytes consumed from @a blob_src and written to
-/// @a blob_dst.
+/// @param flags A combination of blob::optimize_flags_e.
+/// @return The number of bytes written to @a blob_dst.
 CMN_PUBLIC size_t optimize(
     void * CMN_RESTRICT blob_dst,
     void * CMN_RESTRICT blob_src,
-    size_t              blob_size);
+    size_t              blob_size,
+    int32_t             flags = blob::OPTIMIZE_FLAGS_NONE);
+
+/// Performs the first pass of a parallel optimization, computing the
+/// optimized size of every top-level field of a blob. Fields are sized on
+/// up to @a thread_count threads.
+///
+/// @param blob_src A pointer to the source blob. The blob must remain valid
+/// and unmodified until the plan is released.
+/// @param blob_size The total size of the source blob, in bytes.
+/// @param thread_count The maximum number of threads to use, including the
+/// calling thread, or zero to use one thread per processor.
+/// @param flags A combination of blob::optimize_flags_e.
+/// @param out_plan On return, this structure describes the work to perform.
+/// The optimized_size field specifies the destination buffer size.
+/// @return true if the plan was created, or false if memory allocation failed.
+CMN_PUBLIC bool optimize_plan(
+    void                  *blob_src,
+    size_t                 blob_size,
+    size_t                 thread_count,
+    int32_t                flags,
+    blob::optimize_plan_t *out_plan);
+
+/// Performs the second pass of a parallel optimization. Independent top-level
+/// arrays and objects are converted concurrently into their pre-computed
+/// locations within the destination blob. The output is identical to that
+/// of blob::optimize().
+///
+/// @param blob_dst A pointer to the destination blob. This memory block must
+/// be at least plan->optimized_size bytes and must not overlap the source.
+/// @param plan The plan returned by blob::optimize_plan().
+/// @return The number of bytes written to @a blob_dst.
+CMN_PUBLIC size_t optimize_parallel(
+    void                        *blob_dst,
+    blob::optimize_plan_t const *plan);
+
+/// Releases the resources associated with a parallel optimization plan.
+///
+/// @param plan The plan to release. On return, the structure is zeroed.
+CMN_PUBLIC void free_optimize_plan(blob::optimize_plan_t *plan);
+
+/// Optimizes a blob stored in a file, writing the result to another file.
+/// Only one top-level field is held in memory at a time, so blobs much
+/// larger than the available memory can be processed, provided that no
+/// single top-level field is.
+///
+/// @param dst The file to write the optimized blob to, opened for writing.
+/// @param src The file to read the source blob from, opened for reading and
+/// positioned at the start of the blob. The blob extends to the end of file.
+/// @param flags A combination of blob::optimize_flags_e.
+/// @param out_size If non-NULL, on return this location is updated with the
+/// number of bytes written to @a dst.
+/// @return true if the entire blob was optimized, or false if a read or write
+/// failed, memory could not be allocated, or the source blob is malformed.
+CMN_PUBLIC bool optimize_stream(
+    disk::file_t  dst,
+    disk::file_t  src,
+    int32_t       flags,
+    uint64_t     *out_size);
 
 /// Performs a copy-and-optimize operation on an unoptimized blob array field.
 /// This is primarily an internal function used by blob::optimize().
@@ -465,13 +783,14 @@ CMN_PUBLIC size_t optimize(
 /// @param blob_src_offset The current byte offset into the source blob. This
 /// should be the byte offset of a blob::field_type_e constant with the value
 /// blob::FIELD_TYPE_ARRAY.
-/// @return The number of bytes consumed from @a blob_src and written to
-/// @a blob_dst.
+/// @param flags A combination of blob::optimize_flags_e.
+/// @return The number of bytes written to @a blob_dst.
 CMN_PUBLIC size_t optimize_array_field(
     void * CMN_RESTRICT blob_dst,
     ptrdiff_t           blob_dst_offset,
     void * CMN_RESTRICT blob_src,
-    ptrdiff_t           blob_src_offset);
+    ptrdiff_t           blob_src_offset,
+    int32_t             flags = blob::OPTIMIZE_FLAGS_NONE);
 
 /// Performs a copy-and-optimize operation on an unoptimized blob object field.
 /// This is primarily an internal function used by blob::optimize().
@@ -482,13 +801,14 @@ CMN_PUBLIC size_t optimize_array_field(
 /// @param blob_src_offset The current byte offset into the source blob. This
 /// should be the byte offset of a blob::field_type_e constant with the value
 /// blob::FIELD_TYPE_GN_OBJECT.
-/// @return The number of bytes consumed from @a blob_src and written to
-/// @a blob_dst.
+/// @param flags A combination of blob::optimize_flags_e.
+/// @return The number of bytes written to @a blob_dst.
 CMN_PUBLIC size_t optimize_object_field(
     void * CMN_RESTRICT blob_dst,
     ptrdiff_t           blob_dst_offset,
     void * CMN_RESTRICT blob_src,
-    ptrdiff_t           blob_src_offset);
+    ptrdiff_t           blob_src_offset,
+    int32_t             flags = blob::OPTIMIZE_FLAGS_NONE);
 
 /// Computes the size of a field value stored within a data blob. This function
 /// computes valid values for both fixed and variable-length field types. Only
@@ -693,10 +1013,9 @@ CMN_PUBLIC int32_t generic_object_search(
     blob::generic_object_field_t *out_field_info);
 
 /// Searches an object instance encoded within a data blob for a named field.
-/// This is a generic implementation that does not take advantage of any
-/// application-specific data organization. For example, the application might
-/// sort the field_names of the object. It could then use a binary search to
-/// locate fields instead of this simple linear search.
+/// If the object has a hashed field index (see blob::OPTIMIZE_FLAGS_FIELD_INDEX)
+/// the field is located by probing the index; otherwise the field names are
+/// searched linearly.
 ///
 /// @param object The information about the object to search.
 /// @param field_name The integer name of the field to search for.
@@ -725,6 +1044,293 @@ CMN_PUBLIC int32_t prototype_search(
     blob::prototype_t const *prototype,
     uint32_t                 field_name);
 
+/// Determines whether a field stored within a data block is well-formed; that
+/// is, whether its type is valid and it, along with any nested array items,
+/// object fields and prototype entries, lies entirely within the data block.
+/// The fields of a runtime object must be stored in the order listed in its
+/// field_offsets array. Each field of a generic object is checked against
+/// both the object's declared data size and its own declared size, which its
+/// body must exactly fill. Once this function returns true, the field can be
+/// safely accessed with the blob::field_at() family of functions.
+///
+/// @param data A pointer to the data block to read from.
+/// @param data_size The size of the data block, in bytes.
+/// @param byte_offset The byte offset of the field to check within the blob.
+/// @return true if the field is well-formed and in bounds.
+CMN_PUBLIC bool field_offset_valid(
+    void      *data,
+    size_t     data_size,
+    ptrdiff_t  byte_offset);
+
+/// Reverses the byte order of each element of an array of 16-bit values.
+///
+/// @param dst The destination array. This may be the same as @a src to swap
+/// in place, but the arrays must not otherwise overlap.
+/// @param src The source array.
+/// @param count The number of elements to swap.
+CMN_PUBLIC void swap_array_16(void *dst, void const *src, size_t count);
+
+/// Reverses the byte order of each element of an array of 32-bit values.
+///
+/// @param dst The destination array. This may be the same as @a src to swap
+/// in place, but the arrays must not otherwise overlap.
+/// @param src The source array.
+/// @param count The number of elements to swap.
+CMN_PUBLIC void swap_array_32(void *dst, void const *src, size_t count);
+
+/// Reverses the byte order of each element of an array of 64-bit values.
+///
+/// @param dst The destination array. This may be the same as @a src to swap
+/// in place, but the arrays must not otherwise overlap.
+/// @param src The source array.
+/// @param count The number of elements to swap.
+CMN_PUBLIC void swap_array_64(void *dst, void const *src, size_t count);
+
+/// Converts a blob written on a host with a different byte order to the byte
+/// order of the current host, in place. Every field type, count, size, name
+/// and offset is swapped, along with every value; vector and matrix values
+/// are swapped per component, and arrays of fixed-length values are swapped
+/// in bulk. The structure is bounds-checked as it is converted.
+///
+/// @param data A pointer to the blob data to convert.
+/// @param data_size The size of the blob data, in bytes.
+/// @param blob_endianess One of BLOB_ENDIANESS_LSB_FIRST or
+/// BLOB_ENDIANESS_MSB_FIRST, specifying the byte order of the blob. If this
+/// matches BLOB_SYSTEM_ENDIANESS, the blob is not modified.
+/// @return true if the blob was converted. If the blob is malformed, false is
+/// returned and the blob contents are partially converted.
+CMN_PUBLIC bool normalize_endianess(
+    void    *data,
+    size_t   data_size,
+    int32_t  blob_endianess);
+
+/// Computes the maximum size of a compressed blob container.
+///
+/// @param blob_size The size of the blob to compress, in bytes.
+/// @param chunk_size The number of uncompressed bytes in each chunk.
+/// @return The maximum number of bytes written by blob::compress_blob().
+CMN_PUBLIC size_t compressed_bound(
+    size_t blob_size,
+    size_t chunk_size = BLOB_CHUNK_SIZE_DEFAULT);
+
+/// Compresses a blob into a container of independently compressed chunks,
+/// using a fast in-tree LZ codec.
+///
+/// @param dst The buffer to write the container to.
+/// @param dst_size The size of @a dst, in bytes. Use blob::compressed_bound()
+/// to determine the required size.
+/// @param src The blob data to compress.
+/// @param src_size The size of the blob data, in bytes. This must be less
+/// than 4GB.
+/// @param chunk_size The number of uncompressed bytes in each chunk.
+/// @return The number of bytes written to @a dst, or zero if @a dst is too
+/// small or the arguments are invalid.
+CMN_PUBLIC size_t compress_blob(
+    void       *dst,
+    size_t      dst_size,
+    void const *src,
+    size_t      src_size,
+    size_t      chunk_size = BLOB_CHUNK_SIZE_DEFAULT);
+
+/// Reads and validates the header and chunk index of a compressed blob
+/// container. The chunk data is not checked until it is decompressed.
+///
+/// @param container The container data.
+/// @param container_size The number of bytes of container data available.
+/// @param out_info On return, this location is updated with the container
+/// attributes.
+/// @return true if the header and chunk index are well-formed.
+CMN_PUBLIC bool compressed_info(
+    void const              *container,
+    size_t                   container_size,
+    blob::compressed_info_t *out_info);
+
+/// Decompresses a single chunk of a compressed blob container.
+///
+/// @param dst The buffer to write the chunk to.
+/// @param dst_size The size of @a dst, in bytes. This must be at least
+/// chunk_size bytes, or the remainder of the blob for the last chunk.
+/// @param container The container data.
+/// @param container_size The size of the container data, in bytes.
+/// @param chunk_index The zero-based index of the chunk to decompress. The
+/// chunk begins at byte chunk_index * chunk_size of the blob.
+/// @return true if the chunk was decompressed; false if the index is out of
+/// range, the chunk does not fit in @a dst or the chunk data is corrupt.
+CMN_PUBLIC bool decompress_chunk(
+    void       *dst,
+    size_t      dst_size,
+    void const *container,
+    size_t      container_size,
+    size_t      chunk_index);
+
+/// Decompresses a byte range of a blob from a compressed container, only
+/// decompressing the chunks that the range overlaps.
+///
+/// @param dst The buffer to write the range to.
+/// @param dst_size The size of @a dst, in bytes; at least @a amount.
+/// @param container The container data.
+/// @param container_size The size of the container data, in bytes.
+/// @param offset The byte offset of the range within the blob.
+/// @param amount The number of bytes to decompress.
+/// @return true if the range was decompressed; false if the range is outside
+/// of the blob, does not fit in @a dst or overlaps a corrupt chunk.
+CMN_PUBLIC bool decompress_range(
+    void       *dst,
+    size_t      dst_size,
+    void const *container,
+    size_t      container_size,
+    size_t      offset,
+    size_t      amount);
+
+/// Decompresses an entire blob from a compressed container, distributing the
+/// chunks across multiple threads.
+///
+/// @param dst The buffer to write the blob to.
+/// @param dst_size The size of @a dst, in bytes. This must be at least the
+/// blob_size reported by blob::compressed_info().
+/// @param container The container data.
+/// @param container_size The size of the container data, in bytes.
+/// @param thread_count The number of threads to use, including the calling
+/// thread, or zero to use one thread per processor.
+/// @return true if every chunk was decompressed; false if the blob does not
+/// fit in @a dst or any chunk is corrupt.
+CMN_PUBLIC bool decompress_blob(
+    void       *dst,
+    size_t      dst_size,
+    void const *container,
+    size_t      container_size,
+    size_t      thread_count = 0);
+
+/// Computes the size of the patch that blob::diff_blob() would produce.
+///
+/// @param old_blob The blob being updated.
+/// @param old_size The size of the old blob, in bytes.
+/// @param new_blob The updated blob.
+/// @param new_size The size of the new blob, in bytes.
+/// @return The size of the patch, in bytes, or zero if either blob is not a
+/// well-formed sequence of fields.
+CMN_PUBLIC size_t diff_size(
+    void const *old_blob,
+    size_t      old_size,
+    void const *new_blob,
+    size_t      new_size);
+
+/// Computes a structural difference between two blobs, each a sequence of
+/// top-level fields. Fields, array items and object fields are compared in
+/// step; unchanged runs are copied from the old blob, changed fields are
+/// compared recursively, and array ranges inserted into or removed from the
+/// new blob are written as literal data or omitted, so the patch size is
+/// proportional to the size of the change.
+///
+/// @param dst The buffer to write the patch to.
+/// @param dst_size The maximum number of bytes that can be written to dst.
+/// @param old_blob The blob being updated.
+/// @param old_size The size of the old blob, in bytes.
+/// @param new_blob The updated blob.
+/// @param new_size The size of the new blob, in bytes.
+/// @return The number of bytes written to dst, or zero if either blob is not
+/// well-formed or dst is too small.
+CMN_PUBLIC size_t diff_blob(
+    void       *dst,
+    size_t      dst_size,
+    void const *old_blob,
+    size_t      old_size,
+    void const *new_blob,
+    size_t      new_size);
+
+/// Reads and checks the header and ops of a blob patch.
+///
+/// @param patch The patch data.
+/// @param patch_size The size of the patch data, in bytes.
+/// @param out_info On return, describes the patch.
+/// @return true if the patch is well-formed.
+CMN_PUBLIC bool patch_info(
+    void const         *patch,
+    size_t              patch_size,
+    blob::patch_info_t *out_info);
+
+/// Rebuilds a blob from the blob it was diffed against and a patch.
+///
+/// @param dst The buffer to write the new blob to, of at least the new_size
+/// reported by blob::patch_info(). This must not overlap the old blob.
+/// @param dst_size The maximum number of bytes that can be written to dst.
+/// @param old_blob The blob the patch was computed against.
+/// @param old_size The size of the old blob, in bytes.
+/// @param patch The patch data.
+/// @param patch_size The size of the patch data, in bytes.
+/// @return true if the new blob was written; false if the patch is corrupt
+/// or was not computed against the old blob.
+CMN_PUBLIC bool apply_patch(
+    void       *dst,
+    size_t      dst_size,
+    void const *old_blob,
+    size_t      old_size,
+    void const *patch,
+    size_t      patch_size);
+
+/// Maps a blob file into memory for read-only access and validates each top-
+/// level field stored within it using blob::field_offset_valid(). No data is
+/// copied; pages are loaded on demand and shared with any other process
+/// that maps the same file.
+///
+/// @param path A NULL-terminated string specifying the path of the blob file.
+/// @param out_view On return, this structure describes the mapped blob. The
+/// structure is zeroed if an error occurs.
+/// @return true if the file was mapped and contains a valid blob, or false if
+/// the file could not be mapped or the blob is malformed.
+CMN_PUBLIC bool open_view(char const *path, blob::view_t *out_view);
+
+/// Unmaps a blob file previously mapped with blob::open_view(). All pointers
+/// into the view are invalidated.
+///
+/// @param view The view to close. On return, the structure is zeroed.
+CMN_PUBLIC void close_view(blob::view_t *view);
+
+/// Populates a simple structure representing a top-level field within a
+/// mapped blob. The returned field_data points into the mapped pages and
+/// must not be written to.
+///
+/// @param view The view to read from.
+/// @param byte_offset The byte offset of the field within the view, either
+/// zero or the offset of a previous field plus its total_size.
+/// @param out_field_info On return, this location is updated with information
+/// describing the field.
+/// @return One of blob::field_type_e indicating the field type, or the value
+/// blob::FIELD_TYPE_NONE if @a byte_offset is at or past the end of the view.
+CMN_PUBLIC int32_t view_field_at(
+    blob::view_t const *view,
+    ptrdiff_t           byte_offset,
+    blob::field_t      *out_field_info);
+
+/// Populates a simple structure representing a top-level array field within
+/// a mapped blob.
+///
+/// @param view The view to read from.
+/// @param byte_offset The byte offset of the field within the view, either
+/// zero or the offset of a previous field plus its total_size.
+/// @param out_field_info On return, this location is updated with information
+/// describing the array.
+/// @return true if @a byte_offset specifies an array field.
+CMN_PUBLIC bool view_array_at(
+    blob::view_t const  *view,
+    ptrdiff_t            byte_offset,
+    blob::array_field_t *out_field_info);
+
+/// Populates a simple structure representing a top-level runtime object
+/// within a mapped blob. The object can be searched with
+/// blob::runtime_object_search().
+///
+/// @param view The view to read from.
+/// @param byte_offset The byte offset of the field within the view, either
+/// zero or the offset of a previous field plus its total_size.
+/// @param out_field_info On return, this location is updated with information
+/// describing the object.
+/// @return true if @a byte_offset specifies a runtime object field.
+CMN_PUBLIC bool view_runtime_object_at(
+    blob::view_t const     *view,
+    ptrdiff_t               byte_offset,
+    blob::runtime_object_t *out_field_info);
+
 /// Writes a boolean value to a data block. The value is preceeded by the
 /// 4-byte field type, and is written as an unsigned 8-bit integer with a value
 /// of either 0 (false) or 1 (true).
@@ -1103,6 +1709,116 @@ CMN_PUBLIC size_t write_field_prototype(
     uint32_t * CMN_RESTRICT field_names,
     int32_t  * CMN_RESTRICT field_types);
 
+/// Initializes a blob builder and reserves its initial buffer.
+///
+/// @param builder The builder to initialize.
+/// @param allocator The allocator used for the blob buffer, or NULL to use
+/// the C runtime heap. The allocator must outlive the builder.
+/// @param capacity The initial buffer size, in bytes. The buffer doubles in
+/// size whenever it fills up.
+/// @return true if the buffer was allocated.
+CMN_PUBLIC bool builder_init(
+    blob::builder_t     *builder,
+    memory::allocator_t *allocator,
+    size_t               capacity = 4096);
+
+/// Releases the buffer owned by a blob builder.
+///
+/// @param builder The builder to release.
+CMN_PUBLIC void builder_free(blob::builder_t *builder);
+
+/// Discards the blob written to a builder and clears any error, keeping the
+/// buffer for reuse.
+///
+/// @param builder The builder to reset.
+CMN_PUBLIC void builder_reset(blob::builder_t *builder);
+
+/// Writes a fixed-length field. At the top level, the field type and value
+/// are written. Within a generic object, the field is written with the
+/// specified name. Within an array, only the value is written, and the type
+/// must match the element type of the array.
+///
+/// @param builder The builder to write to.
+/// @param field_name The field name, if the field is written to an object.
+/// @param field_type One of blob::field_type_e. This must specify a
+/// fixed-length type.
+/// @param field_data Pointer to the field value. The number of bytes copied
+/// is determined by @a field_type.
+/// @return true if the field was written.
+CMN_PUBLIC bool builder_value(
+    blob::builder_t *builder,
+    uint32_t         field_name,
+    int32_t          field_type,
+    void const      *field_data);
+
+/// Writes a NULL-terminated string as an array of FIELD_TYPE_CHAR.
+///
+/// @param builder The builder to write to.
+/// @param field_name The field name, if the field is written to an object.
+/// @param str The string to write. NULL is written as an empty string.
+/// @return true if the field was written.
+CMN_PUBLIC bool builder_string(
+    blob::builder_t *builder,
+    uint32_t         field_name,
+    char const      *str);
+
+/// Opens an array field. Subsequent values are written as elements of the
+/// array until blob::builder_end_array() is called.
+///
+/// @param builder The builder to write to.
+/// @param field_name The field name, if the array is written to an object.
+/// @param item_type One of blob::field_type_e specifying the element type.
+/// @return true if the array was opened.
+CMN_PUBLIC bool builder_begin_array(
+    blob::builder_t *builder,
+    uint32_t         field_name,
+    int32_t          item_type);
+
+/// Appends tightly-packed elements to the innermost open array, which must
+/// have a fixed-length element type.
+///
+/// @param builder The builder to write to.
+/// @param item_data Pointer to the element data.
+/// @param item_count The number of elements to copy from @a item_data.
+/// @return true if the elements were written.
+CMN_PUBLIC bool builder_array_data(
+    blob::builder_t *builder,
+    void const      *item_data,
+    size_t           item_count);
+
+/// Closes the innermost open array, writing its element count.
+///
+/// @param builder The builder to write to.
+/// @return true if an array was open and has been closed.
+CMN_PUBLIC bool builder_end_array(blob::builder_t *builder);
+
+/// Opens a generic object field. Subsequent values are written as fields
+/// of the object until blob::builder_end_object() is called.
+///
+/// @param builder The builder to write to.
+/// @param field_name The field name, if the object is written to an object.
+/// @return true if the object was opened.
+CMN_PUBLIC bool builder_begin_object(
+    blob::builder_t *builder,
+    uint32_t         field_name);
+
+/// Closes the innermost open object, writing its field count and size.
+///
+/// @param builder The builder to write to.
+/// @return true if an object was open and has been closed.
+CMN_PUBLIC bool builder_end_object(blob::builder_t *builder);
+
+/// Retrieves the completed blob. The data remains owned by the builder.
+///
+/// @param builder The builder to query.
+/// @param out_size On return, this location is updated with the size of
+/// the blob, in bytes.
+/// @return A pointer to the blob data, or NULL if an error occurred or any
+/// array or object is still open.
+CMN_PUBLIC void* builder_finish(
+    blob::builder_t *builder,
+    size_t          *out_size);
+
 /// Performs runtime detection of the endianess (byte ordering) of the host
 /// system.
 ///
@@ -2159,6 +2875,189 @@ inline bool field_offset_valid(ptrdiff_t byte_offset, size_t max_size)
     return (offset < max_size && offset < BLOB_FIELD_OFFSET_INVALID);
 }
 
+/// Maps a C++ value type onto the blob::field_type_e constant used to store
+/// it. Only fixed-length types have a mapping; vectors are represented as
+/// float[N] and matrices as float[Rows][Columns]. Instantiating the template
+/// with an unsupported type produces a compile-time error.
+template <typename T> struct field_type_of;
+template<> struct field_type_of<bool>           { enum { value = FIELD_TYPE_BOOLEAN     }; };
+template<> struct field_type_of<char>           { enum { value = FIELD_TYPE_CHAR        }; };
+template<> struct field_type_of<int8_t>         { enum { value = FIELD_TYPE_SINT8       }; };
+template<> struct field_type_of<uint8_t>        { enum { value = FIELD_TYPE_UINT8       }; };
+template<> struct field_type_of<int16_t>        { enum { value = FIELD_TYPE_SINT16      }; };
+template<> struct field_type_of<uint16_t>       { enum { value = FIELD_TYPE_UINT16      }; };
+template<> struct field_type_of<int32_t>        { enum { value = FIELD_TYPE_SINT32      }; };
+template<> struct field_type_of<uint32_t>       { enum { value = FIELD_TYPE_UINT32      }; };
+template<> struct field_type_of<int64_t>        { enum { value = FIELD_TYPE_SINT64      }; };
+template<> struct field_type_of<uint64_t>       { enum { value = FIELD_TYPE_UINT64      }; };
+template<> struct field_type_of<float>          { enum { value = FIELD_TYPE_FLOAT32     }; };
+template<> struct field_type_of<double>         { enum { value = FIELD_TYPE_FLOAT64     }; };
+template<> struct field_type_of<float[2]>       { enum { value = FIELD_TYPE_VECTOR_2F   }; };
+template<> struct field_type_of<float[3]>       { enum { value = FIELD_TYPE_VECTOR_3F   }; };
+template<> struct field_type_of<float[4]>       { enum { value = FIELD_TYPE_VECTOR_4F   }; };
+template<> struct field_type_of<float[2][2]>    { enum { value = FIELD_TYPE_MATRIX_2X2F }; };
+template<> struct field_type_of<float[3][3]>    { enum { value = FIELD_TYPE_MATRIX_3X3F }; };
+template<> struct field_type_of<float[3][4]>    { enum { value = FIELD_TYPE_MATRIX_3X4F }; };
+template<> struct field_type_of<float[4][4]>    { enum { value = FIELD_TYPE_MATRIX_4X4F }; };
+
+/// Describes a single field of a compile-time schema. The field name is the
+/// 32-bit identifier stored in the blob, typically the value produced by
+/// hash::generate_name() for the field name string, and the index is the
+/// position of the field within the schema's field list.
+///
+/// @tparam T The C++ type of the field value. See blob::field_type_of.
+/// @tparam Name The 32-bit field identifier.
+/// @tparam Index The zero-based position of the field in the field list.
+template <typename T, uint32_t Name, size_t Index>
+struct schema_field_t
+{
+    typedef T value_type;
+    static uint32_t const name  = Name;
+    static size_t   const index = Index;
+    enum { type = field_type_of<T>::value };
+};
+
+template <typename T, uint32_t Name, size_t Index>
+uint32_t const schema_field_t<T, Name, Index>::name;
+
+template <typename T, uint32_t Name, size_t Index>
+size_t   const schema_field_t<T, Name, Index>::index;
+
+/// Terminates a schema field list.
+struct schema_end_t
+{
+    /* empty */
+};
+
+/// Defines a compile-time list of schema fields as a chain of nodes, each
+/// holding one blob::schema_field_t and the remainder of the list. A schema
+/// is any type declaring a nested typedef named fields; for example:
+///
+///     struct transform_schema
+///     {
+///         typedef blob::schema_field_t<float[3], 0x8C2F3A51U, 0> position;
+///         typedef blob::schema_field_t<float[4], 0x1D4E0B77U, 1> orientation;
+///         typedef blob::schema_list_t<position,
+///                 blob::schema_list_t<orientation> > fields;
+///     };
+template <typename Field, typename Next = schema_end_t>
+struct schema_list_t
+{
+    typedef Field head;
+    typedef Next  tail;
+};
+
+/// Computes the number of fields in a blob::schema_list_t at compile time.
+template <typename List>
+struct schema_length
+{
+    enum { value = 1 + schema_length<typename List::tail>::value };
+};
+
+template <>
+struct schema_length<schema_end_t>
+{
+    enum { value = 0 };
+};
+
+/// Provides typed access to the fields of a runtime object that conforms to
+/// a compile-time schema. The accessor is bound to an object once, with
+/// blob::schema_bind(), after which each field read is a direct load from a
+/// stored offset, with no search and no type dispatch.
+///
+/// @tparam Schema A type declaring a nested blob::schema_list_t typedef named
+/// fields.
+template <typename Schema>
+struct schema_object_t
+{
+    typedef typename Schema::fields field_list;
+    enum { field_count = schema_length<field_list>::value };
+
+    uint8_t  *values;                /// The field_values of the bound object.
+    uint32_t  offsets[field_count];  /// Byte offsets of the field data.
+
+    /// Retrieves a field value from the bound object.
+    ///
+    /// @tparam Field One of the blob::schema_field_t types listed by Schema.
+    /// @return A reference to the field value within the blob.
+    template <typename Field>
+    inline typename Field::value_type const& get(void) const
+    {
+        return *(typename Field::value_type const*) (values + offsets[Field::index]);
+    }
+
+    /// Retrieves a modifiable field value from the bound object.
+    ///
+    /// @tparam Field One of the blob::schema_field_t types listed by Schema.
+    /// @return A reference to the field value within the blob.
+    template <typename Field>
+    inline typename Field::value_type& ref(void)
+    {
+        return *(typename Field::value_type*) (values + offsets[Field::index]);
+    }
+};
+
+/// Fails to compile when a schema field is listed out of index order.
+template <bool IndexMatches> struct schema_index_check;
+template <> struct schema_index_check<true> { /* empty */ };
+
+/// Implements blob::schema_bind() by walking the field list at compile time.
+/// Each field is located with blob::runtime_object_search() and must have
+/// the declared type and size; its data offset is then recorded.
+template <typename List, size_t Index>
+struct schema_binder
+{
+    static bool bind(blob::runtime_object_t const *object, uint32_t *offsets)
+    {
+        typedef typename List::head       field;
+        typedef typename field::value_type value_type;
+        // fields must be listed in index order; anything else fails to compile.
+        (void) sizeof(schema_index_check<field::index == Index>);
+        blob::runtime_object_field_t info;
+        if (blob::runtime_object_search(object, field::name, &info) != int32_t(field::type) ||
+            info.field_size != sizeof(value_type))
+        {
+            return false;
+        }
+        offsets[Index] = uint32_t(((uint8_t*) info.field_data) - ((uint8_t*) object->field_values));
+        return schema_binder<typename List::tail, Index + 1>::bind(object, offsets);
+    }
+};
+
+template <size_t Index>
+struct schema_binder<schema_end_t, Index>
+{
+    static bool bind(blob::runtime_object_t const *object, uint32_t *offsets)
+    {
+        CMN_UNUSED(object);
+        CMN_UNUSED(offsets);
+        return true;
+    }
+};
+
+/// Binds a schema accessor to a runtime object, verifying that every field
+/// listed by the schema is present with the expected type and size. This is
+/// performed once, typically when the blob is loaded.
+///
+/// @param object The runtime object to bind to.
+/// @param out_accessor The accessor to bind. On failure, the accessor is
+/// left unbound and must not be used to read field values.
+/// @return true if every schema field was found with the expected type.
+template <typename Schema>
+inline bool schema_bind(
+    blob::runtime_object_t const    *object,
+    blob::schema_object_t<Schema>   *out_accessor)
+{
+    typedef typename blob::schema_object_t<Schema>::field_list field_list;
+    out_accessor->values = (uint8_t*) object->field_values;
+    if (!schema_binder<field_list, 0>::bind(object, out_accessor->offsets))
+    {
+        out_accessor->values = NULL;
+        return false;
+    }
+    return true;
+}
+
 /*/////////////////////
 //   Namespace End   //
 /////////////////////*/
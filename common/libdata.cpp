@@ -13,6 +13,15 @@
 #include <cassert>
 #include "libdata.hpp"
 
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+#if defined(CMN_HAVE_TMMINTRIN_H) && (defined(__SSE2__) || defined(_M_X64))
+    #include <emmintrin.h>
+    #define DATA_USE_SSE2         1
+#endif
+
 /*//////////////////////////
 //   Using Declarations   //
 //////////////////////////*/
@@ -23,6 +32,613 @@
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+/// the seed value used when hashing interned strings.
+#define INTERN_HASH_SEED      0x9747B28CUL
+/// the maximum number of values stored in a roaring array container.
+#define ROARING_ARRAY_MAX     4096
+/// the number of 64-bit words in a roaring bitmap container.
+#define ROARING_BITMAP_WORDS  1024
+/// the minimum capacity of a roaring array container or container list.
+#define ROARING_MIN_CAPACITY  4
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline void memory_barrier(void)
+{
+#if   defined(__GNUC__)
+    __sync_synchronize();
+#elif defined(_MSC_VER)
+    _ReadWriteBarrier();
+#else
+    #error No memory barrier implementation for your compiler!
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline bool try_acquire(int32_t volatile *lock)
+{
+#if   defined(__GNUC__)
+    return __sync_val_compare_and_swap(lock, 0, 1) == 0;
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchange((long volatile*) lock, 1, 0) == 0;
+#else
+    #error No compare-and-swap implementation for your compiler!
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline void release(int32_t volatile *lock)
+{
+    // make sure all prior writes are visible before the lock is seen free.
+    memory_barrier();
+    *lock = 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline size_t intern_slot_count(size_t capacity)
+{
+    // keep the load factor below 0.75; round up to a power of two.
+    size_t need  = capacity + (capacity / 3) + 1;
+    size_t count = 8;
+    while (count < need)
+    {
+        count <<= 1;
+    }
+    return count;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline void* roaring_alloc(data::roaring_bitmap_t *bitmap, size_t size)
+{
+    return bitmap->alloc_fn(size, bitmap->alloc_context);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline void roaring_free(
+    data::roaring_bitmap_t *bitmap,
+    void                   *memory,
+    size_t                  size)
+{
+    if (memory != NULL && bitmap->free_fn != NULL)
+    {
+        bitmap->free_fn(memory, size, bitmap->alloc_context);
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline size_t container_data_size(data::roaring_container_t const *c)
+{
+    if (c->type == data::ROARING_CONTAINER_BITMAP)
+        return ROARING_BITMAP_WORDS * sizeof(uint64_t);
+    else
+        return c->capacity * sizeof(uint16_t);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static size_t container_search(
+    data::roaring_bitmap_t const *bitmap,
+    uint32_t                      key,
+    bool                         *out_found)
+{
+    // binary search for the first container with a key >= key.
+    size_t min_idx = 0;
+    size_t max_idx = bitmap->count;
+    while (min_idx < max_idx)
+    {
+        size_t cur_idx = (min_idx + max_idx) >> 1;
+        if (bitmap->containers[cur_idx].key < key)
+            min_idx = cur_idx + 1;
+        else
+            max_idx = cur_idx;
+    }
+    *out_found = (min_idx < bitmap->count) && (bitmap->containers[min_idx].key == key);
+    return min_idx;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static size_t array_search(uint16_t const *values, size_t count, uint16_t value)
+{
+    // binary search for the first value >= value.
+    size_t min_idx = 0;
+    size_t max_idx = count;
+    while (min_idx < max_idx)
+    {
+        size_t cur_idx = (min_idx + max_idx) >> 1;
+        if (values[cur_idx] < value)
+            min_idx = cur_idx + 1;
+        else
+            max_idx = cur_idx;
+    }
+    return min_idx;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static data::roaring_container_t* container_insert(
+    data::roaring_bitmap_t *bitmap,
+    size_t                  index,
+    uint32_t                key,
+    int32_t                 type,
+    uint32_t                capacity)
+{
+    if (bitmap->count == bitmap->capacity)
+    {
+        // grow the container list; allocate-copy-free since there is no
+        // reallocation callback.
+        size_t new_cap  = CMN_MAX(bitmap->capacity * 2, ROARING_MIN_CAPACITY);
+        size_t new_size = new_cap * sizeof(data::roaring_container_t);
+        void  *new_list = roaring_alloc(bitmap, new_size);
+        if (new_list == NULL) return NULL;
+        if (bitmap->count > 0)
+        {
+            memcpy(new_list, bitmap->containers, bitmap->count * sizeof(data::roaring_container_t));
+        }
+        roaring_free(bitmap, bitmap->containers, bitmap->capacity * sizeof(data::roaring_container_t));
+        bitmap->containers = (data::roaring_container_t*) new_list;
+        bitmap->capacity   = new_cap;
+    }
+
+    data::roaring_container_t c;
+    c.key         = key;
+    c.type        = type;
+    c.cardinality = 0;
+    c.capacity    = capacity;
+    c.data        = roaring_alloc(bitmap, container_data_size(&c));
+    if (c.data   == NULL) return NULL;
+    if (type     == data::ROARING_CONTAINER_BITMAP)
+    {
+        memset(c.data, 0, ROARING_BITMAP_WORDS * sizeof(uint64_t));
+    }
+    if (index < bitmap->count)
+    {
+        memmove(&bitmap->containers[index + 1], &bitmap->containers[index],
+                (bitmap->count - index) * sizeof(data::roaring_container_t));
+    }
+    bitmap->containers[index] = c;
+    bitmap->count++;
+    return &bitmap->containers[index];
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void container_remove(data::roaring_bitmap_t *bitmap, size_t index)
+{
+    data::roaring_container_t *c = &bitmap->containers[index];
+    roaring_free(bitmap, c->data, container_data_size(c));
+    if (index + 1 < bitmap->count)
+    {
+        memmove(&bitmap->containers[index], &bitmap->containers[index + 1],
+                (bitmap->count - index - 1) * sizeof(data::roaring_container_t));
+    }
+    bitmap->count--;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool container_to_bitmap(
+    data::roaring_bitmap_t    *bitmap,
+    data::roaring_container_t *c)
+{
+    size_t    size  = ROARING_BITMAP_WORDS * sizeof(uint64_t);
+    uint64_t *words = (uint64_t*) roaring_alloc(bitmap, size);
+    if (words == NULL) return false;
+    memset(words, 0, size);
+
+    uint16_t const *values = (uint16_t const*) c->data;
+    for (uint32_t i = 0; i < c->cardinality; ++i)
+    {
+        words[values[i] >> 6] |= uint64_t(1) << (values[i] & 63);
+    }
+    roaring_free(bitmap, c->data, container_data_size(c));
+    c->type     = data::ROARING_CONTAINER_BITMAP;
+    c->capacity = 0;
+    c->data     = words;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool container_to_array(
+    data::roaring_bitmap_t    *bitmap,
+    data::roaring_container_t *c)
+{
+    uint32_t  cap    = CMN_MAX(c->cardinality, ROARING_MIN_CAPACITY);
+    uint16_t *values = (uint16_t*) roaring_alloc(bitmap, cap * sizeof(uint16_t));
+    if (values == NULL) return false;
+
+    uint64_t const *words = (uint64_t const*) c->data;
+    size_t          count = 0;
+    for (size_t i = 0; i < ROARING_BITMAP_WORDS; ++i)
+    {
+        uint64_t word = words[i];
+        while (word != 0)
+        {
+            values[count++] = uint16_t((i << 6) + data::find_first_set64(word));
+            word &= word - 1;
+        }
+    }
+    roaring_free(bitmap, c->data, container_data_size(c));
+    c->type     = data::ROARING_CONTAINER_ARRAY;
+    c->capacity = cap;
+    c->data     = values;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool container_add(
+    data::roaring_bitmap_t    *bitmap,
+    data::roaring_container_t *c,
+    uint16_t                   value)
+{
+    if (c->type == data::ROARING_CONTAINER_BITMAP)
+    {
+        uint64_t *words = (uint64_t*) c->data;
+        uint64_t  mask  = uint64_t(1) << (value & 63);
+        if ((words[value >> 6] & mask) == 0)
+        {
+            words[value >> 6] |= mask;
+            c->cardinality++;
+        }
+        return true;
+    }
+
+    uint16_t *values = (uint16_t*) c->data;
+    size_t    index  = array_search(values, c->cardinality, value);
+    if (index < c->cardinality && values[index] == value)
+    {
+        // the value is already present.
+        return true;
+    }
+    if (c->cardinality == ROARING_ARRAY_MAX)
+    {
+        // the array container is full; switch to a bitmap.
+        if (!container_to_bitmap(bitmap, c)) return false;
+        return container_add(bitmap, c, value);
+    }
+    if (c->cardinality == c->capacity)
+    {
+        uint32_t  new_cap = CMN_MIN(c->capacity * 2, ROARING_ARRAY_MAX);
+        uint16_t *new_arr = (uint16_t*) roaring_alloc(bitmap, new_cap * sizeof(uint16_t));
+        if (new_arr == NULL) return false;
+        memcpy(new_arr, values, c->cardinality * sizeof(uint16_t));
+        roaring_free(bitmap, values, container_data_size(c));
+        c->capacity = new_cap;
+        c->data     = new_arr;
+        values      = new_arr;
+    }
+    if (index < c->cardinality)
+    {
+        memmove(&values[index + 1], &values[index], (c->cardinality - index) * sizeof(uint16_t));
+    }
+    values[index] = value;
+    c->cardinality++;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool container_contains(data::roaring_container_t const *c, uint16_t value)
+{
+    if (c->type == data::ROARING_CONTAINER_BITMAP)
+    {
+        uint64_t const *words = (uint64_t const*) c->data;
+        return (words[value >> 6] & (uint64_t(1) << (value & 63))) != 0;
+    }
+    uint16_t const *values = (uint16_t const*) c->data;
+    size_t          index  = array_search(values, c->cardinality, value);
+    return (index < c->cardinality && values[index] == value);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool container_find_first(
+    data::roaring_container_t const *c,
+    uint32_t                         start,
+    uint32_t                        *out_value)
+{
+    if (c->type == data::ROARING_CONTAINER_BITMAP)
+    {
+        uint64_t const *words = (uint64_t const*) c->data;
+        size_t          index = start >> 6;
+        uint64_t        word  = words[index] & (~uint64_t(0) << (start & 63));
+        for ( ; ; )
+        {
+            if (word != 0)
+            {
+                *out_value = uint32_t((index << 6) + data::find_first_set64(word));
+                return true;
+            }
+            if (++index == ROARING_BITMAP_WORDS)
+            {
+                return false;
+            }
+            word = words[index];
+        }
+    }
+    uint16_t const *values = (uint16_t const*) c->data;
+    size_t          index  = array_search(values, c->cardinality, uint16_t(start));
+    if (index < c->cardinality)
+    {
+        *out_value = values[index];
+        return true;
+    }
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool container_copy(
+    data::roaring_bitmap_t          *dst,
+    data::roaring_container_t const *src)
+{
+    uint32_t cap = (src->type == data::ROARING_CONTAINER_ARRAY) ? CMN_MAX(src->cardinality, ROARING_MIN_CAPACITY) : 0;
+    data::roaring_container_t *c = container_insert(dst, dst->count, src->key, src->type, cap);
+    if (c == NULL) return false;
+    if (src->type == data::ROARING_CONTAINER_BITMAP)
+        memcpy(c->data, src->data, ROARING_BITMAP_WORDS * sizeof(uint64_t));
+    else
+        memcpy(c->data, src->data, src->cardinality * sizeof(uint16_t));
+    c->cardinality = src->cardinality;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool container_union(
+    data::roaring_bitmap_t          *dst,
+    data::roaring_container_t const *a,
+    data::roaring_container_t const *b)
+{
+    if (a->type == data::ROARING_CONTAINER_ARRAY && b->type == data::ROARING_CONTAINER_ARRAY)
+    {
+        uint32_t cap = CMN_MAX(a->cardinality + b->cardinality, ROARING_MIN_CAPACITY);
+        if (cap > ROARING_ARRAY_MAX)
+        {
+            // the result may not fit in an array; build it as a bitmap.
+            if (!container_copy(dst, a)) return false;
+            data::roaring_container_t *c = &dst->containers[dst->count - 1];
+            if (!container_to_bitmap(dst, c)) return false;
+            uint16_t const *bv = (uint16_t const*) b->data;
+            for (uint32_t i = 0; i < b->cardinality; ++i)
+            {
+                container_add(dst, c, bv[i]);
+            }
+            if (c->cardinality <= ROARING_ARRAY_MAX)
+            {
+                return container_to_array(dst, c);
+            }
+            return true;
+        }
+        data::roaring_container_t *c = container_insert(dst, dst->count, a->key, data::ROARING_CONTAINER_ARRAY, cap);
+        if (c == NULL) return false;
+        uint16_t const *av = (uint16_t const*) a->data;
+        uint16_t const *bv = (uint16_t const*) b->data;
+        uint16_t       *cv = (uint16_t*) c->data;
+        uint32_t ia = 0, ib = 0, n = 0;
+        while (ia < a->cardinality && ib < b->cardinality)
+        {
+            if      (av[ia] < bv[ib]) cv[n++] = av[ia++];
+            else if (bv[ib] < av[ia]) cv[n++] = bv[ib++];
+            else  { cv[n++] = av[ia++]; ++ib; }
+        }
+        while (ia < a->cardinality) cv[n++] = av[ia++];
+        while (ib < b->cardinality) cv[n++] = bv[ib++];
+        c->cardinality = n;
+        return true;
+    }
+    if (a->type == data::ROARING_CONTAINER_BITMAP && b->type == data::ROARING_CONTAINER_BITMAP)
+    {
+        data::roaring_container_t *c = container_insert(dst, dst->count, a->key, data::ROARING_CONTAINER_BITMAP, 0);
+        if (c == NULL) return false;
+        c->cardinality = (uint32_t) data::bitwise_or(
+            (uint64_t*) c->data, (uint64_t const*) a->data,
+            (uint64_t const*) b->data, ROARING_BITMAP_WORDS);
+        return true;
+    }
+    // one bitmap and one array; copy the bitmap and set the array values.
+    data::roaring_container_t const *bm = (a->type == data::ROARING_CONTAINER_BITMAP) ? a : b;
+    data::roaring_container_t const *ar = (a->type == data::ROARING_CONTAINER_BITMAP) ? b : a;
+    if (!container_copy(dst, bm)) return false;
+    data::roaring_container_t *c  = &dst->containers[dst->count - 1];
+    uint16_t const            *av = (uint16_t const*) ar->data;
+    for (uint32_t i = 0; i < ar->cardinality; ++i)
+    {
+        container_add(dst, c, av[i]);
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool container_intersect(
+    data::roaring_bitmap_t          *dst,
+    data::roaring_container_t const *a,
+    data::roaring_container_t const *b)
+{
+    data::roaring_container_t *c = NULL;
+    if (a->type == data::ROARING_CONTAINER_BITMAP && b->type == data::ROARING_CONTAINER_BITMAP)
+    {
+        c = container_insert(dst, dst->count, a->key, data::ROARING_CONTAINER_BITMAP, 0);
+        if (c == NULL) return false;
+        c->cardinality = (uint32_t) data::bitwise_and(
+            (uint64_t*) c->data, (uint64_t const*) a->data,
+            (uint64_t const*) b->data, ROARING_BITMAP_WORDS);
+        if (c->cardinality <= ROARING_ARRAY_MAX && c->cardinality > 0)
+        {
+            return container_to_array(dst, c);
+        }
+    }
+    else
+    {
+        // at least one input is an array, so the result is bounded by its size.
+        data::roaring_container_t const *ar = (a->type == data::ROARING_CONTAINER_ARRAY) ? a : b;
+        data::roaring_container_t const *ot = (a->type == data::ROARING_CONTAINER_ARRAY) ? b : a;
+        uint32_t cap = CMN_MAX(ar->cardinality, ROARING_MIN_CAPACITY);
+        c = container_insert(dst, dst->count, a->key, data::ROARING_CONTAINER_ARRAY, cap);
+        if (c == NULL) return false;
+        uint16_t const *av = (uint16_t const*) ar->data;
+        uint16_t       *cv = (uint16_t*) c->data;
+        uint32_t        n  = 0;
+        if (ot->type == data::ROARING_CONTAINER_BITMAP)
+        {
+            for (uint32_t i = 0; i < ar->cardinality; ++i)
+            {
+                if (container_contains(ot, av[i])) cv[n++] = av[i];
+            }
+        }
+        else
+        {
+            uint16_t const *bv = (uint16_t const*) ot->data;
+            uint32_t ia = 0, ib = 0;
+            while (ia < ar->cardinality && ib < ot->cardinality)
+            {
+                if      (av[ia] < bv[ib]) ++ia;
+                else if (bv[ib] < av[ia]) ++ib;
+                else  { cv[n++] = av[ia++]; ++ib; }
+            }
+        }
+        c->cardinality = n;
+    }
+    if (c->cardinality == 0)
+    {
+        // don't keep empty containers around.
+        container_remove(dst, dst->count - 1);
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void timer_wheel_link(
+    data::timer_wheel_t *wheel,
+    data::timer_node_t  *node,
+    uint64_t             earliest)
+{
+    uint64_t const  slot_mask = DATA_TIMER_WHEEL_SLOTS - 1;
+    uint64_t        current   = wheel->current_tick;
+    uint64_t        deadline  = node->deadline;
+    size_t          level     = 0;
+    size_t          slot      = 0;
+
+    // timers that are already due fire on the earliest unprocessed tick.
+    if (deadline < earliest)
+    {
+        deadline = earliest;
+    }
+    uint64_t delta = deadline - current;
+    while (level < DATA_TIMER_WHEEL_LEVELS - 1 &&
+           delta >= (uint64_t(1) << ((level + 1) * DATA_TIMER_WHEEL_BITS)))
+    {
+        ++level;
+    }
+    if (level == DATA_TIMER_WHEEL_LEVELS - 1)
+    {
+        // deadlines beyond the range of the wheel are clamped to the last
+        // slot of the top level; they are re-examined when they cascade.
+        uint64_t range = uint64_t(1) << (DATA_TIMER_WHEEL_LEVELS * DATA_TIMER_WHEEL_BITS);
+        if (delta >= range) deadline = current + range - 1;
+    }
+    slot = (size_t) ((deadline >> (level * DATA_TIMER_WHEEL_BITS)) & slot_mask);
+
+    data::timer_node_t **head = &wheel->slots[level][slot];
+    node->next = *head;
+    node->prev =  head;
+    if (*head != NULL) (*head)->prev = &node->next;
+    *head = node;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void timer_wheel_cascade(data::timer_wheel_t *wheel, size_t level)
+{
+    uint64_t const      slot_mask = DATA_TIMER_WHEEL_SLOTS - 1;
+    size_t              slot      = (size_t) ((wheel->current_tick >> (level * DATA_TIMER_WHEEL_BITS)) & slot_mask);
+    data::timer_node_t *iter      = wheel->slots[level][slot];
+    wheel->slots[level][slot]     = NULL;
+    while (iter != NULL)
+    {
+        // re-insert each timer relative to the current tick; it will land
+        // in a lower level (or back in this one if it was clamped.) the
+        // current tick has not been processed yet, so it is still eligible.
+        data::timer_node_t *next = iter->next;
+        timer_wheel_link(wheel, iter, wheel->current_tick);
+        iter = next;
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static char const* intern_table_find(
+    data::intern_table_t *table,
+    char const           *str,
+    uint32_t              hash,
+    uint32_t             *out_id)
+{
+    size_t mask  = table->slot_count - 1;
+    size_t index = hash & mask;
+    for (size_t i = 0; i < table->slot_count; ++i)
+    {
+        data::intern_slot_t *slot = &table->slots[index];
+        uint32_t             id   = slot->id;
+        if (id == 0)
+        {
+            // reached an empty slot; the string is not present.
+            return NULL;
+        }
+        // the id is published last, so the hash and string are visible.
+        memory_barrier();
+        if (slot->hash == hash)
+        {
+            char const *interned = table->strings[id - 1];
+            if (strcmp(interned, str) == 0)
+            {
+                if (out_id != NULL) *out_id = id;
+                return interned;
+            }
+        }
+        index = (index + 1) & mask;
+    }
+    return NULL;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static char* intern_table_store(data::intern_table_t *table, char const *str)
+{
+    data::intern_block_t *block = table->block_list;
+    char                 *copy  = data::string_data_intern(&block->storage, str);
+    if (copy != NULL || table->alloc_fn == NULL)
+    {
+        return copy;
+    }
+
+    // the current block is full; chain a new block large enough for str.
+    size_t header = sizeof(data::intern_block_t);
+    size_t length = strlen(str) + 1;
+    size_t size   = CMN_MAX(table->block_size, header + length);
+    void  *memory = table->alloc_fn(size, table->alloc_context);
+    if (memory == NULL)
+    {
+        return NULL;
+    }
+    block         = (data::intern_block_t*) memory;
+    block->next   = table->block_list;
+    data::string_data_init(&block->storage, (char*) memory + header, size - header);
+    table->block_list = block;
+    return data::string_data_intern(&block->storage, str);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 void data::string_data_init(
     data::string_data_t *data,
     void                *memory,
@@ -120,6 +736,605 @@ size_t data::string_data_bytes_used(data::string_data_t *data)
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+size_t data::intern_table_index_size(size_t capacity)
+{
+    size_t slots   = intern_slot_count(capacity);
+    size_t strings = capacity * sizeof(char const*);
+    return strings + slots * sizeof(data::intern_slot_t);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool data::intern_table_init(
+    data::intern_table_t *table,
+    size_t                capacity,
+    void                 *index_memory,
+    void                 *block_memory,
+    size_t                block_size,
+    data::hash32_fn       hash_fn,
+    data::block_alloc_fn  alloc_fn /* = NULL */,
+    data::block_free_fn   free_fn  /* = NULL */,
+    void                 *context  /* = NULL */)
+{
+    size_t header = sizeof(data::intern_block_t);
+    if (table == NULL || index_memory == NULL || hash_fn == NULL)
+    {
+        return false;
+    }
+    if (block_memory  == NULL || block_size <= header || capacity == 0)
+    {
+        return false;
+    }
+
+    // the string pointer table comes first to maintain pointer alignment.
+    char   *index_base   = (char*) index_memory;
+    size_t  strings_size = capacity * sizeof(char const*);
+    table->strings       = (char const * volatile*) index_base;
+    table->slots         = (data::intern_slot_t*) (index_base + strings_size);
+    table->slot_count    = intern_slot_count(capacity);
+    table->max_count     = capacity;
+    table->block_size    = block_size;
+    table->string_count  = 0;
+    table->write_lock    = 0;
+    table->hash_seed     = INTERN_HASH_SEED;
+    table->hash_fn       = hash_fn;
+    table->alloc_fn      = alloc_fn;
+    table->free_fn       = free_fn;
+    table->alloc_context = context;
+    memset(index_memory, 0, data::intern_table_index_size(capacity));
+
+    data::intern_block_t *block = (data::intern_block_t*) block_memory;
+    block->next        = NULL;
+    data::string_data_init(&block->storage, (char*) block_memory + header, block_size - header);
+    table->block_list  = block;
+    table->first_block = block;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void data::intern_table_reset(data::intern_table_t *table)
+{
+    if (table != NULL)
+    {
+        data::intern_block_t *iter = table->block_list;
+        while (iter != table->first_block)
+        {
+            data::intern_block_t *next = iter->next;
+            size_t                size = (size_t) (iter->storage.memory_end - (char*) iter);
+            if (table->free_fn != NULL)
+            {
+                table->free_fn(iter, size, table->alloc_context);
+            }
+            iter = next;
+        }
+        table->block_list   = table->first_block;
+        table->string_count = 0;
+        table->write_lock   = 0;
+        data::string_data_reset(&table->first_block->storage);
+        memset(table->slots  , 0, table->slot_count * sizeof(data::intern_slot_t));
+        memset((void*) table->strings, 0, table->max_count * sizeof(char const*));
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+char const* data::intern_table_search(
+    data::intern_table_t *table,
+    char const           *str,
+    uint32_t             *out_id)
+{
+    char const *strp = str ? str : "";
+    uint32_t    hash = table->hash_fn(strp, strlen(strp), table->hash_seed);
+    return intern_table_find(table, strp, hash, out_id);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+char const* data::intern_table_intern(
+    data::intern_table_t *table,
+    char const           *str,
+    uint32_t             *out_id)
+{
+    char const *strp  = str ? str : "";
+    uint32_t    hash  = table->hash_fn(strp, strlen(strp), table->hash_seed);
+    char const *found = intern_table_find(table, strp, hash, out_id);
+    if (found != NULL)
+    {
+        // fast path - the string has already been interned.
+        return found;
+    }
+
+    // serialize writers. readers never take the lock.
+    while (!try_acquire(&table->write_lock))
+    {
+        /* spin */
+    }
+
+    // another writer may have inserted the string while we waited.
+    found = intern_table_find(table, strp, hash, out_id);
+    if (found != NULL)
+    {
+        release(&table->write_lock);
+        return found;
+    }
+    if (table->string_count >= table->max_count)
+    {
+        release(&table->write_lock);
+        if (out_id != NULL) *out_id = 0;
+        return NULL;
+    }
+
+    char *copy = intern_table_store(table, strp);
+    if (copy == NULL)
+    {
+        release(&table->write_lock);
+        if (out_id != NULL) *out_id = 0;
+        return NULL;
+    }
+
+    // locate the empty slot; the load factor guarantees there is one.
+    size_t   mask  = table->slot_count - 1;
+    size_t   index = hash & mask;
+    while (table->slots[index].id != 0)
+    {
+        index = (index + 1) & mask;
+    }
+
+    // publish the string, then the hash, and finally the id which readers
+    // use to determine whether the slot is occupied.
+    uint32_t id = table->string_count + 1;
+    table->strings[id - 1]    = copy;
+    table->slots[index].hash  = hash;
+    memory_barrier();
+    table->slots[index].id    = id;
+    table->string_count       = id;
+    release(&table->write_lock);
+    if (out_id != NULL) *out_id = id;
+    return copy;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+char const* data::intern_table_string(data::intern_table_t *table, uint32_t id)
+{
+    if (id == 0 || id > table->string_count)
+    {
+        return NULL;
+    }
+    memory_barrier();
+    return table->strings[id - 1];
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t data::intern_table_count(data::intern_table_t *table)
+{
+    return (size_t) table->string_count;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t data::bitwise_or(
+    uint64_t       *dst,
+    uint64_t const *a,
+    uint64_t const *b,
+    size_t          word_count)
+{
+    size_t count = 0;
+    size_t i     = 0;
+#if DATA_USE_SSE2
+    for ( ; i + 2 <= word_count; i += 2)
+    {
+        __m128i va = _mm_loadu_si128((__m128i const*) &a[i]);
+        __m128i vb = _mm_loadu_si128((__m128i const*) &b[i]);
+        _mm_storeu_si128((__m128i*) &dst[i], _mm_or_si128(va, vb));
+        count += data::popcount64(dst[i]) + data::popcount64(dst[i + 1]);
+    }
+#endif
+    for ( ; i < word_count; ++i)
+    {
+        dst[i] = a[i] | b[i];
+        count += data::popcount64(dst[i]);
+    }
+    return count;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t data::bitwise_and(
+    uint64_t       *dst,
+    uint64_t const *a,
+    uint64_t const *b,
+    size_t          word_count)
+{
+    size_t count = 0;
+    size_t i     = 0;
+#if DATA_USE_SSE2
+    for ( ; i + 2 <= word_count; i += 2)
+    {
+        __m128i va = _mm_loadu_si128((__m128i const*) &a[i]);
+        __m128i vb = _mm_loadu_si128((__m128i const*) &b[i]);
+        _mm_storeu_si128((__m128i*) &dst[i], _mm_and_si128(va, vb));
+        count += data::popcount64(dst[i]) + data::popcount64(dst[i + 1]);
+    }
+#endif
+    for ( ; i < word_count; ++i)
+    {
+        dst[i] = a[i] & b[i];
+        count += data::popcount64(dst[i]);
+    }
+    return count;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t data::bitwise_andnot(
+    uint64_t       *dst,
+    uint64_t const *a,
+    uint64_t const *b,
+    size_t          word_count)
+{
+    size_t count = 0;
+    size_t i     = 0;
+#if DATA_USE_SSE2
+    for ( ; i + 2 <= word_count; i += 2)
+    {
+        __m128i va = _mm_loadu_si128((__m128i const*) &a[i]);
+        __m128i vb = _mm_loadu_si128((__m128i const*) &b[i]);
+        // @note: _mm_andnot_si128 computes (~first & second).
+        _mm_storeu_si128((__m128i*) &dst[i], _mm_andnot_si128(vb, va));
+        count += data::popcount64(dst[i]) + data::popcount64(dst[i + 1]);
+    }
+#endif
+    for ( ; i < word_count; ++i)
+    {
+        dst[i] = a[i] & ~b[i];
+        count += data::popcount64(dst[i]);
+    }
+    return count;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t data::bitwise_count(uint64_t const *words, size_t word_count)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < word_count; ++i)
+    {
+        count += data::popcount64(words[i]);
+    }
+    return count;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void data::roaring_init(
+    data::roaring_bitmap_t *bitmap,
+    data::block_alloc_fn    alloc_fn,
+    data::block_free_fn     free_fn,
+    void                   *context /* = NULL */)
+{
+    bitmap->containers    = NULL;
+    bitmap->count         = 0;
+    bitmap->capacity      = 0;
+    bitmap->alloc_fn      = alloc_fn;
+    bitmap->free_fn       = free_fn;
+    bitmap->alloc_context = context;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void data::roaring_reset(data::roaring_bitmap_t *bitmap)
+{
+    for (size_t i = 0; i < bitmap->count; ++i)
+    {
+        data::roaring_container_t *c = &bitmap->containers[i];
+        roaring_free(bitmap, c->data, container_data_size(c));
+    }
+    roaring_free(bitmap, bitmap->containers, bitmap->capacity * sizeof(data::roaring_container_t));
+    bitmap->containers = NULL;
+    bitmap->count      = 0;
+    bitmap->capacity   = 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool data::roaring_add(data::roaring_bitmap_t *bitmap, uint32_t value)
+{
+    bool   found = false;
+    size_t index = container_search(bitmap, value >> 16, &found);
+    data::roaring_container_t *c = NULL;
+    if (found)
+    {
+        c = &bitmap->containers[index];
+    }
+    else
+    {
+        c = container_insert(bitmap, index, value >> 16, data::ROARING_CONTAINER_ARRAY, ROARING_MIN_CAPACITY);
+        if (c == NULL) return false;
+    }
+    return container_add(bitmap, c, uint16_t(value & 0xFFFF));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool data::roaring_remove(data::roaring_bitmap_t *bitmap, uint32_t value)
+{
+    bool   found = false;
+    size_t index = container_search(bitmap, value >> 16, &found);
+    if (!found)
+    {
+        return false;
+    }
+
+    data::roaring_container_t *c   = &bitmap->containers[index];
+    uint16_t                   low = uint16_t(value & 0xFFFF);
+    if (c->type == data::ROARING_CONTAINER_BITMAP)
+    {
+        uint64_t *words = (uint64_t*) c->data;
+        uint64_t  mask  = uint64_t(1) << (low & 63);
+        if ((words[low >> 6] & mask) == 0)
+        {
+            return false;
+        }
+        words[low >> 6] &= ~mask;
+        c->cardinality--;
+        if (c->cardinality == ROARING_ARRAY_MAX)
+        {
+            // switch back to the more compact form; if this fails, the
+            // bitmap container is still valid, so ignore the result.
+            container_to_array(bitmap, c);
+        }
+    }
+    else
+    {
+        uint16_t *values = (uint16_t*) c->data;
+        size_t    pos    = array_search(values, c->cardinality, low);
+        if (pos >= c->cardinality || values[pos] != low)
+        {
+            return false;
+        }
+        memmove(&values[pos], &values[pos + 1], (c->cardinality - pos - 1) * sizeof(uint16_t));
+        c->cardinality--;
+    }
+    if (c->cardinality == 0)
+    {
+        container_remove(bitmap, index);
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool data::roaring_contains(
+    data::roaring_bitmap_t const *bitmap,
+    uint32_t                      value)
+{
+    bool   found = false;
+    size_t index = container_search(bitmap, value >> 16, &found);
+    if (found)
+    {
+        return container_contains(&bitmap->containers[index], uint16_t(value & 0xFFFF));
+    }
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t data::roaring_count(data::roaring_bitmap_t const *bitmap)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < bitmap->count; ++i)
+    {
+        count += bitmap->containers[i].cardinality;
+    }
+    return count;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool data::roaring_union(
+    data::roaring_bitmap_t       *dst,
+    data::roaring_bitmap_t const *a,
+    data::roaring_bitmap_t const *b)
+{
+    size_t ia = 0;
+    size_t ib = 0;
+    bool   ok = true;
+    data::roaring_reset(dst);
+    while (ok && ia < a->count && ib < b->count)
+    {
+        data::roaring_container_t const *ca = &a->containers[ia];
+        data::roaring_container_t const *cb = &b->containers[ib];
+        if      (ca->key < cb->key) { ok = container_copy(dst, ca); ++ia; }
+        else if (cb->key < ca->key) { ok = container_copy(dst, cb); ++ib; }
+        else  { ok = container_union(dst, ca, cb); ++ia; ++ib; }
+    }
+    while (ok && ia < a->count) ok = container_copy(dst, &a->containers[ia++]);
+    while (ok && ib < b->count) ok = container_copy(dst, &b->containers[ib++]);
+    if (!ok)  data::roaring_reset(dst);
+    return ok;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool data::roaring_intersect(
+    data::roaring_bitmap_t       *dst,
+    data::roaring_bitmap_t const *a,
+    data::roaring_bitmap_t const *b)
+{
+    size_t ia = 0;
+    size_t ib = 0;
+    bool   ok = true;
+    data::roaring_reset(dst);
+    while (ok && ia < a->count && ib < b->count)
+    {
+        data::roaring_container_t const *ca = &a->containers[ia];
+        data::roaring_container_t const *cb = &b->containers[ib];
+        if      (ca->key < cb->key) ++ia;
+        else if (cb->key < ca->key) ++ib;
+        else  { ok = container_intersect(dst, ca, cb); ++ia; ++ib; }
+    }
+    if (!ok)  data::roaring_reset(dst);
+    return ok;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool data::roaring_find_first(
+    data::roaring_bitmap_t const *bitmap,
+    uint32_t                      start,
+    uint32_t                     *out_value)
+{
+    bool   found = false;
+    size_t index = container_search(bitmap, start >> 16, &found);
+    for (uint32_t low = found ? (start & 0xFFFF) : 0; index < bitmap->count; ++index, low = 0)
+    {
+        data::roaring_container_t const *c = &bitmap->containers[index];
+        uint32_t                         v = 0;
+        if (container_find_first(c, low, &v))
+        {
+            *out_value = (c->key << 16) | v;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t data::roaring_to_array(
+    data::roaring_bitmap_t const *bitmap,
+    uint32_t                     *array,
+    size_t                        max_count)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < bitmap->count && count < max_count; ++i)
+    {
+        data::roaring_container_t const *c    = &bitmap->containers[i];
+        uint32_t                         high = c->key << 16;
+        if (c->type == data::ROARING_CONTAINER_BITMAP)
+        {
+            uint64_t const *words = (uint64_t const*) c->data;
+            for (size_t w = 0; w < ROARING_BITMAP_WORDS && count < max_count; ++w)
+            {
+                uint64_t word = words[w];
+                while (word != 0 && count < max_count)
+                {
+                    array[count++] = high | uint32_t((w << 6) + data::find_first_set64(word));
+                    word &= word - 1;
+                }
+            }
+        }
+        else
+        {
+            uint16_t const *values = (uint16_t const*) c->data;
+            for (uint32_t v = 0; v < c->cardinality && count < max_count; ++v)
+            {
+                array[count++] = high | values[v];
+            }
+        }
+    }
+    return count;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void data::timer_wheel_init(data::timer_wheel_t *wheel, uint64_t start_tick)
+{
+    memset(wheel->slots, 0, sizeof(wheel->slots));
+    wheel->current_tick = start_tick;
+    wheel->count        = 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void data::timer_wheel_schedule(
+    data::timer_wheel_t *wheel,
+    data::timer_node_t  *node,
+    uint64_t             deadline)
+{
+    data::timer_wheel_cancel(wheel, node);
+    node->deadline = deadline;
+    timer_wheel_link(wheel, node, wheel->current_tick + 1);
+    wheel->count++;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool data::timer_wheel_cancel(
+    data::timer_wheel_t *wheel,
+    data::timer_node_t  *node)
+{
+    if (node->prev == NULL)
+    {
+        // the timer is not currently scheduled.
+        return false;
+    }
+    *node->prev = node->next;
+    if (node->next != NULL) node->next->prev = node->prev;
+    node->next  = NULL;
+    node->prev  = NULL;
+    wheel->count--;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+data::timer_node_t* data::timer_wheel_advance(
+    data::timer_wheel_t *wheel,
+    uint64_t             now,
+    size_t              *out_count)
+{
+    uint64_t const      slot_mask = DATA_TIMER_WHEEL_SLOTS - 1;
+    data::timer_node_t *expired   = NULL;
+    size_t              nexpired  = 0;
+
+    while (wheel->current_tick < now)
+    {
+        if (wheel->count == 0)
+        {
+            // nothing is scheduled, so skip directly to the current time.
+            wheel->current_tick = now;
+            break;
+        }
+
+        uint64_t tick = ++wheel->current_tick;
+        // cascade each level whose lower levels have just wrapped around,
+        // starting from the highest so timers can trickle all the way down.
+        size_t   wrap = 0;
+        while (wrap < DATA_TIMER_WHEEL_LEVELS - 1 &&
+              (tick & ((uint64_t(1) << ((wrap + 1) * DATA_TIMER_WHEEL_BITS)) - 1)) == 0)
+        {
+            ++wrap;
+        }
+        for (size_t level = wrap; level > 0; --level)
+        {
+            timer_wheel_cascade(wheel, level);
+        }
+
+        // everything in the current level-zero slot expires on this tick.
+        size_t              slot = (size_t) (tick & slot_mask);
+        data::timer_node_t *iter = wheel->slots[0][slot];
+        wheel->slots[0][slot]    = NULL;
+        while (iter != NULL)
+        {
+            data::timer_node_t *next = iter->next;
+            iter->prev = NULL;
+            iter->next = expired;
+            expired    = iter;
+            wheel->count--;
+            nexpired++;
+            iter = next;
+        }
+    }
+    if (out_count != NULL) *out_count = nexpired;
+    return expired;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 /*/////////////////////////////////////////////////////////////////////////////
 //    $Id$
 ///////////////////////////////////////////////////////////////////////////80*/
@@ -15,6 +15,10 @@
 #include "common.hpp"
 #include "common_traits.hpp"
 
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
 /*////////////////////////////
 //   Forward Declarations   //
 ////////////////////////////*/
@@ -27,6 +31,32 @@ namespace data {
 /*//////////////
 //   Macros   //
 //////////////*/
+/// The handle value representing an invalid priority queue item handle.
+#ifndef DATA_PQUEUE_HANDLE_INVALID
+#define DATA_PQUEUE_HANDLE_INVALID           0xFFFFFFFFUL
+#endif /* !defined(DATA_PQUEUE_HANDLE_INVALID) */
+
+/// The handle value representing an invalid slot map item handle. Slot
+/// generations start at one, so a zero handle never refers to a live item.
+#ifndef DATA_SLOT_HANDLE_INVALID
+#define DATA_SLOT_HANDLE_INVALID             0ULL
+#endif /* !defined(DATA_SLOT_HANDLE_INVALID) */
+
+/// The number of bits of the tick count consumed by each timer wheel level.
+#ifndef DATA_TIMER_WHEEL_BITS
+#define DATA_TIMER_WHEEL_BITS                6
+#endif /* !defined(DATA_TIMER_WHEEL_BITS) */
+
+/// The number of slots in each level of a hierarchical timer wheel.
+#ifndef DATA_TIMER_WHEEL_SLOTS
+#define DATA_TIMER_WHEEL_SLOTS               (1 << DATA_TIMER_WHEEL_BITS)
+#endif /* !defined(DATA_TIMER_WHEEL_SLOTS) */
+
+/// The number of levels in a hierarchical timer wheel. With the default
+/// values, timers up to 2^24 ticks in the future are scheduled directly.
+#ifndef DATA_TIMER_WHEEL_LEVELS
+#define DATA_TIMER_WHEEL_LEVELS              4
+#endif /* !defined(DATA_TIMER_WHEEL_LEVELS) */
 
 /*//////////////////////////////////
 //   Public Types and Functions   //
@@ -42,6 +72,185 @@ struct string_data_t
     size_t          memory_size;                   /// Total size of memory
 };
 
+/// Function signature for a user-defined function that computes a 32-bit hash
+/// of a block of data. The signature is compatible with hash::hash32().
+///
+/// @param data Pointer to the start of the data to hash.
+/// @param length The number of bytes of data to hash.
+/// @param seed A starting seed for the hash value.
+/// @return The 32-bit hash of the specified data.
+typedef uint32_t (CMN_CALL_C *hash32_fn)(
+    void const *data,
+    size_t      length,
+    uint32_t    seed);
+
+/// Function signature for a user-defined function that allocates a new block
+/// of memory used to extend a string interning table.
+///
+/// @param size_in_bytes The minimum size of the block, in bytes.
+/// @param context Opaque data associated with the allocator. This value is
+/// optional and may be NULL.
+/// @return The newly allocated block, or NULL if memory allocation failed.
+typedef void* (CMN_CALL_C *block_alloc_fn)(
+    size_t  size_in_bytes,
+    void   *context);
+
+/// Function signature for a user-defined function that releases a block of
+/// memory previously returned by a data::block_alloc_fn.
+///
+/// @param block The block being released.
+/// @param size_in_bytes The size of the block, in bytes.
+/// @param context Opaque data associated with the allocator. This value is
+/// optional and may be NULL.
+typedef void  (CMN_CALL_C *block_free_fn)(
+    void   *block,
+    size_t  size_in_bytes,
+    void   *context);
+
+/// The header stored at the start of each block of string storage owned by
+/// a string interning table. Blocks are chained together, newest first.
+struct intern_block_t
+{
+    data::intern_block_t *next;                    /// The next-oldest block
+    data::string_data_t   storage;                 /// String storage
+};
+
+/// A single slot in the hash index of a string interning table. A slot with
+/// an id of zero is unused.
+struct intern_slot_t
+{
+    uint32_t volatile     hash;                    /// Hash of the string
+    uint32_t volatile     id;                      /// One-based string id
+};
+
+/// A hash-indexed string interning table. Each unique string is stored once
+/// and is assigned a stable pointer and a stable 32-bit identifier. Searches
+/// are lock-free and may run concurrently with each other and with inserts;
+/// inserts are serialized internally. String storage grows by chaining new
+/// blocks obtained from a user-supplied allocator, so interned strings never
+/// move. The hash index itself is fixed-size and is supplied by the caller.
+struct intern_table_t
+{
+    data::intern_block_t *block_list;              /// Current storage block
+    data::intern_block_t *first_block;             /// Caller-supplied block
+    data::intern_slot_t  *slots;                   /// Hash index slots
+    char const * volatile*strings;                 /// Map id-1 => string
+    size_t                slot_count;              /// Power of two
+    size_t                max_count;               /// Max. # of strings
+    size_t                block_size;              /// Default block size
+    uint32_t volatile     string_count;            /// # of interned strings
+    int32_t  volatile     write_lock;              /// Non-zero while writing
+    uint32_t              hash_seed;               /// Seed for hash_fn
+    data::hash32_fn       hash_fn;                 /// Hash function
+    data::block_alloc_fn  alloc_fn;                /// Block allocator
+    data::block_free_fn   free_fn;                 /// Block release
+    void                 *alloc_context;           /// Allocator context
+};
+
+/// A fixed-size set of N bits stored inline as an array of 64-bit words. Bits
+/// beyond N in the last word are always kept clear.
+template <size_t N>
+struct bitset_t
+{
+    uint64_t              words[(N + 63) / 64];    /// Bit storage
+};
+
+/// Defines the container types used to store the low 16 bits of values within
+/// a compressed bitmap.
+enum roaring_container_e
+{
+    /// The container stores a sorted array of up to 4096 16-bit values.
+    ROARING_CONTAINER_ARRAY       = 0,
+    /// The container stores a 65536-bit bitmap as 1024 64-bit words.
+    ROARING_CONTAINER_BITMAP      = 1,
+    /// This type value is unused and serves only to force a minimum of 32-bits
+    /// of storage space for values of this enumeration type.
+    ROARING_CONTAINER_FORCE_32BIT = CMN_FORCE_32BIT
+};
+
+/// Represents a single container within a compressed bitmap, storing all
+/// values that share the same upper 16 bits.
+struct roaring_container_t
+{
+    uint32_t              key;                     /// Upper 16 bits of values
+    int32_t               type;                    /// roaring_container_e
+    uint32_t              cardinality;             /// # of values stored
+    uint32_t              capacity;                /// Max. # of array values
+    void                 *data;                    /// uint16_t[] or uint64_t[]
+};
+
+/// A compressed (roaring-style) bitmap for sets of 32-bit values. Values are
+/// partitioned by their upper 16 bits into containers, ordered by key, which
+/// store the lower 16 bits either as a sorted array (sparse) or as a bitmap
+/// (dense). All memory is obtained through user-supplied callbacks.
+struct roaring_bitmap_t
+{
+    data::roaring_container_t *containers;         /// Sorted by key
+    size_t                     count;              /// # of containers in use
+    size_t                     capacity;           /// Max. # of containers
+    data::block_alloc_fn       alloc_fn;           /// Memory allocator
+    data::block_free_fn        free_fn;            /// Memory release
+    void                      *alloc_context;      /// Allocator context
+};
+
+/// A 4-ary implicit min-heap of items of type T supporting O(log N) insert,
+/// removal and key updates through stable handles. All storage is supplied
+/// by the application; see data::pqueue_memory_size(). The 4-ary layout
+/// keeps the children of a node in the same cache line for small T, which
+/// makes sift-down considerably cheaper than with a binary heap.
+template <typename T>
+struct pqueue_t
+{
+    T                    *items;                   /// Items, in heap order
+    uint32_t             *handles;                 /// Heap index => handle
+    uint32_t             *positions;               /// Handle => heap index
+    size_t                count;                   /// # of items in the heap
+    size_t                capacity;                /// Max. # of items
+    uint32_t              free_handle;             /// Head of free handles
+};
+
+/// A generational slot map storing items of type T densely, addressed through
+/// stable 64-bit handles. Each handle combines a slot index (low 32 bits) with
+/// the generation of that slot (high 32 bits); removing an item increments the
+/// generation, so stale handles are detected rather than aliasing a new item.
+/// Insertion, lookup and removal are O(1), and live items can be iterated as a
+/// contiguous array. All storage is supplied by the application; see the
+/// function data::slot_map_memory_size().
+template <typename T>
+struct slot_map_t
+{
+    T                    *items;                   /// Items, densely packed
+    uint32_t             *item_slots;              /// Item index => slot
+    uint32_t             *slot_items;              /// Slot => item index
+    uint32_t             *generations;             /// Slot => generation
+    size_t                count;                   /// # of live items
+    size_t                capacity;                /// Max. # of items
+    uint32_t              free_slot;               /// Head of free slots
+};
+
+/// A single timer scheduled in a hierarchical timer wheel. Timer nodes are
+/// owned by the application and linked into the wheel intrusively, so the
+/// wheel never allocates memory. Nodes must be initialized with the function
+/// data::timer_node_init() before they are first scheduled.
+struct timer_node_t
+{
+    data::timer_node_t   *next;                    /// Next node in the list
+    data::timer_node_t  **prev;                    /// Link pointing to node
+    uint64_t              deadline;                /// Absolute expiry tick
+    void                 *context;                 /// Application data
+};
+
+/// A hierarchical timer wheel, as described by Varghese and Lauck. Each level
+/// divides time into DATA_TIMER_WHEEL_SLOTS slots; timers are placed in the
+/// lowest level that covers their deadline and cascade toward level zero as
+/// time advances. Scheduling and cancellation are O(1).
+struct timer_wheel_t
+{
+    data::timer_node_t   *slots[DATA_TIMER_WHEEL_LEVELS][DATA_TIMER_WHEEL_SLOTS];
+    uint64_t              current_tick;            /// Last processed tick
+    size_t                count;                   /// # of scheduled timers
+};
+
 /// A simple structure representing a single node in a hash tree. The data
 /// itself is not stored in the node, so each item is relatively small.
 template <typename T>
@@ -173,6 +382,527 @@ CMN_PUBLIC size_t string_data_bytes_free(data::string_data_t *data);
 /// @return The number of bytes used in @a data.
 CMN_PUBLIC size_t string_data_bytes_used(data::string_data_t *data);
 
+/// Computes the number of bytes of memory that must be supplied by the caller
+/// to store the hash index of a string interning table.
+///
+/// @param capacity The maximum number of unique strings that can be stored in
+/// the table. The hash index is sized to keep the load factor below 0.75.
+/// @return The number of bytes of index memory required.
+CMN_PUBLIC size_t intern_table_index_size(size_t capacity);
+
+/// Initializes a string interning table using application-managed memory.
+///
+/// @param table The string interning table to initialize.
+/// @param capacity The maximum number of unique strings that can be stored.
+/// @param index_memory Pointer to a memory block at least as large as the
+/// value returned by data::intern_table_index_size() for @a capacity. This
+/// memory block should be aligned to at least a pointer boundary.
+/// @param block_memory Pointer to the first block of string storage. This
+/// block is never released by the table.
+/// @param block_size The size of @a block_memory, in bytes. Additional blocks
+/// are allocated with at least this size.
+/// @param hash_fn The function used to compute string hash values, typically
+/// hash::hash32.
+/// @param alloc_fn The function used to allocate additional storage blocks.
+/// If NULL, interning fails once @a block_memory is exhausted.
+/// @param free_fn The function used to release additional storage blocks.
+/// @param context Opaque data passed through to @a alloc_fn and @a free_fn.
+/// @return true if the table was initialized successfully.
+CMN_PUBLIC bool intern_table_init(
+    data::intern_table_t *table,
+    size_t                capacity,
+    void                 *index_memory,
+    void                 *block_memory,
+    size_t                block_size,
+    data::hash32_fn       hash_fn,
+    data::block_alloc_fn  alloc_fn = NULL,
+    data::block_free_fn   free_fn  = NULL,
+    void                 *context  = NULL);
+
+/// Releases all storage blocks allocated by a string interning table and
+/// resets the table to empty. Pointers and identifiers returned prior to the
+/// call become invalid. This function is not safe to call concurrently with
+/// any other operation on @a table.
+///
+/// @param table The string interning table to reset.
+CMN_PUBLIC void intern_table_reset(data::intern_table_t *table);
+
+/// Attempts to locate an interned string. This operation has O(1) expected
+/// time complexity and is lock-free; it may be called concurrently with
+/// data::intern_table_intern() from any number of threads.
+///
+/// @param table The string interning table to search.
+/// @param str Pointer to a NULL-terminated, ASCII or UTF-8 encoded string
+/// specifying the string to search for.
+/// @param out_id If non-NULL and the string is found, on return this value
+/// is set to the one-based identifier of the string.
+/// @return A pointer to the interned copy of the string, if found; otherwise,
+/// the function returns NULL.
+CMN_PUBLIC char const* intern_table_search(
+    data::intern_table_t *table,
+    char const           *str,
+    uint32_t             *out_id);
+
+/// Retrieves an existing interned copy of a string, or interns the string if
+/// no copy exists. Returned pointers remain valid until the table is reset.
+///
+/// @param table The string interning table.
+/// @param str Pointer to a NULL-terminated, ASCII or UTF-8 encoded string
+/// specifying the string to internalize.
+/// @param out_id If non-NULL, on return this value is set to the one-based
+/// identifier of the string, or zero if the string could not be interned.
+/// @return A pointer to the interned copy of the string, or NULL if the table
+/// is full or a new storage block could not be allocated.
+CMN_PUBLIC char const* intern_table_intern(
+    data::intern_table_t *table,
+    char const           *str,
+    uint32_t             *out_id);
+
+/// Retrieves an interned string given its identifier. This operation is
+/// lock-free.
+///
+/// @param table The string interning table.
+/// @param id The one-based string identifier returned by a search or intern.
+/// @return A pointer to the interned string, or NULL if @a id is invalid.
+CMN_PUBLIC char const* intern_table_string(
+    data::intern_table_t *table,
+    uint32_t              id);
+
+/// Retrieves the number of unique strings stored in an interning table.
+///
+/// @param table The string interning table.
+/// @return The number of strings interned in @a table.
+CMN_PUBLIC size_t intern_table_count(data::intern_table_t *table);
+
+/// Counts the number of set bits in a 64-bit word using a compiler intrinsic.
+///
+/// @param word The word to examine.
+/// @return The number of bits set in @a word.
+inline size_t popcount64(uint64_t word)
+{
+#if   defined(__GNUC__)
+    return (size_t) __builtin_popcountll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (size_t) __popcnt64(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (size_t) ((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/// Determines the zero-based index of the least significant set bit in a
+/// 64-bit word using a compiler intrinsic.
+///
+/// @param word The word to examine. This value must be non-zero.
+/// @return The zero-based index of the least significant set bit.
+inline size_t find_first_set64(uint64_t word)
+{
+#if   defined(__GNUC__)
+    return (size_t) __builtin_ctzll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index = 0;
+    _BitScanForward64(&index, word);
+    return (size_t) index;
+#else
+    size_t index = 0;
+    while ((word & 1) == 0)
+    {
+        word >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+/// Computes the bitwise OR of two arrays of 64-bit words. SIMD instructions
+/// are used when available. The destination may alias either source.
+///
+/// @param dst The destination array of @a word_count words.
+/// @param a The first source array of @a word_count words.
+/// @param b The second source array of @a word_count words.
+/// @param word_count The number of 64-bit words in each array.
+/// @return The number of bits set in @a dst.
+CMN_PUBLIC size_t bitwise_or(
+    uint64_t       *dst,
+    uint64_t const *a,
+    uint64_t const *b,
+    size_t          word_count);
+
+/// Computes the bitwise AND of two arrays of 64-bit words. SIMD instructions
+/// are used when available. The destination may alias either source.
+///
+/// @param dst The destination array of @a word_count words.
+/// @param a The first source array of @a word_count words.
+/// @param b The second source array of @a word_count words.
+/// @param word_count The number of 64-bit words in each array.
+/// @return The number of bits set in @a dst.
+CMN_PUBLIC size_t bitwise_and(
+    uint64_t       *dst,
+    uint64_t const *a,
+    uint64_t const *b,
+    size_t          word_count);
+
+/// Computes the bitwise AND of one array of 64-bit words with the complement
+/// of another (a & ~b). SIMD instructions are used when available. The
+/// destination may alias either source.
+///
+/// @param dst The destination array of @a word_count words.
+/// @param a The first source array of @a word_count words.
+/// @param b The second source array of @a word_count words.
+/// @param word_count The number of 64-bit words in each array.
+/// @return The number of bits set in @a dst.
+CMN_PUBLIC size_t bitwise_andnot(
+    uint64_t       *dst,
+    uint64_t const *a,
+    uint64_t const *b,
+    size_t          word_count);
+
+/// Counts the number of set bits in an array of 64-bit words.
+///
+/// @param words The array of words to examine.
+/// @param word_count The number of 64-bit words in @a words.
+/// @return The number of bits set in @a words.
+CMN_PUBLIC size_t bitwise_count(uint64_t const *words, size_t word_count);
+
+/// Initializes an empty compressed bitmap.
+///
+/// @param bitmap The bitmap to initialize.
+/// @param alloc_fn The function used to allocate container memory.
+/// @param free_fn The function used to release container memory.
+/// @param context Opaque data passed through to @a alloc_fn and @a free_fn.
+CMN_PUBLIC void roaring_init(
+    data::roaring_bitmap_t *bitmap,
+    data::block_alloc_fn    alloc_fn,
+    data::block_free_fn     free_fn,
+    void                   *context = NULL);
+
+/// Releases all memory owned by a compressed bitmap, leaving it empty. The
+/// bitmap may be used again without re-initialization.
+///
+/// @param bitmap The bitmap to reset.
+CMN_PUBLIC void roaring_reset(data::roaring_bitmap_t *bitmap);
+
+/// Adds a value to a compressed bitmap.
+///
+/// @param bitmap The bitmap to modify.
+/// @param value The value to add.
+/// @return true if the value is present in the set on return, or false if
+/// memory could not be allocated.
+CMN_PUBLIC bool roaring_add(data::roaring_bitmap_t *bitmap, uint32_t value);
+
+/// Removes a value from a compressed bitmap.
+///
+/// @param bitmap The bitmap to modify.
+/// @param value The value to remove.
+/// @return true if the value was present in the set.
+CMN_PUBLIC bool roaring_remove(data::roaring_bitmap_t *bitmap, uint32_t value);
+
+/// Determines whether a compressed bitmap contains a specific value.
+///
+/// @param bitmap The bitmap to query.
+/// @param value The value to search for.
+/// @return true if @a value is a member of the set.
+CMN_PUBLIC bool roaring_contains(
+    data::roaring_bitmap_t const *bitmap,
+    uint32_t                      value);
+
+/// Computes the number of values stored in a compressed bitmap.
+///
+/// @param bitmap The bitmap to query.
+/// @return The number of values in the set.
+CMN_PUBLIC size_t roaring_count(data::roaring_bitmap_t const *bitmap);
+
+/// Computes the union of two compressed bitmaps, replacing the contents of a
+/// third bitmap with the result.
+///
+/// @param dst The bitmap that will store the result. This bitmap must be
+/// initialized and must not be the same as @a a or @a b.
+/// @param a The first input set.
+/// @param b The second input set.
+/// @return true if the operation completed, or false if memory could not be
+/// allocated, in which case @a dst is left empty.
+CMN_PUBLIC bool roaring_union(
+    data::roaring_bitmap_t       *dst,
+    data::roaring_bitmap_t const *a,
+    data::roaring_bitmap_t const *b);
+
+/// Computes the intersection of two compressed bitmaps, replacing the
+/// contents of a third bitmap with the result.
+///
+/// @param dst The bitmap that will store the result. This bitmap must be
+/// initialized and must not be the same as @a a or @a b.
+/// @param a The first input set.
+/// @param b The second input set.
+/// @return true if the operation completed, or false if memory could not be
+/// allocated, in which case @a dst is left empty.
+CMN_PUBLIC bool roaring_intersect(
+    data::roaring_bitmap_t       *dst,
+    data::roaring_bitmap_t const *a,
+    data::roaring_bitmap_t const *b);
+
+/// Locates the smallest value in a compressed bitmap that is greater than or
+/// equal to a given starting value. Call repeatedly with *out_value + 1 to
+/// visit all values in ascending order.
+///
+/// @param bitmap The bitmap to search.
+/// @param start The value at which to begin the search.
+/// @param out_value On return, stores the value that was found.
+/// @return true if a value was found, or false if no values >= @a start.
+CMN_PUBLIC bool roaring_find_first(
+    data::roaring_bitmap_t const *bitmap,
+    uint32_t                      start,
+    uint32_t                     *out_value);
+
+/// Copies the values stored in a compressed bitmap into an array, in
+/// ascending order.
+///
+/// @param bitmap The bitmap to read.
+/// @param array Pointer to the array to write to.
+/// @param max_count The maximum number of values to write to @a array.
+/// @return The number of values copied into the array.
+CMN_PUBLIC size_t roaring_to_array(
+    data::roaring_bitmap_t const *bitmap,
+    uint32_t                     *array,
+    size_t                        max_count);
+
+/// Initializes a timer node to the unscheduled state. This must be called
+/// once before the node is first passed to data::timer_wheel_schedule(),
+/// which otherwise treats a non-NULL prev field as a live link.
+///
+/// @param node The application-owned timer node to initialize.
+/// @param context Opaque application data stored with the timer.
+inline void timer_node_init(data::timer_node_t *node, void *context)
+{
+    node->next     = NULL;
+    node->prev     = NULL;
+    node->deadline = 0;
+    node->context  = context;
+}
+
+/// Initializes an empty timer wheel.
+///
+/// @param wheel The timer wheel to initialize.
+/// @param start_tick The current time, in application-defined ticks.
+CMN_PUBLIC void timer_wheel_init(data::timer_wheel_t *wheel, uint64_t start_tick);
+
+/// Schedules a timer to expire at a specific tick. If the timer is already
+/// scheduled, it is first cancelled. Timers with a deadline at or before the
+/// current tick expire on the next call to data::timer_wheel_advance().
+///
+/// @param wheel The timer wheel.
+/// @param node The application-owned timer node, initialized with the
+/// function data::timer_node_init(). The node must remain valid until it
+/// expires or is cancelled.
+/// @param deadline The absolute tick at which the timer expires.
+CMN_PUBLIC void timer_wheel_schedule(
+    data::timer_wheel_t *wheel,
+    data::timer_node_t  *node,
+    uint64_t             deadline);
+
+/// Cancels a scheduled timer. This operation has O(1) time complexity.
+///
+/// @param wheel The timer wheel.
+/// @param node The timer node to cancel.
+/// @return true if the timer was scheduled and has been cancelled.
+CMN_PUBLIC bool timer_wheel_cancel(
+    data::timer_wheel_t *wheel,
+    data::timer_node_t  *node);
+
+/// Advances a timer wheel to the specified tick, collecting all timers that
+/// expire along the way. Expired timers are unlinked from the wheel and may
+/// be rescheduled by the caller.
+///
+/// @param wheel The timer wheel.
+/// @param now The current time, in application-defined ticks.
+/// @param out_count If non-NULL, on return stores the number of timers that
+/// expired.
+/// @return The first expired timer node, linked to the remaining expired
+/// timers through the next field, or NULL if no timers expired.
+CMN_PUBLIC data::timer_node_t* timer_wheel_advance(
+    data::timer_wheel_t *wheel,
+    uint64_t             now,
+    size_t              *out_count);
+
+/// Determines whether a timer node is currently scheduled in a timer wheel.
+///
+/// @param node The timer node to check.
+/// @return true if @a node is scheduled.
+inline bool timer_scheduled(data::timer_node_t const *node)
+{
+    return (node->prev != NULL);
+}
+
+/// Clears all bits in a bitset.
+///
+/// @param set The bitset to modify.
+template <size_t N>
+inline void bitset_clear_all(data::bitset_t<N> *set)
+{
+    memset(set->words, 0, sizeof(set->words));
+}
+
+/// Sets all bits in a bitset.
+///
+/// @param set The bitset to modify.
+template <size_t N>
+inline void bitset_set_all(data::bitset_t<N> *set)
+{
+    memset(set->words, 0xFF, sizeof(set->words));
+    if (N & 63)
+    {
+        // keep the unused bits in the last word clear.
+        set->words[(N - 1) >> 6] &= (uint64_t(1) << (N & 63)) - 1;
+    }
+}
+
+/// Sets a single bit in a bitset.
+///
+/// @param set The bitset to modify.
+/// @param index The zero-based index of the bit to set, in [0, N).
+template <size_t N>
+inline void bitset_set(data::bitset_t<N> *set, size_t index)
+{
+    set->words[index >> 6] |= (uint64_t(1) << (index & 63));
+}
+
+/// Clears a single bit in a bitset.
+///
+/// @param set The bitset to modify.
+/// @param index The zero-based index of the bit to clear, in [0, N).
+template <size_t N>
+inline void bitset_clear(data::bitset_t<N> *set, size_t index)
+{
+    set->words[index >> 6] &= ~(uint64_t(1) << (index & 63));
+}
+
+/// Tests the value of a single bit in a bitset.
+///
+/// @param set The bitset to query.
+/// @param index The zero-based index of the bit to test, in [0, N).
+/// @return true if the bit is set.
+template <size_t N>
+inline bool bitset_test(data::bitset_t<N> const *set, size_t index)
+{
+    return (set->words[index >> 6] & (uint64_t(1) << (index & 63))) != 0;
+}
+
+/// Counts the number of bits set in a bitset.
+///
+/// @param set The bitset to query.
+/// @return The number of bits set in @a set.
+template <size_t N>
+inline size_t bitset_count(data::bitset_t<N> const *set)
+{
+    return data::bitwise_count(set->words, (N + 63) / 64);
+}
+
+/// Locates the first set bit at or after a given index.
+///
+/// @param set The bitset to search.
+/// @param start The zero-based index of the bit at which to begin searching.
+/// @return The zero-based index of the first set bit at or after @a start,
+/// or N if no such bit exists.
+template <size_t N>
+inline size_t bitset_find_first(data::bitset_t<N> const *set, size_t start)
+{
+    size_t const word_count = (N + 63) / 64;
+    size_t       word_index = start >> 6;
+    if (start >= N)
+    {
+        return N;
+    }
+    // mask off the bits below start in the first word examined.
+    uint64_t word = set->words[word_index] & (~uint64_t(0) << (start & 63));
+    for ( ; ; )
+    {
+        if (word != 0)
+        {
+            return (word_index << 6) + data::find_first_set64(word);
+        }
+        if (++word_index == word_count)
+        {
+            return N;
+        }
+        word = set->words[word_index];
+    }
+}
+
+/// Copies the indices of all set bits in a bitset into an array, in
+/// ascending order.
+///
+/// @param set The bitset to read.
+/// @param array Pointer to the array to write to.
+/// @param max_count The maximum number of indices to write to @a array.
+/// @return The number of indices copied into the array.
+template <size_t N>
+inline size_t bitset_to_array(
+    data::bitset_t<N> const *set,
+    uint32_t                *array,
+    size_t                   max_count)
+{
+    size_t const word_count = (N + 63) / 64;
+    size_t       count      = 0;
+    for (size_t i = 0; i < word_count && count < max_count; ++i)
+    {
+        uint64_t word = set->words[i];
+        while (word != 0 && count < max_count)
+        {
+            array[count++] = uint32_t((i << 6) + data::find_first_set64(word));
+            word &= word - 1; // clear the lowest set bit.
+        }
+    }
+    return count;
+}
+
+/// Computes the union of two bitsets. The destination may alias a source.
+///
+/// @param dst The bitset that will store the result.
+/// @param a The first input set.
+/// @param b The second input set.
+/// @return The number of bits set in @a dst.
+template <size_t N>
+inline size_t bitset_union(
+    data::bitset_t<N>       *dst,
+    data::bitset_t<N> const *a,
+    data::bitset_t<N> const *b)
+{
+    return data::bitwise_or(dst->words, a->words, b->words, (N + 63) / 64);
+}
+
+/// Computes the intersection of two bitsets. The destination may alias a
+/// source.
+///
+/// @param dst The bitset that will store the result.
+/// @param a The first input set.
+/// @param b The second input set.
+/// @return The number of bits set in @a dst.
+template <size_t N>
+inline size_t bitset_intersect(
+    data::bitset_t<N>       *dst,
+    data::bitset_t<N> const *a,
+    data::bitset_t<N> const *b)
+{
+    return data::bitwise_and(dst->words, a->words, b->words, (N + 63) / 64);
+}
+
+/// Computes the difference of two bitsets (bits in @a a but not in @a b.)
+/// The destination may alias a source.
+///
+/// @param dst The bitset that will store the result.
+/// @param a The first input set.
+/// @param b The second input set.
+/// @return The number of bits set in @a dst.
+template <size_t N>
+inline size_t bitset_difference(
+    data::bitset_t<N>       *dst,
+    data::bitset_t<N> const *a,
+    data::bitset_t<N> const *b)
+{
+    return data::bitwise_andnot(dst->words, a->words, b->words, (N + 63) / 64);
+}
+
 /// Performs an O(log N) binary search of an array.
 ///
 /// @param array Pointer to the start of the sorted array to search.
@@ -399,6 +1129,513 @@ inline void sort(
     }
 }
 
+/// Computes the number of bytes of memory that must be supplied by the caller
+/// to store a priority queue with a given capacity.
+///
+/// @param capacity The maximum number of items in the priority queue.
+/// @return The number of bytes of memory required.
+template <typename T>
+inline size_t pqueue_memory_size(size_t capacity)
+{
+    size_t items = ((capacity * sizeof(T)) + 7) & ~size_t(7);
+    return items + (capacity * sizeof(uint32_t) * 2);
+}
+
+/// Initializes an empty priority queue using application-managed memory.
+///
+/// @param queue The priority queue to initialize.
+/// @param memory Pointer to a block of memory at least as large as the value
+/// returned by data::pqueue_memory_size() for @a capacity. The block must be
+/// suitably aligned to store items of type T.
+/// @param capacity The maximum number of items in the priority queue.
+template <typename T>
+inline void pqueue_init(
+    data::pqueue_t<T> *queue,
+    void              *memory,
+    size_t             capacity)
+{
+    size_t items     = ((capacity * sizeof(T)) + 7) & ~size_t(7);
+    queue->items     = (T*) memory;
+    queue->handles   = (uint32_t*) ((uint8_t*) memory + items);
+    queue->positions =  queue->handles + capacity;
+    queue->count     =  0;
+    queue->capacity  =  capacity;
+    // thread the unused handles into a free list via the positions array.
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        queue->positions[i] = (i + 1 < capacity) ? uint32_t(i + 1) : DATA_PQUEUE_HANDLE_INVALID;
+    }
+    queue->free_handle = (capacity > 0) ? 0 : DATA_PQUEUE_HANDLE_INVALID;
+}
+
+/// Moves the item at heap index @a pos toward the root until the heap
+/// property is restored. This is primarily an internal function.
+///
+/// @param queue The priority queue.
+/// @param pos The heap index of the item to sift up.
+/// @param comparer An object implementing an operator with the signature:
+/// int operator()(T const& a, T const& b) const
+template <typename T, typename C>
+inline void pqueue_sift_up(
+    data::pqueue_t<T> *queue,
+    size_t             pos,
+    C const           &comparer)
+{
+    T        item   = queue->items[pos];
+    uint32_t handle = queue->handles[pos];
+    while (pos > 0)
+    {
+        size_t parent = (pos - 1) >> 2;
+        if (comparer(item, queue->items[parent]) >= 0)
+        {
+            break;
+        }
+        queue->items[pos]   = queue->items[parent];
+        queue->handles[pos] = queue->handles[parent];
+        queue->positions[queue->handles[pos]] = uint32_t(pos);
+        pos = parent;
+    }
+    queue->items[pos]   = item;
+    queue->handles[pos] = handle;
+    queue->positions[handle] = uint32_t(pos);
+}
+
+/// Moves the item at heap index @a pos toward the leaves until the heap
+/// property is restored. This is primarily an internal function.
+///
+/// @param queue The priority queue.
+/// @param pos The heap index of the item to sift down.
+/// @param comparer An object implementing an operator with the signature:
+/// int operator()(T const& a, T const& b) const
+template <typename T, typename C>
+inline void pqueue_sift_down(
+    data::pqueue_t<T> *queue,
+    size_t             pos,
+    C const           &comparer)
+{
+    size_t   count  = queue->count;
+    T        item   = queue->items[pos];
+    uint32_t handle = queue->handles[pos];
+    for ( ; ; )
+    {
+        size_t first = (pos << 2) + 1;
+        if (first >= count)
+        {
+            break;
+        }
+        // select the smallest of up to four children.
+        size_t last  = CMN_MIN(first + 4, count);
+        size_t best  = first;
+        for (size_t child = first + 1; child < last; ++child)
+        {
+            if (comparer(queue->items[child], queue->items[best]) < 0)
+            {
+                best = child;
+            }
+        }
+        if (comparer(queue->items[best], item) >= 0)
+        {
+            break;
+        }
+        queue->items[pos]   = queue->items[best];
+        queue->handles[pos] = queue->handles[best];
+        queue->positions[queue->handles[pos]] = uint32_t(pos);
+        pos = best;
+    }
+    queue->items[pos]   = item;
+    queue->handles[pos] = handle;
+    queue->positions[handle] = uint32_t(pos);
+}
+
+/// Inserts an item into a priority queue. This operation has O(log N) time
+/// complexity.
+///
+/// @param queue The priority queue.
+/// @param item The item to insert.
+/// @param comparer An object implementing an operator with the signature:
+/// int operator()(T const& a, T const& b) const
+/// @param out_handle If non-NULL, on return stores the stable handle of the
+/// item, which may be used to update or remove it.
+/// @return Returns one if the item was inserted, or zero if the queue is full.
+template <typename T, typename C>
+inline size_t pqueue_push(
+    data::pqueue_t<T> *queue,
+    T const           &item,
+    C const           &comparer,
+    uint32_t          *out_handle)
+{
+    if (queue->count == queue->capacity)
+    {
+        return 0;
+    }
+    uint32_t handle    = queue->free_handle;
+    size_t   pos       = queue->count++;
+    queue->free_handle = queue->positions[handle];
+    queue->items[pos]  = item;
+    queue->handles[pos]= handle;
+    pqueue_sift_up(queue, pos, comparer);
+    if (out_handle != NULL) *out_handle = handle;
+    return 1;
+}
+
+/// Inserts several items into a priority queue. When the number of items
+/// being inserted is large relative to the current size of the heap, the heap
+/// is rebuilt bottom-up in O(N) time instead of sifting each item.
+///
+/// @param queue The priority queue.
+/// @param items Pointer to the array of items to insert.
+/// @param count The number of items in @a items.
+/// @param comparer An object implementing an operator with the signature:
+/// int operator()(T const& a, T const& b) const
+/// @param out_handles If non-NULL, an array of @a count values that on return
+/// stores the handle of each inserted item.
+/// @return The number of items inserted, which may be less than @a count if
+/// the queue becomes full.
+template <typename T, typename C>
+inline size_t pqueue_push_bulk(
+    data::pqueue_t<T> *queue,
+    T const           *items,
+    size_t             count,
+    C const           &comparer,
+    uint32_t          *out_handles)
+{
+    size_t base = queue->count;
+    size_t n    = CMN_MIN(count, queue->capacity - base);
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint32_t handle        = queue->free_handle;
+        queue->free_handle     = queue->positions[handle];
+        queue->items[base + i] = items[i];
+        queue->handles[base+i] = handle;
+        queue->positions[handle] = uint32_t(base + i);
+        if (out_handles != NULL) out_handles[i] = handle;
+    }
+    queue->count = base + n;
+    if (n > base)
+    {
+        // heapify from the last internal node back to the root.
+        size_t pos = (queue->count > 1) ? ((queue->count - 2) >> 2) + 1 : 0;
+        while (pos-- > 0)
+        {
+            pqueue_sift_down(queue, pos, comparer);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            pqueue_sift_up(queue, base + i, comparer);
+        }
+    }
+    return n;
+}
+
+/// Retrieves the item with the highest priority (lowest value) without
+/// removing it from the queue.
+///
+/// @param queue The priority queue.
+/// @param out_handle If non-NULL, on return stores the handle of the item.
+/// @return A pointer to the item, or NULL if the queue is empty.
+template <typename T>
+inline T* pqueue_top(data::pqueue_t<T> *queue, uint32_t *out_handle)
+{
+    if (queue->count == 0)
+    {
+        return NULL;
+    }
+    if (out_handle != NULL) *out_handle = queue->handles[0];
+    return &queue->items[0];
+}
+
+/// Retrieves an item given its handle.
+///
+/// @param queue The priority queue.
+/// @param handle The handle returned when the item was inserted.
+/// @return A pointer to the item. The pointer is invalidated by any operation
+/// that modifies the queue.
+template <typename T>
+inline T* pqueue_get(data::pqueue_t<T> *queue, uint32_t handle)
+{
+    return &queue->items[queue->positions[handle]];
+}
+
+/// Removes an item from a priority queue given its handle. The handle becomes
+/// invalid and may be reused by a subsequent insert.
+///
+/// @param queue The priority queue.
+/// @param handle The handle of the item to remove.
+/// @param comparer An object implementing an operator with the signature:
+/// int operator()(T const& a, T const& b) const
+/// @param out_item If non-NULL, on return stores a copy of the removed item.
+template <typename T, typename C>
+inline void pqueue_remove(
+    data::pqueue_t<T> *queue,
+    uint32_t           handle,
+    C const           &comparer,
+    T                 *out_item)
+{
+    size_t pos  = queue->positions[handle];
+    size_t last = --queue->count;
+    if (out_item != NULL) *out_item = queue->items[pos];
+    // return the handle to the free list.
+    queue->positions[handle] = queue->free_handle;
+    queue->free_handle       = handle;
+    if (pos != last)
+    {
+        // move the last item into the hole and restore the heap property.
+        queue->items[pos]   = queue->items[last];
+        queue->handles[pos] = queue->handles[last];
+        queue->positions[queue->handles[pos]] = uint32_t(pos);
+        if (pos > 0 && comparer(queue->items[pos], queue->items[(pos - 1) >> 2]) < 0)
+            pqueue_sift_up(queue, pos, comparer);
+        else
+            pqueue_sift_down(queue, pos, comparer);
+    }
+}
+
+/// Removes the item with the highest priority (lowest value) from a priority
+/// queue. This operation has O(log N) time complexity.
+///
+/// @param queue The priority queue.
+/// @param comparer An object implementing an operator with the signature:
+/// int operator()(T const& a, T const& b) const
+/// @param out_item On return, stores a copy of the removed item.
+/// @return Returns one if an item was removed, or zero if the queue is empty.
+template <typename T, typename C>
+inline size_t pqueue_pop(
+    data::pqueue_t<T> *queue,
+    C const           &comparer,
+    T                 *out_item)
+{
+    if (queue->count == 0)
+    {
+        return 0;
+    }
+    pqueue_remove(queue, queue->handles[0], comparer, out_item);
+    return 1;
+}
+
+/// Replaces the value of an item in a priority queue and restores the heap
+/// property. The new value may have either higher or lower priority.
+///
+/// @param queue The priority queue.
+/// @param handle The handle of the item to update.
+/// @param item The new value of the item.
+/// @param comparer An object implementing an operator with the signature:
+/// int operator()(T const& a, T const& b) const
+template <typename T, typename C>
+inline void pqueue_update(
+    data::pqueue_t<T> *queue,
+    uint32_t           handle,
+    T const           &item,
+    C const           &comparer)
+{
+    size_t pos        = queue->positions[handle];
+    int    order      = comparer(item, queue->items[pos]);
+    queue->items[pos] = item;
+    if (order < 0)
+        pqueue_sift_up  (queue, pos, comparer);
+    else if (order > 0)
+        pqueue_sift_down(queue, pos, comparer);
+}
+
+/// Increases the priority of an item in a priority queue (decreases its key.)
+/// This is cheaper than data::pqueue_update() because the item can only move
+/// toward the root.
+///
+/// @param queue The priority queue.
+/// @param handle The handle of the item to update.
+/// @param item The new value of the item, which must not compare greater
+/// than the current value.
+/// @param comparer An object implementing an operator with the signature:
+/// int operator()(T const& a, T const& b) const
+template <typename T, typename C>
+inline void pqueue_decrease_key(
+    data::pqueue_t<T> *queue,
+    uint32_t           handle,
+    T const           &item,
+    C const           &comparer)
+{
+    size_t pos        = queue->positions[handle];
+    queue->items[pos] = item;
+    pqueue_sift_up(queue, pos, comparer);
+}
+
+/// Computes the number of bytes of memory that must be supplied by the caller
+/// to store a slot map with a given capacity.
+///
+/// @param capacity The maximum number of items in the slot map.
+/// @return The number of bytes of memory required.
+template <typename T>
+inline size_t slot_map_memory_size(size_t capacity)
+{
+    size_t items = ((capacity * sizeof(T)) + 7) & ~size_t(7);
+    return items + (capacity * sizeof(uint32_t) * 3);
+}
+
+/// Initializes an empty slot map using application-managed memory.
+///
+/// @param map The slot map to initialize.
+/// @param memory Pointer to a block of memory at least as large as the value
+/// returned by data::slot_map_memory_size() for @a capacity. The block must be
+/// suitably aligned to store items of type T.
+/// @param capacity The maximum number of items in the slot map.
+template <typename T>
+inline void slot_map_init(
+    data::slot_map_t<T> *map,
+    void                *memory,
+    size_t               capacity)
+{
+    size_t items       = ((capacity * sizeof(T)) + 7) & ~size_t(7);
+    map->items         = (T*) memory;
+    map->item_slots    = (uint32_t*) ((uint8_t*) memory + items);
+    map->slot_items    =  map->item_slots + capacity;
+    map->generations   =  map->slot_items + capacity;
+    map->count         =  0;
+    map->capacity      =  capacity;
+    // thread the unused slots into a free list via the slot_items array.
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        map->slot_items[i]  = (i + 1 < capacity) ? uint32_t(i + 1) : 0xFFFFFFFFUL;
+        map->generations[i] = 1;
+    }
+    map->free_slot = (capacity > 0) ? 0 : 0xFFFFFFFFUL;
+}
+
+/// Removes all items from a slot map. All outstanding handles become invalid.
+///
+/// @param map The slot map to clear.
+template <typename T>
+inline void slot_map_clear(data::slot_map_t<T> *map)
+{
+    for (size_t i = 0; i < map->count; ++i)
+    {
+        uint32_t slot = map->item_slots[i];
+        if (++map->generations[slot] == 0) map->generations[slot] = 1;
+        map->slot_items[slot] = map->free_slot;
+        map->free_slot = slot;
+    }
+    map->count = 0;
+}
+
+/// Inserts an item into a slot map.
+///
+/// @param map The slot map.
+/// @param item The item to insert.
+/// @param out_handle If non-NULL, on return stores the stable handle used to
+/// reference the item. This value is set to DATA_SLOT_HANDLE_INVALID if the
+/// map is full.
+/// @return One if the item was inserted, or zero if the map is full.
+template <typename T>
+inline size_t slot_map_insert(
+    data::slot_map_t<T> *map,
+    T const             &item,
+    uint64_t            *out_handle)
+{
+    if (map->count == map->capacity)
+    {
+        if (out_handle != NULL) *out_handle = DATA_SLOT_HANDLE_INVALID;
+        return 0;
+    }
+    uint32_t slot          = map->free_slot;
+    uint32_t index         = uint32_t(map->count++);
+    map->free_slot         = map->slot_items[slot];
+    map->slot_items[slot]  = index;
+    map->item_slots[index] = slot;
+    map->items[index]      = item;
+    if (out_handle != NULL) *out_handle = (uint64_t(map->generations[slot]) << 32) | slot;
+    return 1;
+}
+
+/// Determines whether a handle refers to a live item in a slot map. Besides
+/// the generation, the slot must be occupied: free slots share the starting
+/// generation with slots that have never been used, so a forged handle or
+/// one issued by a different map would otherwise pass the generation check.
+///
+/// @param map The slot map.
+/// @param handle The handle to check.
+/// @return true if @a handle refers to a live item.
+template <typename T>
+inline bool slot_map_valid(
+    data::slot_map_t<T> const *map,
+    uint64_t                   handle)
+{
+    uint32_t slot = uint32_t(handle & 0xFFFFFFFFUL);
+    uint32_t gen  = uint32_t(handle >> 32);
+    if (slot >= map->capacity || map->generations[slot] != gen)
+    {
+        return false;
+    }
+    // a free slot stores a free-list link in slot_items, which only
+    // maps back to the slot through item_slots if the slot is live.
+    uint32_t index = map->slot_items[slot];
+    return (index < map->count && map->item_slots[index] == slot);
+}
+
+/// Retrieves the item referenced by a handle.
+///
+/// @param map The slot map.
+/// @param handle The handle of the item to retrieve.
+/// @return A pointer to the item, or NULL if @a handle is stale or invalid.
+/// The pointer remains valid until the next insertion or removal.
+template <typename T>
+inline T* slot_map_get(
+    data::slot_map_t<T> *map,
+    uint64_t             handle)
+{
+    if (!slot_map_valid(map, handle)) return NULL;
+    return &map->items[map->slot_items[uint32_t(handle & 0xFFFFFFFFUL)]];
+}
+
+/// Retrieves the handle of the item at a given position in the dense item
+/// array, for use when iterating over map->items.
+///
+/// @param map The slot map.
+/// @param index The zero-based index of the item, in [0, map->count).
+/// @return The handle of the item at @a index.
+template <typename T>
+inline uint64_t slot_map_handle(
+    data::slot_map_t<T> const *map,
+    size_t                     index)
+{
+    uint32_t slot = map->item_slots[index];
+    return (uint64_t(map->generations[slot]) << 32) | slot;
+}
+
+/// Removes an item from a slot map. The last item in the dense item array is
+/// moved into the vacated position, so the order of items is not preserved.
+///
+/// @param map The slot map.
+/// @param handle The handle of the item to remove.
+/// @param out_item On return, if non-NULL, stores a copy of the removed item.
+/// @return One if the item was removed, or zero if @a handle is stale.
+template <typename T>
+inline size_t slot_map_remove(
+    data::slot_map_t<T> *map,
+    uint64_t             handle,
+    T                   *out_item = NULL)
+{
+    if (!slot_map_valid(map, handle)) return 0;
+
+    uint32_t slot  = uint32_t(handle & 0xFFFFFFFFUL);
+    uint32_t index = map->slot_items[slot];
+    uint32_t last  = uint32_t(--map->count);
+    if (out_item) *out_item = map->items[index];
+    if (index != last)
+    {
+        uint32_t moved          = map->item_slots[last];
+        map->items[index]       = map->items[last];
+        map->item_slots[index]  = moved;
+        map->slot_items[moved]  = index;
+    }
+    // bump the generation so outstanding handles become stale. generation
+    // zero is skipped so that DATA_SLOT_HANDLE_INVALID is never valid.
+    if (++map->generations[slot] == 0) map->generations[slot] = 1;
+    map->slot_items[slot] = map->free_slot;
+    map->free_slot        = slot;
+    return 1;
+}
+
 /// Attempts to add an item to an unordered key-value table. This operation has
 /// O(N) time complexity because the table is unordered. When the table has
 /// been fully populated, use the runtime sort function in combination with an
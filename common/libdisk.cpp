@@ -10,6 +10,7 @@
 //   Includes   //
 ////////////////*/
 #include <assert.h>
+#include <stdlib.h>
 #include "libdisk.hpp"
 
 /*//////////////////////////
@@ -711,6 +711,13 @@ void json::write(FILE *fp, json::item_t *root)
 void json::free(json::item_t *node, json::alloc_t *allocator)
 {
     if (NULL == node) return;
+    if (NULL == allocator)
+    {
+        // use the same default allocator as json::parse().
+        json::alloc_t libc = {libc_alloc, libc_free};
+        json::free(node, &libc);
+        return;
+    }
     // recurse across the list:
     json::free(node->next_sibling, allocator);
     // recurse down the tree:
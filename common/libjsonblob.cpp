@@ -0,0 +1,1159 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements direct conversion between JSON text and data blobs.
+/// The reader walks the text once, emitting fields into a blob::builder_t as
+/// it goes; the writer walks a validated blob and batches the generated text
+/// into a fixed-size buffer.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libjsonblob.hpp"
+#include "libhash.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the size of the buffer used to batch text passed to a jsonblob::write_fn.
+#define JSON_WRITE_BUFFER_SIZE  16384
+
+/// the longest key, after escape sequences are decoded, accepted by to_blob.
+#define JSON_MAX_KEY_SIZE       256
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct reader_t
+{
+    char const      *text;     /// the start of the document
+    char const      *it;       /// the current read position
+    char const      *end;      /// one past the last byte of the document
+    blob::builder_t *builder;  /// receives the blob
+    char const      *error;    /// a description of the first error, or NULL
+    char const      *error_at; /// the position of the first error
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct writer_t
+{
+    jsonblob::write_fn write;   /// receives each block of text
+    void              *context; /// passed through to write
+    size_t             size;    /// the number of bytes used in buffer
+    bool               failed;  /// set once write returns false or on error
+    uint32_t          *names;   /// open-addressed table of hashed names
+    char const       **strs;    /// the name string for each slot of names
+    uint32_t           mask;    /// the number of slots in names, minus one
+    char               buffer[JSON_WRITE_BUFFER_SIZE];
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline bool is_digit(char ch)
+{
+    return (ch >= '0' && ch <= '9');
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static char* str_to_int(char *first, char *last, int64_t *out)
+{
+    int64_t  sign   = 1;
+    int64_t  result = 0;
+
+    if (first != last)
+    {
+        if ('-' == *first)
+        {
+            sign = -1;
+            ++first;
+        }
+        else if ('+' == *first)
+        {
+            sign = +1;
+            ++first;
+        }
+    }
+    for (; first != last && is_digit(*first); ++first)
+    {
+        result = 10 * result + (*first - '0');
+    }
+    *out = result * sign;
+    return first;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static char* str_to_hex(char *first, char *last, uint32_t *out)
+{
+    uint32_t result = 0;
+    for (; first != last; ++first)
+    {
+        unsigned int digit;
+        if (is_digit(*first))
+        {
+            digit = *first - '0';
+        }
+        else if (*first >= 'a' && *first <= 'f')
+        {
+            digit = *first - 'a' + 10;
+        }
+        else if (*first >= 'A' && *first <= 'F')
+        {
+            digit = *first - 'A' + 10;
+        }
+        else break;
+        result = 16 * result + digit;
+    }
+    *out = result;
+    return first;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static char* str_to_num(char *first, char *last, double *out)
+{
+    double sign     = 1.0;
+    double result   = 0.0;
+    bool   exp_neg  = false;
+    int    exponent = 0;
+
+    if (first != last)
+    {
+        if ('-' == *first)
+        {
+            sign = -1.0;
+            ++first;
+        }
+        else if ('+' == *first)
+        {
+            sign = +1.0;
+            ++first;
+        }
+    }
+    for (; first != last && is_digit(*first); ++first)
+    {
+        result = 10 * result + (*first - '0');
+    }
+    if (first != last && '.' == *first)
+    {
+        double inv_base = 0.1;
+        ++first;
+        for (; first != last && is_digit(*first); ++first)
+        {
+            result   += (*first - '0') * inv_base;
+            inv_base *= 0.1;
+        }
+    }
+    result *= sign;
+    if (first != last && ('e' == *first || 'E' == *first))
+    {
+        ++first;
+        if ('-' == *first)
+        {
+            exp_neg = true;
+            ++first;
+        }
+        else if ('+' == *first)
+        {
+            exp_neg = false;
+            ++first;
+        }
+        for (; first != last && is_digit(*first); ++first)
+        {
+            exponent = 10 * exponent + (*first - '0');
+        }
+    }
+    if (exponent != 0)
+    {
+        double power_of_ten = 10;
+        for (; exponent > 1; exponent--)
+        {
+            power_of_ten *= 10;
+        }
+        if (exp_neg) result /= power_of_ten;
+        else         result *= power_of_ten;
+    }
+    *out = result;
+    return first;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool read_fail(reader_t *r, char const *desc)
+{
+    // only the first error is reported.
+    if (NULL == r->error)
+    {
+        r->error    = desc;
+        r->error_at = r->it;
+    }
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline bool read_check(reader_t *r, bool builder_ok)
+{
+    return builder_ok ? true : read_fail(r, "Blob builder error");
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline void read_space(reader_t *r)
+{
+    while (r->it != r->end && ('\x20' == *r->it || '\x9' == *r->it || '\xD' == *r->it || '\xA' == *r->it))
+    {
+        ++r->it;
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool read_escape(reader_t *r, char *out, size_t *out_size)
+{
+    // decodes the escape sequence at r->it into at most four bytes of UTF-8.
+    char const *it = r->it + 1;
+    uint32_t    cp = 0;
+    if (r->end - it < 1)
+    {
+        return read_fail(r, "Unterminated string");
+    }
+    switch (*it)
+    {
+        case '"':  cp = '"';  break;
+        case '\\': cp = '\\'; break;
+        case '/':  cp = '/';  break;
+        case 'b':  cp = '\b'; break;
+        case 'f':  cp = '\f'; break;
+        case 'n':  cp = '\n'; break;
+        case 'r':  cp = '\r'; break;
+        case 't':  cp = '\t'; break;
+        case 'u':
+            {
+                if (r->end - it < 5 || str_to_hex((char*) it + 1, (char*) it + 5, &cp) != it + 5)
+                {
+                    return read_fail(r, "Invalid Unicode codepoint");
+                }
+                it += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF)
+                {
+                    // a high surrogate must be followed by a low surrogate.
+                    uint32_t lo = 0;
+                    if (r->end - it < 7 || it[1] != '\\' || it[2] != 'u' ||
+                        str_to_hex((char*) it + 3, (char*) it + 7, &lo) != it + 7 ||
+                        lo < 0xDC00 || lo > 0xDFFF)
+                    {
+                        return read_fail(r, "Invalid Unicode codepoint");
+                    }
+                    cp  = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    it += 6;
+                }
+            }
+            break;
+        default:
+            return read_fail(r, "Unrecognized escape sequence");
+    }
+    if (cp < 0x80)
+    {
+        out[0] = char(cp);
+        *out_size = 1;
+    }
+    else if (cp < 0x800)
+    {
+        out[0] = char(0xC0 | (cp >> 6));
+        out[1] = char(0x80 | (cp & 0x3F));
+        *out_size = 2;
+    }
+    else if (cp < 0x10000)
+    {
+        out[0] = char(0xE0 | (cp >> 12));
+        out[1] = char(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = char(0x80 | (cp & 0x3F));
+        *out_size = 3;
+    }
+    else
+    {
+        out[0] = char(0xF0 | (cp >> 18));
+        out[1] = char(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = char(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = char(0x80 | (cp & 0x3F));
+        *out_size = 4;
+    }
+    r->it = it + 1;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool read_key(reader_t *r, uint32_t *out_name)
+{
+    // keys without escape sequences are hashed in place.
+    char        key[JSON_MAX_KEY_SIZE];
+    size_t      key_size = 0;
+    char const *first    = ++r->it;
+    char const *last     = NULL;
+    while (r->it != r->end && *r->it != '"')
+    {
+        if ((unsigned char) *r->it < '\x20')
+        {
+            return read_fail(r, "Unexpected control character");
+        }
+        if ('\\' == *r->it)
+        {
+            char   ch[4];
+            size_t n = 0;
+            if (NULL == last)
+            {
+                if (size_t(r->it - first) > JSON_MAX_KEY_SIZE) return read_fail(r, "Key too long");
+                memcpy(key, first, r->it - first);
+                key_size = size_t(r->it - first);
+                last     = r->it;
+            }
+            if (!read_escape(r, ch, &n))
+            {
+                return false;
+            }
+            if (key_size + n > JSON_MAX_KEY_SIZE)
+            {
+                return read_fail(r, "Key too long");
+            }
+            memcpy(key + key_size, ch, n);
+            key_size += n;
+            continue;
+        }
+        if (last != NULL)
+        {
+            if (key_size == JSON_MAX_KEY_SIZE) return read_fail(r, "Key too long");
+            key[key_size++] = *r->it;
+        }
+        ++r->it;
+    }
+    if (r->it == r->end)
+    {
+        return read_fail(r, "Unterminated string");
+    }
+    if (NULL == last)
+    {
+        key_size = size_t(r->it - first);
+        last     = first;
+    }
+    else last = key;
+    ++r->it;
+    if (9 == key_size && '#' == last[0])
+    {
+        // a name written by jsonblob::from_blob() that had no string.
+        uint32_t name = 0;
+        if (str_to_hex((char*) last + 1, (char*) last + 9, &name) == last + 9)
+        {
+            *out_name = name;
+            return true;
+        }
+    }
+    if (!hash::generate_name(last, last + key_size, out_name))
+    {
+        return read_fail(r, "Invalid field name");
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool read_string(reader_t *r, uint32_t name)
+{
+    // runs of plain characters are appended to the array directly.
+    blob::builder_t *b     = r->builder;
+    char const      *first = ++r->it;
+    if (!read_check(r, blob::builder_begin_array(b, name, blob::FIELD_TYPE_CHAR)))
+    {
+        return false;
+    }
+    while (r->it != r->end && *r->it != '"')
+    {
+        if ((unsigned char) *r->it < '\x20')
+        {
+            return read_fail(r, "Unexpected control character");
+        }
+        if ('\\' == *r->it)
+        {
+            char   ch[4];
+            size_t n = 0;
+            if (!read_check(r, blob::builder_array_data(b, first, size_t(r->it - first))))
+            {
+                return false;
+            }
+            if (!read_escape(r, ch, &n) || !read_check(r, blob::builder_array_data(b, ch, n)))
+            {
+                return false;
+            }
+            first = r->it;
+            continue;
+        }
+        ++r->it;
+    }
+    if (r->it == r->end)
+    {
+        return read_fail(r, "Unterminated string");
+    }
+    char const nul = '\0';
+    bool       ok  = blob::builder_array_data(b, first, size_t(r->it - first)) &&
+                     blob::builder_array_data(b, &nul, 1) &&
+                     blob::builder_end_array(b);
+    ++r->it;
+    return read_check(r, ok);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool read_number(reader_t *r, uint32_t name, int32_t item_type)
+{
+    char const *first = r->it;
+    bool        real  = false;
+    while (r->it != r->end)
+    {
+        char ch = *r->it;
+        if ('.' == ch || 'e' == ch || 'E' == ch) real = true;
+        else if (!is_digit(ch) && ch != '-' && ch != '+') break;
+        ++r->it;
+    }
+    if (real || blob::FIELD_TYPE_FLOAT64 == item_type)
+    {
+        double value = 0.0;
+        if (str_to_num((char*) first, (char*) r->it, &value) != r->it || blob::FIELD_TYPE_SINT64 == item_type)
+        {
+            r->it = first;
+            return read_fail(r, "Bad number value");
+        }
+        return read_check(r, blob::builder_value(r->builder, name, blob::FIELD_TYPE_FLOAT64, &value));
+    }
+    int64_t value = 0;
+    if (str_to_int((char*) first, (char*) r->it, &value) != r->it)
+    {
+        r->it = first;
+        return read_fail(r, "Bad integer value");
+    }
+    return read_check(r, blob::builder_value(r->builder, name, blob::FIELD_TYPE_SINT64, &value));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool read_literal(reader_t *r, uint32_t name)
+{
+    size_t  remain = size_t(r->end - r->it);
+    uint8_t value  = 0;
+    if (remain >= 4 && 0 == memcmp(r->it, "null", 4))
+    {
+        r->it += 4;
+        return read_check(r, blob::builder_value(r->builder, name, blob::FIELD_TYPE_NULL, &value));
+    }
+    if (remain >= 4 && 0 == memcmp(r->it, "true", 4))
+    {
+        value  = 1;
+        r->it += 4;
+        return read_check(r, blob::builder_value(r->builder, name, blob::FIELD_TYPE_BOOLEAN, &value));
+    }
+    if (remain >= 5 && 0 == memcmp(r->it, "false", 5))
+    {
+        r->it += 5;
+        return read_check(r, blob::builder_value(r->builder, name, blob::FIELD_TYPE_BOOLEAN, &value));
+    }
+    return read_fail(r, "Unknown identifier");
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static int32_t array_item_type(reader_t *r)
+{
+    // blob arrays are homogeneous, so the element type is chosen from the
+    // first element. numeric arrays are scanned ahead for any real value.
+    char const *it = r->it;
+    if (it == r->end)
+    {
+        return blob::FIELD_TYPE_NONE;
+    }
+    switch (*it)
+    {
+        case ']': return blob::FIELD_TYPE_NULL;
+        case 'n': return blob::FIELD_TYPE_NULL;
+        case 't': return blob::FIELD_TYPE_BOOLEAN;
+        case 'f': return blob::FIELD_TYPE_BOOLEAN;
+        case '{': return blob::FIELD_TYPE_GN_OBJECT;
+        case '[': return blob::FIELD_TYPE_ARRAY;
+        case '"': return blob::FIELD_TYPE_ARRAY;
+        default:  break;
+    }
+    if (!is_digit(*it) && *it != '-' && *it != '+')
+    {
+        return blob::FIELD_TYPE_NONE;
+    }
+    for ( ; it != r->end && *it != ']'; ++it)
+    {
+        if ('.' == *it || 'e' == *it || 'E' == *it) return blob::FIELD_TYPE_FLOAT64;
+    }
+    return blob::FIELD_TYPE_SINT64;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool read_value(reader_t *r, uint32_t name, int32_t item_type);
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool read_array(reader_t *r, uint32_t name)
+{
+    ++r->it;
+    read_space(r);
+    int32_t item_type = array_item_type(r);
+    if (blob::FIELD_TYPE_NONE == item_type)
+    {
+        return read_fail(r, "Unexpected character");
+    }
+    if (!read_check(r, blob::builder_begin_array(r->builder, name, item_type)))
+    {
+        return false;
+    }
+    if (r->it != r->end && ']' == *r->it)
+    {
+        ++r->it;
+        return read_check(r, blob::builder_end_array(r->builder));
+    }
+    for ( ; ; )
+    {
+        if (!read_value(r, 0, item_type))
+        {
+            return false;
+        }
+        read_space(r);
+        if (r->it == r->end)
+        {
+            return read_fail(r, "Not all objects or arrays were closed");
+        }
+        if (']' == *r->it)
+        {
+            ++r->it;
+            return read_check(r, blob::builder_end_array(r->builder));
+        }
+        if (*r->it != ',')
+        {
+            return read_fail(r, "Expected \',\' or \']\'");
+        }
+        ++r->it;
+        read_space(r);
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool read_object(reader_t *r, uint32_t name)
+{
+    ++r->it;
+    read_space(r);
+    if (!read_check(r, blob::builder_begin_object(r->builder, name)))
+    {
+        return false;
+    }
+    if (r->it != r->end && '}' == *r->it)
+    {
+        ++r->it;
+        return read_check(r, blob::builder_end_object(r->builder));
+    }
+    for ( ; ; )
+    {
+        uint32_t key = 0;
+        if (r->it == r->end || *r->it != '"')
+        {
+            return read_fail(r, "Expected a field name");
+        }
+        if (!read_key(r, &key))
+        {
+            return false;
+        }
+        read_space(r);
+        if (r->it == r->end || *r->it != ':')
+        {
+            return read_fail(r, "Expected \':\'");
+        }
+        ++r->it;
+        read_space(r);
+        if (!read_value(r, key, blob::FIELD_TYPE_NONE))
+        {
+            return false;
+        }
+        read_space(r);
+        if (r->it == r->end)
+        {
+            return read_fail(r, "Not all objects or arrays were closed");
+        }
+        if ('}' == *r->it)
+        {
+            ++r->it;
+            return read_check(r, blob::builder_end_object(r->builder));
+        }
+        if (*r->it != ',')
+        {
+            return read_fail(r, "Expected \',\' or \'}\'");
+        }
+        ++r->it;
+        read_space(r);
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool read_value(reader_t *r, uint32_t name, int32_t item_type)
+{
+    // within an array, item_type is the element type and each value must
+    // be of the matching kind.
+    int32_t kind = blob::FIELD_TYPE_NONE;
+    if (r->it == r->end)
+    {
+        return read_fail(r, "Unexpected end of document");
+    }
+    switch (*r->it)
+    {
+        case '{': kind = blob::FIELD_TYPE_GN_OBJECT; break;
+        case '[': kind = blob::FIELD_TYPE_ARRAY;     break;
+        case '"': kind = blob::FIELD_TYPE_ARRAY;     break;
+        case 'n': kind = blob::FIELD_TYPE_NULL;      break;
+        case 't': kind = blob::FIELD_TYPE_BOOLEAN;   break;
+        case 'f': kind = blob::FIELD_TYPE_BOOLEAN;   break;
+        default:
+            if (is_digit(*r->it) || '-' == *r->it || '+' == *r->it)
+            {
+                kind = (blob::FIELD_TYPE_NONE == item_type) ? blob::FIELD_TYPE_SINT64 : item_type;
+                if (kind != blob::FIELD_TYPE_SINT64 && kind != blob::FIELD_TYPE_FLOAT64)
+                {
+                    return read_fail(r, "Mixed-type array");
+                }
+                return read_number(r, name, item_type);
+            }
+            return read_fail(r, "Unexpected character");
+    }
+    if (item_type != blob::FIELD_TYPE_NONE && item_type != kind)
+    {
+        return read_fail(r, "Mixed-type array");
+    }
+    switch (*r->it)
+    {
+        case '{': return read_object(r, name);
+        case '[': return read_array (r, name);
+        case '"': return read_string(r, name);
+        default:  break;
+    }
+    return read_literal(r, name);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void write_flush(writer_t *w)
+{
+    if (w->size > 0 && !w->failed)
+    {
+        w->failed = !w->write(w->buffer, w->size, w->context);
+    }
+    w->size = 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void write_text(writer_t *w, char const *text, size_t size)
+{
+    if (size > JSON_WRITE_BUFFER_SIZE - w->size)
+    {
+        write_flush(w);
+        if (size > JSON_WRITE_BUFFER_SIZE)
+        {
+            // too big to buffer; pass it straight through.
+            if (!w->failed) w->failed = !w->write(text, size, w->context);
+            return;
+        }
+    }
+    memcpy(w->buffer + w->size, text, size);
+    w->size += size;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline void write_char(writer_t *w, char ch)
+{
+    if (JSON_WRITE_BUFFER_SIZE == w->size) write_flush(w);
+    w->buffer[w->size++] = ch;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void write_integer(writer_t *w, uint64_t magnitude, bool negative)
+{
+    char  digits[24];
+    char *p = digits + sizeof(digits);
+    do
+    {
+        *--p = char('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (negative) *--p = '-';
+    write_text(w, p, size_t(digits + sizeof(digits) - p));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline void write_signed(writer_t *w, int64_t value)
+{
+    if (value < 0) write_integer(w, uint64_t(0) - uint64_t(value), true);
+    else write_integer(w, uint64_t(value), false);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void write_real(writer_t *w, double value, bool single)
+{
+    // JSON has no representation for NaN or infinity. integral values keep
+    // a fraction so that they read back as floating point.
+    static double const Pow10[16] =
+    {
+        1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+        1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+    };
+    char text[40];
+    int  size = 0;
+    if (value != value || value - value != 0.0)
+    {
+        write_text(w, "null", 4);
+        return;
+    }
+    // sprintf() is slow, so first look for the fewest decimal places that
+    // reproduce the value exactly. both the scaled mantissa and the power
+    // of ten are exact doubles, so the division rounds correctly.
+    double magnitude = value < 0.0 ? -value : value;
+    for (size_t places = 0; places < 16 && magnitude * Pow10[places] < 9007199254740992.0; ++places)
+    {
+        double   scaled = magnitude * Pow10[places];
+        uint64_t digits = uint64_t(scaled + 0.5);
+        double   check  = double(digits) / Pow10[places];
+        if (single ? float(check) != float(magnitude) : check != magnitude)
+        {
+            continue;
+        }
+        uint64_t whole  = digits;
+        char    *p      = text + sizeof(text);
+        for (size_t i = 0; i < places; ++i)
+        {
+            *--p   = char('0' + whole % 10);
+            whole /= 10;
+        }
+        if (0 == places) *--p = '0';
+        *--p = '.';
+        do
+        {
+            *--p   = char('0' + whole % 10);
+            whole /= 10;
+        } while (whole != 0);
+        if (value < 0.0) *--p = '-';
+        write_text(w, p, size_t(text + sizeof(text) - p));
+        return;
+    }
+    size = sprintf(text, single ? "%.9g" : "%.17g", value);
+    if (NULL == strpbrk(text, ".e"))
+    {
+        text[size++] = '.';
+        text[size++] = '0';
+    }
+    write_text(w, text, size_t(size));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void write_string(writer_t *w, char const *str, size_t size)
+{
+    static char const Hex[] = "0123456789ABCDEF";
+    char const *first = str;
+    char const *end   = str + size;
+    write_char(w, '"');
+    for (char const *it = str; it != end; ++it)
+    {
+        unsigned char ch = (unsigned char) *it;
+        if (ch >= '\x20' && ch != '"' && ch != '\\')
+        {
+            continue;
+        }
+        char   esc[6] = {'\\', char(ch), 0, 0, 0, 0};
+        size_t n      = 2;
+        switch (ch)
+        {
+            case '"':  break;
+            case '\\': break;
+            case '\b': esc[1] = 'b'; break;
+            case '\f': esc[1] = 'f'; break;
+            case '\n': esc[1] = 'n'; break;
+            case '\r': esc[1] = 'r'; break;
+            case '\t': esc[1] = 't'; break;
+            default:
+                esc[1] = 'u'; esc[2] = '0'; esc[3] = '0';
+                esc[4] = Hex[ch >> 4];
+                esc[5] = Hex[ch & 15];
+                n      = 6;
+                break;
+        }
+        write_text(w, first, size_t(it - first));
+        write_text(w, esc, n);
+        first = it + 1;
+    }
+    write_text(w, first, size_t(end - first));
+    write_char(w, '"');
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void write_name(writer_t *w, uint32_t name)
+{
+    if (w->names != NULL)
+    {
+        for (uint32_t slot = name & w->mask; w->strs[slot] != NULL; slot = (slot + 1) & w->mask)
+        {
+            if (w->names[slot] == name)
+            {
+                write_string(w, w->strs[slot], strlen(w->strs[slot]));
+                write_char(w, ':');
+                return;
+            }
+        }
+    }
+    static char const Hex[] = "0123456789abcdef";
+    char text[12] = {'"', '#'};
+    for (size_t i = 0; i < 8; ++i)
+    {
+        text[2 + i] = Hex[(name >> (28 - i * 4)) & 15];
+    }
+    text[10] = '"';
+    text[11] = ':';
+    write_text(w, text, sizeof(text));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+template <typename T>
+static inline T load(uint8_t const *p)
+{
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline bool write_bounds(writer_t *w, size_t limit, size_t offset, size_t amount)
+{
+    // the blob has been validated, so this only fails if the validator and
+    // the writer disagree; stop writing rather than read out of bounds.
+    if (offset <= limit && amount <= limit - offset)
+    {
+        return true;
+    }
+    w->failed = true;
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static size_t write_body(writer_t *w, uint8_t *data, size_t limit, int32_t type, size_t offset)
+{
+    // writes the value whose body starts at offset, reading no further than
+    // limit. returns the offset of the end of the value.
+    uint8_t const *p     = data + offset;
+    size_t         fixed = blob::field_size_for_type(type);
+    if (w->failed)
+    {
+        return limit;
+    }
+    if (fixed != BLOB_FIELD_SIZE_VARIABLE && !write_bounds(w, limit, offset, fixed))
+    {
+        return limit;
+    }
+    switch (type)
+    {
+        case blob::FIELD_TYPE_NULL:    write_text(w, "null", 4); return offset;
+        case blob::FIELD_TYPE_BOOLEAN: if (p[0]) write_text(w, "true", 4); else write_text(w, "false", 5); return offset + 1;
+        case blob::FIELD_TYPE_CHAR:    write_signed(w, load<int8_t>(p));   return offset + 1;
+        case blob::FIELD_TYPE_SINT8:   write_signed(w, load<int8_t>(p));   return offset + 1;
+        case blob::FIELD_TYPE_UINT8:   write_integer(w, load<uint8_t>(p), false);  return offset + 1;
+        case blob::FIELD_TYPE_SINT16:  write_signed(w, load<int16_t>(p));  return offset + 2;
+        case blob::FIELD_TYPE_UINT16:  write_integer(w, load<uint16_t>(p), false); return offset + 2;
+        case blob::FIELD_TYPE_SINT32:  write_signed(w, load<int32_t>(p));  return offset + 4;
+        case blob::FIELD_TYPE_UINT32:  write_integer(w, load<uint32_t>(p), false); return offset + 4;
+        case blob::FIELD_TYPE_SINT64:  write_signed(w, load<int64_t>(p));  return offset + 8;
+        case blob::FIELD_TYPE_UINT64:  write_integer(w, load<uint64_t>(p), false); return offset + 8;
+        case blob::FIELD_TYPE_FLOAT32: write_real(w, load<float>(p), true); return offset + 4;
+        case blob::FIELD_TYPE_FLOAT64: write_real(w, load<double>(p), false); return offset + 8;
+        case blob::FIELD_TYPE_ARRAY:
+            {
+                if (!write_bounds(w, limit, offset, sizeof(uint32_t) * 2))
+                {
+                    return limit;
+                }
+                uint32_t count     = load<uint32_t>(p);
+                int32_t  item_type = load<int32_t>(p + sizeof(uint32_t));
+                size_t   item_size = blob::field_size_for_type(item_type);
+                size_t   at        = offset + sizeof(uint32_t) * 2;
+                if (item_size != BLOB_FIELD_SIZE_VARIABLE && item_size > 0 &&
+                    count > (limit - at) / item_size)
+                {
+                    w->failed = true;
+                    return limit;
+                }
+                if (blob::FIELD_TYPE_CHAR == item_type)
+                {
+                    // strings are stored with their NULL-terminator.
+                    size_t length = count;
+                    if (length > 0 && '\0' == data[at + length - 1]) length--;
+                    write_string(w, (char const*) data + at, length);
+                    return at + count;
+                }
+                write_char(w, '[');
+                for (uint32_t i = 0; i < count && !w->failed; ++i)
+                {
+                    if (i > 0) write_char(w, ',');
+                    at = write_body(w, data, limit, item_type, at);
+                }
+                write_char(w, ']');
+                return at;
+            }
+        case blob::FIELD_TYPE_GN_OBJECT:
+            {
+                size_t field_header_size = sizeof(uint32_t) * 3;
+                if (!write_bounds(w, limit, offset, sizeof(uint32_t) * 2))
+                {
+                    return limit;
+                }
+                uint32_t count = load<uint32_t>(p);
+                uint32_t size  = load<uint32_t>(p + sizeof(uint32_t));
+                size_t   at    = offset + sizeof(uint32_t) * 2;
+                size_t   end   = at + size;
+                if (!write_bounds(w, limit, at, size))
+                {
+                    return limit;
+                }
+                // each field body is bounded by its own declared size.
+                write_char(w, '{');
+                for (uint32_t i = 0; i < count && !w->failed; ++i)
+                {
+                    if (!write_bounds(w, end, at, field_header_size))
+                    {
+                        break;
+                    }
+                    uint32_t name  = load<uint32_t>(data + at);
+                    int32_t  ftype = load<int32_t> (data + at + sizeof(uint32_t));
+                    uint32_t fsize = load<uint32_t>(data + at + sizeof(uint32_t) * 2);
+                    size_t   body  = at + field_header_size;
+                    if (!write_bounds(w, end, body, fsize))
+                    {
+                        break;
+                    }
+                    if (i > 0) write_char(w, ',');
+                    write_name(w, name);
+                    write_body(w, data, body + fsize, ftype, body);
+                    at = body + fsize;
+                }
+                write_char(w, '}');
+                return end;
+            }
+        case blob::FIELD_TYPE_RT_OBJECT:
+            {
+                // the header layout is checked by blob::field_offset_valid();
+                // the values are still read no further than the object end.
+                blob::runtime_object_t object;
+                blob::runtime_object_at(data, offset, &object);
+                if (!write_bounds(w, limit, offset, object.object_size))
+                {
+                    return limit;
+                }
+                size_t base = size_t((uint8_t*) object.field_values - data);
+                size_t end  = offset + object.object_size;
+                write_char(w, '{');
+                for (size_t i = 0; i < object.field_count && !w->failed; ++i)
+                {
+                    size_t at = base + object.field_offsets[i];
+                    if (!write_bounds(w, end, at, sizeof(int32_t)))
+                    {
+                        break;
+                    }
+                    if (i > 0) write_char(w, ',');
+                    write_name(w, object.field_names[i]);
+                    write_body(w, data, end, load<int32_t>(data + at), at + sizeof(int32_t));
+                }
+                write_char(w, '}');
+                return end;
+            }
+        case blob::FIELD_TYPE_PROTOTYPE:
+            {
+                if (!write_bounds(w, limit, offset, sizeof(uint32_t)))
+                {
+                    return limit;
+                }
+                uint32_t count = load<uint32_t>(p);
+                size_t   names = offset + sizeof(uint32_t);
+                size_t   types = names  + count * sizeof(uint32_t);
+                if (count > (limit - names) / (sizeof(uint32_t) + sizeof(int32_t)))
+                {
+                    w->failed = true;
+                    return limit;
+                }
+                write_char(w, '{');
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    if (i > 0) write_char(w, ',');
+                    write_name(w, load<uint32_t>(data + names + i * sizeof(uint32_t)));
+                    write_signed(w, load<int32_t>(data + types + i * sizeof(int32_t)));
+                }
+                write_char(w, '}');
+                return types + count * sizeof(int32_t);
+            }
+        default:
+            break;
+    }
+    // vectors and matrices are written as flat arrays.
+    size_t count = fixed / sizeof(float);
+    write_char(w, '[');
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i > 0) write_char(w, ',');
+        write_real(w, load<float>(p + i * sizeof(float)), true);
+    }
+    write_char(w, ']');
+    return offset + fixed;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool jsonblob::to_blob(
+    char const      *text,
+    size_t           text_size,
+    blob::builder_t *builder,
+    json::error_t   *out_error)
+{
+    reader_t r = {text, text, text + text_size, builder, NULL, NULL};
+    bool     ok;
+    read_space(&r);
+    if (r.it == r.end || '\0' == *r.it)
+    {
+        ok = read_fail(&r, "Empty document");
+    }
+    else ok = read_value(&r, 0, blob::FIELD_TYPE_NONE);
+    if (ok)
+    {
+        // a NULL-terminator may be included in the text size.
+        read_space(&r);
+        if (r.it != r.end && *r.it != '\0')
+        {
+            ok = read_fail(&r, "Multiple root objects");
+        }
+    }
+    if (!ok && out_error != NULL)
+    {
+        out_error->description = r.error;
+        out_error->position    = r.error_at;
+        out_error->line        = 1;
+        for (char const *c = text; c != r.error_at; ++c)
+        {
+            if ('\n' == *c) out_error->line++;
+        }
+    }
+    return ok;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool jsonblob::from_blob(
+    void                *data,
+    size_t               data_size,
+    jsonblob::write_fn   write_func,
+    void                *context,
+    char const         **name_strs,
+    size_t               name_count)
+{
+    writer_t *w     = NULL;
+    uint8_t  *bytes = (uint8_t*) data;
+    size_t    count = 0;
+    size_t    end   = 0;
+    bool      ok    = true;
+    // validate everything before writing anything.
+    for (size_t at = 0; at < data_size; at = end, ++count)
+    {
+        if (!blob::field_offset_valid(data, data_size, ptrdiff_t(at)))
+        {
+            return false;
+        }
+        end = at + blob::field_total_size(data, ptrdiff_t(at));
+    }
+    if (NULL == (w = (writer_t*) ::malloc(sizeof(writer_t))))
+    {
+        return false;
+    }
+    w->write   = write_func;
+    w->context = context;
+    w->size    = 0;
+    w->failed  = false;
+    w->names   = NULL;
+    w->strs    = NULL;
+    w->mask    = 0;
+    if (name_count > 0 && name_strs != NULL)
+    {
+        // hash the known names once, into a table at most half full.
+        uint32_t slots = 4;
+        while (slots < name_count * 2) slots <<= 1;
+        w->names = (uint32_t*)    ::malloc(slots * sizeof(uint32_t));
+        w->strs  = (char const**) ::calloc(slots,  sizeof(char const*));
+        w->mask  = slots - 1;
+        if (NULL == w->names || NULL == w->strs)
+        {
+            ::free(w->strs);
+            ::free(w->names);
+            ::free(w);
+            return false;
+        }
+        for (size_t i = 0; i < name_count; ++i)
+        {
+            char const *str  = name_strs[i];
+            uint32_t    name = 0;
+            if (!hash::generate_name(str, str + strlen(str), &name)) continue;
+            uint32_t slot = name & w->mask;
+            while (w->strs[slot] != NULL && w->names[slot] != name)
+            {
+                slot = (slot + 1) & w->mask;
+            }
+            w->names[slot] = name;
+            w->strs [slot] = name_strs[i];
+        }
+    }
+    if (count != 1) write_char(w, '[');
+    end = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i > 0) write_char(w, ',');
+        size_t next = end + blob::field_total_size(data, ptrdiff_t(end));
+        write_body(w, bytes, next, blob::read_s32(data, ptrdiff_t(end)), end + sizeof(int32_t));
+        end = next;
+    }
+    if (count != 1) write_char(w, ']');
+    write_flush(w);
+    ok = !w->failed;
+    ::free(w->strs);
+    ::free(w->names);
+    ::free(w);
+    return ok;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
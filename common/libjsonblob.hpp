@@ -0,0 +1,101 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Defines an interface for converting directly between JSON text
+/// and data blobs, without building a tree of json::item_t nodes. JSON text is
+/// read straight into a blob::builder_t, and blobs are written out as JSON
+/// text through a buffered writer. Field names are mapped to and from their
+/// integer form with hash::generate_name().
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+#ifndef LIBJSONBLOB_HPP_INCLUDED
+#define LIBJSONBLOB_HPP_INCLUDED
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include "common.hpp"
+#include "libjson.hpp"
+#include "libblob.hpp"
+
+/*///////////////////////
+//   Namespace Begin   //
+///////////////////////*/
+namespace jsonblob {
+
+/*////////////////////////////
+//   Forward Declarations   //
+////////////////////////////*/
+
+/*//////////////////////////////////
+//   Public Types and Functions   //
+//////////////////////////////////*/
+/// Function signature for a user-defined function that receives the text
+/// generated by jsonblob::from_blob(). The text is delivered in blocks of up
+/// to several kilobytes, in order.
+///
+/// @param data The block of UTF-8 text. The text is not NULL-terminated.
+/// @param size_in_bytes The number of bytes of text in @a data.
+/// @param context Opaque data passed to jsonblob::from_blob().
+/// @return true to continue, or false to stop writing.
+typedef bool          (CMN_CALL_C *write_fn)(
+    char const   *data,
+    size_t        size_in_bytes,
+    void         *context);
+
+/// Converts a JSON document directly into a blob, without building a tree of
+/// json::item_t nodes. The document is not modified. Objects are written as
+/// generic objects, with each key mapped through hash::generate_name(), or,
+/// for a key of the form "#XXXXXXXX", taken as the given hexadecimal name.
+/// Strings become arrays of characters, including a NULL-terminator,
+/// integers become 64-bit signed values and other numbers 64-bit floating
+/// point values. Arrays must hold values of a single kind, except that an
+/// array mixing integers and other numbers is stored as floating point.
+///
+/// @param text The JSON document. This need not be NULL-terminated.
+/// @param text_size The size of the document, in bytes.
+/// @param builder The builder that receives the root value as a single
+/// top-level field. The builder must have been initialized.
+/// @param out_error The structure that will be populated with error details
+/// if an error occurs. This value is optional and may be NULL.
+/// @return true if the document was converted; false if it is malformed or
+/// cannot be represented as a blob, or if the builder failed.
+CMN_PUBLIC bool to_blob(
+    char const      *text,
+    size_t           text_size,
+    blob::builder_t *builder,
+    json::error_t   *out_error);
+
+/// Converts a blob directly into JSON text, delivered through a buffered
+/// writer. A blob with a single top-level field produces that value; one
+/// with several produces an array of them. Field names are written as the
+/// matching string from @a name_strs, or as "#XXXXXXXX" if the name is not
+/// listed, which jsonblob::to_blob() maps back to the same name. Vectors and
+/// matrices are written as flat arrays of numbers, and character arrays as
+/// strings. Every top-level field is checked with blob::field_offset_valid()
+/// before any text is written.
+///
+/// @param data The blob data.
+/// @param data_size The size of the blob data, in bytes.
+/// @param write_func The function that receives the generated text.
+/// @param context Opaque data passed to @a write_func.
+/// @param name_strs An optional array of NULL-terminated field name strings,
+/// used to map names back to strings through hash::generate_name().
+/// @param name_count The number of strings in @a name_strs.
+/// @return true if the blob was well-formed and all of the text was written.
+CMN_PUBLIC bool from_blob(
+    void                *data,
+    size_t               data_size,
+    jsonblob::write_fn   write_func,
+    void                *context,
+    char const         **name_strs  = NULL,
+    size_t               name_count = 0);
+
+/*/////////////////////
+//   Namespace End   //
+/////////////////////*/
+}; /* end namespace jsonblob */
+
+#endif /* LIBJSONBLOB_HPP_INCLUDED */
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
@@ -888,6 +888,238 @@ private:
     trace_allocator_t& operator =(trace_allocator_t const &other); /* noimp */
 };
 
+/// A dynamic array which stores up to N items inline, within the object itself,
+/// and only spills to memory obtained from an allocator_t once that inline
+/// capacity is exceeded. Small collections therefore never touch the heap and
+/// keep their items adjacent to the owning structure.
+template <typename T, size_t N>
+class small_vector_t
+{
+public:
+    small_vector_t(allocator_t *alloc = NULL);
+    ~small_vector_t(void);
+
+    /// Retrieves the number of items currently stored in the vector.
+    /// @return The number of items stored in the vector.
+    size_t   size(void) const     { return count;    }
+
+    /// Retrieves the number of items that can be stored without reallocating.
+    /// @return The current capacity of the vector, in items.
+    size_t   capacity(void) const { return max_count; }
+
+    /// Determines whether the vector is currently empty.
+    /// @return true if the vector contains no items.
+    bool     empty(void) const    { return (0 == count); }
+
+    /// Determines whether items are currently stored in the inline buffer.
+    /// @return true if the vector has not spilled to allocator memory.
+    bool     is_inline(void) const { return (items == inline_items()); }
+
+    /// Retrieves a pointer to the first item in the vector.
+    /// @return A pointer to the contiguous item storage.
+    T*       data(void)           { return items; }
+    T const* data(void) const     { return items; }
+
+    /// Retrieves a pointer to one-past the last item in the vector.
+    /// @return A pointer to the end of the item storage.
+    T*       end(void)            { return items + count; }
+    T const* end(void) const      { return items + count; }
+
+    T&       operator[](size_t index)       { assert(index < count); return items[index]; }
+    T const& operator[](size_t index) const { assert(index < count); return items[index]; }
+
+    /// Ensures that the vector can store at least the specified number of
+    /// items without further reallocation.
+    /// @param capacity The minimum number of items the vector must hold.
+    /// @return true if the storage is sufficient, or false if the vector
+    /// has no allocator or the allocation failed.
+    bool     reserve(size_t capacity);
+
+    /// Appends a copy of an item to the end of the vector.
+    /// @param item The item to copy.
+    /// @return true if the item was appended.
+    bool     push_back(T const &item);
+
+    /// Removes the last item from the vector. The vector must not be empty.
+    void     pop_back(void);
+
+    /// Inserts a copy of an item at a given position, shifting the items
+    /// at and after @a index towards the end of the vector.
+    /// @param index The zero-based insertion index, in [0, size()].
+    /// @param item The item to copy.
+    /// @return true if the item was inserted.
+    bool     insert(size_t index, T const &item);
+
+    /// Removes the item at a given position, preserving the order of the
+    /// remaining items. This operation is O(n).
+    /// @param index The zero-based index of the item to remove.
+    void     remove(size_t index);
+
+    /// Removes the item at a given position by moving the last item into
+    /// its place. This operation is O(1) but does not preserve order.
+    /// @param index The zero-based index of the item to remove.
+    void     remove_swap(size_t index);
+
+    /// Destroys all items in the vector. Allocator memory, if any, is kept.
+    void     clear(void);
+
+    /// Destroys all items in the vector and returns any allocator memory,
+    /// so that subsequent items are stored inline again.
+    void     shrink(void);
+
+private:
+    small_vector_t(small_vector_t const &other);             /* noimp */
+    small_vector_t& operator =(small_vector_t const &other); /* noimp */
+
+    T*       inline_items(void) const
+    {
+        return (T*) storage.bytes;
+    }
+
+    bool     grow(size_t min_capacity);
+
+private:
+    typedef traits::type_with_alignment<traits::alignof<T>::value> align_t;
+
+    T           *items;      /// Points at the inline buffer or allocator memory
+    size_t       count;      /// The number of items currently stored
+    size_t       max_count;  /// The number of items that can be stored
+    allocator_t *allocator;  /// The allocator used once N items is exceeded
+    union
+    {
+        align_t  align;      /// Forces the alignment of the inline buffer
+        uint8_t  bytes[N * sizeof(T)];
+    }            storage;    /// The inline item buffer
+};
+
+template <typename T, size_t N>
+inline small_vector_t<T, N>::small_vector_t(allocator_t *alloc /* = NULL */)
+    :
+    items(NULL),
+    count(0),
+    max_count(N),
+    allocator(alloc)
+{
+    items = inline_items();
+}
+
+template <typename T, size_t N>
+inline small_vector_t<T, N>::~small_vector_t(void)
+{
+    shrink();
+}
+
+template <typename T, size_t N>
+inline bool small_vector_t<T, N>::grow(size_t min_capacity)
+{
+    if (NULL == allocator) return false;
+
+    size_t new_max = max_count * 2;
+    if (new_max < min_capacity) new_max = min_capacity;
+
+    T *new_items   = (T*) allocator->allocate(new_max * sizeof(T), traits::alignof<T>::value);
+    if (NULL == new_items) return false;
+
+    traits::copy_construct(items, count, new_items);
+    traits::destruct(items, count);
+    if (items != inline_items()) allocator->deallocate(items);
+    items     = new_items;
+    max_count = new_max;
+    return true;
+}
+
+template <typename T, size_t N>
+inline bool small_vector_t<T, N>::reserve(size_t capacity)
+{
+    if (capacity <= max_count) return true;
+    else return grow(capacity);
+}
+
+template <typename T, size_t N>
+inline bool small_vector_t<T, N>::push_back(T const &item)
+{
+    if (count == max_count)
+    {
+        // item may refer to an item in this vector, which grow() destroys,
+        // so take a copy of it before growing.
+        T temp(item);
+        if (!grow(count + 1)) return false;
+        traits::copy_construct(&items[count++], temp);
+        return true;
+    }
+    traits::copy_construct(&items[count++], item);
+    return true;
+}
+
+template <typename T, size_t N>
+inline void small_vector_t<T, N>::pop_back(void)
+{
+    assert(count > 0);
+    traits::destruct(&items[--count]);
+}
+
+template <typename T, size_t N>
+inline bool small_vector_t<T, N>::insert(size_t index, T const &item)
+{
+    assert(index <= count);
+    if (index == count) return push_back(item);
+    // take a copy of the source item first, since it may refer to an item
+    // in this vector, which is moved by the shift and destroyed by grow().
+    T temp(item);
+    if (count == max_count && !grow(count + 1))
+    {
+        return false;
+    }
+    // copy-construct the new last item from the current last item, then
+    // shift the remaining items up using assignment.
+    traits::copy_construct(&items[count], items[count-1]);
+    for (size_t i = count - 1; i > index; --i)
+    {
+        items[i] = items[i-1];
+    }
+    items[index] = temp;
+    count++;
+    return true;
+}
+
+template <typename T, size_t N>
+inline void small_vector_t<T, N>::remove(size_t index)
+{
+    assert(index < count);
+    for (size_t i = index + 1; i < count; ++i)
+    {
+        items[i-1] = items[i];
+    }
+    traits::destruct(&items[--count]);
+}
+
+template <typename T, size_t N>
+inline void small_vector_t<T, N>::remove_swap(size_t index)
+{
+    assert(index < count);
+    if (index != count - 1) items[index] = items[count-1];
+    traits::destruct(&items[--count]);
+}
+
+template <typename T, size_t N>
+inline void small_vector_t<T, N>::clear(void)
+{
+    traits::destruct(items, count);
+    count = 0;
+}
+
+template <typename T, size_t N>
+inline void small_vector_t<T, N>::shrink(void)
+{
+    clear();
+    if (items != inline_items())
+    {
+        allocator->deallocate(items);
+        items     = inline_items();
+        max_count = N;
+    }
+}
+
 /// Captures the callstack for the current thread without performing any symbol
 /// lookup to resolve addresses into symbol names.
 ///
@@ -187,12 +187,26 @@ void network::close(network::socket_t const &sockfd)
 #if CMN_IS_WINDOWS
     closesocket(sockfd);
 #else
-    close(sockfd);
+    ::close(sockfd);
 #endif
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+bool network::readable(
+    network::socket_t const &sockfd,
+    uint64_t                 timeout_usec)
+{
+    if (INVALID_SOCKET_ID == sockfd)
+    {
+        // invalid parameter. return immediately.
+        return false;
+    }
+    return wait_for_read(sockfd, timeout_usec);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 bool network::listen(
     char const        *service_or_port,
     size_t             backlog,
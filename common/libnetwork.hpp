@@ -93,6 +93,18 @@ CMN_PUBLIC bool socket_valid(network::socket_t const &sockfd);
 /// @param sockfd The socket handle to close.
 CMN_PUBLIC void close(network::socket_t const &sockfd);
 
+/// Waits for a socket to become readable. For a listening socket, this
+/// indicates that a call to network::accept() will not block. Specify a
+/// timeout of zero to poll the socket without waiting.
+///
+/// @param sockfd The socket handle to poll.
+/// @param timeout_usec The maximum amount of time to wait, in microseconds.
+/// @return true if the socket is readable, or false if the wait timed out or
+/// an error occurred.
+CMN_PUBLIC bool readable(
+    network::socket_t const &sockfd,
+    uint64_t                 timeout_usec);
+
 /// Creates a TCP streaming 'server' socket listening on the specified port.
 /// The socket is created as a blocking socket. This process creates the
 /// socket, binds it to the default interface on the specified port, and places
@@ -16,6 +16,7 @@
 //////////////////////////*/
 using processor::thread_t;
 using processor::channel_t;
+using processor::mpsc_list_t;
 
 /*//////////////////////
 //   Implementation   //
@@ -280,7 +281,7 @@ uint64_t processor::current_time(void)
     }
     return mach_absolute_time() * Time_Scale.numer / Time_Scale.denom;
 #elif CMN_IS_LINUX
-    struct timespect ts   = {0};
+    struct timespec  ts   = {0};
     clock_gettime(CLOCK_REALTIME, &ts);
     return (uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec);
 #elif CMN_IS_WINDOWS
@@ -799,6 +800,70 @@ bool channel_t::describe_write(
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+mpsc_list_t::mpsc_list_t(void)
+    :
+    head(&stub),
+    tail(&stub)
+{
+    stub.next = NULL;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void mpsc_list_t::push(processor::mpsc_node_t *node)
+{
+    // swing the head to the new node, then link the previous head to it.
+    // until the link is made the reader sees the queue as momentarily empty.
+    node->next = NULL;
+    processor::mpsc_node_t *prev = (processor::mpsc_node_t*)
+        processor::exchange_pointer((void * volatile*) &head, node);
+    prev->next = node;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+processor::mpsc_node_t* mpsc_list_t::pop(void)
+{
+    processor::mpsc_node_t *node = tail;
+    processor::mpsc_node_t *next = node->next;
+    if (node == &stub)
+    {
+        // skip over the sentinel node.
+        if (NULL == next) return NULL;
+        tail = next;
+        node = next;
+        next = next->next;
+    }
+    if (next != NULL)
+    {
+        tail = next;
+        return node;
+    }
+    if (node != head)
+    {
+        // a writer has swung the head but not yet linked the node.
+        return NULL;
+    }
+    // node is the last node; re-insert the sentinel so it can be removed.
+    push(&stub);
+    next = node->next;
+    if (next != NULL)
+    {
+        tail = next;
+        return node;
+    }
+    return NULL;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool mpsc_list_t::empty(void) const
+{
+    return (tail == &stub && stub.next == NULL);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 /*/////////////////////////////////////////////////////////////////////////////
 //    $Id$
 ///////////////////////////////////////////////////////////////////////////80*/
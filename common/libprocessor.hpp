@@ -1228,6 +1228,456 @@ private:
     channel_t& operator =(channel_t const &other);
 };
 
+/// Atomically replaces a pointer value and returns the previous value. A full
+/// memory barrier is issued.
+///
+/// @param address The address of the pointer to update.
+/// @param new_value The value to store at @a address.
+/// @return The value previously stored at @a address.
+inline void* exchange_pointer(void * volatile *address, void *new_value)
+{
+#if   defined(__GNUC__)
+    // @note: __sync_lock_test_and_set is not a full barrier
+    // so we issue a __sync_synchronize (full barrier) afterward.
+    void *old_value = __sync_lock_test_and_set(address, new_value);
+    __sync_synchronize();
+    return old_value;
+#elif defined(_MSC_VER)
+    return _InterlockedExchangePointer(address, new_value);
+#else
+    #error No implementation of processor::exchange_pointer() for your platform!
+#endif
+}
+
+/// Defines a fixed-capacity, lock-free ring buffer of values of type T that
+/// is safe for concurrent access by a single reader and a single writer.
+/// Unlike channel_t, items are stored and returned by value, which avoids
+/// message framing for small payloads such as pointers or handles. T must be
+/// copyable using the assignment operator.
+template <typename T>
+class spsc_queue_t
+{
+public:
+    T                                                      *storage;
+    uint32_t                                                capacity;
+    uint32_t                                                mask;
+    CMN_ALIGN_BEGIN(64) volatile uint32_t CMN_ALIGN_END(64) offset_r;
+    CMN_ALIGN_BEGIN(64) volatile uint32_t CMN_ALIGN_END(64) offset_w;
+
+public:
+    /// Default constructor. Call spsc_queue_t::bind() before attempting to
+    /// access the queue.
+    spsc_queue_t(void)
+        :
+        storage(NULL),
+        capacity(0),
+        mask(0),
+        offset_r(0),
+        offset_w(0)
+    { /* empty */ }
+
+    /// Constructs a new instance bound to the specified storage. This is
+    /// equivalent to calling the default constructor followed by bind().
+    ///
+    /// @param buffer Pointer to the externally-managed array of items.
+    /// @param item_count The number of items in @a buffer. This value must
+    /// be a power-of-two.
+    spsc_queue_t(T *buffer, size_t item_count)
+        :
+        storage(NULL),
+        capacity(0),
+        mask(0),
+        offset_r(0),
+        offset_w(0)
+    {
+        bind(buffer, item_count);
+    }
+
+public:
+    /// Binds the queue to an externally-managed array of items, resetting
+    /// the queue to empty. This is not safe to call concurrently with any
+    /// other operation on the queue.
+    ///
+    /// @param buffer Pointer to the externally-managed array of items.
+    /// @param item_count The number of items in @a buffer. This value must
+    /// be a power-of-two.
+    /// @return true if the queue was bound to @a buffer.
+    bool bind(T *buffer, size_t item_count)
+    {
+        if (NULL == buffer || item_count < 2 || (item_count & (item_count - 1)) != 0)
+        {
+            assert((item_count & (item_count - 1)) == 0 && "Must be pow2");
+            return false;
+        }
+        storage  = buffer;
+        capacity = (uint32_t) item_count;
+        mask     = (uint32_t)(item_count - 1);
+        offset_r = 0;
+        offset_w = 0;
+        return true;
+    }
+
+    /// Unbinds the queue from its storage array.
+    ///
+    /// @param out_item_count On return, if non-NULL, stores the number of
+    /// items in the storage array.
+    /// @return A pointer to the storage array previously bound to the queue.
+    T* unbind(size_t *out_item_count = NULL)
+    {
+        T *buffer = storage;
+        if (out_item_count) *out_item_count = capacity;
+        storage   = NULL;
+        capacity  = 0;
+        mask      = 0;
+        offset_r  = 0;
+        offset_w  = 0;
+        return buffer;
+    }
+
+    /// Retrieves the approximate number of items currently in the queue.
+    ///
+    /// @return The number of items available to be read.
+    size_t count(void) const
+    {
+        return (size_t) (offset_w - offset_r);
+    }
+
+    /// Attempts to write a single item to the queue. Called from the writer.
+    ///
+    /// @param item The item to write.
+    /// @return true if the item was written, or false if the queue is full.
+    bool enqueue(T const &item)
+    {
+        return enqueue_batch(&item, 1) == 1;
+    }
+
+    /// Attempts to write several items to the queue. Called from the writer.
+    /// The write offset is published once for the entire batch.
+    ///
+    /// @param items Pointer to the array of items to write.
+    /// @param item_count The number of items in @a items.
+    /// @return The number of items written, which may be less than
+    /// @a item_count if the queue does not have sufficient space.
+    size_t enqueue_batch(T const *items, size_t item_count)
+    {
+        uint32_t rd_ofs = offset_r;
+        uint32_t wr_ofs = offset_w;
+        uint32_t n      = (uint32_t) CMN_MIN(item_count, (size_t) (capacity - (wr_ofs - rd_ofs)));
+        if (n == 0) return 0;
+
+        // make sure the reader has finished with the slots before reuse.
+        processor::read_barrier();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            storage[(wr_ofs + i) & mask] = items[i];
+        }
+
+        // all items must be visible before the write offset is updated.
+        processor::write_barrier();
+        offset_w = wr_ofs + n;
+        return n;
+    }
+
+    /// Attempts to read a single item from the queue. Called from the reader.
+    ///
+    /// @param out_item On return, stores the item that was read.
+    /// @return true if an item was read, or false if the queue is empty.
+    bool dequeue(T *out_item)
+    {
+        return dequeue_batch(out_item, 1) == 1;
+    }
+
+    /// Attempts to read several items from the queue. Called from the reader.
+    /// The read offset is published once for the entire batch.
+    ///
+    /// @param out_items Pointer to the array that will receive the items.
+    /// @param max_count The maximum number of items to read.
+    /// @return The number of items read.
+    size_t dequeue_batch(T *out_items, size_t max_count)
+    {
+        uint32_t rd_ofs = offset_r;
+        uint32_t wr_ofs = offset_w;
+        uint32_t n      = (uint32_t) CMN_MIN(max_count, (size_t) (wr_ofs - rd_ofs));
+        if (n == 0) return 0;
+
+        // don't read item data until the write offset has been observed.
+        processor::read_barrier();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            out_items[i] = storage[(rd_ofs + i) & mask];
+        }
+
+        // all items must be read before the slots are released to the writer.
+        processor::full_barrier();
+        offset_r = rd_ofs + n;
+        return n;
+    }
+
+private:
+    spsc_queue_t(spsc_queue_t<T> const &other);
+    spsc_queue_t<T>& operator =(spsc_queue_t<T> const &other);
+};
+
+/// Defines a fixed-capacity, lock-free ring buffer of values of type T that
+/// is safe for concurrent access by multiple writers and a single reader.
+/// Each slot carries a sequence number, as described by Dmitry Vyukov at
+/// http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+/// so writers only contend on the write offset and never block the reader.
+template <typename T>
+class mpsc_queue_t
+{
+public:
+    /// A single slot in the queue storage.
+    struct cell_t
+    {
+        volatile uint32_t sequence;  /// Position at which the slot is usable.
+        T                 value;     /// The item stored in the slot.
+    };
+
+public:
+    cell_t                                                 *storage;
+    uint32_t                                                capacity;
+    uint32_t                                                mask;
+    CMN_ALIGN_BEGIN(64) processor::atomic_int32_t CMN_ALIGN_END(64) offset_w;
+    CMN_ALIGN_BEGIN(64) volatile uint32_t CMN_ALIGN_END(64) offset_r;
+
+public:
+    /// Default constructor. Call mpsc_queue_t::bind() before attempting to
+    /// access the queue.
+    mpsc_queue_t(void)
+        :
+        storage(NULL),
+        capacity(0),
+        mask(0),
+        offset_w(0),
+        offset_r(0)
+    { /* empty */ }
+
+    /// Constructs a new instance bound to the specified storage. This is
+    /// equivalent to calling the default constructor followed by bind().
+    ///
+    /// @param buffer Pointer to the externally-managed array of cells.
+    /// @param cell_count The number of cells in @a buffer. This value must
+    /// be a power-of-two.
+    mpsc_queue_t(cell_t *buffer, size_t cell_count)
+        :
+        storage(NULL),
+        capacity(0),
+        mask(0),
+        offset_w(0),
+        offset_r(0)
+    {
+        bind(buffer, cell_count);
+    }
+
+public:
+    /// Binds the queue to an externally-managed array of cells, resetting
+    /// the queue to empty. This is not safe to call concurrently with any
+    /// other operation on the queue.
+    ///
+    /// @param buffer Pointer to the externally-managed array of cells.
+    /// @param cell_count The number of cells in @a buffer. This value must
+    /// be a power-of-two.
+    /// @return true if the queue was bound to @a buffer.
+    bool bind(cell_t *buffer, size_t cell_count)
+    {
+        if (NULL == buffer || cell_count < 2 || (cell_count & (cell_count - 1)) != 0)
+        {
+            assert((cell_count & (cell_count - 1)) == 0 && "Must be pow2");
+            return false;
+        }
+        for (size_t i = 0; i < cell_count; ++i)
+        {
+            buffer[i].sequence = (uint32_t) i;
+        }
+        storage  = buffer;
+        capacity = (uint32_t) cell_count;
+        mask     = (uint32_t)(cell_count - 1);
+        offset_r = 0;
+        offset_w.store(0);
+        return true;
+    }
+
+    /// Unbinds the queue from its storage array.
+    ///
+    /// @param out_cell_count On return, if non-NULL, stores the number of
+    /// cells in the storage array.
+    /// @return A pointer to the storage array previously bound to the queue.
+    cell_t* unbind(size_t *out_cell_count = NULL)
+    {
+        cell_t *buffer = storage;
+        if (out_cell_count) *out_cell_count = capacity;
+        storage  = NULL;
+        capacity = 0;
+        mask     = 0;
+        offset_r = 0;
+        offset_w.store(0);
+        return buffer;
+    }
+
+    /// Attempts to write a single item to the queue. Safe to call from any
+    /// number of writer threads concurrently.
+    ///
+    /// @param item The item to write.
+    /// @return true if the item was written, or false if the queue is full.
+    bool enqueue(T const &item)
+    {
+        return enqueue_batch(&item, 1) == 1;
+    }
+
+    /// Attempts to write several items to the queue as a contiguous run. Safe
+    /// to call from any number of writer threads concurrently. The run is
+    /// claimed with a single compare-and-swap on the write offset.
+    ///
+    /// @param items Pointer to the array of items to write.
+    /// @param item_count The number of items in @a items.
+    /// @return The number of items written, which may be less than
+    /// @a item_count if the queue does not have sufficient space.
+    size_t enqueue_batch(T const *items, size_t item_count)
+    {
+        int32_t  pos = offset_w.load();
+        uint32_t n   = 0;
+        for ( ; ; )
+        {
+            uint32_t upos = (uint32_t) pos;
+            uint32_t seq  = storage[upos & mask].sequence;
+            int32_t  diff = (int32_t) (seq - upos);
+            if (diff < 0)
+            {
+                // the slot at the write position is still in use; full.
+                return 0;
+            }
+            if (diff > 0)
+            {
+                // another writer claimed this position; reload and retry.
+                pos = offset_w.load();
+                continue;
+            }
+
+            // the reader releases slots in order, so if the last slot of the
+            // run is available then every slot before it is available.
+            n = (uint32_t) CMN_MIN(item_count, (size_t) capacity);
+            while (n > 1)
+            {
+                uint32_t last = upos + n - 1;
+                if (storage[last & mask].sequence == last) break;
+                --n;
+            }
+            if (n == 0 || offset_w.compare_exchange(pos, (int32_t) (upos + n)))
+            {
+                break;
+            }
+            // pos was updated with the current write offset; retry.
+        }
+
+        processor::read_barrier();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            uint32_t p = (uint32_t) pos + i;
+            cell_t  *c = &storage[p & mask];
+            c->value   = items[i];
+            // the value must be visible before the sequence is published.
+            processor::write_barrier();
+            c->sequence = p + 1;
+        }
+        return n;
+    }
+
+    /// Attempts to read a single item from the queue. Must only be called
+    /// from the single reader thread.
+    ///
+    /// @param out_item On return, stores the item that was read.
+    /// @return true if an item was read, or false if the queue is empty.
+    bool dequeue(T *out_item)
+    {
+        return dequeue_batch(out_item, 1) == 1;
+    }
+
+    /// Attempts to read several items from the queue. Must only be called
+    /// from the single reader thread. Reading stops at the first slot that
+    /// has not yet been published by its writer.
+    ///
+    /// @param out_items Pointer to the array that will receive the items.
+    /// @param max_count The maximum number of items to read.
+    /// @return The number of items read.
+    size_t dequeue_batch(T *out_items, size_t max_count)
+    {
+        uint32_t pos = offset_r;
+        size_t   n   = 0;
+        while (n < max_count)
+        {
+            cell_t *c = &storage[pos & mask];
+            if (c->sequence != pos + 1)
+            {
+                // the slot has not been published yet; the queue is empty.
+                break;
+            }
+            processor::read_barrier();
+            out_items[n++] = c->value;
+            // the value must be read before the slot is released.
+            processor::full_barrier();
+            c->sequence = pos + capacity;
+            ++pos;
+        }
+        offset_r = pos;
+        return n;
+    }
+
+private:
+    mpsc_queue_t(mpsc_queue_t<T> const &other);
+    mpsc_queue_t<T>& operator =(mpsc_queue_t<T> const &other);
+};
+
+/// A node in an intrusive multiple-producer, single-consumer queue. Embed an
+/// instance within the structure to be queued and recover the containing
+/// structure from the node pointer returned by mpsc_list_t::pop().
+struct mpsc_node_t
+{
+    processor::mpsc_node_t * volatile next;       /// The next node, or NULL.
+};
+
+/// Defines an unbounded, intrusive, lock-free queue that is safe for
+/// concurrent access by multiple writers and a single reader. No memory is
+/// allocated and no data is copied; writers link caller-owned nodes, and a
+/// push is a single atomic exchange. The algorithm is that of Dmitry Vyukov:
+/// http://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue
+class CMN_PUBLIC mpsc_list_t
+{
+public:
+    processor::mpsc_node_t * volatile head;       /// Most recently pushed.
+    processor::mpsc_node_t           *tail;       /// Next node to pop.
+    processor::mpsc_node_t            stub;       /// Sentinel node.
+
+public:
+    /// Default constructor. Initializes the queue to empty.
+    mpsc_list_t(void);
+
+public:
+    /// Appends a node to the back of the queue. Safe to call from any number
+    /// of writer threads concurrently. The node must remain valid until it
+    /// is returned by mpsc_list_t::pop().
+    ///
+    /// @param node The node to append.
+    void push(processor::mpsc_node_t *node);
+
+    /// Removes the node at the front of the queue. Must only be called from
+    /// the single reader thread.
+    ///
+    /// @return The node at the front of the queue, or NULL if the queue is
+    /// empty or a writer is in the middle of a push operation.
+    processor::mpsc_node_t* pop(void);
+
+    /// Determines whether the queue appears to be empty. Must only be called
+    /// from the single reader thread.
+    ///
+    /// @return true if no nodes are available to be popped.
+    bool empty(void) const;
+
+private:
+    mpsc_list_t(mpsc_list_t const &other);
+    mpsc_list_t& operator =(mpsc_list_t const &other);
+};
+
 /// Gets the current system timestamp, specified in nanoseconds.
 ///
 /// @return The current absolute system timestamp, in nanoseconds.
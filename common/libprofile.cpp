@@ -12,29 +12,45 @@
 ////////////////*/
 #if   CMN_IS_APPLE
     #include <math.h>
+    #include <errno.h>
+    #include <dlfcn.h>
     #include <stdio.h>
+    #include <signal.h>
     #include <stdlib.h>
     #include <string.h>
+    #include <sys/time.h>
     #include <mach/mach_time.h>
 #elif CMN_IS_LINUX
     #include <math.h>
     #include <time.h>
+    #include <errno.h>
+    #include <dlfcn.h>
     #include <stdio.h>
+    #include <signal.h>
     #include <stdlib.h>
     #include <string.h>
+    #include <unistd.h>
+    #include <pthread.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <linux/perf_event.h>
 #elif CMN_IS_WINDOWS
     #include <math.h>
     #include <stdio.h>
     #include <stdlib.h>
     #include <string.h>
     #include <windows.h>
+    #include <intrin.h>
 #endif
 
 #include "libprofile.hpp"
+#include "libmemory.hpp"
 
 /*//////////////////////////
 //   Using Declarations   //
 //////////////////////////*/
+using profile::Profile_Stack;
+using profile::Profile_Dummy_Stack;
 
 /*//////////////////////
 //   Implementation   //
@@ -42,8 +58,25 @@
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-/// the size of the zone hash table - must be power-of-two.
-#define HASH_TABLE_SIZE       2048
+/// the size of the zone hash table - must be power-of-two. each registered
+/// thread has its own root, and so its own copy of every stack location.
+#define HASH_TABLE_SIZE       8192
+/// the number of stack locations stored in the hash table before further
+/// locations are kept on the overflow list; keeps probe sequences short and
+/// guarantees that the table always has an empty slot.
+#define HASH_LOAD_LIMIT       (HASH_TABLE_SIZE / 4 * 3)
+/// the maximum number of zones with report records and history.
+#define MAX_ZONES             512
+/// the maximum call depth written when exporting folded stacks.
+#define MAX_EXPORT_DEPTH      256
+/// the maximum number of threads that can be registered with the profiler.
+#define MAX_THREADS           64
+/// the minimum number of events in a thread's timeline ring buffer.
+#define MIN_TIMELINE_EVENTS   64
+/// the version number written to the header of binary timelines.
+#define TIMELINE_VERSION      1
+/// the version number written to the header of binary report summaries.
+#define SUMMARY_VERSION       3
 /// the number of calls to update before averages are computed.
 #define THROWAWAY_COUNT       3
 /// the frame time used when the frame delta is zero.
@@ -54,31 +87,174 @@
 #define VARIANCE_TOLERANCE    0.5f
 /// convert struct timespec time value to an absolute nanosecond time value.
 #define TIMESPEC_TO_NS(tm)    (uint64_t(tm.tv_sec) * 1000000000 + tm.tv_nsec)
+/// the size of the table of aggregated samples - must be power-of-two.
+#define SAMPLE_TABLE_SIZE     4096
+/// the maximum number of frames captured for each sample.
+#define MAX_SAMPLE_FRAMES     8
+/// the frames above the interrupted code: capture_callstack(), the
+/// SIGPROF handler and the signal trampoline.
+#define SAMPLE_SKIP_FRAMES    3
+
+#if CMN_IS_LINUX && !defined(sigev_notify_thread_id)
+/// older C libraries do not name the SIGEV_THREAD_ID target field.
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the per-thread state used to read hardware performance counters.
+struct thread_counters_t
+{
+    int32_t     access;                       /// one of counter_access_e
+    int         fd  [PROFILER_COUNTER_COUNT]; /// perf event file descriptors
+    void       *page[PROFILER_COUNTER_COUNT]; /// mapped perf_event_mmap_page
+};
+
+/// the metric accumulators of a single thread. values are written only by
+/// the owning thread; marks are written only by profile::update().
+struct thread_metrics_t
+{
+    int64_t     values[PROFILER_MAX_METRICS]; /// running counts and levels
+    int64_t     marks [PROFILER_MAX_METRICS]; /// counts at the last update
+};
+
+/// the values of a single metric merged from all threads by profile::update().
+struct metric_state_t
+{
+    profile::metric_t *metric;  /// the registered metric
+    int64_t            sample;  /// the count this tick, or the current level
+    int64_t            total;   /// the count since registration; counters only
+    profile::scalar_t  value;   /// the smoothed per-tick values and history
+};
+
+/// the number of SIGPROF samples taken at one code address while a thread was
+/// at one stack location. entries are claimed with a compare-and-swap on the
+/// location; since each location is owned by a single thread, and the signal
+/// handler runs on that thread, the remaining fields have a single writer.
+struct sample_entry_t
+{
+    profile::stack_t  *location; /// the sampled location, or NULL if unused
+    void              *address;  /// the address of the interrupted code
+    uint32_t           count;    /// the number of samples taken
+};
+
+/// a stack location created once the hash table reached HASH_LOAD_LIMIT. the
+/// location is needed to unwind the zone correctly, but it is never reported.
+/// entries are pushed with a compare-and-swap and are never removed.
+struct overflow_stack_t
+{
+    profile::stack_t  *stack;   /// the unreported stack location
+    overflow_stack_t  *next;    /// the previously created entry, or NULL
+};
+
+/// a library-owned copy of a zone unregistered by profile::unregister_zone().
+/// the copy, followed by its name, keeps the zone's stack locations valid.
+struct retired_zone_t
+{
+    profile::zone_t    zone;    /// the copy referenced by the stack locations
+    retired_zone_t    *next;    /// the next retired zone, or NULL
+};
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
 /// the empty stack location.
-profile::stack_t         Profile_Dummy_Stack        = {0};
+profile::stack_t         profile::Profile_Dummy_Stack = {0};
 /// the initial stack location.
 profile::stack_t         Profile_Dummy_Stack2       = {0};
-/// the current stack location.
-profile::stack_t        *Profile_Stack              =  &Profile_Dummy_Stack2;
+/// the current stack location for the calling thread.
+CMN_THREAD_LOCAL profile::stack_t *profile::Profile_Stack = &Profile_Dummy_Stack2;
+/// the profiler epoch the calling thread was last registered in.
+static CMN_THREAD_LOCAL uint32_t   Thread_Epoch     =  0;
+/// the zero-based index of the calling thread.
+static CMN_THREAD_LOCAL uint32_t   Thread_Index     =  0;
 /// the global allocator instance.
 static profile::alloc_t  Profile_Alloc              = {0};
+/// incremented each time the profiler is initialized.
+static uint32_t volatile Profile_Epoch              =  1;
+/// guards thread, metric and sampling timer registration, and serializes
+/// zone unregistration.
+static int32_t  volatile Profile_Lock               =  0;
+/// the number of registered threads.
+static int32_t  volatile Thread_Count               =  0;
+/// the thread whose call graph is reported, or PROFILER_ALL_THREADS.
+static int32_t           Thread_Filter              =  PROFILER_ALL_THREADS;
+/// the root stack location of each registered thread.
+static profile::stack_t *Thread_Roots[MAX_THREADS]  = {NULL};
+/// the name of each registered thread.
+static char const       *Thread_Names[MAX_THREADS]  = {NULL};
+/// non-zero while timeline events are being recorded.
+int32_t volatile         profile::Profile_Timeline  =  0;
+/// the capacity of newly created timeline buffers; a power of two.
+static size_t            Timeline_Capacity          =  0;
+/// the timeline ring buffer of each registered thread.
+static profile::timeline_t *Thread_Timelines[MAX_THREADS] = {NULL};
+/// the timeline ring buffer of the calling thread.
+static CMN_THREAD_LOCAL profile::timeline_t *Thread_Timeline = NULL;
+/// the profiler epoch in which Thread_Timeline was created.
+static CMN_THREAD_LOCAL uint32_t   Timeline_Epoch   =  0;
+/// the hardware counter state of each registered thread.
+static thread_counters_t *Thread_Counters[MAX_THREADS] = {NULL};
+/// the sampling interval in microseconds, or zero if not sampling.
+static uint32_t volatile Sample_Interval            =  0;
+/// the number of samples dropped because the sample table was full.
+static int32_t  volatile Sample_Dropped             =  0;
+/// the samples aggregated by location and address by the SIGPROF handler.
+static sample_entry_t    Sample_Table[SAMPLE_TABLE_SIZE];
+#if CMN_IS_LINUX
+/// the kernel thread id of each registered thread, or zero if unknown.
+static pid_t             Thread_Ids[MAX_THREADS]    = {0};
+/// the CPU-time clock of each registered thread.
+static clockid_t         Thread_Clocks[MAX_THREADS];
+/// the SIGPROF timer of each registered thread.
+static timer_t           Thread_Timers[MAX_THREADS];
+/// non-zero for each registered thread with a SIGPROF timer.
+static uint8_t           Thread_Sampled[MAX_THREADS] = {0};
+#endif
+/// the hardware counter state of the calling thread.
+static CMN_THREAD_LOCAL thread_counters_t *Counters = NULL;
+/// the profiler epoch in which Counters was created.
+static CMN_THREAD_LOCAL uint32_t   Counter_Epoch    =  0;
+/// the metric accumulators of the calling thread.
+CMN_THREAD_LOCAL int64_t          *profile::Profile_Metric_Values = NULL;
+/// the epoch of Profile_Metric_Values; initially never a valid epoch.
+CMN_THREAD_LOCAL uint32_t          profile::Profile_Metric_Epoch  = ~0U;
+/// the metric accumulators of each registered thread.
+static thread_metrics_t *Thread_Metrics[MAX_THREADS] = {NULL};
+/// the accumulators shared by threads beyond MAX_THREADS; never reported.
+static thread_metrics_t  Overflow_Metrics;
+/// the slot updated for metrics beyond PROFILER_MAX_METRICS; never reported.
+static int64_t           Metric_Discard             =  0;
+/// the number of registered metrics.
+static int32_t  volatile Metric_Count               =  0;
+/// the merged values of each registered metric.
+static metric_state_t    Metric_State[PROFILER_MAX_METRICS];
+#if PROFILER_COMPACT
+/// per-tick history of each registered metric.
+static float             Metric_History[PROFILER_MAX_METRICS][PROFILER_HISTORY_SIZE];
+#endif
 /// number of items in the hash table.
-static int32_t           Hash_Count                 =  1;
+static int32_t  volatile Hash_Count                 =  1;
 /// the current hash table index mask.
 static int32_t           Hash_Mask                  =  0;
 /// maximum number of items in the hash table.
 static int32_t           Hash_Max                   =  1;
 /// the hash table storage.
-static profile::stack_t *Hash_Table[2048]           = {&Profile_Dummy_Stack};
-/// the number of profile zones in use.
-static int32_t           Zone_Count                 =  0;
+static profile::stack_t *Hash_Table[HASH_TABLE_SIZE] = {&Profile_Dummy_Stack};
+/// the stack locations that did not fit within HASH_LOAD_LIMIT.
+static overflow_stack_t * volatile Overflow_Stacks   =  NULL;
+/// the number of stack locations created past HASH_LOAD_LIMIT; these are
+/// never reported, so the count is exported to show that data is missing.
+static int32_t  volatile Overflow_Dropped           =  0;
+/// the number of zone table slots reserved; may exceed MAX_ZONES.
+static int32_t  volatile Zone_Count                 =  0;
+/// the zones unregistered since the profiler was initialized.
+static retired_zone_t   *Retired_Zones              =  NULL;
+/// the zone used for unregistered zones when a copy cannot be allocated.
+static profile::zone_t   Unloaded_Zone              = {"(unloaded)", NULL, NULL, 0, 0, 0, 0, 0};
 /// the zone expanded in call-graph view.
 static profile::zone_t  *Expanded_Zone              =  NULL;
 /// the array of pointers to zones.
-static profile::zone_t  *Zones[512]                 = {NULL};
+static profile::zone_t  *Zones[MAX_ZONES]          = {NULL};
 /// the current reporting mode.
 static int32_t           Report_Mode                = profile::REPORT_SELF_TIME;
 /// the current recursion mode (no effect).
@@ -106,7 +282,7 @@ static float             Time_To_90Percent[3]       = {0.1f, 0.8f, 2.5f};
 /// not sure what these values do either.
 static float             Factors[3]                 = {0};
 /// zone history data; 256 KB.
-static float             History[512][128];
+static float             History[MAX_ZONES][128];
 /// values & variances for the current frame.
 static profile::scalar_t Frame_Times;
 /// a global profile report instance.
@@ -129,6 +305,133 @@ static char const       *Format_Strings[5]  =
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+static inline void memory_barrier(void)
+{
+#if   defined(__GNUC__)
+    __sync_synchronize();
+#elif defined(_MSC_VER)
+    _ReadWriteBarrier();
+#else
+    #error No memory barrier implementation for your compiler!
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline void acquire(int32_t volatile *lock)
+{
+#if   defined(__GNUC__)
+    while (__sync_val_compare_and_swap(lock, 0, 1) != 0)
+    {
+        /* spin */
+    }
+#elif defined(_MSC_VER)
+    while (_InterlockedCompareExchange((long volatile*) lock, 1, 0) != 0)
+    {
+        /* spin */
+    }
+#else
+    #error No compare-and-swap implementation for your compiler!
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline void release(int32_t volatile *lock)
+{
+    // make sure all prior writes are visible before the lock is seen free.
+    memory_barrier();
+    *lock = 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline int32_t atomic_increment(int32_t volatile *value)
+{
+    // returns the incremented value; acts as a full memory barrier.
+#if   defined(__GNUC__)
+    return __sync_add_and_fetch(value, 1);
+#elif defined(_MSC_VER)
+    return _InterlockedIncrement((long volatile*) value);
+#else
+    #error No atomic increment implementation for your compiler!
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline uint32_t compare_and_swap(
+    uint32_t volatile *address,
+    uint32_t           expected,
+    uint32_t           desired)
+{
+    // returns the value stored at address prior to the operation.
+#if   defined(__GNUC__)
+    return __sync_val_compare_and_swap(address, expected, desired);
+#elif defined(_MSC_VER)
+    return uint32_t(_InterlockedCompareExchange(
+        (long volatile*) address, long(desired), long(expected)));
+#else
+    #error No compare-and-swap implementation for your compiler!
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline bool compare_and_swap_stack(
+    profile::stack_t * volatile *address,
+    profile::stack_t            *expected,
+    profile::stack_t            *desired)
+{
+    // returns true if desired was stored at address.
+#if   defined(__GNUC__)
+    return __sync_bool_compare_and_swap(address, expected, desired);
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchangePointer(
+        (void* volatile*) address, desired, expected) == expected;
+#else
+    #error No compare-and-swap implementation for your compiler!
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline bool compare_and_swap_overflow(
+    overflow_stack_t * volatile *address,
+    overflow_stack_t            *expected,
+    overflow_stack_t            *desired)
+{
+    // returns true if desired was stored at address.
+#if   defined(__GNUC__)
+    return __sync_bool_compare_and_swap(address, expected, desired);
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchangePointer(
+        (void* volatile*) address, desired, expected) == expected;
+#else
+    #error No compare-and-swap implementation for your compiler!
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline int32_t zone_count(void)
+{
+    // slots are reserved before the zone pointer is stored, so a
+    // slot below the count may still be NULL; zones registered
+    // beyond MAX_ZONES reserve a slot but have no table entry.
+    int32_t count = Zone_Count;
+    return (count < MAX_ZONES) ? count : MAX_ZONES;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline char const* zone_name(profile::zone_t *zone)
+{
+    return (zone != NULL) ? zone->name : NULL;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 static inline uint32_t zone_id(profile::zone_t *zone)
 {
     uint32_t hash = 0x55555555;
@@ -161,121 +464,1331 @@ static inline uint32_t hash_zone(profile::zone_t *z, profile::stack_t *s)
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-static void initialize_zone(profile::zone_t *zone)
-{
-    // store a pointer to a zone in the table of zones and
-    // mark the zone as initialized. when a zone is declared
-    // it is declared as static, so this pointer remains
-    // valid throughout the lifetime of the application.
-    Zones[Zone_Count++] = zone;
-    zone->initialized   = 1;
-}
+static inline uint32_t zone_slot(profile::zone_t const *zone)
+{
+    // the table slot is derived from zone->initialized, which is the
+    // value published by the compare-and-swap. zone->index is written
+    // after it, so a thread that sees the zone as initialized may still
+    // read a stale index. zones outside of the table map to 0xFFFFFFFF.
+    uint32_t slot = zone->initialized - 1;
+    return (slot < MAX_ZONES) ? slot : 0xFFFFFFFFUL;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void initialize_zone(profile::zone_t *zone)
+{
+    // store a pointer to a zone in the table of zones and
+    // mark the zone as initialized. when a zone is declared
+    // it is declared as static, so this pointer remains
+    // valid until profile::unregister_zone() is called.
+    // no lock is taken: each thread entering the zone for
+    // the first time reserves a slot, and the thread that
+    // stores its slot (plus one) in zone->initialized wins.
+    // the slots reserved by the other threads stay NULL.
+    // zones beyond MAX_ZONES have no report record or history
+    // but are still included by profile::export_report().
+    int32_t  slot  = atomic_increment(&Zone_Count) - 1;
+    uint32_t prior = compare_and_swap(&zone->initialized, 0, uint32_t(slot) + 1);
+    if (prior != 0)
+    {
+        // another thread registered the zone first.
+        slot = int32_t(prior - 1);
+    }
+    zone->index = (slot < MAX_ZONES) ? uint32_t(slot) : 0xFFFFFFFFUL;
+    if (0 == prior && slot < MAX_ZONES)
+    {
+        // publish the table entry after the zone is set up.
+        memory_barrier();
+        Zones[slot] = zone;
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void clear_history_scalar(profile::scalar_t *s)
+{
+    s->values[0]    = 0.0f;
+    s->values[1]    = 0.0f;
+    s->values[2]    = 0.0f;
+    s->variances[0] = 0.0f;
+    s->variances[1] = 0.0f;
+    s->variances[2] = 0.0f;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline void store_history_scalar(profile::scalar_t *s, float new_val)
+{
+#if PROFILER_COMPACT
+    // in compact mode, only inspected locations have a history ring.
+    if (NULL == s->history) return;
+#endif
+    s->history[History_Index] = new_val;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void update_history_scalar(
+    profile::scalar_t *s,
+    float              new_val,
+    float             *history)
+{
+    // recompute history values and variances based
+    // on the specified value for the current frame.
+    float    k0      = history[0];
+    float    k1      = history[1];
+    float    k2      = history[3];
+    float    new_var = new_val * new_val;
+    s->values[0]    = s->values[0]    * k0 + new_val * (1.0f - k0);
+    s->values[1]    = s->values[1]    * k1 + new_val * (1.0f - k1);
+    s->values[2]    = s->values[2]    * k2 + new_val * (1.0f - k2);
+    s->variances[0] = s->variances[0] * k0 + new_var * (1.0f - k0);
+    s->variances[1] = s->variances[1] * k1 + new_var * (1.0f - k1);
+    s->variances[2] = s->variances[2] * k2 + new_var * (1.0f - k2);
+    store_history_scalar(s, new_val);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void eternity_set_scalar(profile::scalar_t *s, float new_val)
+{
+    // sets all history values and variances to the same value.
+    float    new_var = new_val * new_val;
+    s->values[0]     = new_val;
+    s->values[1]     = new_val;
+    s->values[2]     = new_val;
+    s->variances[0]  = new_var;
+    s->variances[1]  = new_var;
+    s->variances[2]  = new_var;
+    store_history_scalar(s, new_val);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static float history_value(profile::scalar_t *s)
+{
+    if (Display_Frame != 0)
+    {
+        // report a history value - never averaged.
+        size_t n = (History_Index - Display_Frame + 128) % 128;
+#if PROFILER_COMPACT
+        if (NULL == s->history) return 0.0f;
+#endif
+        return s->history[n];
+    }
+    // report the value for the current frame - possibly averaged.
+    return s->values[Smoothing_Factor];
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static uint32_t count_recursion_depth(profile::stack_t *s, profile::zone_t *z)
+{
+    uint32_t n = 0;
+    while  (s != NULL)
+    {
+        if (z == s->zone) ++n;
+        s = s->parent;
+    }
+    return  n;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void close_thread_counters(thread_counters_t *counters)
+{
+#if CMN_IS_LINUX
+    long page_size = sysconf(_SC_PAGESIZE);
+    for (size_t i  = 0; i < PROFILER_COUNTER_COUNT; ++i)
+    {
+        if (counters->page[i] != NULL) munmap(counters->page[i], page_size);
+        if (counters->fd[i]   >= 0)    ::close(counters->fd[i]);
+    }
+#endif
+    ::free(counters);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static thread_counters_t* open_thread_counters(void)
+{
+    thread_counters_t *counters = NULL;
+
+    if (Thread_Epoch != Profile_Epoch || Thread_Index >= MAX_THREADS)
+    {
+        // counters are only opened for registered threads, so that
+        // they can be closed again by profile::shutdown().
+        return NULL;
+    }
+    counters = (thread_counters_t*) ::malloc(sizeof(thread_counters_t));
+    if (NULL == counters)
+    {
+        return NULL;
+    }
+    counters->access = profile::COUNTER_ACCESS_NONE;
+    for (size_t i = 0; i < PROFILER_COUNTER_COUNT; ++i)
+    {
+        counters->fd[i]   = -1;
+        counters->page[i] = NULL;
+    }
+
+#if CMN_IS_LINUX
+    // the events are opened as a group led by the instruction counter so
+    // that they are scheduled onto the PMU together. only user-mode events
+    // are counted, which is permitted at the default paranoia level.
+    static uint64_t const config[PROFILER_COUNTER_COUNT] =
+    {
+        PERF_COUNT_HW_INSTRUCTIONS,   // profile::COUNTER_INSTRUCTIONS
+        PERF_COUNT_HW_CACHE_MISSES,   // profile::COUNTER_CACHE_MISSES
+        PERF_COUNT_HW_BRANCH_MISSES   // profile::COUNTER_BRANCH_MISSES
+    };
+    long page_size = sysconf(_SC_PAGESIZE);
+    bool rdpmc     = true;
+    for (size_t i  = 0; i < PROFILER_COUNTER_COUNT; ++i)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.size           = sizeof(attr);
+        attr.config         = config[i];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        counters->fd[i]     = (int) syscall(__NR_perf_event_open, &attr, 0, -1, counters->fd[0], 0);
+        if (counters->fd[i] < 0)
+        {
+            close_thread_counters(counters);
+            return NULL;
+        }
+        counters->page[i] = mmap(NULL, page_size, PROT_READ, MAP_SHARED, counters->fd[i], 0);
+        if (MAP_FAILED == counters->page[i])
+        {
+            counters->page[i] = NULL;
+            rdpmc = false;
+        }
+        else
+        {
+            struct perf_event_mmap_page *pc = (struct perf_event_mmap_page*) counters->page[i];
+            if (!pc->cap_user_rdpmc) rdpmc = false;
+        }
+    }
+#if defined(__i386__) || defined(__x86_64__)
+    counters->access = rdpmc ? profile::COUNTER_ACCESS_RDPMC : profile::COUNTER_ACCESS_SYSCALL;
+#else
+    counters->access = profile::COUNTER_ACCESS_SYSCALL;
+#endif
+#endif
+
+    if (profile::COUNTER_ACCESS_NONE == counters->access)
+    {
+        close_thread_counters(counters);
+        return NULL;
+    }
+    acquire(&Profile_Lock);
+    Thread_Counters[Thread_Index] = counters;
+    release(&Profile_Lock);
+    return counters;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static thread_counters_t* thread_counters(void)
+{
+    // counters are opened the first time they are needed, and at
+    // most once per profiler epoch, even if they are unavailable.
+    if (Counter_Epoch != Profile_Epoch)
+    {
+        Counters      = open_thread_counters();
+        Counter_Epoch = Profile_Epoch;
+    }
+    return Counters;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static inline void read_counters(thread_counters_t *counters, uint64_t *values)
+{
+#if CMN_IS_LINUX
+#if defined(__i386__) || defined(__x86_64__)
+    if (profile::COUNTER_ACCESS_RDPMC == counters->access)
+    {
+        // read each counter from user mode; the kernel updates the
+        // mapped page under a sequence lock when the event is moved
+        // between hardware counters, so retry if it changes.
+        for (size_t i = 0; i < PROFILER_COUNTER_COUNT; ++i)
+        {
+            struct perf_event_mmap_page volatile *pc =
+                (struct perf_event_mmap_page volatile*) counters->page[i];
+            uint32_t seq    = 0;
+            int64_t  count  = 0;
+            do
+            {
+                seq   = pc->lock;
+                memory_barrier();
+                count = pc->offset;
+                if (pc->index != 0)
+                {
+                    uint32_t lo    = 0;
+                    uint32_t hi    = 0;
+                    uint32_t width = pc->pmc_width;
+                    __asm__ __volatile__("rdpmc" : "=a" (lo), "=d" (hi) : "c" (pc->index - 1));
+                    int64_t  pmc   = int64_t((uint64_t(hi) << 32) | lo);
+                    pmc   <<= 64 - width;
+                    pmc   >>= 64 - width;
+                    count  += pmc;
+                }
+                memory_barrier();
+            } while (pc->lock != seq);
+            values[i] = uint64_t(count);
+        }
+        return;
+    }
+#endif
+    for (size_t i = 0; i < PROFILER_COUNTER_COUNT; ++i)
+    {
+        uint64_t value = 0;
+        if (::read(counters->fd[i], &value, sizeof(value)) != ssize_t(sizeof(value)))
+        {
+            value = 0;
+        }
+        values[i] = value;
+    }
+#else
+    CMN_UNUSED(counters);
+    for (size_t i = 0; i < PROFILER_COUNTER_COUNT; ++i)
+    {
+        values[i] = 0;
+    }
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void update_counter_values(profile::counters_t *c, float *factors)
+{
+    // counters keep smoothed values only; they have no per-frame
+    // history, so they are not reported when viewing history.
+    for (size_t i = 0; i < PROFILER_COUNTER_COUNT; ++i)
+    {
+        float new_val = float(c->count[i]);
+        if (NULL == factors)
+        {
+            c->values[i][0] = new_val;
+            c->values[i][1] = new_val;
+            c->values[i][2] = new_val;
+        }
+        else
+        {
+            c->values[i][0] = c->values[i][0] * factors[0] + new_val * (1.0f - factors[0]);
+            c->values[i][1] = c->values[i][1] * factors[1] + new_val * (1.0f - factors[1]);
+            c->values[i][2] = c->values[i][2] * factors[2] + new_val * (1.0f - factors[2]);
+        }
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void accumulate_counters(profile::record_t *record, profile::stack_t *stack)
+{
+    profile::counters_t *c = stack->counters;
+    if (c != NULL && 0 == Display_Frame)
+    {
+        for (size_t i = 0; i < PROFILER_COUNTER_COUNT; ++i)
+        {
+            record->values[3 + i] += c->values[i][Smoothing_Factor];
+            record->value_flags   |= (8 << i);
+        }
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static profile::stack_t* create_stack_node(
+    profile::zone_t  *zone,
+    profile::stack_t *parent)
+{
+    // this function gets called from the push_zone() function
+    // and is the only function that allocates memory dynamically
+    // allocation can happen on zone entry, so we can't eliminate
+    // this dynamic allocation - but it shouldn't happen very often
+    // (happens when a zone is entered from a particular location
+    //  the very first time, and during recursion)
+    profile::stack_t *stack = Profile_Alloc.alloc(
+        sizeof(profile::stack_t),
+        Profile_Alloc.context);
+    stack->parent       = parent;
+    stack->zone         = zone;
+    stack->self_start   = 0;
+    stack->self_total   = 0;
+    stack->self_mark    = 0;
+    stack->self_ticks   = 0;
+    stack->heir_ticks   = 0;
+    stack->entry_total  = 0;
+    stack->entry_mark   = 0;
+    stack->entry_count  = 0;
+    stack->entry_depth  = count_recursion_depth(parent, zone);
+    stack->thread_index = parent->thread_index;
+    stack->counters     = NULL;
+    if (zone->counters && thread_counters() != NULL)
+    {
+        stack->counters = (profile::counters_t*) ::malloc(sizeof(profile::counters_t));
+        if (stack->counters != NULL)
+        {
+            memset(stack->counters, 0, sizeof(profile::counters_t));
+        }
+    }
+    clear_history_scalar(&stack->history.self_time);
+    clear_history_scalar(&stack->history.heir_time);
+    clear_history_scalar(&stack->history.entry_count);
+    stack->history.max_depth = 0;
+#if PROFILER_COMPACT
+    stack->history.self_time.history   = NULL;
+    stack->history.heir_time.history   = NULL;
+    stack->history.entry_count.history = NULL;
+#endif
+    return stack;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void record_sample(profile::stack_t *location, void *address)
+{
+    // called from the SIGPROF handler; must be async-signal-safe.
+    size_t   n    = ((size_t) location) ^ ((size_t) address);
+    uint32_t mask = uint32_t(n ^ (n >> 4) ^ (n >> 13)) & (SAMPLE_TABLE_SIZE - 1);
+    for (size_t probe = 0; probe < SAMPLE_TABLE_SIZE; ++probe)
+    {
+        sample_entry_t *entry = &Sample_Table[mask];
+        if (entry->location == location && entry->address == address)
+        {
+            entry->count++;
+            return;
+        }
+        if (entry->location == NULL && compare_and_swap_stack(
+           (profile::stack_t* volatile*) &entry->location, NULL, location))
+        {
+            // the count is set last; readers skip entries with no samples.
+            entry->address = address;
+            memory_barrier();
+            entry->count   = 1;
+            return;
+        }
+        mask = (mask + 1) & (SAMPLE_TABLE_SIZE - 1);
+    }
+    atomic_increment(&Sample_Dropped);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+#if CMN_IS_LINUX || CMN_IS_APPLE
+static void sample_handler(int signum, siginfo_t *info, void *context)
+{
+    // runs on the thread whose CPU-time timer expired, so Profile_Stack
+    // is the stack location that thread was executing. the handler stays
+    // installed after sampling is disabled and ignores late signals.
+    void             *frames[MAX_SAMPLE_FRAMES];
+    profile::stack_t *location = Profile_Stack;
+    int               error    = errno;
+    size_t            count    = 0;
+
+    CMN_UNUSED(signum);
+    CMN_UNUSED(info);
+    CMN_UNUSED(context);
+    if (Sample_Interval != 0 &&
+        location != &Profile_Dummy_Stack &&
+        location != &Profile_Dummy_Stack2)
+    {
+        count = memory::capture_callstack(frames, MAX_SAMPLE_FRAMES);
+        if (count > SAMPLE_SKIP_FRAMES)
+        {
+            record_sample(location, frames[SAMPLE_SKIP_FRAMES]);
+        }
+    }
+    errno = error;
+}
+#endif
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void start_thread_sampling(int32_t index)
+{
+    // the caller holds Profile_Lock. on Linux, each registered thread
+    // has a timer on its own CPU-time clock that signals that thread.
+#if CMN_IS_LINUX
+    struct sigevent   event;
+    struct itimerspec period;
+
+    if (Thread_Sampled[index] || 0 == Thread_Ids[index])
+    {
+        return;
+    }
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify           = SIGEV_THREAD_ID;
+    event.sigev_signo            = SIGPROF;
+    event.sigev_notify_thread_id = Thread_Ids[index];
+    if (timer_create(Thread_Clocks[index], &event, &Thread_Timers[index]) != 0)
+    {
+        return;
+    }
+    period.it_interval.tv_sec  = time_t(Sample_Interval / 1000000);
+    period.it_interval.tv_nsec = long (Sample_Interval % 1000000) * 1000;
+    period.it_value            = period.it_interval;
+    if (timer_settime(Thread_Timers[index], 0, &period, NULL) != 0)
+    {
+        timer_delete(Thread_Timers[index]);
+        return;
+    }
+    Thread_Sampled[index] = 1;
+#else
+    CMN_UNUSED(index);
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void stop_thread_sampling(int32_t index)
+{
+    // the caller holds Profile_Lock.
+#if CMN_IS_LINUX
+    if (Thread_Sampled[index])
+    {
+        timer_delete(Thread_Timers[index]);
+        Thread_Sampled[index] = 0;
+    }
+#else
+    CMN_UNUSED(index);
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static int compare_samples(void const *a, void const *b)
+{
+    // sort samples by count, most frequent first.
+    sample_entry_t const *sa = (sample_entry_t const*) a;
+    sample_entry_t const *sb = (sample_entry_t const*) b;
+    if (sa->count > sb->count) return -1;
+    if (sa->count < sb->count) return +1;
+    return 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static int32_t register_current_thread(char const *name)
+{
+    // allocate a root stack location for the calling thread. each
+    // thread builds its own tree beneath its root, so zone entry
+    // and exit never touch data owned by another thread.
+    profile::stack_t *root  = Profile_Alloc.alloc(
+        sizeof(profile::stack_t),
+        Profile_Alloc.context);
+    memset(root, 0, sizeof(profile::stack_t));
+
+    acquire(&Profile_Lock);
+    int32_t index = Thread_Count;
+    if (index < MAX_THREADS)
+    {
+        Thread_Roots[index] = root;
+        Thread_Names[index] = name;
+#if CMN_IS_LINUX
+        // record the thread's kernel id and CPU-time clock, so
+        // that any thread can create its SIGPROF timer.
+        Thread_Ids[index]   = pid_t(syscall(SYS_gettid));
+        if (pthread_getcpuclockid(pthread_self(), &Thread_Clocks[index]) != 0)
+        {
+            Thread_Ids[index] = 0;
+        }
+#endif
+        memory_barrier();
+        Thread_Count = index + 1;
+        if (Sample_Interval != 0)
+        {
+            start_thread_sampling(index);
+        }
+    }
+    else
+    {
+        // too many threads; the thread is still profiled and its
+        // data appears in the merged report, but it cannot be
+        // selected individually and its root is never freed.
+        index = MAX_THREADS;
+    }
+    release(&Profile_Lock);
+
+    root->thread_index = uint32_t(index);
+    Profile_Stack      = root;
+    Thread_Index       = uint32_t(index);
+    Thread_Epoch       = Profile_Epoch;
+    return index;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static thread_metrics_t* create_thread_metrics(void)
+{
+    thread_metrics_t *metrics = &Overflow_Metrics;
+    if (Thread_Epoch != Profile_Epoch)
+    {
+        // the thread has not entered a zone since the profiler
+        // was initialized; register it so update() can find it.
+        register_current_thread(NULL);
+    }
+    if (Thread_Index < MAX_THREADS)
+    {
+        metrics = (thread_metrics_t*) ::malloc(sizeof(thread_metrics_t));
+        if (NULL == metrics)
+        {
+            return NULL;
+        }
+        memset(metrics, 0, sizeof(thread_metrics_t));
+        memory_barrier();
+        Thread_Metrics[Thread_Index] = metrics;
+    }
+    profile::Profile_Metric_Values = metrics->values;
+    profile::Profile_Metric_Epoch  = Profile_Epoch;
+    return metrics;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void register_metric(profile::metric_t *metric)
+{
+    acquire(&Profile_Lock);
+    // another thread may have registered the metric first.
+    if (metric->epoch != Profile_Epoch && Metric_Count < PROFILER_MAX_METRICS)
+    {
+        int32_t         index = Metric_Count;
+        metric_state_t *state = &Metric_State[index];
+        state->metric = metric;
+        state->sample = 0;
+        state->total  = 0;
+        clear_history_scalar(&state->value);
+#if PROFILER_COMPACT
+        state->value.history = Metric_History[index];
+#endif
+        memset(state->value.history, 0, PROFILER_HISTORY_SIZE * sizeof(float));
+        metric->index = uint32_t(index);
+        // the state must be initialized before it is published, and
+        // the index must be visible before the epoch enables it.
+        memory_barrier();
+        Metric_Count  = index + 1;
+        metric->epoch = Profile_Epoch;
+    }
+    release(&Profile_Lock);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static profile::timeline_t* create_thread_timeline(void)
+{
+    profile::timeline_t *timeline = NULL;
+    size_t               capacity = Timeline_Capacity;
+    size_t               nbytes   = 0;
+
+    if (Thread_Epoch != Profile_Epoch)
+    {
+        // the thread has not entered a zone since the profiler
+        // was initialized; its events would refer to stale data.
+        return NULL;
+    }
+    if (Thread_Index < MAX_THREADS && capacity > 0)
+    {
+        // allocate the ring buffer header and storage together.
+        nbytes   = sizeof(profile::timeline_t) + capacity * sizeof(profile::event_t);
+        timeline = (profile::timeline_t*) ::malloc(nbytes);
+        if (timeline != NULL)
+        {
+            timeline->events       = (profile::event_t*) (timeline + 1);
+            timeline->mask         = uint32_t(capacity - 1);
+            timeline->thread_index = Thread_Index;
+            timeline->count        = 0;
+            acquire(&Profile_Lock);
+            Thread_Timelines[Thread_Index] = timeline;
+            release(&Profile_Lock);
+        }
+    }
+    Thread_Timeline = timeline;
+    Timeline_Epoch  = Profile_Epoch;
+    return timeline;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+
+static uint64_t ticks_per_second(void)
+{
+#if   CMN_IS_APPLE
+    mach_timebase_info_data_t time_scale = {0};
+    (void) mach_timebase_info(&time_scale);
+    return (uint64_t(1000000000) * time_scale.denom) / time_scale.numer;
+#elif CMN_IS_LINUX
+    return  uint64_t(1000000000); // tick_count() returns nanoseconds.
+#elif CMN_IS_WINDOWS
+    LARGE_INTEGER freq;
+    (void) QueryPerformanceFrequency(&freq);
+    return  uint64_t(freq.QuadPart);
+#else
+    #error No implementation of ticks_per_second() for your platform!
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static size_t copy_timeline(
+    profile::timeline_t *timeline,
+    profile::event_t    *events)
+{
+    // copy the events currently held in the ring buffer, then
+    // discard any that the owning thread may have overwritten
+    // while the copy was in progress.
+    uint32_t capacity = timeline->mask + 1;
+    uint32_t end      = timeline->count;
+    uint32_t begin    = (end > capacity) ? end - capacity : 0;
+    uint32_t valid    = 0;
+    for (uint32_t i = begin; i != end; ++i)
+    {
+        events[i - begin] = timeline->events[i & timeline->mask];
+    }
+    memory_barrier();
+    valid = timeline->count;
+    valid = (valid > capacity) ? valid - capacity : 0;
+    if (valid > begin)
+    {
+        if (valid >= end) return 0;
+        memmove(events, events + (valid - begin), (end - valid) * sizeof(profile::event_t));
+        begin = valid;
+    }
+    return size_t(end - begin);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool emit(
+    profile::write_fn  write_func,
+    void              *context,
+    void const        *data,
+    size_t             size,
+    size_t            &total)
+{
+    if (write_func(data, size, context) != size)
+    {
+        return false;
+    }
+    total += size;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool emit_json_string(
+    profile::write_fn  write_func,
+    void              *context,
+    char const        *str,
+    size_t            &total)
+{
+    char   buf[256];
+    size_t n = 0;
+    buf[n++] = '"';
+    while (str != NULL && *str && n < sizeof(buf) - 8)
+    {
+        unsigned char ch = (unsigned char) *str++;
+        if (ch == '"' || ch == '\\')
+        {
+            buf[n++] = '\\';
+            buf[n++] = char(ch);
+        }
+        else if (ch < 0x20)
+        {
+            n += sprintf(&buf[n], "\\u%04x", (unsigned) ch);
+        }
+        else buf[n++] = char(ch);
+    }
+    buf[n++] = '"';
+    return emit(write_func, context, buf, n, total);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool write_chrome_json(
+    profile::write_fn  write_func,
+    void              *context,
+    int32_t            thread_count,
+    int32_t            zone_count,
+    profile::event_t  *events,
+    size_t            &total)
+{
+    char        buf[256];
+    char const *sep   = "";
+    double      scale = 1000000.0 / double(ticks_per_second());
+    int         n     = 0;
+
+    n = sprintf(buf, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    if (!emit(write_func, context, buf, size_t(n), total)) return false;
+
+    for (int32_t i = 0; i < thread_count; ++i)
+    {
+        profile::timeline_t *timeline = Thread_Timelines[i];
+        char const          *name     = Thread_Names[i];
+        size_t               count    = 0;
+
+        if (timeline == NULL) continue;
+        // emit a metadata event naming the thread.
+        n = sprintf(buf, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":", sep, (int) i);
+        if (!emit(write_func, context, buf, size_t(n), total)) return false;
+        if (name != NULL)
+        {
+            if (!emit_json_string(write_func, context, name, total)) return false;
+        }
+        else
+        {
+            n = sprintf(buf, "\"thread %d\"", (int) i);
+            if (!emit(write_func, context, buf, size_t(n), total)) return false;
+        }
+        if (!emit(write_func, context, "}}", 2, total)) return false;
+        sep = ",\n";
+
+        count = copy_timeline(timeline, events);
+        for (size_t j = 0; j < count; ++j)
+        {
+            profile::event_t *e = &events[j];
+            if (e->zone_index >= uint32_t(zone_count)) continue;
+            n = sprintf(buf, "%s{\"name\":", sep);
+            if (!emit(write_func, context, buf, size_t(n), total)) return false;
+            if (!emit_json_string(write_func, context, zone_name(Zones[e->zone_index]), total)) return false;
+            n = sprintf(buf, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%d}",
+                (profile::TIMELINE_ENTER == e->event_type) ? 'B' : 'E',
+                double(e->timestamp) * scale, (int) i);
+            if (!emit(write_func, context, buf, size_t(n), total)) return false;
+        }
+    }
+
+    n = sprintf(buf, "\n]}\n");
+    return emit(write_func, context, buf, size_t(n), total);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool write_binary(
+    profile::write_fn  write_func,
+    void              *context,
+    int32_t            thread_count,
+    int32_t            zone_count,
+    profile::event_t  *events,
+    size_t            &total)
+{
+    profile::timeline_header_t header;
+    uint32_t                   length = 0;
+
+    header.magic[0]         = 'P';
+    header.magic[1]         = 'T';
+    header.magic[2]         = 'L';
+    header.magic[3]         = 'N';
+    header.version          = TIMELINE_VERSION;
+    header.ticks_per_second = ticks_per_second();
+    header.zone_count       = uint32_t(zone_count);
+    header.thread_count     = 0;
+    for (int32_t i = 0; i < thread_count; ++i)
+    {
+        if (Thread_Timelines[i] != NULL) header.thread_count++;
+    }
+    if (!emit(write_func, context, &header, sizeof(header), total)) return false;
+
+    for (int32_t i = 0; i < zone_count; ++i)
+    {
+        char const *name = zone_name(Zones[i]);
+        length = (name != NULL) ? uint32_t(strlen(name)) : 0;
+        if (!emit(write_func, context, &length, sizeof(length), total)) return false;
+        if (!emit(write_func, context, name, length, total)) return false;
+    }
+
+    for (int32_t i = 0; i < thread_count; ++i)
+    {
+        profile::timeline_t *timeline = Thread_Timelines[i];
+        char const          *name     = Thread_Names[i];
+        uint32_t             index    = uint32_t(i);
+        uint32_t             count    = 0;
+
+        if (timeline == NULL) continue;
+        count  = uint32_t(copy_timeline(timeline, events));
+        length = (name != NULL) ? uint32_t(strlen(name)) : 0;
+        if (!emit(write_func, context, &index,  sizeof(index),  total)) return false;
+        if (!emit(write_func, context, &length, sizeof(length), total)) return false;
+        if (!emit(write_func, context, name,    length,         total)) return false;
+        if (!emit(write_func, context, &count,  sizeof(count),  total)) return false;
+        if (!emit(write_func, context, events,  count * sizeof(profile::event_t), total)) return false;
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static int compare_parents(void const *p, void const *q)
+{
+    // qsort callback function for grouping stack locations by
+    // their parent, ordered by decreasing heirarchical time.
+    profile::stack_t *a = *(profile::stack_t**) p;
+    profile::stack_t *b = *(profile::stack_t**) q;
+    float            va = a->history.heir_time.values[Smoothing_Factor];
+    float            vb = b->history.heir_time.values[Smoothing_Factor];
+    if (a->parent != b->parent) return (a->parent < b->parent) ? -1 : +1;
+    return (vb < va) ? -1 : ((vb > va) ? +1 : 0);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static int compare_zones(void const *p, void const *q)
+{
+    // qsort callback function for grouping stack locations by zone.
+    profile::stack_t *a = *(profile::stack_t**) p;
+    profile::stack_t *b = *(profile::stack_t**) q;
+    if (a->zone == b->zone) return 0;
+    return (a->zone < b->zone) ? -1 : +1;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static size_t gather_stacks(profile::stack_t **stacks)
+{
+    size_t count = 0;
+    for (int32_t i = 0; i < Hash_Max; ++i)
+    {
+        if (Hash_Table[i] != &Profile_Dummy_Stack)
+        {
+            stacks[count++] = Hash_Table[i];
+        }
+    }
+    return count;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static float variance_value(profile::scalar_t *s, float scale)
+{
+    // variances are stored as the moving average of the squared
+    // sample values; convert to a variance in output units.
+    float v = s->values[Smoothing_Factor];
+    float e = s->variances[Smoothing_Factor] - v * v;
+    return (e > 0.0f) ? e * scale * scale : 0.0f;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool export_json_stack(
+    profile::write_fn   write_func,
+    void               *context,
+    profile::stack_t   *stack,
+    profile::stack_t  **stacks,
+    size_t              count,
+    size_t              depth,
+    size_t             &total)
+{
+    profile::history_t *h = &stack->history;
+    char                buf[512];
+    size_t              i = 0;
+    size_t              n = 0;
+    size_t             lo = 0;
+    size_t             hi = count;
+    bool                c = false;
+
+    n = sprintf(buf, "%*s{\"zone\":", int(depth * 2), "");
+    if (!emit(write_func, context, buf, n, total)) return false;
+    if (!emit_json_string(write_func, context, stack->zone->name, total)) return false;
+    n = sprintf(buf,
+        ",\"self_ms\":%.6f,\"heir_ms\":%.6f,\"entries\":%.3f"
+        ",\"self_var\":%.6f,\"heir_var\":%.6f,\"entries_var\":%.6f"
+        ",\"max_depth\":%u",
+        1000.0 * h->self_time.values[Smoothing_Factor],
+        1000.0 * h->heir_time.values[Smoothing_Factor],
+        double(h->entry_count.values[Smoothing_Factor]),
+        double(variance_value(&h->self_time, 1000.0f)),
+        double(variance_value(&h->heir_time, 1000.0f)),
+        double(variance_value(&h->entry_count, 1.0f)),
+        (unsigned) h->max_depth);
+    if (!emit(write_func, context, buf, n, total)) return false;
+    if (stack->counters != NULL)
+    {
+        profile::counters_t *pc = stack->counters;
+        n = sprintf(buf, ",\"instructions\":%.0f,\"cache_misses\":%.0f,\"branch_misses\":%.0f",
+            double(pc->values[profile::COUNTER_INSTRUCTIONS ][Smoothing_Factor]),
+            double(pc->values[profile::COUNTER_CACHE_MISSES ][Smoothing_Factor]),
+            double(pc->values[profile::COUNTER_BRANCH_MISSES][Smoothing_Factor]));
+        if (!emit(write_func, context, buf, n, total)) return false;
+    }
+    if (!emit(write_func, context, ",\"children\":[", 13, total)) return false;
+
+    // the stack locations are sorted by parent; find the first child.
+    // the range of children is contiguous within the sorted array.
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (stacks[mid]->parent < stack) lo = mid + 1;
+        else hi = mid;
+    }
+    for (i = lo; i < count && stacks[i]->parent == stack; ++i)
+    {
+        if (!emit(write_func, context, c ? ",\n" : "\n", c ? 2 : 1, total)) return false;
+        if (!export_json_stack(write_func, context, stacks[i], stacks, count, depth + 1, total)) return false;
+        c = true;
+    }
+    return emit(write_func, context, "]}", 2, total);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool export_json_samples(
+    profile::write_fn   write_func,
+    void               *context,
+    size_t             &total)
+{
+    sample_entry_t *samples = NULL;
+    size_t          count   = 0;
+    bool            result  = true;
+    char            buf[256];
+    size_t          n       = 0;
+
+    // take a snapshot of the table; the handler keeps counting.
+    samples = (sample_entry_t*) ::malloc(SAMPLE_TABLE_SIZE * sizeof(sample_entry_t));
+    if (NULL == samples)
+    {
+        return true;
+    }
+    for (size_t i = 0; i < SAMPLE_TABLE_SIZE; ++i)
+    {
+        if (Sample_Table[i].count > 0)
+        {
+            samples[count++] = Sample_Table[i];
+        }
+    }
+    qsort(samples, count, sizeof(sample_entry_t), compare_samples);
+
+    // each sample is attributed to the zone the thread was in when
+    // the sample was taken; the root location has no zone.
+    for (size_t i = 0; result && i < count; ++i)
+    {
+        profile::stack_t *location = samples[i].location;
+        char const       *symbol   = NULL;
+#if CMN_IS_LINUX || CMN_IS_APPLE
+        Dl_info           info;
+        if (dladdr(samples[i].address, &info) != 0) symbol = info.dli_sname;
+#endif
+        n = sprintf(buf, "%s\n {\"zone\":", (i > 0) ? "," : "");
+        result = emit(write_func, context, buf, n, total);
+        if (result && location->zone != NULL)
+        {
+            result = emit_json_string(write_func, context, location->zone->name, total);
+        }
+        else if (result) result = emit(write_func, context, "null", 4, total);
+        if (result)
+        {
+            n = sprintf(buf, ",\"thread\":%u,\"address\":\"%p\",\"symbol\":",
+                (unsigned) location->thread_index, samples[i].address);
+            result = emit(write_func, context, buf, n, total);
+        }
+        if (result && symbol != NULL)
+        {
+            result = emit_json_string(write_func, context, symbol, total);
+        }
+        else if (result) result = emit(write_func, context, "null", 4, total);
+        if (result)
+        {
+            n = sprintf(buf, ",\"count\":%u}", (unsigned) samples[i].count);
+            result = emit(write_func, context, buf, n, total);
+        }
+    }
+    ::free(samples);
+    return result;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool export_json(
+    profile::write_fn   write_func,
+    void               *context,
+    profile::stack_t  **stacks,
+    size_t              count,
+    size_t             &total)
+{
+    char    buf[512];
+    size_t  n   = 0;
+    float   ft  = Frame_Times.values[Smoothing_Factor];
+    int32_t nt  = Thread_Count;
+    bool    c   = false;
+
+    n = sprintf(buf, "{\"frame_ms\":%.6f,\"update_count\":%.0f,\"threads\":[",
+        1000.0 * ft, double(Update_Count));
+    if (!emit(write_func, context, buf, n, total)) return false;
+
+    // write the call graph beneath each thread's root.
+    qsort(stacks, count, sizeof(profile::stack_t*), compare_parents);
+    for (int32_t t = 0; t < nt; ++t)
+    {
+        profile::stack_t *root = Thread_Roots[t];
+        size_t            lo   = 0;
+        size_t            hi   = count;
+        bool              cc   = false;
+
+        n = sprintf(buf, "%s\n {\"index\":%d,\"name\":", (t > 0) ? "," : "", (int) t);
+        if (!emit(write_func, context, buf, n, total)) return false;
+        if (Thread_Names[t] != NULL)
+        {
+            if (!emit_json_string(write_func, context, Thread_Names[t], total)) return false;
+        }
+        else if (!emit(write_func, context, "null", 4, total)) return false;
+        if (!emit(write_func, context, ",\"calls\":[", 10, total)) return false;
+
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            if (stacks[mid]->parent < root) lo = mid + 1;
+            else hi = mid;
+        }
+        for (size_t i = lo; i < count && stacks[i]->parent == root; ++i)
+        {
+            if (!emit(write_func, context, cc ? ",\n" : "\n", cc ? 2 : 1, total)) return false;
+            if (!export_json_stack(write_func, context, stacks[i], stacks, count, 2, total)) return false;
+            cc = true;
+        }
+        if (!emit(write_func, context, "]}", 2, total)) return false;
+    }
+
+    // write the flattened per-zone totals across all threads.
+    if (!emit(write_func, context, "],\n\"zones\":[", 12, total)) return false;
+    qsort(stacks, count, sizeof(profile::stack_t*), compare_zones);
+    for (size_t i = 0; i < count; )
+    {
+        profile::zone_t *zone      = stacks[i]->zone;
+        double           self_ms   = 0.0;
+        double           heir_ms   = 0.0;
+        double           entries   = 0.0;
+        uint32_t         max_depth = 0;
+        for ( ; i < count && stacks[i]->zone == zone; ++i)
+        {
+            profile::history_t *h = &stacks[i]->history;
+            self_ms += 1000.0 * h->self_time.values[Smoothing_Factor];
+            heir_ms += 1000.0 * h->heir_time.values[Smoothing_Factor];
+            entries += h->entry_count.values[Smoothing_Factor];
+            if (h->max_depth > max_depth) max_depth = h->max_depth;
+        }
+        n = sprintf(buf, "%s\n {\"zone\":", c ? "," : "");
+        if (!emit(write_func, context, buf, n, total)) return false;
+        if (!emit_json_string(write_func, context, zone->name, total)) return false;
+        n = sprintf(buf, ",\"self_ms\":%.6f,\"heir_ms\":%.6f,\"entries\":%.3f,\"max_depth\":%u}",
+            self_ms, heir_ms, entries, (unsigned) max_depth);
+        if (!emit(write_func, context, buf, n, total)) return false;
+        c = true;
+    }
 
-/*/////////////////////////////////////////////////////////////////////////80*/
+    // write the counters and gauges in registration order.
+    if (!emit(write_func, context, "],\n\"metrics\":[", 14, total)) return false;
+    for (int32_t i = 0; i < Metric_Count; ++i)
+    {
+        metric_state_t *m       = &Metric_State[i];
+        bool            counter = (profile::METRIC_COUNTER == m->metric->type);
+        n = sprintf(buf, "%s\n {\"metric\":", (i > 0) ? "," : "");
+        if (!emit(write_func, context, buf, n, total)) return false;
+        if (!emit_json_string(write_func, context, m->metric->name, total)) return false;
+        n = sprintf(buf, ",\"type\":\"%s\",\"value\":%.3f,\"value_var\":%.6f,\"sample\":%lld",
+            counter ? "counter" : "gauge",
+            double(m->value.values[Smoothing_Factor]),
+            double(variance_value(&m->value, 1.0f)),
+            (long long) m->sample);
+        if (!emit(write_func, context, buf, n, total)) return false;
+        if (counter)
+        {
+            n = sprintf(buf, ",\"total\":%lld", (long long) m->total);
+            if (!emit(write_func, context, buf, n, total)) return false;
+        }
+        if (!emit(write_func, context, "}", 1, total)) return false;
+    }
 
-static void clear_history_scalar(profile::scalar_t *s)
-{
-    s->values[0]    = 0.0f;
-    s->values[1]    = 0.0f;
-    s->values[2]    = 0.0f;
-    s->variances[0] = 0.0f;
-    s->variances[1] = 0.0f;
-    s->variances[2] = 0.0f;
+    // write the SIGPROF samples, most frequent first.
+    if (!emit(write_func, context, "],\n\"samples\":[", 14, total)) return false;
+    if (!export_json_samples(write_func, context, total)) return false;
+    n = sprintf(buf, "],\n\"samples_dropped\":%d,\"locations_dropped\":%d}\n",
+        (int) Sample_Dropped, (int) Overflow_Dropped);
+    return emit(write_func, context, buf, n, total);
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-static void update_history_scalar(
-    profile::scalar_t *s,
-    float              new_val,
-    float             *history)
+static bool export_folded(
+    profile::write_fn   write_func,
+    void               *context,
+    profile::stack_t  **stacks,
+    size_t              count,
+    size_t             &total)
 {
-    // recompute history values and variances based
-    // on the specified value for the current frame.
-    size_t   h       = History_Index;
-    float    k0      = history[0];
-    float    k1      = history[1];
-    float    k2      = history[3];
-    float    new_var = new_val * new_val;
-    s->values[0]    = s->values[0]    * k0 + new_val * (1.0f - k0);
-    s->values[1]    = s->values[1]    * k1 + new_val * (1.0f - k1);
-    s->values[2]    = s->values[2]    * k2 + new_val * (1.0f - k2);
-    s->variances[0] = s->variances[0] * k0 + new_var * (1.0f - k0);
-    s->variances[1] = s->variances[1] * k1 + new_var * (1.0f - k1);
-    s->variances[2] = s->variances[2] * k2 + new_var * (1.0f - k2);
-    s->history[h]   = new_val;
+    profile::zone_t *path[MAX_EXPORT_DEPTH];
+    char             buf[64];
+
+    // write one line per stack location, of the form:
+    // thread;outer;inner <self time in microseconds>
+    // which is the input format expected by flamegraph.pl.
+    for (size_t i = 0; i < count; ++i)
+    {
+        profile::stack_t *s     = stacks[i];
+        size_t            depth = 0;
+        uint32_t          t     = s->thread_index;
+        double            us    = 1000000.0 * s->history.self_time.values[Smoothing_Factor];
+        size_t            n     = 0;
+
+        if (us < 0.5) continue;
+        while (s->zone != NULL && depth < MAX_EXPORT_DEPTH)
+        {
+            path[depth++] = s->zone;
+            s = s->parent;
+        }
+        if (t < MAX_THREADS && Thread_Names[t] != NULL)
+        {
+            char const *name = Thread_Names[t];
+            if (!emit(write_func, context, name, strlen(name), total)) return false;
+        }
+        else
+        {
+            n = sprintf(buf, "thread %u", (unsigned) t);
+            if (!emit(write_func, context, buf, n, total)) return false;
+        }
+        while (depth > 0)
+        {
+            char const *name = path[--depth]->name;
+            if (!emit(write_func, context, ";", 1, total)) return false;
+            if (!emit(write_func, context, name, strlen(name), total)) return false;
+        }
+        n = sprintf(buf, " %.0f\n", us);
+        if (!emit(write_func, context, buf, n, total)) return false;
+    }
+    return true;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-static void eternity_set_scalar(profile::scalar_t *s, float new_val)
+static int compare_summaries(void const *p, void const *q)
 {
-    // sets all history values and variances to the same value.
-    size_t   h       = History_Index;
-    float    new_var = new_val * new_val;
-    s->values[0]     = new_val;
-    s->values[1]     = new_val;
-    s->values[2]     = new_val;
-    s->variances[0]  = new_var;
-    s->variances[1]  = new_var;
-    s->variances[2]  = new_var;
-    s->history[h]    = new_val;
+    // qsort callback function for ordering zone summaries by
+    // decreasing self time.
+    profile::summary_zone_t const *a = (profile::summary_zone_t const*) p;
+    profile::summary_zone_t const *b = (profile::summary_zone_t const*) q;
+    return (b->self_ms < a->self_ms) ? -1 : ((b->self_ms > a->self_ms) ? +1 : 0);
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-static float history_value(profile::scalar_t *s)
+static bool export_summary(
+    profile::write_fn   write_func,
+    void               *context,
+    profile::stack_t  **stacks,
+    size_t              count,
+    size_t             &total)
 {
-    if (Display_Frame != 0)
+    profile::summary_header_t  header;
+    profile::summary_zone_t   *items = NULL;
+    profile::zone_t          **names = NULL;
+    size_t                     n     = 0;
+    bool                       res   = true;
+
+    // the index of each zone in the names array is stashed in the
+    // name_length field while the records are sorted by self time.
+    items = (profile::summary_zone_t*) ::malloc(count * sizeof(profile::summary_zone_t) + 1);
+    names = (profile::zone_t**)        ::malloc(count * sizeof(profile::zone_t*) + 1);
+    if (NULL == items || NULL == names)
     {
-        // report a history value - never averaged.
-        size_t n = (History_Index - Display_Frame + 128) % 128;
-        return s->history[n];
+        ::free(names);
+        ::free(items);
+        return false;
     }
-    // report the value for the current frame - possibly averaged.
-    return s->values[Smoothing_Factor];
-}
-
-/*/////////////////////////////////////////////////////////////////////////80*/
 
-static uint32_t count_recursion_depth(profile::stack_t *s, profile::zone_t *z)
-{
-    uint32_t n = 0;
-    while  (s != NULL)
+    qsort(stacks, count, sizeof(profile::stack_t*), compare_zones);
+    for (size_t i = 0; i < count; )
     {
-        if (z == s->zone) ++n;
-        s = s->parent;
+        profile::zone_t         *zone = stacks[i]->zone;
+        profile::summary_zone_t *item = &items[n];
+        item->self_ms     = 0.0f;
+        item->heir_ms     = 0.0f;
+        item->entries     = 0.0f;
+        item->max_depth   = 0;
+        item->name_length = uint32_t(n);
+        for ( ; i < count && stacks[i]->zone == zone; ++i)
+        {
+            profile::history_t *h = &stacks[i]->history;
+            item->self_ms += 1000.0f * h->self_time.values[Smoothing_Factor];
+            item->heir_ms += 1000.0f * h->heir_time.values[Smoothing_Factor];
+            item->entries += h->entry_count.values[Smoothing_Factor];
+            if (h->max_depth > item->max_depth) item->max_depth = h->max_depth;
+        }
+        names[n++] = zone;
     }
-    return  n;
+    qsort(items, n, sizeof(profile::summary_zone_t), compare_summaries);
+
+    header.magic[0]     = 'P';
+    header.magic[1]     = 'S';
+    header.magic[2]     = 'U';
+    header.magic[3]     = 'M';
+    header.version      = SUMMARY_VERSION;
+    header.zone_count   = uint32_t(n);
+    header.frame_ms     = 1000.0f * Frame_Times.values[Smoothing_Factor];
+    header.update_count = Update_Count;
+    header.metric_count = uint32_t(Metric_Count);
+    header.dropped      = uint32_t(Overflow_Dropped);
+    res = emit(write_func, context, &header, sizeof(header), total);
+
+    for (size_t i = 0; res && i < n; ++i)
+    {
+        profile::summary_zone_t item = items[i];
+        char const             *name = names[item.name_length]->name;
+        item.name_length = (name != NULL) ? uint32_t(strlen(name)) : 0;
+        res = emit(write_func, context, &item, sizeof(item), total) &&
+              emit(write_func, context, name, item.name_length, total);
+    }
+    for (uint32_t i = 0; res && i < header.metric_count; ++i)
+    {
+        metric_state_t           *m    = &Metric_State[i];
+        char const               *name = m->metric->name;
+        profile::summary_metric_t item;
+        item.value       = m->value.values[Smoothing_Factor];
+        item.type        = m->metric->type;
+        item.sample      = m->sample;
+        item.name_length = (name != NULL) ? uint32_t(strlen(name)) : 0;
+        item.reserved    = 0;
+        res = emit(write_func, context, &item, sizeof(item), total) &&
+              emit(write_func, context, name, item.name_length, total);
+    }
+    ::free(names);
+    ::free(items);
+    return res;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-static profile::stack_t* create_stack_node(
-    profile::zone_t  *zone,
-    profile::stack_t *parent)
+static void sample_stack_times(void)
 {
-    // this function gets called from the push_zone() function
-    // and is the only function that allocates memory dynamically
-    // allocation can happen on zone entry, so we can't eliminate
-    // this dynamic allocation - but it shouldn't happen very often
-    // (happens when a zone is entered from a particular location
-    //  the very first time, and during recursion)
-    profile::stack_t *stack = Profile_Alloc.alloc(
-        sizeof(profile::stack_t),
-        Profile_Alloc.context);
-    stack->parent      = parent;
-    stack->zone        = zone;
-    stack->self_start  = 0;
-    stack->self_ticks  = 0;
-    stack->heir_ticks  = 0;
-    stack->entry_count = 0;
-    stack->entry_depth = count_recursion_depth(parent, zone);
-    clear_history_scalar(&stack->history.self_time);
-    clear_history_scalar(&stack->history.heir_time);
-    clear_history_scalar(&stack->history.entry_count);
-    stack->history.max_depth = 0;
-    return stack;
+    profile::stack_t *dummy = &Profile_Dummy_Stack;
+    // capture the ticks and entries accumulated since the
+    // last update. the running totals are written only by
+    // the owning thread, so they are read here and marked
+    // rather than cleared to avoid losing concurrent updates.
+    for (int32_t i = 0; i < Hash_Max; ++i)
+    {
+        profile::stack_t *s = Hash_Table[i];
+        if (s != dummy)
+        {
+            int64_t  self_total  = s->self_total;
+            uint32_t entry_total = s->entry_total;
+            s->self_ticks        = self_total  - s->self_mark;
+            s->entry_count       = entry_total - s->entry_mark;
+            s->self_mark         = self_total;
+            s->entry_mark        = entry_total;
+            if (s->counters != NULL)
+            {
+                profile::counters_t *c = s->counters;
+                for (size_t j = 0; j < PROFILER_COUNTER_COUNT; ++j)
+                {
+                    uint64_t total = c->total[j];
+                    c->count[j]    = total - c->mark[j];
+                    c->mark[j]     = total;
+                }
+            }
+        }
+    }
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
@@ -342,6 +1855,111 @@ static void accumulate_stack_times(void)
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+static void sample_metrics(void)
+{
+    int32_t metric_count = Metric_Count;
+    int32_t thread_count = Thread_Count;
+    // counters report the amounts added by all threads since the
+    // last update; gauges report the sum of each thread's level.
+    // the accumulators are written only by the owning thread, so
+    // counters are read here and marked rather than cleared.
+    for (int32_t i = 0; i < metric_count; ++i)
+    {
+        Metric_State[i].sample = 0;
+    }
+    for (int32_t t = 0; t < thread_count; ++t)
+    {
+        thread_metrics_t *m = Thread_Metrics[t];
+        if (NULL == m) continue;
+        for (int32_t i = 0; i < metric_count; ++i)
+        {
+            int64_t value = m->values[i];
+            if (profile::METRIC_COUNTER == Metric_State[i].metric->type)
+            {
+                Metric_State[i].sample += value - m->marks[i];
+                m->marks[i]             = value;
+            }
+            else Metric_State[i].sample += value;
+        }
+    }
+    for (int32_t i = 0; i < metric_count; ++i)
+    {
+        if (profile::METRIC_COUNTER == Metric_State[i].metric->type)
+        {
+            Metric_State[i].total += Metric_State[i].sample;
+        }
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void update_metric_history(void)
+{
+    int32_t metric_count = Metric_Count;
+    for (int32_t i = 0; i < metric_count; ++i)
+    {
+        metric_state_t *state = &Metric_State[i];
+        float           value = float(state->sample);
+        if (Update_Count < THROWAWAY_COUNT)
+        {
+            eternity_set_scalar(&state->value, value);
+        }
+        else
+        {
+            // @note: Factors set in profile::update().
+            update_history_scalar(&state->value, value, Factors);
+        }
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+#if PROFILER_COMPACT
+static void free_history_ring(profile::history_t *history)
+{
+    // the ring is a single allocation; self_time points to its start.
+    ::free(history->self_time.history);
+    history->self_time.history   = NULL;
+    history->heir_time.history   = NULL;
+    history->entry_count.history = NULL;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void update_history_ring(profile::stack_t *stack)
+{
+    // locations of inspected zones, and those listed when the
+    // expanded zone is displayed, record per-tick history. the
+    // ring is allocated when inspection starts and released when
+    // it ends, so uninspected locations stay small.
+    profile::history_t *history   = &stack->history;
+    profile::zone_t    *parent    =  stack->parent->zone;
+    bool                inspected =
+        stack->zone->inspected != 0  ||
+        stack->zone == Expanded_Zone ||
+        (parent != NULL && parent == Expanded_Zone);
+
+    if (inspected && NULL == history->self_time.history)
+    {
+        size_t n     = PROFILER_HISTORY_SIZE;
+        float *ring  = (float*) ::malloc(3 * n * sizeof(float));
+        if (ring != NULL)
+        {
+            memset(ring, 0, 3 * n * sizeof(float));
+            history->self_time.history   = ring;
+            history->heir_time.history   = ring + n;
+            history->entry_count.history = ring + n * 2;
+        }
+    }
+    else if (!inspected && history->self_time.history != NULL)
+    {
+        free_history_ring(history);
+    }
+}
+#endif /* PROFILER_COMPACT */
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 static void update_stack_history(void)
 {
     profile::stack_t *dummy = &Profile_Dummy_Stack;
@@ -356,6 +1974,9 @@ static void update_stack_history(void)
             float               heir_time   = 0.0f;
             float               entry_count = 0.0f; // averaged
 
+#if PROFILER_COMPACT
+            update_history_ring(stack);
+#endif
             if (stack->entry_depth > history->max_depth)
             {
                 history->max_depth = stack->entry_depth;
@@ -369,6 +1990,7 @@ static void update_stack_history(void)
                 eternity_set_scalar(&history->self_time,   self_time);
                 eternity_set_scalar(&history->heir_time,   heir_time);
                 eternity_set_scalar(&history->entry_count, entry_count);
+                if (stack->counters != NULL) update_counter_values(stack->counters, NULL);
             }
             else
             {
@@ -376,18 +1998,49 @@ static void update_stack_history(void)
                 update_history_scalar(&history->self_time,   self_time,   Factors);
                 update_history_scalar(&history->heir_time,   heir_time,   Factors);
                 update_history_scalar(&history->entry_count, entry_count, Factors);
+                if (stack->counters != NULL) update_counter_values(stack->counters, Factors);
+            }
+            if (zone->history != NULL)
+            {
+                // a zone registered by another thread since the
+                // history pointers were assigned has no slot yet.
+                *zone->history += self_time; // updates a value in global History
             }
-            *zone->history += self_time; // updates a value in global History
         }
     }
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-static void accumulate_times_to_zones(void)
+static bool include_in_report(profile::stack_t *s)
 {
-    profile::stack_t *dummy = &Profile_Dummy_Stack;
+    // skip stack locations owned by threads other than the one
+    // selected, and those whose zones were registered by another
+    // thread after the report records were assigned.
+    if (s == &Profile_Dummy_Stack)
+    {
+        return false;
+    }
+    if (Thread_Filter != PROFILER_ALL_THREADS &&
+        Thread_Filter != int32_t(s->thread_index))
+    {
+        return false;
+    }
+    if (s->zone->report_nodes == NULL)
+    {
+        return false;
+    }
+    if (s->parent->zone != NULL && s->parent->zone->report_nodes == NULL)
+    {
+        return false;
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
 
+static void accumulate_times_to_zones(void)
+{
     // accumulate times for each stack location to
     // their associated zone for reporting purposes
     // this function is called when creating a report
@@ -395,7 +2048,7 @@ static void accumulate_times_to_zones(void)
     // there is one node associated with each zone
     for (int32_t i = 0; i < Hash_Max; ++i)
     {
-        if (Hash_Table[i] != dummy)
+        if (include_in_report(Hash_Table[i]))
         {
             float               t       = 0.0;
             profile::stack_t   *stack   = Hash_Table[i];
@@ -406,6 +2059,7 @@ static void accumulate_times_to_zones(void)
             records->values[0] += 1000.0f * history_value(&history->self_time);
             records->values[1] += 1000.0f * history_value(&history->heir_time);
             records->values[2] += history_value(&history->entry_count);
+            accumulate_counters(records, stack);
             if (history_value(&history->entry_count) > INT_ZERO_THRESHOLD)
             {
                 if (history->max_depth > records->max_depth)
@@ -451,7 +2105,6 @@ static void accumulate_times_to_zones(void)
 
 static void accumulate_times_to_zones_expanded(void)
 {
-    profile::stack_t *dummy = &Profile_Dummy_Stack;
     // accumulate times for each stack location to
     // their associated zone for reporting purposes
     // this function is called when creating a report
@@ -459,7 +2112,7 @@ static void accumulate_times_to_zones_expanded(void)
     // there are three nodes associated with each zone
     for (int32_t i = 0; i < Hash_Max; ++i)
     {
-        if (Hash_Table[i] != dummy)
+        if (include_in_report(Hash_Table[i]))
         {
             profile::stack_t   *stack     = Hash_Table[i];
             profile::history_t *history   = &stack->history;
@@ -493,6 +2146,7 @@ static void accumulate_times_to_zones_expanded(void)
                 records[2].values[0]  += 1000.0f * self_val;
                 records[2].values[1]  += 1000.0f * heir_val;
                 records[2].values[2]  += entry_val;
+                accumulate_counters(&records[2], stack);
                 if (history->max_depth > records[2].max_depth)
                 {
                     if (entry_val > INT_ZERO_THRESHOLD)
@@ -508,6 +2162,7 @@ static void accumulate_times_to_zones_expanded(void)
                     records[1].values[0]  += 1000.0f * self_val;
                     records[1].values[1]  += 1000.0f * heir_val;
                     records[1].values[2]  += entry_val;
+                    accumulate_counters(&records[1], stack);
                     if (history->max_depth > records[1].max_depth)
                     {
                         if (entry_val > INT_ZERO_THRESHOLD)
@@ -525,6 +2180,7 @@ static void accumulate_times_to_zones_expanded(void)
                 records[0].values[0]  += 1000.0f * self_val;
                 records[0].values[1]  += 1000.0f * heir_val;
                 records[0].values[2]  += entry_val;
+                accumulate_counters(&records[0], stack);
                 if (history->max_depth > records[0].max_depth)
                 {
                     if (entry_val > INT_ZERO_THRESHOLD)
@@ -651,6 +2307,7 @@ static profile::report_t* initialize_report(int32_t recordCount)
     memset(report->headers, 0, sizeof(report->headers));
     report->highlighted   = 0;
     report->record_count  = recordCount;
+    report->metric_count  = 0;
     for (int32_t i = 0; i < recordCount; ++i)
     {
         report->records[i].name        = NULL;
@@ -663,6 +2320,8 @@ static profile::report_t* initialize_report(int32_t recordCount)
         report->records[i].values[1]   = 0.0f;
         report->records[i].values[2]   = 0.0f;
         report->records[i].values[3]   = 0.0f;
+        report->records[i].values[4]   = 0.0f;
+        report->records[i].values[5]   = 0.0f;
         report->records[i].prefix      = 0;
     }
     return report;
@@ -678,16 +2337,21 @@ static profile::report_t* create_report(void)
     float              frame_time_avg   = 0.0;
     float              frames_per_sec   = 0.0;
     int32_t            i                = 0;
+    int32_t            n                = 0;
+    int32_t            count            = zone_count();
     int32_t            s                =
         (profile::REPORT_CALL_GRAPH == Report_Mode) ? 3 : 1;
 
-    report = initialize_report(Zone_Count * s);
-    for (i = 0; i < Zone_Count; ++i)
+    report = initialize_report(count * s);
+    for (i = 0; i < count; ++i)
     {
         profile::zone_t   *zone    =  Zones[i];
-        profile::record_t *records = &report->records[i * s];
+        profile::record_t *records = &report->records[n * s];
 
+        // skip slots reserved by a registration still in progress.
+        if (NULL == zone) continue;
         zone->report_nodes = records;
+        n++;
         if (profile::REPORT_CALL_GRAPH == Report_Mode)
         {
             records[0].name        = zone->name;
@@ -715,6 +2379,7 @@ static profile::report_t* create_report(void)
             records[0].prefix      = 0;
         }
     }
+    report->record_count = n * s;
 
     // compute average frame time (ms/frame)
     // compute frames-per-second
@@ -755,6 +2420,14 @@ static profile::report_t* create_report(void)
         strcat(report->title, " - [CURRENT FRAME]");
     }
 
+    if (Thread_Filter != PROFILER_ALL_THREADS)
+    {
+        char       *end  = report->title + strlen(report->title);
+        char const *name = Thread_Names[Thread_Filter];
+        if (name != NULL) sprintf(end, " - [THREAD %.64s]", name);
+        else sprintf(end, " - [THREAD %d]", (int) Thread_Filter);
+    }
+
     // build the header strings - strings are constant
     // but the order of the strings may vary based on
     // the current report viewing mode
@@ -804,7 +2477,7 @@ static profile::report_t* create_report(void)
     else
     {
         accumulate_times_to_zones();
-        for (i = 0; i < Zone_Count; ++i)
+        for (i = 0; i < report->record_count; ++i)
         {
             profile::record_t *record = &report->records[i];
 
@@ -820,6 +2493,18 @@ static profile::report_t* create_report(void)
         qsort(report->records, report->record_count, record_size, compare_records);
     }
 
+    // list the counters and gauges in registration order. they
+    // are not selectable, so they do not affect the cursor.
+    report->metric_count = Metric_Count;
+    for (i = 0; i < report->metric_count; ++i)
+    {
+        profile::record_t *record = &report->metrics[i];
+        memset(record, 0, record_size);
+        record->name        = Metric_State[i].metric->name;
+        record->value_flags = 1;
+        record->values[0]   = history_value(&Metric_State[i].value);
+    }
+
     // update the cursor index if necessary
     if (Update_Cursor)
     {
@@ -887,66 +2572,228 @@ static void CMN_CALL_C null_free(
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-static void fixup_allocator(profile::alloc_t *allocator)
+static void fixup_allocator(profile::alloc_t *allocator)
+{
+    if (NULL == allocator->alloc && NULL == allocator->free)
+    {
+        allocator->alloc = libc_alloc;
+        allocator->free  = libc_free;
+    }
+    if (NULL != allocator->alloc && NULL == allocator->free)
+    {
+        // free is a no-op, but we don't want to have to constantly NULL-check.
+        allocator->free  = null_free;
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool reserve_hash_slot(void)
+{
+    // claims one of the HASH_LOAD_LIMIT table entries, if any remain.
+    int32_t count = Hash_Count;
+    while (count < HASH_LOAD_LIMIT)
+    {
+        int32_t prior = int32_t(compare_and_swap(
+            (uint32_t volatile*) &Hash_Count, uint32_t(count), uint32_t(count + 1)));
+        if (prior == count)
+        {
+            return true;
+        }
+        count = prior;
+    }
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static profile::stack_t* push_overflow_zone(profile::zone_t *zone)
+{
+    // the hash table is at its load limit. the key includes the parent
+    // stack location, which is owned by the calling thread, so no other
+    // thread can insert this key while the list is searched.
+    overflow_stack_t *entry = Overflow_Stacks;
+    for ( ; entry != NULL; entry = entry->next)
+    {
+        if (entry->stack->parent == Profile_Stack && entry->stack->zone == zone)
+        {
+            return entry->stack;
+        }
+    }
+    profile::stack_t *stack = create_stack_node(zone, Profile_Stack);
+    if (0 == zone->initialized)
+    {
+        initialize_zone(zone);
+    }
+    atomic_increment(&Overflow_Dropped);
+    entry = (overflow_stack_t*) ::malloc(sizeof(overflow_stack_t));
+    if (NULL == entry)
+    {
+        // the location must still be returned so that the zone unwinds to
+        // the right parent; the caller's location cache keeps using it, but
+        // it cannot be found again or freed by profile::shutdown().
+        return stack;
+    }
+    entry->stack = stack;
+    do
+    {
+        entry->next = Overflow_Stacks;
+    } while (!compare_and_swap_overflow(&Overflow_Stacks, entry->next, entry));
+    return stack;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void free_overflow_stacks(void)
+{
+    while (Overflow_Stacks != NULL)
+    {
+        overflow_stack_t *next = Overflow_Stacks->next;
+        ::free(Overflow_Stacks->stack->counters);
+#if PROFILER_COMPACT
+        free_history_ring(&Overflow_Stacks->stack->history);
+#endif
+        Profile_Alloc.free(
+            Overflow_Stacks->stack,
+            sizeof(profile::stack_t),
+            Profile_Alloc.context);
+        ::free(Overflow_Stacks);
+        Overflow_Stacks = next;
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+profile::stack_t* profile::push_zone(profile::zone_t *zone)
+{
+    if (Thread_Epoch != Profile_Epoch)
+    {
+        // first zone entered on this thread since the
+        // profiler was initialized; create its root.
+        register_current_thread(NULL);
+    }
+
+    uint32_t          hash  = hash_zone(zone, Profile_Stack);
+    uint32_t          mask  = hash & Hash_Mask;
+    uint32_t          shuf  = ((hash << 4) + (hash >> 4)) | 1;
+    profile::stack_t *stack = Hash_Table[mask];
+
+    // the key includes the parent stack location, which is
+    // owned by the calling thread, so no other thread can
+    // insert this key and the search can run without a lock.
+    // compute secondary hash function; force it to be odd
+    // so it's relatively prime to table size.
+    // @note: guaranteed to terminate since the hash table
+    // never holds more than HASH_LOAD_LIMIT entries.
+    while (stack != &Profile_Dummy_Stack)
+    {
+        if (stack->parent == Profile_Stack && stack->zone == zone)
+        {
+            return stack;
+        }
+        mask  = (mask + shuf) & Hash_Mask;
+        stack = Hash_Table[mask];
+    }
+
+    // reserve a table entry before allocating; once the
+    // table is at its load limit, the location is created
+    // on the overflow list instead.
+    if (!reserve_hash_slot())
+    {
+        return push_overflow_zone(zone);
+    }
+    // allocate the new entry and initialize the zone
+    // if initialization hasn't been performed yet.
+    stack = create_stack_node(zone, Profile_Stack);
+    if (0 == zone->initialized)
+    {
+        initialize_zone(zone);
+    }
+    // insert the new entry into the hash table. another
+    // thread may claim the empty slot first, in which case
+    // keep probing. the compare-and-swap is a full barrier,
+    // so the node is fully initialized before it is published.
+    while (!compare_and_swap_stack((profile::stack_t* volatile*) &Hash_Table[mask], &Profile_Dummy_Stack, stack))
+    {
+        mask = (mask + shuf) & Hash_Mask;
+    }
+    return stack;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t profile::record_event(
+    profile::zone_t *zone,
+    int64_t          timestamp,
+    int32_t          event_type)
 {
-    if (NULL == allocator->alloc && NULL == allocator->free)
+    profile::timeline_t *timeline = Thread_Timeline;
+    if (Timeline_Epoch != Profile_Epoch)
     {
-        allocator->alloc = libc_alloc;
-        allocator->free  = libc_free;
+        // first event recorded on this thread; create its buffer.
+        timeline = create_thread_timeline();
     }
-    if (NULL != allocator->alloc && NULL == allocator->free)
+    if (timeline != NULL && zone != NULL)
     {
-        // free is a no-op, but we don't want to have to constantly NULL-check.
-        allocator->free  = null_free;
+        // the event is written before the count is published so
+        // that profile::write_timeline() never reads a partial
+        // event that it believes to be complete.
+        uint32_t                   n = timeline->count;
+        profile::event_t volatile *e = &timeline->events[n & timeline->mask];
+        e->timestamp     = timestamp;
+        e->zone_index    = zone_slot(zone);
+        e->event_type    = uint32_t(event_type);
+        timeline->count  = n + 1;
     }
+    return 0;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
-profile::stack_t* profile::push_zone(profile::zone_t *zone)
+int32_t profile::enter_counters(profile::stack_t *stack)
 {
-    uint32_t          hash  = hash_zone(zone, Profile_Stack);
-    uint32_t          mask  = hash & Hash_Mask;
-    uint32_t          shuf  = 0;
-    profile::stack_t *stack = Hash_Table[mask];
+    // stack->counters is only allocated for threads with open counters.
+    read_counters(Counters, stack->counters->start);
+    return 0;
+}
 
-    if (stack->parent == Profile_Stack && stack->zone == zone)
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t profile::leave_counters(profile::stack_t *stack)
+{
+    profile::counters_t *c = stack->counters;
+    uint64_t             v[PROFILER_COUNTER_COUNT];
+    read_counters(Counters, v);
+    for (size_t i = 0; i < PROFILER_COUNTER_COUNT; ++i)
     {
-        return stack;
+        c->total[i] += v[i] - c->start[i];
     }
-    if (stack != &Profile_Dummy_Stack)
-    {
-        // compute secondary hash function; force it to
-        // be odd so it's relatively prime to table size
-        shuf = ((hash << 4) + (hash >> 4)) | 1;
+    return 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
 
-        // @note: guaranteed to terminate since the hash
-        // table is guaranteed to never be totally full.
-        for (;;)
+int64_t* profile::metric_slot(profile::metric_t *metric)
+{
+    if (profile::Profile_Metric_Epoch != Profile_Epoch)
+    {
+        // first metric updated on this thread since the profiler
+        // was initialized; create the thread's accumulators.
+        if (NULL == create_thread_metrics())
         {
-            mask  = (mask + shuf) & Hash_Mask;
-            stack = Hash_Table[mask];
-            if (stack->parent == Profile_Stack && stack->zone == zone)
-            {
-                return stack;
-            }
-            if (stack == &Profile_Dummy_Stack)
-            {
-                break;
-            }
+            return &Metric_Discard;
         }
     }
-    // initialize the zone (and the rest of the system)
-    // if initialization hasn't been performed yet.
-    if (0 == zone->initialized)
+    if (metric->epoch != Profile_Epoch)
     {
-        initialize_zone(zone);
+        register_metric(metric);
+        if (metric->epoch != Profile_Epoch)
+        {
+            // the metric table is full.
+            return &Metric_Discard;
+        }
     }
-    // insert the new entry into the hash table.
-    Hash_Count       += 1;
-    stack             = create_stack_node(zone, Profile_Stack);
-    Hash_Table[mask]  = stack;
-    return stack;
+    return profile::Profile_Metric_Values + metric->index;
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
@@ -964,7 +2811,7 @@ float profile::current_time(void)
     uint64_t ns = mach_absolute_time() * _time_scale.numer / _time_scale.denom;
     return  (ns * 0.000000001f); // one billion nanoseconds in one second.
 #elif CMN_IS_LINUX
-    struct timespect ts   = {0};
+    struct timespec ts   = {0};
     clock_gettime(CLOCK_REALTIME, &ts);
     uint64_t ns = TIMESPEC_TO_NS(ts);
     return  (ns * 0.000000001f); // one billion nanoseconds in one second.
@@ -1040,6 +2887,13 @@ void profile::tick_count(int64_t *out_ticks)
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+uint64_t profile::tick_frequency(void)
+{
+    return ticks_per_second();
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 void profile::allocator_init(
     profile::alloc_t  *alloc,
     profile::alloc_fn  alloc_func,
@@ -1072,9 +2926,16 @@ void profile::initialize(profile::alloc_t *allocator)
         Profile_Alloc.context = NULL;
     }
 
-    // initialize/reset global data.
+    // initialize/reset global data. advancing the epoch causes
+    // each thread to register a new root on its next zone entry.
     Profile_Stack             = &Profile_Dummy_Stack2;
+    Profile_Epoch             = Profile_Epoch + 1;
+    Thread_Count              = 0;
+    Thread_Filter             = PROFILER_ALL_THREADS;
+    Profile_Timeline          = 0;
+    Timeline_Capacity         = 0;
     Zone_Count                = 0;
+    Metric_Count              = 0;
     Expanded_Zone             = NULL;
     Report_Mode               = profile::REPORT_HEIRARCHICAL_TIME;
     Recursion_Mode            = profile::RECURSION_FLATTEN;
@@ -1107,10 +2968,19 @@ void profile::initialize(profile::alloc_t *allocator)
     {
         Hash_Table[i] = &Profile_Dummy_Stack;
     }
-    for (int32_t i = 0; i < 512; ++i)
+    Overflow_Stacks  = NULL;
+    Overflow_Dropped = 0;
+    for (int32_t i = 0; i < MAX_ZONES; ++i)
     {
         Zones[i] = NULL;
     }
+    for (int32_t i = 0; i < MAX_THREADS; ++i)
+    {
+        Thread_Roots[i]     = NULL;
+        Thread_Names[i]     = NULL;
+        Thread_Timelines[i] = NULL;
+        Thread_Metrics[i]   = NULL;
+    }
 
     memset(&Profile_Dummy_Stack,  0, sizeof(Profile_Dummy_Stack));
     memcpy(&Profile_Dummy_Stack2, &Profile_Dummy_Stack, sizeof(Profile_Dummy_Stack));
@@ -1128,6 +2998,10 @@ void profile::initialize(profile::alloc_t *allocator)
 
 void profile::shutdown(void)
 {
+    // stop sampling before the sampled stack locations are freed.
+    profile::disable_sampling();
+    memset(Sample_Table, 0, sizeof(Sample_Table));
+
     // free memory allocated for stack locations.
     Hash_Max   = HASH_TABLE_SIZE;
     Hash_Mask  = HASH_TABLE_SIZE - 1;
@@ -1138,6 +3012,10 @@ void profile::shutdown(void)
         {
             if (Hash_Table[i] != NULL)
             {
+                ::free(Hash_Table[i]->counters);
+#if PROFILER_COMPACT
+                free_history_ring(&Hash_Table[i]->history);
+#endif
                 Profile_Alloc.free(
                     Hash_Table[i],
                     sizeof(profile::stack_t),
@@ -1146,14 +3024,67 @@ void profile::shutdown(void)
             }
         }
     }
+    free_overflow_stacks();
+
+    // free the root stack location and timeline of each thread.
+    Profile_Timeline  = 0;
+    Timeline_Capacity = 0;
+    for (int32_t i = 0; i < Thread_Count; ++i)
+    {
+        Profile_Alloc.free(
+            Thread_Roots[i],
+            sizeof(profile::stack_t),
+            Profile_Alloc.context);
+        if (Thread_Timelines[i] != NULL)
+        {
+            ::free(Thread_Timelines[i]);
+        }
+        if (Thread_Counters[i] != NULL)
+        {
+            close_thread_counters(Thread_Counters[i]);
+        }
+        ::free(Thread_Metrics[i]);
+        Thread_Roots[i]     = NULL;
+        Thread_Names[i]     = NULL;
+        Thread_Timelines[i] = NULL;
+        Thread_Counters[i]  = NULL;
+        Thread_Metrics[i]   = NULL;
+    }
+    Thread_Count  = 0;
+    Thread_Filter = PROFILER_ALL_THREADS;
+    Profile_Epoch = Profile_Epoch + 1;
+    Profile_Stack = &Profile_Dummy_Stack2;
 
-    // zero the zone table.
+    // zero the zone table, so that zones register again after the
+    // profiler is re-initialized, and free the retired zones.
     Zone_Count    = 0;
     Expanded_Zone = NULL;
-    for (size_t i = 0; i < 512; ++i)
+    for (size_t i = 0; i < MAX_ZONES; ++i)
     {
+        if (Zones[i] != NULL)
+        {
+            Zones[i]->history      = NULL;
+            Zones[i]->report_nodes = NULL;
+            Zones[i]->initialized  = 0;
+            Zones[i]->index        = 0;
+        }
         Zones[i]  = NULL;
     }
+    while (Retired_Zones != NULL)
+    {
+        retired_zone_t *next = Retired_Zones->next;
+        ::free(Retired_Zones);
+        Retired_Zones = next;
+    }
+
+    // unregister the metrics, so that no thread uses the cached
+    // accumulator slot of a metric until it is registered again.
+    for (int32_t i = 0; i < Metric_Count; ++i)
+    {
+        Metric_State[i].metric->epoch = 0;
+        Metric_State[i].metric        = NULL;
+    }
+    Metric_Count  = 0;
 
     // reset other state to safe values.
     Report_Mode    = profile::REPORT_HEIRARCHICAL_TIME;
@@ -1166,6 +3097,57 @@ void profile::shutdown(void)
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+int32_t profile::register_thread(char const *name)
+{
+    if (Thread_Epoch != Profile_Epoch)
+    {
+        return register_current_thread(name);
+    }
+    if (Thread_Index < MAX_THREADS)
+    {
+        Thread_Names[Thread_Index] = name;
+    }
+    return int32_t(Thread_Index);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t profile::thread_count(void)
+{
+    return size_t(Thread_Count);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+char const* profile::thread_name(int32_t thread_index)
+{
+    if (thread_index >= 0 && thread_index < Thread_Count)
+    {
+        return Thread_Names[thread_index];
+    }
+    else return NULL;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void profile::select_thread(int32_t thread_index)
+{
+    if (thread_index < 0 || thread_index >= Thread_Count)
+    {
+        thread_index  = PROFILER_ALL_THREADS;
+    }
+    Thread_Filter = thread_index;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t profile::current_thread(void)
+{
+    return Thread_Filter;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 int32_t profile::current_reporting_mode(void)
 {
     return Report_Mode;
@@ -1286,6 +3268,101 @@ void profile::select_parent(void)
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+void profile::inspect_zone(profile::zone_t *zone, bool inspect)
+{
+    if (zone != NULL)
+    {
+        // the history ring is allocated or released by the next
+        // call to profile::update(), on the reporting thread.
+        zone->inspected = inspect ? 1 : 0;
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void profile::unregister_zone(profile::zone_t *zone)
+{
+    profile::zone_t *target = &Unloaded_Zone;
+    retired_zone_t  *copy   = NULL;
+    size_t           length = 0;
+    uint32_t         slot   = 0;
+
+    if (NULL == zone)
+    {
+        return;
+    }
+    // this is a cold path, so calls are simply serialized; zone
+    // registration and the stack location inserts never take the
+    // lock, so they can continue alongside.
+    acquire(&Profile_Lock);
+    if (0 == zone->initialized)
+    {
+        release(&Profile_Lock);
+        return;
+    }
+
+    // copy the zone and its name into library-owned memory. if the
+    // copy cannot be allocated, the data is reported as (unloaded).
+    length = (zone->name != NULL) ? strlen(zone->name) : 0;
+    copy   = (retired_zone_t*) ::malloc(sizeof(retired_zone_t) + length + 1);
+    if (copy != NULL)
+    {
+        char *name = (char*) (copy + 1);
+        memcpy(name, zone->name, length);
+        name[length]    = '\0';
+        copy->zone      = *zone;
+        copy->zone.name = name;
+        copy->next      = Retired_Zones;
+        Retired_Zones   = copy;
+        target          = &copy->zone;
+    }
+
+    // the copy takes over the table slot of the zone, and with it the
+    // zone history and report records. slots are never reused.
+    slot = zone_slot(zone);
+    if (slot < MAX_ZONES && Zones[slot] == zone)
+    {
+        Zones[slot] = target;
+    }
+    for (int32_t i = 0; i < Hash_Max; ++i)
+    {
+        if (Hash_Table[i]->zone == zone)
+        {
+            Hash_Table[i]->zone = target;
+        }
+    }
+    for (overflow_stack_t *entry = Overflow_Stacks; entry != NULL; entry = entry->next)
+    {
+        if (entry->stack->zone == zone)
+        {
+            entry->stack->zone = target;
+        }
+    }
+    for (int32_t i = 0; i < Report.record_count; ++i)
+    {
+        if (Report.records[i].zone == zone)
+        {
+            Report.records[i].zone = target;
+            Report.records[i].name = target->name;
+        }
+    }
+    if (Expanded_Zone == zone)
+    {
+        Expanded_Zone = target;
+    }
+
+    // the zone registers again, in a new slot, if it is entered after
+    // the module defining it is reloaded.
+    zone->history      = NULL;
+    zone->report_nodes = NULL;
+    zone->index        = 0;
+    memory_barrier();
+    zone->initialized  = 0;
+    release(&Profile_Lock);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 void profile::update(int32_t update_mode)
 {
     PROFILER_ENTER_SCOPE(_PROFILE_UPDATE_);
@@ -1299,7 +3376,12 @@ void profile::update(int32_t update_mode)
     float   tsps  = 0.0; // timestamps per-second
     int64_t delta = 0;   // delta time, in ticks
 
-    // accumulate times up the known stacks for all zones.
+    // capture the times recorded by each thread since the last
+    // update, then accumulate times up the known stacks for all
+    // zones. each thread's stack locations have a distinct root,
+    // so the report merges the per-thread call graphs by zone.
+    sample_stack_times();
+    sample_metrics();
     propagate_stack_times();
 
     // compute the time delta (seconds) and use that to
@@ -1376,13 +3458,15 @@ void profile::update(int32_t update_mode)
 
     if (tsps != 0.0f) Ticks_To_Seconds = 1.0f / tsps;
     else              Ticks_To_Seconds = 0.0f;
-    for (int32_t i = 0; i < Zone_Count; ++i)
+    for (int32_t i = 0, n = zone_count(); i < n; ++i)
     {
+        if (NULL == Zones[i]) continue;
         Zones[i]->history = &History[i][History_Index];
         History[i][History_Index] = 0.0f;
     }
 
     update_stack_history();
+    update_metric_history();
     update_history_scalar(&Frame_Times, dt, Factors);
 
     Update_Count += 1;
@@ -1416,6 +3500,7 @@ void profile::render_report(
     int32_t               i                = 0;
     int32_t               j                = 0;
     int32_t               n                = 0;
+    int32_t               m                = 0;
     int32_t               o                = 0;
     int32_t               max_records      = 0;
     int32_t               highlighted_item = 0;
@@ -1494,7 +3579,7 @@ void profile::render_report(
         ctx.user_data   = c;
         render_func(x + 1, sy, buf, &ctx);
 
-        for (j = 0; j < 4; ++j)
+        for (j = 0; j < 3; ++j)
         {
             if (record->value_flags & (1 << j))
             {
@@ -1518,6 +3603,43 @@ void profile::render_report(
 
         sy += line_spacing;
     }
+
+    // render the counters and gauges beneath the zones, with a
+    // header line, if there is room for at least one of them.
+    m = report->metric_count;
+    if (m > max_records - n - 1) m = max_records - n - 1;
+    if (m > 0)
+    {
+        ctx.hotness     = 0.0f;
+        ctx.title       = 0;
+        ctx.header      = 1;
+        ctx.highlighted = 0;
+        ctx.user_data   = c;
+        render_func(sx + 8, sy, "METRIC", &ctx);
+        render_func(
+            sx + name_width + field_width / 2 - measure_func("VALUE", c) / 2,
+            sy, "VALUE", &ctx);
+        sy += line_spacing;
+    }
+    for (i = 0; i < m; ++i)
+    {
+        profile::record_t *record   = &report->metrics[i];
+        char               buf[256] = {0};
+        float              x        = sx + plus_width / 2 + plus_width;
+        float              pad      = 0.0f;
+
+        ctx.hotness     = 0.0f;
+        ctx.title       = 0;
+        ctx.header      = 0;
+        ctx.highlighted = 0;
+        ctx.user_data   = c;
+        render_func(x + 1, sy, record->name, &ctx);
+
+        float_to_string(buf, 255, record->values[0], 2);
+        pad = field_width - plus_width - measure_func(buf, c);
+        render_func(sx + pad + name_width, sy, buf, &ctx);
+        sy += line_spacing;
+    }
 }
 
 /*/////////////////////////////////////////////////////////////////////////80*/
@@ -1543,10 +3665,11 @@ void profile::render_graph(
     ctx.spacing_y = spacing_y;
     ctx.user_data = context;
 
-    for (i = 0; i < Zone_Count; ++i)
+    for (i = 0; i < zone_count(); ++i)
     {
         uint32_t id = zone_id(Zones[i]);
 
+        if (NULL == Zones[i]) continue;
         if (h >= n)
         {
             render_func(id, 0, n, &History[i][h - n], &ctx);
@@ -1569,6 +3692,216 @@ void profile::render_graph(
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+void profile::enable_timeline(size_t events_per_thread)
+{
+    size_t capacity = MIN_TIMELINE_EVENTS;
+    while (capacity < events_per_thread)
+    {
+        capacity <<= 1;
+    }
+    Timeline_Capacity = capacity;
+    memory_barrier();
+    Profile_Timeline  = 1;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void profile::disable_timeline(void)
+{
+    Profile_Timeline  = 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool profile::timeline_enabled(void)
+{
+    return (Profile_Timeline != 0);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool profile::enable_sampling(uint32_t interval_usec)
+{
+#if CMN_IS_LINUX || CMN_IS_APPLE
+    struct sigaction action;
+    void            *frames[MAX_SAMPLE_FRAMES];
+
+    if (0 == interval_usec)
+    {
+        return false;
+    }
+    profile::disable_sampling();
+
+    // capture one callstack up front; the first call may load the
+    // unwinder, which is not safe to do from a signal handler.
+    memory::capture_callstack(frames, MAX_SAMPLE_FRAMES);
+    memset(Sample_Table, 0, sizeof(Sample_Table));
+    Sample_Dropped = 0;
+
+    memset(&action, 0, sizeof(action));
+    sigemptyset(&action.sa_mask);
+    action.sa_sigaction = sample_handler;
+    action.sa_flags     = SA_SIGINFO | SA_RESTART;
+    if (sigaction(SIGPROF, &action, NULL) != 0)
+    {
+        return false;
+    }
+
+    acquire(&Profile_Lock);
+    Sample_Interval = interval_usec;
+    memory_barrier();
+#if CMN_IS_LINUX
+    for (int32_t i = 0; i < Thread_Count; ++i)
+    {
+        start_thread_sampling(i);
+    }
+#else
+    struct itimerval period;
+    period.it_interval.tv_sec  = time_t(interval_usec / 1000000);
+    period.it_interval.tv_usec = suseconds_t(interval_usec % 1000000);
+    period.it_value            = period.it_interval;
+    setitimer(ITIMER_PROF, &period, NULL);
+#endif
+    release(&Profile_Lock);
+    return true;
+#else
+    CMN_UNUSED(interval_usec);
+    return false;
+#endif
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void profile::disable_sampling(void)
+{
+    acquire(&Profile_Lock);
+    Sample_Interval = 0;
+#if CMN_IS_LINUX
+    for (int32_t i = 0; i < Thread_Count; ++i)
+    {
+        stop_thread_sampling(i);
+    }
+#elif CMN_IS_APPLE
+    struct itimerval period;
+    memset(&period, 0, sizeof(period));
+    setitimer(ITIMER_PROF, &period, NULL);
+#endif
+    release(&Profile_Lock);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool profile::sampling_enabled(void)
+{
+    return (Sample_Interval != 0);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int32_t profile::counter_access(void)
+{
+    thread_counters_t *counters = NULL;
+    if (Thread_Epoch != Profile_Epoch)
+    {
+        // counters are tracked per registered thread.
+        register_current_thread(NULL);
+    }
+    counters = thread_counters();
+    return (counters != NULL) ? counters->access : profile::COUNTER_ACCESS_NONE;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t profile::write_timeline(
+    int32_t            format,
+    profile::write_fn  write_func,
+    void              *context)
+{
+    profile::event_t *events       = NULL;
+    size_t            capacity     = 0;
+    size_t            total        = 0;
+    bool              result       = false;
+    int32_t           thread_count = Thread_Count;
+    int32_t           zone_count   = ::zone_count();
+
+    if (NULL == write_func)
+    {
+        return 0;
+    }
+
+    // allocate scratch space large enough for the largest buffer.
+    memory_barrier();
+    for (int32_t i = 0; i < thread_count; ++i)
+    {
+        if (Thread_Timelines[i] != NULL)
+        {
+            size_t n = size_t(Thread_Timelines[i]->mask) + 1;
+            if (n > capacity) capacity = n;
+        }
+    }
+    if (capacity > 0)
+    {
+        events = (profile::event_t*) ::malloc(capacity * sizeof(profile::event_t));
+        if (NULL == events) return 0;
+    }
+
+    switch (format)
+    {
+    case profile::TIMELINE_CHROME_JSON:
+        result = write_chrome_json(write_func, context, thread_count, zone_count, events, total);
+        break;
+
+    case profile::TIMELINE_BINARY:
+        result = write_binary(write_func, context, thread_count, zone_count, events, total);
+        break;
+    }
+    if (events != NULL) ::free(events);
+    return result ? total : 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t profile::export_report(
+    int32_t            format,
+    profile::write_fn  write_func,
+    void              *context)
+{
+    profile::stack_t **stacks = NULL;
+    size_t             count  = 0;
+    size_t             total  = 0;
+    bool               result = false;
+
+    if (NULL == write_func)
+    {
+        return 0;
+    }
+    stacks = (profile::stack_t**) ::malloc(Hash_Max * sizeof(profile::stack_t*));
+    if (NULL == stacks)
+    {
+        return 0;
+    }
+    count = gather_stacks(stacks);
+
+    switch (format)
+    {
+    case profile::EXPORT_JSON:
+        result = export_json(write_func, context, stacks, count, total);
+        break;
+
+    case profile::EXPORT_FOLDED_STACKS:
+        result = export_folded(write_func, context, stacks, count, total);
+        break;
+
+    case profile::EXPORT_SUMMARY:
+        result = export_summary(write_func, context, stacks, count, total);
+        break;
+    }
+    ::free(stacks);
+    return result ? total : 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 /*/////////////////////////////////////////////////////////////////////////////
 //    $Id$
 ///////////////////////////////////////////////////////////////////////////80*/
@@ -31,17 +31,61 @@ struct scalar_t;
 struct history_t;
 struct text_item_t;
 struct graph_item_t;
+struct event_t;
+struct timeline_t;
+struct counters_t;
+struct metric_t;
 struct stack_t* push_zone(struct zone_t*);
+extern int64_t* metric_slot(struct metric_t*);
+extern int32_t  record_event(struct zone_t*, int64_t, int32_t);
+extern int32_t  enter_counters(struct stack_t*);
+extern int32_t  leave_counters(struct stack_t*);
 extern float    current_time(void);
 extern void     tick_count(int64_t*);
 
 /*//////////////////////////////////
 //   Public Types and Functions   //
 //////////////////////////////////*/
+/// The thread index passed to profile::select_thread() to report the merged
+/// call graph of all threads.
+#define PROFILER_ALL_THREADS            (-1)
+
+/// The number of hardware performance counters captured for zones defined
+/// with PROFILER_ENTER_COUNTER_ZONE() or PROFILER_ENTER_COUNTER_SCOPE().
+#define PROFILER_COUNTER_COUNT          3
+
+/// Compile-time define that selects the compact profiler layout. In compact
+/// mode, stack locations do not embed the per-tick history used to browse
+/// previous ticks; it is kept in a separately allocated ring only for the
+/// locations of zones being inspected (see profile::inspect_zone()), which
+/// reduces each stack location from over 1.5KB to a few cache lines. The
+/// layout changes the size of public structures, so it is taken from the
+/// CMN_PROFILER_COMPACT build option recorded in common_config.hpp, and the
+/// library and its consumers always agree.
+#ifndef CMN_PROFILER_COMPACT
+#define CMN_PROFILER_COMPACT            0
+#endif /* !defined(CMN_PROFILER_COMPACT) */
+
+#if defined(PROFILER_COMPACT) && (PROFILER_COMPACT != CMN_PROFILER_COMPACT)
+#error PROFILER_COMPACT must match CMN_PROFILER_COMPACT; set the CMake option instead.
+#endif
+
+#ifndef PROFILER_COMPACT
+#define PROFILER_COMPACT                CMN_PROFILER_COMPACT
+#endif /* !defined(PROFILER_COMPACT) */
+
+/// The number of ticks of per-tick history maintained for a stack location.
+#define PROFILER_HISTORY_SIZE           128
+
+/// The maximum number of counters and gauges that can be registered. Metrics
+/// updated after the limit is reached are not reported.
+#define PROFILER_MAX_METRICS            64
+
 /* INTERNAL. DO NOT USE. */
 #define PROFILER_BEGIN_DATA(zone)                                             \
-    /* declare a static cache of the zone stack */                            \
-    static profile::stack_t *Profile_Cache_Stack = &Profile_Dummy_Stack
+    /* declare a per-thread static cache of the zone stack */                 \
+    static CMN_THREAD_LOCAL profile::stack_t *Profile_Cache_Stack =           \
+        &profile::Profile_Dummy_Stack
 
 /* INTERNAL. DO NOT USE. */
 #define PROFILER_BEGIN_RAW(zone)                                              \
@@ -52,27 +96,42 @@ extern void     tick_count(int64_t*);
 #define PROFILER_BEGIN_CODE(zone)                                             \
     (                                                                         \
     /* check the cached stack and update if needed */                         \
-    (Profile_Cache_Stack->parent != Profile_Stack    ?                        \
-     Profile_Cache_Stack = profile::push_zone(&zone) :                        \
+    (Profile_Cache_Stack->parent != profile::Profile_Stack ?                  \
+     Profile_Cache_Stack = profile::push_zone(&zone)     :                    \
      0),                                                                      \
-    ++Profile_Cache_Stack->entry_count,                                       \
-    profile::tick_count(&Profile_Time),                                       \
+    ++Profile_Cache_Stack->entry_total,                                       \
+    profile::tick_count(&profile::Profile_Time),                              \
     /* stop the timer on the parent zone stack */                             \
-    (Profile_Stack->self_ticks += Profile_Time - Profile_Stack->self_start),  \
+    (profile::Profile_Stack->self_total +=                                    \
+        profile::Profile_Time - profile::Profile_Stack->self_start),          \
     /* make the cached stack current */                                       \
-    Profile_Stack = Profile_Cache_Stack,                                      \
-    Profile_Stack->self_start = Profile_Time,                                 \
+    profile::Profile_Stack = Profile_Cache_Stack,                             \
+    profile::Profile_Stack->self_start = profile::Profile_Time,               \
+    /* read the hardware counters if the location captures them */            \
+    (profile::Profile_Stack->counters != NULL ?                               \
+     profile::enter_counters(profile::Profile_Stack) : 0),                    \
+    /* record the entry event if the timeline is enabled */                   \
+    (profile::Profile_Timeline ?                                              \
+     profile::record_event(&zone, profile::Profile_Time, 0) : 0),             \
     0)
 
 /* INTERNAL. DO NOT USE. */
 #define PROFILER_END_RAW()                                                    \
-    (profile::tick_count(&Profile_Time),                                      \
+    (/* read the hardware counters if the location captures them */           \
+     (profile::Profile_Stack->counters != NULL ?                              \
+      profile::leave_counters(profile::Profile_Stack) : 0),                   \
+     profile::tick_count(&profile::Profile_Time),                             \
      /* stop the timer for the current zone stack */                          \
-     Profile_Stack->self_ticks += Profile_Time - Profile_Stack->self_start,   \
+     profile::Profile_Stack->self_total +=                                    \
+        profile::Profile_Time - profile::Profile_Stack->self_start,           \
+     /* record the exit event if the timeline is enabled */                   \
+     (profile::Profile_Timeline ?                                             \
+      profile::record_event(profile::Profile_Stack->zone,                     \
+                            profile::Profile_Time, 1) : 0),                   \
      /* make the parent chain current */                                      \
-     Profile_Stack = Profile_Stack->parent,                                   \
+     profile::Profile_Stack = profile::Profile_Stack->parent,                 \
      /* start the timer for the parent zone stack */                          \
-     Profile_Stack->self_start = Profile_Time);
+     profile::Profile_Stack->self_start = profile::Profile_Time);
 
 #define PROFILER_DECLARE_ZONE(zone)                                           \
     profile::zone_t Profile_Zone_##zone
@@ -80,6 +139,9 @@ extern void     tick_count(int64_t*);
 #define PROFILER_DEFINE_ZONE(zone)                                            \
     PROFILER_DECLARE_ZONE(zone) = { #zone }
 
+#define PROFILER_DEFINE_COUNTER_ZONE(zone)                                    \
+    PROFILER_DECLARE_ZONE(zone) = { #zone, NULL, NULL, 0, 0, 0, 1 }
+
 /* INTERNAL. DO NOT USE. */
 #define PROFILER_REGION(zone)                                                 \
     PROFILER_BEGIN_RAW(Profile_Zone_##zone);
@@ -110,6 +172,60 @@ extern void     tick_count(int64_t*);
     static PROFILER_DEFINE_ZONE(zone);                                        \
     PROFILER_DECLARE_SCOPE(zone)
 
+/// Use this macro in place of PROFILER_ENTER_ZONE to define and enter a zone
+/// that also captures hardware performance counters on each entry and exit.
+/// Counters are only captured where profile::counter_access() reports that
+/// they are available; otherwise the zone behaves like any other zone.
+#define PROFILER_ENTER_COUNTER_ZONE(zone)                                     \
+    static PROFILER_DEFINE_COUNTER_ZONE(zone);                                \
+    PROFILER_REGION(zone)
+
+/// Use this macro in place of PROFILER_ENTER_SCOPE to define and enter a zone
+/// that also captures hardware performance counters on each entry and exit.
+/// Use a semicolon at the end of the macro.
+#define PROFILER_ENTER_COUNTER_SCOPE(zone)                                    \
+    static PROFILER_DEFINE_COUNTER_ZONE(zone);                                \
+    PROFILER_DECLARE_SCOPE(zone)
+
+/* INTERNAL. DO NOT USE. */
+#define PROFILER_METRIC_SLOT(metric)                                          \
+    (/* use the cached slot if the metric and thread are both current */      \
+     metric.epoch == profile::Profile_Metric_Epoch ?                          \
+     profile::Profile_Metric_Values + metric.index :                          \
+     profile::metric_slot(&metric))
+
+#define PROFILER_DECLARE_METRIC(name)                                         \
+    profile::metric_t Profile_Metric_##name
+
+/// Use this macro at file scope to define a named counter. A counter reports
+/// the sum of the amounts added by all threads during each tick.
+#define PROFILER_DEFINE_COUNTER(name)                                         \
+    PROFILER_DECLARE_METRIC(name) = { #name, profile::METRIC_COUNTER }
+
+/// Use this macro at file scope to define a named gauge. A gauge reports a
+/// level, such as a queue depth, sampled at each call to profile::update().
+#define PROFILER_DEFINE_GAUGE(name)                                           \
+    PROFILER_DECLARE_METRIC(name) = { #name, profile::METRIC_GAUGE }
+
+/// Use this macro to add an amount to a counter. The amount is added to an
+/// accumulator private to the calling thread, so the macro is cheap enough to
+/// use in hot loops. Use a semicolon at the end of the macro.
+#define PROFILER_COUNT(name, amount)                                          \
+    (*PROFILER_METRIC_SLOT(Profile_Metric_##name) += int64_t(amount))
+
+/// Use this macro to set the calling thread's contribution to a gauge. The
+/// reported level is the sum of the contributions of all threads, so a gauge
+/// set from more than one thread should instead be adjusted with
+/// PROFILER_GAUGE_ADD(). Use a semicolon at the end of the macro.
+#define PROFILER_GAUGE_SET(name, value)                                       \
+    (*PROFILER_METRIC_SLOT(Profile_Metric_##name)  = int64_t(value))
+
+/// Use this macro to adjust the calling thread's contribution to a gauge; for
+/// example, a producer thread adds one and a consumer thread subtracts one to
+/// track the depth of a queue. Use a semicolon at the end of the macro.
+#define PROFILER_GAUGE_ADD(name, delta)                                       \
+    (*PROFILER_METRIC_SLOT(Profile_Metric_##name) += int64_t(delta))
+
 /// Function signature for a user-defined function that allocates a new stack_t
 /// structure. Instances are always fixed-size.
 ///
@@ -169,6 +285,19 @@ typedef void  (CMN_CALL_C *render_graph_fn)(
 /// @param context Additional opaque data passed to the callback function.
 typedef float (CMN_CALL_C *text_width_fn)(char const *text, void *context);
 
+/// Function signature for a user-defined function that is called by the
+/// profiler to write exported profile data to a file, socket or buffer.
+///
+/// @param data Pointer to the data to write.
+/// @param size The number of bytes to write.
+/// @param context Additional opaque data passed to the callback function.
+/// @return The number of bytes written. A value less than @a size aborts
+/// the export operation.
+typedef size_t (CMN_CALL_C *write_fn)(
+    void const            *data,
+    size_t                 size,
+    void                  *context);
+
 /// An enumeration defining the update modes supported by the profiler.
 enum update_mode_e
 {
@@ -210,6 +339,118 @@ enum recursion_mode_e
     RECURSION_FORCE_32BIT       = CMN_FORCE_32BIT,
 };
 
+/// An enumeration defining the types of events recorded in the timeline.
+enum timeline_event_e
+{
+    /// The event marks entry into a profile zone.
+    TIMELINE_ENTER              = 0,
+    /// The event marks exit from a profile zone.
+    TIMELINE_EXIT               = 1,
+    /// This value is unused and serves to force the enumeration to be stored
+    /// in (at minimum) a 32-bit value.
+    TIMELINE_EVENT_FORCE_32BIT  = CMN_FORCE_32BIT,
+};
+
+/// An enumeration defining the formats supported when writing the timeline.
+enum timeline_format_e
+{
+    /// The timeline is written as Chrome trace-event JSON, suitable for
+    /// loading into chrome://tracing or a compatible trace viewer.
+    TIMELINE_CHROME_JSON        = 0,
+    /// The timeline is written in a compact binary format. The data starts
+    /// with a timeline_header_t, followed by zone_count zone names (each a
+    /// uint32_t byte length followed by the characters, not terminated) and
+    /// thread_count thread blocks. Each thread block is a uint32_t thread
+    /// index, a uint32_t name length, the name characters, a uint32_t event
+    /// count and that many event_t records. All values are in host order.
+    TIMELINE_BINARY             = 1,
+    /// This value is unused and serves to force the enumeration to be stored
+    /// in (at minimum) a 32-bit value.
+    TIMELINE_FORMAT_FORCE_32BIT = CMN_FORCE_32BIT,
+};
+
+/// An enumeration defining the formats supported by profile::export_report().
+enum export_format_e
+{
+    /// The call graph is written as a JSON document. The document contains
+    /// the frame time, an array of threads, each holding a tree of call sites
+    /// with self and heirarchical times (in milliseconds), entry counts, their
+    /// variances and the maximum recursion depth, and an array of per-zone
+    /// totals across all threads. Call sites of zones capturing hardware
+    /// counters also report instructions, cache misses and branch misses.
+    /// A final array lists the smoothed per-tick value of each counter and
+    /// gauge, the unsmoothed value for the last tick and, for counters, the
+    /// total count since the metric was registered. When sampling has been
+    /// enabled, a samples array lists the number of SIGPROF samples taken at
+    /// each code address within each zone, most frequent first, along with
+    /// the symbol name when it can be resolved. The document ends with the
+    /// number of samples dropped and the number of stack locations that are
+    /// missing from the report because the location table was full.
+    EXPORT_JSON                 = 0,
+    /// The call graph is written in the "folded stacks" text format consumed
+    /// by flame graph tools; one line per call site, listing the thread name
+    /// and zone names separated by semicolons, followed by the self time in
+    /// microseconds.
+    EXPORT_FOLDED_STACKS        = 1,
+    /// The per-zone totals across all threads are written in a compact binary
+    /// format intended for transmission to a remote viewer. The data starts
+    /// with a summary_header_t, followed by zone_count summary_zone_t records,
+    /// each immediately followed by name_length bytes of zone name (not
+    /// terminated), and then metric_count summary_metric_t records, each
+    /// followed by its name in the same way. Zones are ordered by decreasing
+    /// self time, metrics by registration order, and all values are in host
+    /// order. The header also counts the stack locations that are missing
+    /// from the totals because the location table was full.
+    EXPORT_SUMMARY              = 2,
+    /// This value is unused and serves to force the enumeration to be stored
+    /// in (at minimum) a 32-bit value.
+    EXPORT_FORCE_32BIT          = CMN_FORCE_32BIT,
+};
+
+/// An enumeration defining the hardware performance counters captured for
+/// zones that request them. The values are indices into counters_t arrays.
+enum counter_e
+{
+    /// The number of instructions retired.
+    COUNTER_INSTRUCTIONS        = 0,
+    /// The number of last-level cache misses.
+    COUNTER_CACHE_MISSES        = 1,
+    /// The number of mispredicted branches.
+    COUNTER_BRANCH_MISSES       = 2,
+    /// This value is unused and serves to force the enumeration to be stored
+    /// in (at minimum) a 32-bit value.
+    COUNTER_FORCE_32BIT         = CMN_FORCE_32BIT,
+};
+
+/// An enumeration defining how hardware performance counters are read on the
+/// calling thread, as returned by profile::counter_access().
+enum counter_access_e
+{
+    /// Hardware counters are not available; counter zones capture nothing.
+    COUNTER_ACCESS_NONE         = 0,
+    /// Counters are read with a system call on each zone entry and exit.
+    COUNTER_ACCESS_SYSCALL      = 1,
+    /// Counters are read directly from user mode using the RDPMC instruction.
+    COUNTER_ACCESS_RDPMC        = 2,
+    /// This value is unused and serves to force the enumeration to be stored
+    /// in (at minimum) a 32-bit value.
+    COUNTER_ACCESS_FORCE_32BIT  = CMN_FORCE_32BIT,
+};
+
+/// An enumeration defining the types of metric that can be registered.
+enum metric_type_e
+{
+    /// The metric counts events; the value reported for each tick is the
+    /// total amount added by all threads during the tick.
+    METRIC_COUNTER              = 0,
+    /// The metric measures a level; the value reported for each tick is the
+    /// sum of the contributions of all threads at the time of the update.
+    METRIC_GAUGE                = 1,
+    /// This value is unused and serves to force the enumeration to be stored
+    /// in (at minimum) a 32-bit value.
+    METRIC_TYPE_FORCE_32BIT     = CMN_FORCE_32BIT,
+};
+
 /// Stores the callback functions necessary to allocate and release profile
 /// stack_t instances. An instance of this structure should be passed to the
 /// profiler initialization function.
@@ -221,12 +462,17 @@ struct alloc_t
 };
 
 /// Represents a single sample value within the profiler. These structures are
-/// used for both time values and for entry counts.
+/// used for both time values and for entry counts. In compact mode, history
+/// points into a ring allocated on demand, and is NULL while not inspected.
 struct scalar_t
 {
     float      values[3];    /// computed values for the previous 3 frames
     float      variances[3]; /// computed variances for the previous 3 frames
-    float      history[128]; /// measured values for the previous 128 frames
+#if PROFILER_COMPACT
+    float     *history;      /// measured values for the previous 128 frames
+#else
+    float      history[PROFILER_HISTORY_SIZE];
+#endif
 };
 
 /// Represents historical values for a single stack location.
@@ -245,28 +491,68 @@ struct zone_t
     char const *name;         /// the null-terminated string name of the zone
     float      *history;      /// pointer to an item in the zone history array
     record_t   *report_nodes; /// nodes associated with this zone in the report
-    uint32_t    initialized;  /// non-zero if the zone is in use
+    uint32_t    initialized;  /// one plus the table slot, or zero if unused
     uint32_t    visited;      /// non-zero if the zone has been visited
+    uint32_t    index;        /// zero-based index; may lag initialized
+    uint32_t    counters;     /// non-zero to capture hardware counters
+    uint32_t    inspected;    /// non-zero to keep history in compact mode
+};
+
+/// Represents a single, named counter or gauge. Like zones, metrics are file-
+/// static instances registered the first time they are updated. The values
+/// are held in per-thread accumulators and merged by profile::update().
+struct metric_t
+{
+    char const *name;         /// the null-terminated string name of the metric
+    uint32_t    type;         /// one of profile::metric_type_e
+    uint32_t    epoch;        /// the profiler epoch it was registered in
+    uint32_t    index;        /// zero-based index of the metric once in use
+};
+
+/// Represents the hardware performance counter data for a stack location whose
+/// zone captures counters. Counts are inclusive of any child zones.
+struct counters_t
+{
+    uint64_t    start[PROFILER_COUNTER_COUNT];  /// values at the last entry
+    uint64_t    total[PROFILER_COUNTER_COUNT];  /// running totals; owner only
+    uint64_t    mark [PROFILER_COUNTER_COUNT];  /// total at the last update
+    uint64_t    count[PROFILER_COUNTER_COUNT];  /// events counted this tick
+    float       values[PROFILER_COUNTER_COUNT][3]; /// smoothed counts per tick
 };
 
 /// Represents a single entry location to a profile zone. The same profile zone
 /// can be entered from multiple locations within the code; each one of these
 /// locations is represented by a stack_t instance. These instances are
-/// allocated on the heap.
+/// allocated on the heap. Each thread has its own tree of stack_t instances;
+/// the running totals are only ever written by the owning thread, and are
+/// sampled into the per-tick values by profile::update(). The fields read
+/// and written on zone entry and exit come first and span 40 bytes, so the
+/// instrumentation touches a single cache line of each location; the fields
+/// that follow are only accessed by profile::update() and the reports.
 struct stack_t
 {
     stack_t    *parent;      /// pointer to the parent zone entry location data
-    zone_t     *zone;        /// pointer to the zone associated with this entry
-    history_t   history;     /// historical data for this location
     int64_t     self_start;  /// tick count for first entry at this location
-    int64_t     self_ticks;  /// number of ticks spent only in self
+    int64_t     self_total;  /// running ticks spent in self; owner-thread only
+    counters_t *counters;    /// hardware counter data, or NULL if not captured
+    uint32_t    entry_total; /// running entry count; owner-thread only
+    uint32_t    thread_index; /// index of the thread owning this location
+    zone_t     *zone;        /// pointer to the zone associated with this entry
+    int64_t     self_mark;   /// value of self_total at the previous update
+    int64_t     self_ticks;  /// number of ticks spent only in self this tick
     int64_t     heir_ticks;  /// number of ticks spent in self and descendants
-    uint32_t    entry_count; /// number of times the zone has been entered here
+    uint32_t    entry_mark;  /// value of entry_total at the previous update
+    uint32_t    entry_count; /// number of times the zone was entered this tick
     uint32_t    entry_depth; /// number of times the location has recursed
+    history_t   history;     /// historical data for this location
 };
 
 /// Represents the record for a single zone within a profile report. The
 /// profile report is the mechanism used to present information on-screen.
+/// The first three values hold the self time, heirarchical time and entry
+/// count. For zones capturing hardware counters, values 3 through 5 hold the
+/// instructions retired, cache misses and branch misses per tick, indexed by
+/// profile::counter_e, and bits 3 through 5 of value_flags are set.
 struct record_t
 {
     char const *name;        /// the name of the associated zone
@@ -275,20 +561,23 @@ struct record_t
     uint32_t    indent;      /// level of indentation when in call-graph mode
     uint32_t    value_flags; /// bit flags indicating which values are specified
     float       hotness;     /// the level of "hotness" for the zone
-    float       values[4];   /// computed values for each of the columns
+    float       values[6];   /// computed values for each of the columns
     char        prefix;      /// the prefix character used in call-graph mode
 };
 
 /// Represents the profile report. The report presents information on a maximum
 /// of 512 profile zones. When in call-graph view, up to three report nodes may
-/// be displayed per-zone.
+/// be displayed per-zone. Counters and gauges are listed separately, with the
+/// per-tick value of each stored in the first value of its record.
 struct report_t
 {
     char        title[256];     /// title string containing FPS and ms/frame
     char        headers[5][32]; /// strings for each of the column header fields
     int32_t     highlighted;    /// zero-based index of the highlighted record
     int32_t     record_count;   /// the total number of used report records
+    int32_t     metric_count;   /// the number of used metric records
     record_t    records[512*3]; /// storage for maximum number of report records
+    record_t    metrics[PROFILER_MAX_METRICS]; /// records for each metric
 };
 
 /// Represents the information required to display a single on-screen line item
@@ -312,18 +601,100 @@ struct graph_item_t
     void       *user_data;   /// user-supplied context value
 };
 
+/// Represents a single zone entry or exit event recorded in the timeline.
+/// Events are stored in a ring buffer owned by the recording thread.
+struct event_t
+{
+    int64_t     timestamp;   /// the tick count at which the event occurred
+    uint32_t    zone_index;  /// the zero-based index of the zone
+    uint32_t    event_type;  /// one of profile::timeline_event_e
+};
+
+/// Represents the timeline ring buffer owned by a single thread. The events
+/// array holds mask + 1 items; the event with sequence number n is stored at
+/// index (n & mask).
+struct timeline_t
+{
+    event_t          *events;       /// the ring buffer storage
+    uint32_t          mask;         /// the ring buffer capacity, minus one
+    uint32_t          thread_index; /// the index of the owning thread
+    uint32_t volatile count;        /// the total number of events recorded
+};
+
+/// The header written at the start of a timeline in TIMELINE_BINARY format.
+struct timeline_header_t
+{
+    char        magic[4];         /// always 'P', 'T', 'L', 'N'
+    uint32_t    version;          /// the format version; currently 1
+    uint64_t    ticks_per_second; /// the frequency of event timestamps
+    uint32_t    zone_count;       /// the number of zone names that follow
+    uint32_t    thread_count;     /// the number of thread blocks that follow
+};
+
+/// The header written at the start of a profile report in EXPORT_SUMMARY
+/// format.
+struct summary_header_t
+{
+    char        magic[4];         /// always 'P', 'S', 'U', 'M'
+    uint32_t    version;          /// the format version; currently 3
+    uint32_t    zone_count;       /// the number of zone records that follow
+    float       frame_ms;         /// the average frame time, in milliseconds
+    uint64_t    update_count;     /// the number of calls to profile::update()
+    uint32_t    metric_count;     /// the number of metric records that follow
+    uint32_t    dropped;          /// the number of unreported stack locations
+};
+
+/// The record written for each zone of a profile report in EXPORT_SUMMARY
+/// format. Times are summed over all call sites and threads.
+struct summary_zone_t
+{
+    float       self_ms;          /// the self time, in milliseconds
+    float       heir_ms;          /// the heirarchical time, in milliseconds
+    float       entries;          /// the average number of entries per tick
+    uint32_t    max_depth;        /// the maximum recursion depth
+    uint32_t    name_length;      /// the number of name bytes that follow
+};
+
+/// The record written for each counter and gauge of a profile report in
+/// EXPORT_SUMMARY format.
+struct summary_metric_t
+{
+    float       value;            /// the smoothed value per tick
+    uint32_t    type;             /// one of profile::metric_type_e
+    int64_t     sample;           /// the value for the most recent tick
+    uint32_t    name_length;      /// the number of name bytes that follow
+    uint32_t    reserved;         /// unused; always zero
+};
+
 /// A module-local value used to temporarially store a sample time value,
 /// exported here because it is referenced explicitly by the macros above.
-static int64_t           Profile_Time;
+static CMN_THREAD_LOCAL int64_t           Profile_Time;
 
-/// A global value used to track the current top-of-stack for the profiling
+/// A per-thread value used to track the current top-of-stack for the profiling
 /// information. Exported here due to an explicit reference by the macros.
-extern profile::stack_t* Profile_Stack;
+extern CMN_THREAD_LOCAL profile::stack_t* Profile_Stack;
 
 /// A global dummy stack entry. Exported here due to an explicit reference by
 /// the macros above.
 extern profile::stack_t  Profile_Dummy_Stack;
 
+/// A per-thread pointer to the metric accumulators of the calling thread.
+/// Exported here due to an explicit reference by the macros above.
+extern CMN_THREAD_LOCAL int64_t*          Profile_Metric_Values;
+
+/// The profiler epoch in which Profile_Metric_Values was assigned. Exported
+/// here due to an explicit reference by the macros above.
+extern CMN_THREAD_LOCAL uint32_t          Profile_Metric_Epoch;
+
+/// A global flag that is non-zero while timeline events are being recorded.
+/// Exported here due to an explicit reference by the macros above.
+extern int32_t volatile  Profile_Timeline;
+
+/// Retrieves the frequency of the clock sampled by profile::tick_count().
+///
+/// @return The number of ticks per second.
+CMN_PUBLIC uint64_t tick_frequency(void);
+
 /// Initializes a stack_t allocator instance.
 ///
 /// @param alloc The allocator structure to initialize.
@@ -351,6 +722,36 @@ CMN_PUBLIC void initialize(profile::alloc_t *allocator);
 /// for allocator_init() and initialize().
 CMN_PUBLIC void shutdown(void);
 
+/// Registers the calling thread with the profiler and assigns it a name for
+/// reporting purposes. Threads are registered automatically the first time
+/// they enter a zone, so calling this function is optional.
+///
+/// @param name A NULL-terminated string specifying the thread name. The string
+/// must remain valid until profile::shutdown() is called. May be NULL.
+/// @return The zero-based index of the calling thread.
+CMN_PUBLIC int32_t register_thread(char const *name);
+
+/// Retrieves the number of threads that have been registered with the
+/// profiler since it was initialized.
+/// @return The number of registered threads.
+CMN_PUBLIC size_t  thread_count(void);
+
+/// Retrieves the name associated with a registered thread.
+///
+/// @param thread_index The zero-based index of the thread.
+/// @return The thread name, or NULL if the thread has no name.
+CMN_PUBLIC char const* thread_name(int32_t thread_index);
+
+/// Selects the thread whose call graph is displayed in the report.
+///
+/// @param thread_index The zero-based index of the thread to display, or
+/// PROFILER_ALL_THREADS to display the merged call graph of all threads.
+CMN_PUBLIC void select_thread(int32_t thread_index);
+
+/// Retrieves the index of the thread whose call graph is being displayed.
+/// @return The zero-based thread index, or PROFILER_ALL_THREADS.
+CMN_PUBLIC int32_t current_thread(void);
+
 /// Retrieves the current reporting mode value.
 /// @return One of profile::report_mode_e.
 CMN_PUBLIC int32_t current_reporting_mode(void);
@@ -420,8 +821,39 @@ CMN_PUBLIC void select_item(void);
 /// Returns to the parent of the currently selected zone.
 CMN_PUBLIC void select_parent(void);
 
+/// Marks a zone as being inspected. In compact mode, per-tick history is only
+/// recorded for the stack locations of inspected zones, of the currently
+/// expanded zone and of its children, starting from the next update; other
+/// locations report zero when a previous tick is displayed. In the default
+/// mode, history is recorded for every location and this flag has no effect.
+///
+/// @param zone The zone to inspect. Use the Profile_Zone_<name> variable
+/// declared by PROFILER_DECLARE_ZONE().
+/// @param inspect Specify true to start recording history for the zone, or
+/// false to stop and release the history.
+CMN_PUBLIC void inspect_zone(profile::zone_t *zone, bool inspect);
+
+/// Unregisters a zone defined by a module that is about to be unloaded, such
+/// as a shared library or plugin. The stack locations of the zone, and its
+/// report records and history, are moved to a library-owned copy of the zone
+/// so they remain valid after the zone variable and its name are unmapped.
+/// Zones register themselves without a lock the first time they are entered
+/// on any thread; if the module is loaded again, the zone registers again in
+/// a new slot. Slots are never reused, so a zone that is repeatedly loaded
+/// and unloaded consumes one of the 512 table slots each time. Calls to this
+/// function are serialized internally, so several modules may unload at once,
+/// and other zones may register concurrently. No thread may be inside, or
+/// enter, the zone during the call, and this function must not be called
+/// concurrently with profile::update() or the report functions.
+///
+/// @param zone The zone to unregister. Use the Profile_Zone_<name> variable
+/// declared by PROFILER_DECLARE_ZONE().
+CMN_PUBLIC void unregister_zone(profile::zone_t *zone);
+
 /// This function should be called once per-tick to collect timing information
-/// and update the profile report data.
+/// and update the profile report data. Timing information is collected from
+/// all threads that have entered profile zones; only one thread may call this
+/// function (or any of the report functions) at a time.
 ///
 /// @param update_mode One of the profile::update_mode_e values.
 CMN_PUBLIC void update(int32_t update_mode);
@@ -475,6 +907,89 @@ CMN_PUBLIC void render_graph(
     profile::render_graph_fn  render_func,
     void                     *context);
 
+/// Writes the current call graph of every thread without rendering anything,
+/// for use by applications that have no display. Unlike the on-screen report,
+/// the export covers every call site and zone. Values reflect the smoothing
+/// factor set by profile::configure_report() and are updated by
+/// profile::update(), which must not be running concurrently.
+///
+/// @param format One of profile::export_format_e.
+/// @param write_func The application-specified output callback.
+/// @param context Opaque application-defined data to be passed to the
+/// callback function @a write_func.
+/// @return The number of bytes written, or zero if the output callback
+/// reported an error.
+CMN_PUBLIC size_t export_report(
+    int32_t                   format,
+    profile::write_fn         write_func,
+    void                     *context);
+
+/// Starts recording zone entry and exit events on all threads. Each thread
+/// records into its own ring buffer, allocated from the C runtime heap the
+/// first time the thread records an event, so the buffers always hold the
+/// most recent events. Buffers are released by profile::shutdown().
+///
+/// @param events_per_thread The capacity of each thread's ring buffer. This
+/// value is rounded up to the next power of two. Buffers that already exist
+/// keep their original capacity.
+CMN_PUBLIC void enable_timeline(size_t events_per_thread);
+
+/// Stops recording timeline events. Recorded events are retained and can
+/// still be written with profile::write_timeline().
+CMN_PUBLIC void disable_timeline(void);
+
+/// Determines whether timeline events are currently being recorded.
+/// @return true if the timeline is enabled.
+CMN_PUBLIC bool timeline_enabled(void);
+
+/// Writes the events currently held in each thread's ring buffer. Threads may
+/// continue recording while the timeline is written; events overwritten while
+/// being copied are dropped.
+///
+/// @param format One of profile::timeline_format_e.
+/// @param write_func The application-specified output callback.
+/// @param context Opaque application-defined data to be passed to the
+/// callback function @a write_func.
+/// @return The number of bytes written, or zero if the output callback
+/// reported an error.
+CMN_PUBLIC size_t write_timeline(
+    int32_t                   format,
+    profile::write_fn         write_func,
+    void                     *context);
+
+/// Starts statistical sampling of all registered threads, to find the time
+/// spent in code that is not instrumented. On Linux, each registered thread
+/// gets a timer on its own CPU-time clock that raises SIGPROF on that thread;
+/// on Mac OS X, a single process-wide ITIMER_PROF timer is used. The signal
+/// handler captures the callstack with memory::capture_callstack() and counts
+/// the interrupted code address against the stack location of the zone the
+/// thread is executing, in a fixed-size table that is updated without locks.
+/// Samples are included in profile::export_report() with EXPORT_JSON. The
+/// handler replaces any existing SIGPROF handler and remains installed after
+/// sampling is disabled. Sampling is not supported on Windows.
+///
+/// @param interval_usec The sampling interval, in microseconds of CPU time.
+/// Samples recorded previously are discarded.
+/// @return true if sampling was started.
+CMN_PUBLIC bool enable_sampling(uint32_t interval_usec);
+
+/// Stops statistical sampling. Recorded samples are retained until sampling
+/// is enabled again or the profiler is shut down.
+CMN_PUBLIC void disable_sampling(void);
+
+/// Determines whether statistical sampling is currently enabled.
+/// @return true if threads are being sampled.
+CMN_PUBLIC bool sampling_enabled(void);
+
+/// Determines whether hardware performance counters can be captured on the
+/// calling thread, and how they are read. On Linux, counters are opened with
+/// perf_event_open() the first time a thread enters a counter zone, and are
+/// read with RDPMC when the kernel allows user-mode access. Access may be
+/// denied by the kernel.perf_event_paranoid setting or by the hypervisor.
+///
+/// @return One of profile::counter_access_e.
+CMN_PUBLIC int32_t counter_access(void);
+
 /// Defines a convenience structure instance created on the stack to enter a
 /// profile zone when the PROFILE_ENTER_SCOPE() macro is used and exit the
 /// zone automatically whenever the enclosing scope is exited.
@@ -0,0 +1,800 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements a minimal STOMP endpoint that publishes summaries of
+/// the profile report to remote listeners, and the listener side used by
+/// tools to subscribe to a running process.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libprofnet.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the maximum size of the command and header portion of a MESSAGE frame.
+#define MAX_FRAME_HEADER_SIZE  1024U
+/// the maximum size of a control frame sent to or from a client.
+#define MAX_CONTROL_FRAME_SIZE 1024U
+/// the subscription id used by profnet::create_listener().
+#define LISTENER_SUBSCRIPTION  "0"
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static size_t CMN_CALL_C append_body(
+    void const *data,
+    size_t      size,
+    void       *context)
+{
+    // profile::write_fn callback used to serialize the report summary into
+    // the publisher's body buffer, growing the buffer as necessary.
+    profnet::publisher_t *pub = (profnet::publisher_t*) context;
+    if (pub->body_size + size > pub->body_capacity)
+    {
+        size_t   capacity = pub->body_capacity * 2;
+        uint8_t *body     = NULL;
+        if (capacity < pub->body_size + size)
+        {
+            capacity = pub->body_size + size;
+        }
+        body = (uint8_t*) ::realloc(pub->body, capacity);
+        if (NULL == body) return 0;
+        pub->body          = body;
+        pub->body_capacity = capacity;
+    }
+    memcpy(pub->body + pub->body_size, data, size);
+    pub->body_size += size;
+    return size;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool send_data(
+    network::socket_t &sock,
+    void const        *data,
+    size_t             size)
+{
+    bool   disconnected = false;
+    size_t sent         = network::write(sock, data, size, 0, size, &disconnected);
+    if (disconnected)
+    {
+        // network::write() has already shut the socket down.
+        sock = INVALID_SOCKET_ID;
+        return false;
+    }
+    return (sent == size);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool send_control(
+    network::socket_t &sock,
+    char const        *command,
+    char const       **headers)
+{
+    // headers is a NULL-terminated list of alternating keys and values.
+    uint8_t               buffer[MAX_CONTROL_FRAME_SIZE];
+    stomp::write_state_t  writer;
+    void                 *data = NULL;
+    size_t                size = 0;
+
+    stomp::write_state_init(&writer, buffer, sizeof(buffer));
+    stomp::write_begin_frame(&writer, command);
+    for (size_t i = 0; headers != NULL && headers[i] != NULL; i += 2)
+    {
+        stomp::write_header_direct(&writer, headers[i], headers[i + 1]);
+    }
+    stomp::write_header_end(&writer);
+    if (stomp::close_frame(&writer) != stomp::WRITE_STATE_FRAME_COMPLETE)
+    {
+        // the frame didn't fit in the buffer.
+        return false;
+    }
+    stomp::write_state_flush(&writer, &data, &size);
+    return send_data(sock, data, size);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void drop_client(profnet::publisher_t *pub, profnet::client_t *client)
+{
+    if (client->subscribed)
+    {
+        pub->subscriber_count--;
+    }
+    if (network::socket_valid(client->socket))
+    {
+        network::close(client->socket);
+    }
+    client->socket     = INVALID_SOCKET_ID;
+    client->connected  = false;
+    client->subscribed = false;
+    client->id[0]      = 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void accept_clients(profnet::publisher_t *pub)
+{
+    while (network::readable(pub->socket, 0))
+    {
+        profnet::client_t *client = NULL;
+        network::socket_t  sock   = INVALID_SOCKET_ID;
+
+        if (!network::accept(pub->socket, true, &sock, NULL, NULL))
+        {
+            return;
+        }
+        for (size_t i = 0; i < PROFNET_MAX_CLIENTS; ++i)
+        {
+            if (!network::socket_valid(pub->clients[i].socket))
+            {
+                client = &pub->clients[i];
+                break;
+            }
+        }
+        if (NULL == client)
+        {
+            // no free client slots; turn the connection away.
+            char const *headers[] = {
+                stomp::HEADER_MESSAGE, "too many clients",
+                NULL
+            };
+            send_control(sock, stomp::FRAME_ERROR, headers);
+            if (network::socket_valid(sock)) network::close(sock);
+            continue;
+        }
+        client->socket     = sock;
+        client->connected  = false;
+        client->subscribed = false;
+        client->id[0]      = 0;
+        stomp::parse_state_init(&client->parser, client->message, PROFNET_CLIENT_BUFFER_SIZE);
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static char const* header_value(stomp::header_t *head, char const *name)
+{
+    size_t index = 0;
+    if (stomp::find_header(head, name, &index))
+    {
+        return head->header_values[index];
+    }
+    return NULL;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool process_frame(
+    profnet::publisher_t *pub,
+    profnet::client_t    *client,
+    stomp::message_t     *msg)
+{
+    stomp::header_t *head    = msg->head;
+    char const      *command = head->command;
+    char const      *receipt = header_value(head, stomp::HEADER_RECEIPT);
+    bool             result  = true;
+
+    if (0 == strcmp(command, stomp::FRAME_CONNECT) ||
+        0 == strcmp(command, stomp::FRAME_STOMP))
+    {
+        char const *headers[] = {
+            stomp::HEADER_VERSION, "1.1",
+            stomp::HEADER_SERVER,  "profnet/1",
+            NULL
+        };
+        client->connected = true;
+        return send_control(client->socket, stomp::FRAME_CONNECTED, headers);
+    }
+    if (!client->connected)
+    {
+        // the client must connect before sending any other frame.
+        char const *headers[] = {
+            stomp::HEADER_MESSAGE, "not connected",
+            NULL
+        };
+        send_control(client->socket, stomp::FRAME_ERROR, headers);
+        return false;
+    }
+    if (0 == strcmp(command, stomp::FRAME_SUBSCRIBE))
+    {
+        char const *dest = header_value(head, stomp::HEADER_DESTINATION);
+        char const *id   = header_value(head, stomp::HEADER_ID);
+        if (NULL == dest || 0 != strcmp(dest, pub->destination))
+        {
+            char const *headers[] = {
+                stomp::HEADER_MESSAGE, "unknown destination",
+                NULL
+            };
+            send_control(client->socket, stomp::FRAME_ERROR, headers);
+            return false;
+        }
+        if (!client->subscribed)
+        {
+            pub->subscriber_count++;
+            client->subscribed = true;
+        }
+        strncpy(client->id, (id != NULL) ? id : "0", sizeof(client->id) - 1);
+        client->id[sizeof(client->id) - 1] = 0;
+    }
+    else if (0 == strcmp(command, stomp::FRAME_UNSUBSCRIBE))
+    {
+        if (client->subscribed)
+        {
+            pub->subscriber_count--;
+            client->subscribed = false;
+        }
+    }
+    else if (0 == strcmp(command, stomp::FRAME_DISCONNECT))
+    {
+        result = false;
+    }
+    // other frames (SEND, ACK, etc.) are ignored.
+
+    if (receipt != NULL && network::socket_valid(client->socket))
+    {
+        char const *headers[] = {
+            stomp::HEADER_RECEIPT_ID, receipt,
+            NULL
+        };
+        send_control(client->socket, stomp::FRAME_RECEIPT, headers);
+    }
+    return result;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void receive_frames(profnet::publisher_t *pub, profnet::client_t *client)
+{
+    bool   disconnected = false;
+    size_t count        = 0;
+    size_t offset       = 0;
+
+    count = network::read(client->socket, client->rx_buffer, PROFNET_CLIENT_BUFFER_SIZE, 0, &disconnected);
+    if (disconnected)
+    {
+        // network::read() has already shut the socket down.
+        client->socket = INVALID_SOCKET_ID;
+        drop_client(pub, client);
+        return;
+    }
+    while (offset < count)
+    {
+        stomp::message_t msg;
+        size_t           used  = 0;
+        int32_t          state = stomp::parse_state_update(&client->parser, client->rx_buffer, count, offset, &used);
+
+        offset += used;
+        if (stomp::PARSE_STATE_MESSAGE_COMPLETE == state)
+        {
+            stomp::get_message(&client->parser, &msg);
+            if (!process_frame(pub, client, &msg))
+            {
+                drop_client(pub, client);
+                return;
+            }
+            stomp::parse_state_reset(&client->parser);
+        }
+        else if (stomp::PARSE_STATE_ERROR == state)
+        {
+            // the client isn't speaking STOMP; disconnect it.
+            drop_client(pub, client);
+            return;
+        }
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool send_summary(profnet::publisher_t *pub, profnet::client_t *client)
+{
+    stomp::write_state_t  writer;
+    void                 *data = NULL;
+    size_t                size = 0;
+
+    // the frame buffer is sized to hold the complete frame, so the
+    // writer never needs to be flushed part way through.
+    stomp::write_state_init(&writer, pub->frame, pub->frame_capacity);
+    stomp::write_begin_frame (&writer, stomp::FRAME_MESSAGE);
+    stomp::write_header_direct(&writer, stomp::HEADER_DESTINATION,  pub->destination);
+    stomp::write_header_direct(&writer, stomp::HEADER_SUBSCRIPTION, client->id);
+    stomp::write_header_format(&writer, stomp::HEADER_MESSAGE_ID, "%llu", (unsigned long long) pub->message_id);
+    stomp::write_header_direct(&writer, stomp::HEADER_CONTENT_TYPE, PROFNET_CONTENT_TYPE);
+    stomp::write_header_format(&writer, stomp::HEADER_CONTENT_LENGTH, "%u", (unsigned) pub->body_size);
+    stomp::write_header_end  (&writer);
+    stomp::write_body_data   (&writer, pub->body, pub->body_size, 0, NULL);
+    if (stomp::close_frame(&writer) != stomp::WRITE_STATE_FRAME_COMPLETE)
+    {
+        return false;
+    }
+    stomp::write_state_flush(&writer, &data, &size);
+    return send_data(client->socket, data, size);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool grow_message(profnet::listener_t *listener)
+{
+    // called when the frame being parsed does not fit in the message
+    // buffer. once the body has started its Content-Length is known, so
+    // the buffer is sized to hold the whole frame; otherwise it doubles.
+    stomp::parse_state_t *parser   =&listener->parser;
+    size_t                capacity = listener->message_capacity * 2;
+    uint8_t              *message  = NULL;
+    if (stomp::FRAME_PARSE_STATE_FRAME_BODY == parser->parse_state_frame &&
+        parser->message_body_head != NULL && parser->message_header.content_length > 0)
+    {
+        size_t head   = size_t(parser->message_body_head - parser->message_buffer);
+        size_t length = parser->message_header.content_length;
+        // the body is followed by its terminating null byte.
+        if (length < PROFNET_LISTEN_BUFFER_MAX && head + length + 1 > listener->message_capacity)
+        {
+            capacity = head + length + 1;
+        }
+    }
+    if (capacity > PROFNET_LISTEN_BUFFER_MAX)
+    {
+        return false;
+    }
+    if (NULL == (message = (uint8_t*) ::malloc(capacity)))
+    {
+        return false;
+    }
+    if (!stomp::parse_state_resize(parser, message, capacity))
+    {
+        ::free(message);
+        return false;
+    }
+    ::free(listener->message);
+    listener->message          = message;
+    listener->message_capacity = capacity;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void drop_message(profnet::listener_t *listener)
+{
+    // the body of a summary is binary, so the parser cannot re-synchronize
+    // on the terminating null byte. when the Content-Length is known, the
+    // rest of the frame is skipped instead and parsing starts over.
+    stomp::parse_state_t *parser =&listener->parser;
+    listener->oversize_count++;
+    if (stomp::FRAME_PARSE_STATE_FRAME_BODY == parser->parse_state_frame &&
+        parser->message_body_head != NULL && parser->message_header.content_length > 0)
+    {
+        size_t read = size_t(parser->message_body_tail - parser->message_body_head);
+        listener->rx_skip = parser->message_header.content_length - read + 1;
+        stomp::parse_state_init(parser, listener->message, listener->message_capacity);
+    }
+    else stomp::parse_state_recover(parser);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool profnet::create_publisher(
+    profnet::publisher_t *publisher,
+    char const           *service_or_port,
+    char const           *destination,
+    float                 interval,
+    bool                  local_only)
+{
+    if (NULL == publisher || NULL == service_or_port)
+    {
+        return false;
+    }
+    if (NULL == destination)
+    {
+        destination = PROFNET_DEFAULT_DESTINATION;
+    }
+    if (strlen(destination) >= sizeof(publisher->destination))
+    {
+        return false;
+    }
+    if (interval < 0.0f)
+    {
+        interval = 0.0f;
+    }
+
+    strcpy(publisher->destination, destination);
+    publisher->interval         = int64_t(interval * profile::tick_frequency());
+    publisher->message_id       = 0;
+    publisher->subscriber_count = 0;
+    publisher->body             = NULL;
+    publisher->body_size        = 0;
+    publisher->body_capacity    = 0;
+    publisher->frame            = NULL;
+    publisher->frame_capacity   = 0;
+    for (size_t i = 0; i < PROFNET_MAX_CLIENTS; ++i)
+    {
+        publisher->clients[i].socket     = INVALID_SOCKET_ID;
+        publisher->clients[i].connected  = false;
+        publisher->clients[i].subscribed = false;
+        publisher->clients[i].id[0]      = 0;
+    }
+    // the first call to profnet::publish() always polls for clients.
+    profile::tick_count(&publisher->last_update);
+    publisher->last_update -= publisher->interval;
+    return network::listen(service_or_port, PROFNET_MAX_CLIENTS, local_only, &publisher->socket);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void profnet::delete_publisher(profnet::publisher_t *publisher)
+{
+    if (NULL == publisher)
+    {
+        return;
+    }
+    for (size_t i = 0; i < PROFNET_MAX_CLIENTS; ++i)
+    {
+        if (network::socket_valid(publisher->clients[i].socket))
+        {
+            network::shutdown(publisher->clients[i].socket, NULL, NULL);
+            publisher->clients[i].socket = INVALID_SOCKET_ID;
+        }
+        publisher->clients[i].subscribed = false;
+    }
+    if (network::socket_valid(publisher->socket))
+    {
+        network::close(publisher->socket);
+        publisher->socket = INVALID_SOCKET_ID;
+    }
+    ::free(publisher->frame);
+    ::free(publisher->body);
+    publisher->frame            = NULL;
+    publisher->frame_capacity   = 0;
+    publisher->body             = NULL;
+    publisher->body_capacity    = 0;
+    publisher->subscriber_count = 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+size_t profnet::publish(profnet::publisher_t *publisher)
+{
+    int64_t now   = 0;
+    size_t  count = 0;
+
+    profile::tick_count(&now);
+    if (now - publisher->last_update < publisher->interval)
+    {
+        // not time to publish yet.
+        return 0;
+    }
+    publisher->last_update = now;
+
+    accept_clients(publisher);
+    for (size_t i = 0; i < PROFNET_MAX_CLIENTS; ++i)
+    {
+        if (network::socket_valid(publisher->clients[i].socket))
+        {
+            receive_frames(publisher, &publisher->clients[i]);
+        }
+    }
+    if (0 == publisher->subscriber_count)
+    {
+        // nobody is listening; don't bother serializing the report.
+        return 0;
+    }
+
+    publisher->body_size = 0;
+    if (0 == profile::export_report(profile::EXPORT_SUMMARY, append_body, publisher))
+    {
+        return 0;
+    }
+    if (publisher->frame_capacity < publisher->body_size + MAX_FRAME_HEADER_SIZE)
+    {
+        size_t   capacity = publisher->body_capacity + MAX_FRAME_HEADER_SIZE;
+        uint8_t *frame    = (uint8_t*) ::realloc(publisher->frame, capacity);
+        if (NULL == frame) return 0;
+        publisher->frame          = frame;
+        publisher->frame_capacity = capacity;
+    }
+
+    for (size_t i = 0; i < PROFNET_MAX_CLIENTS; ++i)
+    {
+        profnet::client_t *client = &publisher->clients[i];
+        if (client->subscribed)
+        {
+            if (send_summary(publisher, client)) ++count;
+            else drop_client(publisher, client);
+        }
+    }
+    publisher->message_id++;
+    return count;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool profnet::create_listener(
+    profnet::listener_t  *listener,
+    char const           *host_or_address,
+    char const           *service_or_port,
+    char const           *destination)
+{
+    if (NULL == listener)
+    {
+        return false;
+    }
+    if (NULL == destination)
+    {
+        destination = PROFNET_DEFAULT_DESTINATION;
+    }
+
+    listener->socket           = INVALID_SOCKET_ID;
+    listener->rx_count         = 0;
+    listener->rx_offset        = 0;
+    listener->rx_skip          = 0;
+    listener->message          = (uint8_t*) ::malloc(PROFNET_LISTEN_BUFFER_SIZE);
+    listener->message_capacity = PROFNET_LISTEN_BUFFER_SIZE;
+    listener->oversize_count   = 0;
+    if (NULL == listener->message)
+    {
+        return false;
+    }
+    stomp::parse_state_init(&listener->parser, listener->message, PROFNET_LISTEN_BUFFER_SIZE);
+    if (!network::connect(host_or_address, service_or_port, true, &listener->socket))
+    {
+        profnet::delete_listener(listener);
+        return false;
+    }
+
+    char const *connect[]   = {
+        stomp::HEADER_ACCEPT_VERSION, "1.1",
+        stomp::HEADER_HOST,           host_or_address,
+        NULL
+    };
+    char const *subscribe[] = {
+        stomp::HEADER_DESTINATION,    destination,
+        stomp::HEADER_ID,             LISTENER_SUBSCRIPTION,
+        stomp::HEADER_ACK,            "auto",
+        NULL
+    };
+    if (!send_control(listener->socket, stomp::FRAME_CONNECT,   connect) ||
+        !send_control(listener->socket, stomp::FRAME_SUBSCRIBE, subscribe))
+    {
+        profnet::delete_listener(listener);
+        return false;
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+void profnet::delete_listener(profnet::listener_t *listener)
+{
+    if (NULL == listener)
+    {
+        return;
+    }
+    ::free(listener->message);
+    listener->message          = NULL;
+    listener->message_capacity = 0;
+    if (!network::socket_valid(listener->socket))
+    {
+        return;
+    }
+    char const *unsubscribe[] = {
+        stomp::HEADER_ID, LISTENER_SUBSCRIPTION,
+        NULL
+    };
+    send_control(listener->socket, stomp::FRAME_UNSUBSCRIBE, unsubscribe);
+    if (network::socket_valid(listener->socket))
+    {
+        send_control(listener->socket, stomp::FRAME_DISCONNECT, NULL);
+    }
+    if (network::socket_valid(listener->socket))
+    {
+        network::shutdown(listener->socket, NULL, NULL);
+    }
+    listener->socket = INVALID_SOCKET_ID;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool profnet::receive_summary(
+    profnet::listener_t  *listener,
+    uint64_t              timeout_usec,
+    void const          **out_body,
+    size_t               *out_body_size,
+    bool                 *out_disconnected)
+{
+    *out_body         = NULL;
+    *out_body_size    = 0;
+    *out_disconnected = false;
+
+    if (!network::socket_valid(listener->socket))
+    {
+        *out_disconnected = true;
+        return false;
+    }
+    if (stomp::PARSE_STATE_MESSAGE_COMPLETE == listener->parser.parse_state_global)
+    {
+        // release the message returned by the previous call.
+        stomp::parse_state_reset(&listener->parser);
+    }
+
+    for ( ; ; )
+    {
+        // parse any data remaining from the previous read.
+        while (listener->rx_offset < listener->rx_count)
+        {
+            if (listener->rx_skip > 0)
+            {
+                size_t skip = listener->rx_count - listener->rx_offset;
+                if (skip > listener->rx_skip) skip = listener->rx_skip;
+                listener->rx_offset += skip;
+                listener->rx_skip   -= skip;
+                continue;
+            }
+            stomp::message_t msg;
+            size_t           used  = 0;
+            int32_t          state = stomp::parse_state_update(
+                &listener->parser,
+                listener->rx_buffer,
+                listener->rx_count,
+                listener->rx_offset,
+                &used);
+
+            listener->rx_offset += used;
+            if (stomp::PARSE_STATE_MESSAGE_COMPLETE == state)
+            {
+                stomp::get_message(&listener->parser, &msg);
+                if (0 == strcmp(msg.head->command, stomp::FRAME_MESSAGE))
+                {
+                    *out_body      = msg.body;
+                    *out_body_size = msg.body_size;
+                    return true;
+                }
+                stomp::parse_state_reset(&listener->parser);
+            }
+            else if (stomp::parse_state_full(&listener->parser))
+            {
+                if (!grow_message(listener))
+                {
+                    // the summary is lost; count it so it can be reported.
+                    drop_message(listener);
+                }
+            }
+            else if (stomp::PARSE_STATE_ERROR == state)
+            {
+                stomp::parse_state_recover(&listener->parser);
+            }
+        }
+
+        // wait for more data from the publisher.
+        if (!network::readable(listener->socket, timeout_usec))
+        {
+            return false;
+        }
+        listener->rx_offset = 0;
+        listener->rx_count  = network::read(listener->socket, listener->rx_buffer, sizeof(listener->rx_buffer), 0, out_disconnected);
+        if (*out_disconnected)
+        {
+            listener->socket = INVALID_SOCKET_ID;
+            return false;
+        }
+    }
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool profnet::decode_summary(
+    void const                *data,
+    size_t                     data_size,
+    profile::summary_header_t *out_header,
+    profnet::summary_zone_fn   zone_func,
+    void                      *context)
+{
+    uint8_t const *iter = (uint8_t const*) data;
+    uint8_t const *end  = iter + data_size;
+
+    if (NULL == data || NULL == out_header || data_size < sizeof(profile::summary_header_t))
+    {
+        return false;
+    }
+    memcpy(out_header, iter, sizeof(profile::summary_header_t));
+    iter += sizeof(profile::summary_header_t);
+    if (0 != memcmp(out_header->magic, "PSUM", 4))
+    {
+        return false;
+    }
+    if (NULL == zone_func)
+    {
+        return true;
+    }
+    for (uint32_t i = 0; i < out_header->zone_count; ++i)
+    {
+        profile::summary_zone_t zone;
+        if (size_t(end - iter) < sizeof(profile::summary_zone_t))
+        {
+            return false;
+        }
+        memcpy(&zone, iter, sizeof(profile::summary_zone_t));
+        iter += sizeof(profile::summary_zone_t);
+        if (size_t(end - iter) < zone.name_length)
+        {
+            return false;
+        }
+        if (!zone_func(&zone, (char const*) iter, context))
+        {
+            return true;
+        }
+        iter += zone.name_length;
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+bool profnet::decode_summary_metrics(
+    void const                *data,
+    size_t                     data_size,
+    profnet::summary_metric_fn metric_func,
+    void                      *context)
+{
+    profile::summary_header_t header;
+    uint8_t const            *iter = (uint8_t const*) data;
+    uint8_t const            *end  = iter + data_size;
+
+    if (NULL == metric_func || !profnet::decode_summary(data, data_size, &header, NULL, NULL))
+    {
+        return false;
+    }
+    // skip over the zone records to the first metric record.
+    iter += sizeof(profile::summary_header_t);
+    for (uint32_t i = 0; i < header.zone_count; ++i)
+    {
+        profile::summary_zone_t zone;
+        if (size_t(end - iter) < sizeof(profile::summary_zone_t))
+        {
+            return false;
+        }
+        memcpy(&zone, iter, sizeof(profile::summary_zone_t));
+        iter += sizeof(profile::summary_zone_t);
+        if (size_t(end - iter) < zone.name_length)
+        {
+            return false;
+        }
+        iter += zone.name_length;
+    }
+    for (uint32_t i = 0; i < header.metric_count; ++i)
+    {
+        profile::summary_metric_t metric;
+        if (size_t(end - iter) < sizeof(profile::summary_metric_t))
+        {
+            return false;
+        }
+        memcpy(&metric, iter, sizeof(profile::summary_metric_t));
+        iter += sizeof(profile::summary_metric_t);
+        if (size_t(end - iter) < metric.name_length)
+        {
+            return false;
+        }
+        if (!metric_func(&metric, (char const*) iter, context))
+        {
+            return true;
+        }
+        iter += metric.name_length;
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
@@ -0,0 +1,254 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Defines an interface for watching the profiler of a running
+/// process from another machine. The publisher acts as a minimal STOMP
+/// endpoint; remote listeners connect, subscribe to a destination and receive
+/// profile report summaries in MESSAGE frames at a fixed interval.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+#ifndef LIBPROFNET_HPP_INCLUDED
+#define LIBPROFNET_HPP_INCLUDED
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include "common.hpp"
+#include "libstomp.hpp"
+#include "libprofile.hpp"
+#include "libnetwork.hpp"
+
+/*///////////////////////
+//   Namespace Begin   //
+///////////////////////*/
+namespace profnet {
+
+/*////////////////////////////
+//   Forward Declarations   //
+////////////////////////////*/
+
+/*//////////////////////////////////
+//   Public Types and Functions   //
+//////////////////////////////////*/
+/// Compile-time define the maximum number of remote clients that may be
+/// connected to a single publisher at any one time.
+#ifndef PROFNET_MAX_CLIENTS
+#define PROFNET_MAX_CLIENTS        8U
+#endif /* !defined(PROFNET_MAX_CLIENTS) */
+
+/// Compile-time define the size of the buffers used to receive and parse
+/// frames sent by a client. Clients only send small control frames.
+#ifndef PROFNET_CLIENT_BUFFER_SIZE
+#define PROFNET_CLIENT_BUFFER_SIZE 1024U
+#endif /* !defined(PROFNET_CLIENT_BUFFER_SIZE) */
+
+/// Compile-time define the initial size of the buffer used by a listener to
+/// parse frames received from a publisher. A profile summary needs a little
+/// over 50 bytes per zone; the buffer grows when a larger frame arrives.
+#ifndef PROFNET_LISTEN_BUFFER_SIZE
+#define PROFNET_LISTEN_BUFFER_SIZE 65536U
+#endif /* !defined(PROFNET_LISTEN_BUFFER_SIZE) */
+
+/// Compile-time define the largest frame a listener will receive. Larger
+/// frames are discarded and counted in listener_t::oversize_count.
+#ifndef PROFNET_LISTEN_BUFFER_MAX
+#define PROFNET_LISTEN_BUFFER_MAX  (16U * 1024U * 1024U)
+#endif /* !defined(PROFNET_LISTEN_BUFFER_MAX) */
+
+/// The destination used when none is specified by the application.
+#define PROFNET_DEFAULT_DESTINATION "/topic/profile"
+
+/// The MIME content type of the MESSAGE frames sent by a publisher. The frame
+/// body is a report in profile::EXPORT_SUMMARY format.
+#define PROFNET_CONTENT_TYPE        "application/x-profile-summary"
+
+/// Function signature for the callback invoked by profnet::decode_summary()
+/// for each zone record in a profile summary.
+///
+/// @param zone The zone record.
+/// @param name The zone name. This string is not NULL-terminated; its length
+/// is specified by the name_length field of @a zone.
+/// @param context Optional opaque data passed by the application.
+/// @return true to continue decoding, or false to stop.
+typedef bool (CMN_CALL_C *summary_zone_fn)(
+    profile::summary_zone_t const *zone,
+    char const                    *name,
+    void                          *context);
+
+/// Function signature for the callback invoked by
+/// profnet::decode_summary_metrics() for each metric record in a summary.
+///
+/// @param metric The metric record.
+/// @param name The metric name. This string is not NULL-terminated; its
+/// length is specified by the name_length field of @a metric.
+/// @param context Optional opaque data passed by the application.
+/// @return true to continue decoding, or false to stop.
+typedef bool (CMN_CALL_C *summary_metric_fn)(
+    profile::summary_metric_t const *metric,
+    char const                      *name,
+    void                            *context);
+
+/// Maintains the state associated with a single remote client of a publisher.
+struct client_t
+{
+    network::socket_t     socket;           /// the client socket, or invalid
+    bool                  connected;        /// true once CONNECT is received
+    bool                  subscribed;       /// true if subscribed to the topic
+    char                  id[64];           /// the client's subscription id
+    stomp::parse_state_t  parser;           /// parser for client frames
+    uint8_t               rx_buffer[PROFNET_CLIENT_BUFFER_SIZE];
+    uint8_t               message[PROFNET_CLIENT_BUFFER_SIZE];
+};
+
+/// Maintains the state associated with a profile publisher. Publishers are
+/// created with profnet::create_publisher() and serviced by calling
+/// profnet::publish() after each call to profile::update().
+struct publisher_t
+{
+    network::socket_t     socket;           /// the listening socket
+    char                  destination[128]; /// the published destination
+    int64_t               interval;         /// ticks between publish ticks
+    int64_t               last_update;      /// tick count of the last tick
+    uint64_t              message_id;       /// the next message-id value
+    size_t                subscriber_count; /// number of subscribed clients
+    uint8_t              *body;             /// the serialized summary
+    size_t                body_size;        /// number of bytes used in body
+    size_t                body_capacity;    /// number of bytes allocated
+    uint8_t              *frame;            /// the composed MESSAGE frame
+    size_t                frame_capacity;   /// number of bytes allocated
+    client_t              clients[PROFNET_MAX_CLIENTS];
+};
+
+/// Maintains the state associated with a remote listener subscribed to a
+/// profile publisher.
+struct listener_t
+{
+    network::socket_t     socket;           /// the connection to the publisher
+    stomp::parse_state_t  parser;           /// parser for publisher frames
+    size_t                rx_count;         /// number of bytes in rx_buffer
+    size_t                rx_offset;        /// number of bytes parsed
+    size_t                rx_skip;          /// frame bytes left to discard
+    uint8_t              *message;          /// the frame being parsed
+    size_t                message_capacity; /// number of bytes allocated
+    size_t                oversize_count;   /// number of frames discarded
+    uint8_t               rx_buffer[4096];
+};
+
+/// Creates a publisher listening for remote clients. Nothing is serialized
+/// or sent until at least one client has subscribed to the destination.
+///
+/// @param publisher The publisher state to initialize.
+/// @param service_or_port The port number or service name to listen on.
+/// @param destination The NULL-terminated destination that clients must
+/// subscribe to. If this value is NULL, PROFNET_DEFAULT_DESTINATION is used.
+/// @param interval The number of seconds between published summaries. The
+/// publisher also polls for new clients at this interval.
+/// @param local_only Specify true to accept connections from the local host
+/// only.
+/// @return true if the publisher was created successfully.
+CMN_PUBLIC bool create_publisher(
+    profnet::publisher_t *publisher,
+    char const           *service_or_port,
+    char const           *destination,
+    float                 interval,
+    bool                  local_only);
+
+/// Disconnects all clients of a publisher, closes the listening socket and
+/// releases any memory allocated by the publisher.
+///
+/// @param publisher The publisher state to delete.
+CMN_PUBLIC void delete_publisher(profnet::publisher_t *publisher);
+
+/// Services a publisher. This function should be called from the thread that
+/// calls profile::update(), after the update. When less than the configured
+/// interval has elapsed since the last publish tick, the function returns
+/// immediately. Otherwise, new clients are accepted, client frames are
+/// processed and, if any client is subscribed, a summary of the current
+/// profile report is sent to each subscriber.
+///
+/// @param publisher The publisher to service.
+/// @return The number of subscribers the summary was sent to.
+CMN_PUBLIC size_t publish(profnet::publisher_t *publisher);
+
+/// Connects to a publisher and subscribes to a destination.
+///
+/// @param listener The listener state to initialize.
+/// @param host_or_address The host name or address of the publisher.
+/// @param service_or_port The port number or service name of the publisher.
+/// @param destination The NULL-terminated destination to subscribe to. If
+/// this value is NULL, PROFNET_DEFAULT_DESTINATION is used.
+/// @return true if the connection was established and the subscription sent.
+CMN_PUBLIC bool create_listener(
+    profnet::listener_t  *listener,
+    char const           *host_or_address,
+    char const           *service_or_port,
+    char const           *destination);
+
+/// Unsubscribes and disconnects a listener from its publisher, and releases
+/// any memory allocated by the listener.
+///
+/// @param listener The listener state to delete.
+CMN_PUBLIC void delete_listener(profnet::listener_t *listener);
+
+/// Waits for the next profile summary to be received by a listener. Frames
+/// other than MESSAGE frames are discarded, as are frames larger than
+/// PROFNET_LISTEN_BUFFER_MAX; the latter are counted in the oversize_count
+/// field of the listener.
+///
+/// @param listener The listener to receive on.
+/// @param timeout_usec The maximum amount of time to wait for data, in
+/// microseconds, each time the socket is polled.
+/// @param out_body On return, points to the body of the received MESSAGE
+/// frame. The data remains valid until the next call.
+/// @param out_body_size On return, the size of the body, in bytes.
+/// @param out_disconnected On return, set to true if the publisher has
+/// disconnected.
+/// @return true if a summary was received, or false if the wait timed out or
+/// the publisher disconnected.
+CMN_PUBLIC bool receive_summary(
+    profnet::listener_t  *listener,
+    uint64_t              timeout_usec,
+    void const          **out_body,
+    size_t               *out_body_size,
+    bool                 *out_disconnected);
+
+/// Decodes a profile report in profile::EXPORT_SUMMARY format.
+///
+/// @param data Pointer to the summary data.
+/// @param data_size The number of bytes of summary data.
+/// @param out_header On return, the summary header is copied here.
+/// @param zone_func The callback to invoke for each zone record. This value
+/// may be NULL to decode only the header.
+/// @param context Opaque application-defined data to be passed to the
+/// callback function @a zone_func.
+/// @return true if the data is a valid summary and all records were decoded.
+CMN_PUBLIC bool decode_summary(
+    void const                *data,
+    size_t                     data_size,
+    profile::summary_header_t *out_header,
+    profnet::summary_zone_fn   zone_func,
+    void                      *context);
+
+/// Decodes the counter and gauge records of a profile report in
+/// profile::EXPORT_SUMMARY format.
+///
+/// @param data Pointer to the summary data.
+/// @param data_size The number of bytes of summary data.
+/// @param metric_func The callback to invoke for each metric record.
+/// @param context Opaque application-defined data to be passed to the
+/// callback function @a metric_func.
+/// @return true if the data is a valid summary and all records were decoded.
+CMN_PUBLIC bool decode_summary_metrics(
+    void const                *data,
+    size_t                     data_size,
+    profnet::summary_metric_fn metric_func,
+    void                      *context);
+
+/*/////////////////////
+//   Namespace End   //
+/////////////////////*/
+}; /* end namespace profnet */
+
+#endif /* LIBPROFNET_HPP_INCLUDED */
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
@@ -174,6 +174,20 @@ static int32_t stomp_parse_error(
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+static uint8_t* rebase_pointer(void *p, uint8_t *old_base, size_t old_size, uint8_t *new_base)
+{
+    // returns the address at the same offset in the new message buffer as p
+    // is in the old buffer; pointers outside of the old buffer are returned.
+    uint8_t *u = (uint8_t*) p;
+    if (u != NULL && u >= old_base && u <= old_base + old_size)
+    {
+        return new_base + (u - old_base);
+    }
+    return u;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 static int32_t stomp_write_error(
     stomp::write_state_t *state,
     char const           *error)
@@ -1831,6 +1845,48 @@ int32_t stomp::parse_state_recover(stomp::parse_state_t *state)
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+bool stomp::parse_state_resize(
+    stomp::parse_state_t *state,
+    void                 *buffer,
+    size_t                buffer_size)
+{
+    uint8_t         *old_base = state->message_buffer;
+    size_t           old_size = state->message_size;
+    uint8_t         *new_base = (uint8_t*) buffer;
+    stomp::header_t *h        =&state->message_header;
+
+    if (NULL == new_base || buffer_size <= old_size)
+    {
+        return false;
+    }
+    if (old_size > 0)
+    {
+        // the header strings and body all point into the message buffer.
+        memmove(new_base, old_base, old_size);
+        h->command         = (char*) rebase_pointer(h->command,         old_base, old_size, new_base);
+        h->content_type    = (char*) rebase_pointer(h->content_type,    old_base, old_size, new_base);
+        h->content_charset = (char*) rebase_pointer(h->content_charset, old_base, old_size, new_base);
+        for (size_t i = 0; i < h->header_count; ++i)
+        {
+            h->header_fields[i] = (char*) rebase_pointer(h->header_fields[i], old_base, old_size, new_base);
+            h->header_values[i] = (char*) rebase_pointer(h->header_values[i], old_base, old_size, new_base);
+        }
+        state->message_body_head = rebase_pointer(state->message_body_head, old_base, old_size, new_base);
+        state->message_body_tail = rebase_pointer(state->message_body_tail, old_base, old_size, new_base);
+    }
+    state->message_buffer      = new_base;
+    state->message_buffer_size = buffer_size;
+    if (stomp::parse_state_full(state))
+    {
+        // the byte that did not fit was not consumed; parsing resumes there.
+        state->parse_state_global  = stomp::PARSE_STATE_NEED_MORE;
+        state->error_description   = STOMP_ERROR_STR_NONE;
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 bool stomp::parse_state_error(stomp::parse_state_t *s)
 {
     return (stomp::PARSE_STATE_ERROR == s->parse_state_global);
@@ -1838,6 +1894,14 @@ bool stomp::parse_state_error(stomp::parse_state_t *s)
 
 /*/////////////////////////////////////////////////////////////////////////80*/
 
+bool stomp::parse_state_full(stomp::parse_state_t *s)
+{
+    return (stomp::PARSE_STATE_ERROR   == s->parse_state_global &&
+            STOMP_ERROR_STR_BUFFERSPACE == s->error_description);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
 bool stomp::parse_state_valid(stomp::parse_state_t *s)
 {
     return (s->message_buffer != NULL && s->message_buffer_size > 0);
@@ -1882,6 +1946,12 @@ int32_t stomp::parse_state_update(
     while (it != end)
     {
         // consume input one unit at a time.
+        // each unit produces at most one byte.
+        if (state->message_size >= state->message_buffer_size)
+        {
+            stomp_parse_error(state, STOMP_ERROR_STR_BUFFERSPACE);
+            break;
+        }
         size_t   num_consumed = 0;
         size_t   num_produced = 0;
         uint8_t *msg_buffer   =&state->message_buffer[state->message_size];
@@ -496,6 +496,21 @@ CMN_PUBLIC int32_t parse_state_reset(stomp::parse_state_t *state);
 /// global parser state.
 CMN_PUBLIC int32_t parse_state_recover(stomp::parse_state_t *state);
 
+/// Moves the message being parsed into a different buffer, typically after
+/// stomp::parse_state_update() stopped because the message did not fit. The
+/// partial message is copied and parsing resumes where it stopped; the old
+/// buffer may be freed once this function returns.
+///
+/// @param state The parser state to update.
+/// @param buffer The new message composition buffer.
+/// @param buffer_size The size of @a buffer, in bytes. This must be larger
+/// than the partial message.
+/// @return true if the message was moved, or false if @a buffer is too small.
+CMN_PUBLIC bool parse_state_resize(
+    stomp::parse_state_t *state,
+    void                 *buffer,
+    size_t                buffer_size);
+
 /// Checks the state of a STOMP message parser to determine whether it is
 /// currently in an error state.
 ///
@@ -503,6 +518,15 @@ CMN_PUBLIC int32_t parse_state_recover(stomp::parse_state_t *state);
 /// @return true if the parser is currently in the error state.
 CMN_PUBLIC bool parse_state_error(stomp::parse_state_t *state);
 
+/// Checks the state of a STOMP message parser to determine whether it stopped
+/// because the message did not fit in the message buffer. The parser can be
+/// resumed with stomp::parse_state_resize(), or the message discarded with
+/// stomp::parse_state_recover().
+///
+/// @param state The parser state to inspect.
+/// @return true if the message buffer is full.
+CMN_PUBLIC bool parse_state_full(stomp::parse_state_t *state);
+
 /// Checks the state of a STOMP message parser to ensure that it is valid, that
 /// is, that it has a valid message buffer set.
 ///
@@ -529,7 +553,9 @@ CMN_PUBLIC bool parse_state_ready(stomp::parse_state_t *state);
 /// @param amount_consumed On return, this location is updated with the number
 /// of bytes consumed in @a rx_buffer, starting at @a rx_buffer_offset. This
 /// value may be less than @rx_buffer_count, in which case either an error
-/// occurred, or a complete message was parsed.
+/// occurred, or a complete message was parsed. If the message does not fit
+/// in the message buffer, parsing stops with stomp::PARSE_STATE_ERROR and
+/// stomp::parse_state_full() returns true.
 /// @return One of the stomp::parse_state_e values indicating the current
 /// global parser state. If this value is stomp::PARSE_STATE_ERROR, an error
 /// occurred. If this value is stomp::PARSE_STATE_MESSAGE_COMPLETE, a complete
@@ -0,0 +1,168 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements a command-line tool that subscribes to the profile
+/// publisher of a running process and prints the hottest zones, and any
+/// counters and gauges, each time a profile summary is received.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "libprofnet.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the number of zones printed for each summary, unless overridden.
+#define DEFAULT_ZONE_COUNT     20
+/// the time to wait for a summary before checking the connection.
+#define RECEIVE_TIMEOUT_USEC   1000000U
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct print_state_t
+{
+    size_t remaining;     /// number of zones left to print
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool CMN_CALL_C print_zone(
+    profile::summary_zone_t const *zone,
+    char const                    *name,
+    void                          *context)
+{
+    // zones are ordered by decreasing self time, so the
+    // first few zones in the summary are the hottest.
+    print_state_t *state = (print_state_t*) context;
+    if (0 == state->remaining) return false;
+    printf("%9.3f %9.3f %9.2f  %.*s\n",
+        double(zone->self_ms),
+        double(zone->heir_ms),
+        double(zone->entries),
+        int(zone->name_length), name);
+    state->remaining--;
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool CMN_CALL_C print_metric(
+    profile::summary_metric_t const *metric,
+    char const                      *name,
+    void                            *context)
+{
+    CMN_UNUSED(context);
+    printf("%9.2f %9lld %9s  %.*s\n",
+        double(metric->value),
+        (long long) metric->sample,
+        (profile::METRIC_COUNTER == metric->type) ? "counter" : "gauge",
+        int(metric->name_length), name);
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static void print_usage(char const *program)
+{
+    fprintf(stderr, "usage: %s host port [destination] [zone_count]\n", program);
+    fprintf(stderr, "  destination defaults to %s\n", PROFNET_DEFAULT_DESTINATION);
+    fprintf(stderr, "  zone_count  defaults to %d\n", DEFAULT_ZONE_COUNT);
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int main(int argc, char **argv)
+{
+    profnet::listener_t *listener    = NULL;
+    char const          *destination = PROFNET_DEFAULT_DESTINATION;
+    size_t               zone_count  = DEFAULT_ZONE_COUNT;
+    size_t               oversize    = 0;
+    bool                 disconnect  = false;
+
+    if (argc < 3)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (argc > 3) destination = argv[3];
+    if (argc > 4) zone_count  = size_t(atoi(argv[4]));
+
+    // the listener holds a large parse buffer; keep it off the stack.
+    listener = (profnet::listener_t*) malloc(sizeof(profnet::listener_t));
+    if (NULL == listener || !network::startup())
+    {
+        fprintf(stderr, "ERROR: unable to initialize.\n");
+        free(listener);
+        return 1;
+    }
+    if (!profnet::create_listener(listener, argv[1], argv[2], destination))
+    {
+        fprintf(stderr, "ERROR: unable to connect to %s:%s.\n", argv[1], argv[2]);
+        network::cleanup();
+        free(listener);
+        return 1;
+    }
+
+    while (!disconnect)
+    {
+        profile::summary_header_t header;
+        print_state_t             state;
+        void const               *body = NULL;
+        size_t                    size = 0;
+        bool                      received;
+
+        received = profnet::receive_summary(listener, RECEIVE_TIMEOUT_USEC, &body, &size, &disconnect);
+        if (listener->oversize_count != oversize)
+        {
+            fprintf(stderr, "WARNING: discarded %u summaries larger than %u bytes.\n",
+                unsigned(listener->oversize_count - oversize), unsigned(PROFNET_LISTEN_BUFFER_MAX));
+            oversize = listener->oversize_count;
+        }
+        if (!received)
+        {
+            continue;
+        }
+        state.remaining = zone_count;
+        if (!profnet::decode_summary(body, size, &header, NULL, NULL))
+        {
+            fprintf(stderr, "WARNING: discarded malformed summary.\n");
+            continue;
+        }
+        printf("\n%.3f ms/frame (%llu updates)\n",
+            double(header.frame_ms),
+            (unsigned long long) header.update_count);
+        if (header.dropped > 0)
+        {
+            printf("%u call sites not reported; the location table is full.\n",
+                unsigned(header.dropped));
+        }
+        printf("%9s %9s %9s  %s\n", "SELF", "HEIR", "COUNT", "ZONE");
+        profnet::decode_summary(body, size, &header, print_zone, &state);
+        if (header.metric_count > 0)
+        {
+            printf("%9s %9s %9s  %s\n", "VALUE", "SAMPLE", "TYPE", "METRIC");
+            profnet::decode_summary_metrics(body, size, print_metric, NULL);
+        }
+        fflush(stdout);
+    }
+
+    printf("publisher disconnected.\n");
+    profnet::delete_listener(listener);
+    network::cleanup();
+    free(listener);
+    return 0;
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/
@@ -0,0 +1,255 @@
+/*/////////////////////////////////////////////////////////////////////////////
+/// @summary Implements a command-line tool that checks libprofnet end to end.
+/// A publisher and a listener are connected over 127.0.0.1 within a single
+/// process, a few profile summaries are published and each one is decoded and
+/// compared against the values recorded for that tick. The tool exits with a
+/// non-zero status if any summary is missing or does not match.
+/// @author Russell Klenk (russ@ninjabirdstudios.com)
+///////////////////////////////////////////////////////////////////////////80*/
+
+/*////////////////
+//   Includes   //
+////////////////*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libprofnet.hpp"
+
+/*//////////////////////////
+//   Using Declarations   //
+//////////////////////////*/
+
+/*//////////////////////
+//   Implementation   //
+//////////////////////*/
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+/// the port the publisher listens on, unless overridden.
+#define DEFAULT_PORT           "43917"
+/// the number of summaries published and checked.
+#define FRAME_COUNT            4
+/// the amount added to the loopback_items counter per frame, times the
+/// one-based frame number, so each summary carries a distinct sample.
+#define ITEMS_PER_FRAME        10
+/// the time to wait for data each time the listener is polled.
+#define RECEIVE_TIMEOUT_USEC   10000U
+/// the number of times the publisher is serviced before giving up on a frame.
+#define MAX_ATTEMPTS           500
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+struct check_state_t
+{
+    bool    found_zone;   /// true if the loopback_work zone was decoded
+    bool    found_metric; /// true if the loopback_items counter was decoded
+    int64_t sample;       /// the sample reported for loopback_items
+};
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+PROFILER_DEFINE_COUNTER(loopback_items);
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool name_equals(char const *name, size_t length, char const *expected)
+{
+    return (strlen(expected) == length && 0 == memcmp(name, expected, length));
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool CMN_CALL_C check_zone(
+    profile::summary_zone_t const *zone,
+    char const                    *name,
+    void                          *context)
+{
+    check_state_t *state = (check_state_t*) context;
+    if (name_equals(name, zone->name_length, "loopback_work"))
+    {
+        state->found_zone = true;
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool CMN_CALL_C check_metric(
+    profile::summary_metric_t const *metric,
+    char const                      *name,
+    void                            *context)
+{
+    check_state_t *state = (check_state_t*) context;
+    if (name_equals(name, metric->name_length, "loopback_items") &&
+        profile::METRIC_COUNTER == metric->type)
+    {
+        state->found_metric = true;
+        state->sample       = metric->sample;
+    }
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static uint32_t do_work(size_t frame)
+{
+    PROFILER_ENTER_SCOPE(loopback_work);
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < (frame + 1) * ITEMS_PER_FRAME; ++i)
+    {
+        hash = (hash ^ uint32_t(i)) * 16777619U;
+        PROFILER_COUNT(loopback_items, 1);
+    }
+    return hash;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool pump(
+    profnet::publisher_t *publisher,
+    profnet::listener_t  *listener,
+    void const          **out_body,
+    size_t               *out_size)
+{
+    // the first few publish ticks only accept the listener and
+    // process its CONNECT and SUBSCRIBE frames. once a summary
+    // has been sent, stop publishing and wait for it to arrive.
+    bool sent = false;
+    for (size_t i = 0; i < MAX_ATTEMPTS; ++i)
+    {
+        bool disconnect = false;
+        if (!sent)
+        {
+            sent = (profnet::publish(publisher) > 0);
+        }
+        if (profnet::receive_summary(listener, RECEIVE_TIMEOUT_USEC, out_body, out_size, &disconnect))
+        {
+            return true;
+        }
+        if (disconnect)
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+static bool check_frame(void const *body, size_t size, size_t frame)
+{
+    profile::summary_header_t header;
+    check_state_t             state;
+    int64_t                   items = int64_t((frame + 1) * ITEMS_PER_FRAME);
+
+    state.found_zone   = false;
+    state.found_metric = false;
+    state.sample       = 0;
+    if (!profnet::decode_summary(body, size, &header, check_zone, &state) ||
+        !profnet::decode_summary_metrics(body, size, check_metric, &state))
+    {
+        fprintf(stderr, "ERROR: frame %u: malformed summary.\n", unsigned(frame));
+        return false;
+    }
+    if (header.update_count != uint64_t(frame + 1))
+    {
+        fprintf(stderr, "ERROR: frame %u: update_count %llu, expected %u.\n",
+            unsigned(frame), (unsigned long long) header.update_count, unsigned(frame + 1));
+        return false;
+    }
+    if (!state.found_zone)
+    {
+        fprintf(stderr, "ERROR: frame %u: zone loopback_work missing.\n", unsigned(frame));
+        return false;
+    }
+    if (!state.found_metric || state.sample != items)
+    {
+        fprintf(stderr, "ERROR: frame %u: loopback_items sample %lld, expected %lld.\n",
+            unsigned(frame), (long long) state.sample, (long long) items);
+        return false;
+    }
+    printf("frame %u: %u zones, %u metrics, %u bytes ok\n",
+        unsigned(frame), unsigned(header.zone_count),
+        unsigned(header.metric_count), unsigned(size));
+    return true;
+}
+
+/*/////////////////////////////////////////////////////////////////////////80*/
+
+int main(int argc, char **argv)
+{
+    profnet::publisher_t *publisher = NULL;
+    profnet::listener_t  *listener  = NULL;
+    char const           *port      = DEFAULT_PORT;
+    uint32_t              hash      = 0;
+    int                   result    = 1;
+
+    if (argc > 2)
+    {
+        fprintf(stderr, "usage: %s [port]\n", argv[0]);
+        fprintf(stderr, "  port defaults to %s\n", DEFAULT_PORT);
+        return 1;
+    }
+    if (argc > 1) port = argv[1];
+
+    // both structures hold large buffers; keep them off the stack.
+    publisher = (profnet::publisher_t*) malloc(sizeof(profnet::publisher_t));
+    listener  = (profnet::listener_t *) malloc(sizeof(profnet::listener_t));
+    if (NULL == publisher || NULL == listener || !network::startup())
+    {
+        fprintf(stderr, "ERROR: unable to initialize.\n");
+        free(listener);
+        free(publisher);
+        return 1;
+    }
+    profile::initialize(NULL);
+    profile::register_thread("main");
+
+    if (!profnet::create_publisher(publisher, port, NULL, 0.0f, true))
+    {
+        fprintf(stderr, "ERROR: unable to listen on port %s.\n", port);
+        goto cleanup_profile;
+    }
+    // a local-only publisher binds the first loopback address returned
+    // by the resolver, which is ::1 on hosts that prefer IPv6.
+    if (!profnet::create_listener(listener, "127.0.0.1", port, NULL) &&
+        !profnet::create_listener(listener, "::1", port, NULL))
+    {
+        fprintf(stderr, "ERROR: unable to connect to the loopback port %s.\n", port);
+        goto cleanup_publisher;
+    }
+
+    result = 0;
+    for (size_t frame = 0; frame < FRAME_COUNT && 0 == result; ++frame)
+    {
+        void const *body = NULL;
+        size_t      size = 0;
+
+        hash ^= do_work(frame);
+        profile::update(profile::UPDATE_ACCUMULATE);
+        if (!pump(publisher, listener, &body, &size))
+        {
+            fprintf(stderr, "ERROR: frame %u: no summary received.\n", unsigned(frame));
+            result = 1;
+        }
+        else if (!check_frame(body, size, frame))
+        {
+            result = 1;
+        }
+    }
+    printf("%s (%08X)\n", (0 == result) ? "passed" : "FAILED", hash);
+
+    profnet::delete_listener(listener);
+cleanup_publisher:
+    profnet::delete_publisher(publisher);
+cleanup_profile:
+    profile::shutdown();
+    network::cleanup();
+    free(listener);
+    free(publisher);
+    return result;
+}
+
+/*/////////////////////////////////////////////////////////////////////////////
+//    $Id$
+///////////////////////////////////////////////////////////////////////////80*/